@@ -30,6 +30,7 @@
 
 #include "itkProcessObject.h"
 #include "itkImage.h"
+#include "itkSimpleFastMutexLock.h"
 
 namespace itk
 {
@@ -53,6 +54,12 @@ namespace itk
  * ProcessObject::ReleaseDataBeforeUpdateFlagOn().  A user may want to
  * set this flag to limit peak memory usage during a pipeline update.
  *
+ * By default the output requested region is split in one piece per
+ * thread. When DynamicMultiThreading is on, the region is instead split
+ * in NumberOfChunksPerThread pieces per thread, and each thread
+ * repeatedly claims the next unprocessed piece until none is left. This
+ * balances the load for filters whose cost per pixel is not uniform.
+ *
  * \ingroup DataSources
  * \ingroup ITKCommon
  *
@@ -208,9 +215,26 @@ public:
   using Superclass::MakeOutput;
   virtual DataObjectPointer MakeOutput(unsigned int idx);
 
+  /** Set/Get whether the threads pull pieces of the output region
+   * dynamically instead of receiving a single piece each. In this mode
+   * ThreadedGenerateData() is called several times per thread, always with
+   * the same threadId for a given thread, so per thread state indexed by
+   * threadId remains valid. Filters that expect exactly one call per
+   * thread must not turn this on. Off by default. */
+  itkSetMacro(DynamicMultiThreading, bool);
+  itkGetConstMacro(DynamicMultiThreading, bool);
+  itkBooleanMacro(DynamicMultiThreading);
+
+  /** Set/Get the number of pieces per thread the output region is split in
+   * when DynamicMultiThreading is on. Defaults to 8. */
+  itkSetClampMacro(NumberOfChunksPerThread, unsigned int, 1,
+                   NumericTraits< unsigned int >::max());
+  itkGetConstMacro(NumberOfChunksPerThread, unsigned int);
+
 protected:
   ImageSource();
   virtual ~ImageSource() {}
+  void PrintSelf(std::ostream & os, Indent indent) const;
 
   /** A version of GenerateData() specific for image processing
    * filters.  This implementation will split the processing across
@@ -299,6 +323,11 @@ protected:
    * control to ThreadedGenerateData(). */
   static ITK_THREAD_RETURN_TYPE ThreaderCallback(void *arg);
 
+  /** Static function used as a "callback" by the MultiThreader when
+   * DynamicMultiThreading is on. Each thread calls ThreadedGenerateData()
+   * on the pieces it claims until all the pieces have been processed. */
+  static ITK_THREAD_RETURN_TYPE DynamicThreaderCallback(void *arg);
+
   /** Internal structure used for passing image data into the threading library
     */
   struct ThreadStruct {
@@ -307,6 +336,19 @@ protected:
 private:
   ImageSource(const Self &);    //purposely not implemented
   void operator=(const Self &); //purposely not implemented
+
+  /** Claim the next unprocessed piece. Returns false when all the pieces
+   * have been claimed. */
+  bool GetNextChunk(unsigned int & chunk);
+
+  bool         m_DynamicMultiThreading;
+  unsigned int m_NumberOfChunksPerThread;
+
+  /** Number of pieces of the current execution, and next piece to hand out.
+   * m_NextChunk is protected by m_ChunkLock. */
+  unsigned int        m_NumberOfChunks;
+  unsigned int        m_NextChunk;
+  SimpleFastMutexLock m_ChunkLock;
 };
 } // end namespace itk
 
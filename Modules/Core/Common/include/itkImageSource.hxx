@@ -53,6 +53,11 @@ ImageSource< TOutputImage >
   // output bulk data prior to GenerateData() in case that bulk data
   // can be reused (an thus avoid a costly deallocate/allocate cycle).
   this->ReleaseDataBeforeUpdateFlagOff();
+
+  m_DynamicMultiThreading = false;
+  m_NumberOfChunksPerThread = 8;
+  m_NumberOfChunks = 0;
+  m_NextChunk = 0;
 }
 
 /**
@@ -269,7 +274,20 @@ ImageSource< TOutputImage >
   str.Filter = this;
 
   this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
-  this->GetMultiThreader()->SetSingleMethod(this->ThreaderCallback, &str);
+  if ( m_DynamicMultiThreading )
+    {
+    // Ask for more pieces than threads; SplitRequestedRegion() tells how
+    // many it could actually produce.
+    OutputImageRegionType splitRegion;
+    m_NumberOfChunks = this->SplitRequestedRegion(
+      0, this->GetMultiThreader()->GetNumberOfThreads() * m_NumberOfChunksPerThread, splitRegion);
+    m_NextChunk = 0;
+    this->GetMultiThreader()->SetSingleMethod(this->DynamicThreaderCallback, &str);
+    }
+  else
+    {
+    this->GetMultiThreader()->SetSingleMethod(this->ThreaderCallback, &str);
+    }
 
   // multithread the execution
   this->GetMultiThreader()->SingleMethodExecute();
@@ -336,6 +354,62 @@ ImageSource< TOutputImage >
 
   return ITK_THREAD_RETURN_VALUE;
 }
+
+template< class TOutputImage >
+bool
+ImageSource< TOutputImage >
+::GetNextChunk(unsigned int & chunk)
+{
+  bool found = false;
+
+  m_ChunkLock.Lock();
+  if ( m_NextChunk < m_NumberOfChunks )
+    {
+    chunk = m_NextChunk++;
+    found = true;
+    }
+  m_ChunkLock.Unlock();
+  return found;
+}
+
+// Callback routine used by the threading library when the pieces are
+// distributed dynamically. Each thread processes pieces until none is left,
+// always passing its own threadId to ThreadedGenerateData.
+template< class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+ImageSource< TOutputImage >
+::DynamicThreaderCallback(void *arg)
+{
+  ThreadStruct *str;
+  ThreadIdType  threadId;
+
+  threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+
+  str = (ThreadStruct *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  typename TOutputImage::RegionType splitRegion;
+  unsigned int                      chunk;
+  while ( str->Filter->GetNextChunk(chunk) )
+    {
+    str->Filter->SplitRequestedRegion(chunk, str->Filter->m_NumberOfChunks,
+                                      splitRegion);
+    str->Filter->ThreadedGenerateData(splitRegion, threadId);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TOutputImage >
+void
+ImageSource< TOutputImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "DynamicMultiThreading: "
+     << ( m_DynamicMultiThreading ? "On" : "Off" ) << std::endl;
+  os << indent << "NumberOfChunksPerThread: " << m_NumberOfChunksPerThread << std::endl;
+}
 } // end namespace itk
 
 #endif
@@ -20,6 +20,7 @@
 
 #include "itkObject.h"
 #include "itkObjectFactory.h"
+#include "itkPixelBufferAllocator.h"
 #include <utility>
 
 namespace itk
@@ -36,6 +37,12 @@ namespace itk
  *
  * \tparam TElement The element type stored in the container.
  *
+ * The memory managed by the container is allocated according to its
+ * AllocationPolicy: with new[] (the default), or through
+ * PixelBufferAllocator as an aligned, an uninitialized or a pooled buffer.
+ * The container can also hold a view of a file mapped in memory, see
+ * MapFile().
+ *
  * \ingroup ImageObjects
  * \ingroup IOFilters
  * \ingroup ITKCommon
@@ -55,6 +62,8 @@ public:
   typedef TElementIdentifier ElementIdentifier;
   typedef TElement           Element;
 
+  typedef PixelBufferAllocator::PolicyType AllocationPolicyType;
+
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
 
@@ -73,6 +82,17 @@ public:
   void SetImportPointer(TElement *ptr, TElementIdentifier num,
                         bool LetContainerManageMemory = false);
 
+  /** Replace the buffer by num elements mapped from the file fileName,
+   * starting at byte offset. The file must store the elements exactly as
+   * they are laid out in memory. policy is
+   * PixelBufferAllocator::MappedReadOnlyPolicy, in which case the elements
+   * must not be modified, or PixelBufferAllocator::MappedCopyOnWritePolicy.
+   * The mapping is released with the container. Returns false, leaving the
+   * container unchanged, when the file cannot be mapped, or when offset is
+   * not aligned for TElement. */
+  bool MapFile(const char *fileName, SizeValueType offset, ElementIdentifier num,
+               AllocationPolicyType policy);
+
   /** Index operator. This version can be an lvalue. */
   TElement & operator[](const ElementIdentifier id)
   { return m_ImportPointer[id]; }
@@ -131,6 +151,14 @@ public:
   itkSetMacro(ContainerManageMemory, bool);
   itkGetConstMacro(ContainerManageMemory, bool);
   itkBooleanMacro(ContainerManageMemory);
+
+  /** Set/Get how the buffers allocated from now on by this container are
+   * obtained. The initial value is
+   * PixelBufferAllocator::GetGlobalDefaultPolicy(). Changing the policy does
+   * not affect the buffer currently held by the container.
+   * \sa PixelBufferAllocator */
+  itkSetEnumMacro(AllocationPolicy, AllocationPolicyType);
+  itkGetEnumMacro(AllocationPolicy, AllocationPolicyType);
 protected:
   ImportImageContainer();
   virtual ~ImportImageContainer();
@@ -169,10 +197,18 @@ private:
   ImportImageContainer(const Self &); //purposely not implemented
   void operator=(const Self &);       //purposely not implemented
 
-  TElement *         m_ImportPointer;
-  TElementIdentifier m_Size;
-  TElementIdentifier m_Capacity;
-  bool               m_ContainerManageMemory;
+  /** Whether the elements of a buffer allocated with the given policy have
+   * been constructed, and must therefore be destroyed. */
+  static bool ElementsAreConstructed(AllocationPolicyType policy);
+
+  TElement *           m_ImportPointer;
+  TElementIdentifier   m_Size;
+  TElementIdentifier   m_Capacity;
+  bool                 m_ContainerManageMemory;
+  AllocationPolicyType m_AllocationPolicy;
+
+  /** Policy with which m_ImportPointer was allocated, used to release it. */
+  AllocationPolicyType m_BufferAllocationPolicy;
 };
 } // end namespace itk
 
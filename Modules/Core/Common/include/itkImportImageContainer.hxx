@@ -29,7 +29,9 @@
 #define __itkImportImageContainer_hxx
 
 #include "itkImportImageContainer.h"
+#include <algorithm>
 #include <cstring>
+#include <new>
 #include <stdlib.h>
 #include <string.h>
 
@@ -43,6 +45,8 @@ ImportImageContainer< TElementIdentifier, TElement >
   m_ContainerManageMemory = true;
   m_Capacity = 0;
   m_Size = 0;
+  m_AllocationPolicy = PixelBufferAllocator::GetGlobalDefaultPolicy();
+  m_BufferAllocationPolicy = PixelBufferAllocator::NewPolicy;
 }
 
 template< typename TElementIdentifier, typename TElement >
@@ -66,15 +70,19 @@ ImportImageContainer< TElementIdentifier, TElement >
   // See http://www.itk.org/Bug/view.php?id=2893 for details
   if ( m_ImportPointer )
     {
-    if ( size > m_Capacity )
+    // The caller of Reserve writes to the buffer, which a read-only
+    // mapping does not allow.
+    if ( size > m_Capacity
+         || m_BufferAllocationPolicy == PixelBufferAllocator::MappedReadOnlyPolicy )
       {
       TElement *temp = this->AllocateElements(size);
       // only copy the portion of the data used in the old buffer
-      memcpy( temp, m_ImportPointer, m_Size * sizeof( TElement ) );
+      memcpy( temp, m_ImportPointer, std::min(m_Size, size) * sizeof( TElement ) );
 
       DeallocateManagedMemory();
 
       m_ImportPointer = temp;
+      m_BufferAllocationPolicy = m_AllocationPolicy;
       m_ContainerManageMemory = true;
       m_Capacity = size;
       m_Size = size;
@@ -89,6 +97,7 @@ ImportImageContainer< TElementIdentifier, TElement >
   else
     {
     m_ImportPointer = this->AllocateElements(size);
+    m_BufferAllocationPolicy = m_AllocationPolicy;
     m_Capacity = size;
     m_Size = size;
     m_ContainerManageMemory = true;
@@ -116,6 +125,7 @@ ImportImageContainer< TElementIdentifier, TElement >
       DeallocateManagedMemory();
 
       m_ImportPointer = temp;
+      m_BufferAllocationPolicy = m_AllocationPolicy;
       m_ContainerManageMemory = true;
       m_Capacity = size;
       m_Size = size;
@@ -160,6 +170,8 @@ ImportImageContainer< TElementIdentifier, TElement >
 {
   DeallocateManagedMemory();
   m_ImportPointer = ptr;
+  // A pointer handed over by the application is released with delete[].
+  m_BufferAllocationPolicy = PixelBufferAllocator::NewPolicy;
   m_ContainerManageMemory = LetContainerManageMemory;
   m_Capacity = num;
   m_Size = num;
@@ -167,6 +179,37 @@ ImportImageContainer< TElementIdentifier, TElement >
   this->Modified();
 }
 
+template< typename TElementIdentifier, typename TElement >
+bool
+ImportImageContainer< TElementIdentifier, TElement >
+::MapFile(const char *fileName, SizeValueType offset, ElementIdentifier num,
+          AllocationPolicyType policy)
+{
+  // The elements are at offset from a page boundary: they must not be
+  // misaligned.
+  if ( !PixelBufferAllocator::IsMappedPolicy(policy)
+       || offset % PixelBufferAlignment< TElement >::Value != 0 )
+    {
+    return false;
+    }
+  TElement *data = static_cast< TElement * >(
+    PixelBufferAllocator::MapFile(fileName, offset, num * sizeof( TElement ), policy) );
+  if ( !data )
+    {
+    return false;
+    }
+
+  DeallocateManagedMemory();
+  m_ImportPointer = data;
+  m_BufferAllocationPolicy = policy;
+  m_ContainerManageMemory = true;
+  m_Capacity = num;
+  m_Size = num;
+
+  this->Modified();
+  return true;
+}
+
 template< typename TElementIdentifier, typename TElement >
 TElement *ImportImageContainer< TElementIdentifier, TElement >
 ::AllocateElements(ElementIdentifier size) const
@@ -178,7 +221,22 @@ TElement *ImportImageContainer< TElementIdentifier, TElement >
 
   try
     {
-    data = new TElement[size];
+    if ( m_AllocationPolicy == PixelBufferAllocator::NewPolicy )
+      {
+      data = new TElement[size];
+      }
+    else
+      {
+      data = static_cast< TElement * >(
+        PixelBufferAllocator::Allocate(size * sizeof( TElement ), m_AllocationPolicy) );
+      if ( data && ElementsAreConstructed(m_AllocationPolicy) )
+        {
+        for ( ElementIdentifier i = 0; i < size; i++ )
+          {
+          new( data + i ) TElement;
+          }
+        }
+      }
     }
   catch ( ... )
     {
@@ -202,13 +260,42 @@ void ImportImageContainer< TElementIdentifier, TElement >
   // Encapsulate all image memory deallocation here
   if ( m_ImportPointer && m_ContainerManageMemory )
     {
-    delete[] m_ImportPointer;
+    if ( m_BufferAllocationPolicy == PixelBufferAllocator::NewPolicy )
+      {
+      delete[] m_ImportPointer;
+      }
+    else
+      {
+      if ( ElementsAreConstructed(m_BufferAllocationPolicy) )
+        {
+        for ( ElementIdentifier i = 0; i < m_Capacity; i++ )
+          {
+          m_ImportPointer[i].~TElement();
+          }
+        }
+      PixelBufferAllocator::Deallocate(m_ImportPointer, m_Capacity * sizeof( TElement ),
+                                       m_BufferAllocationPolicy);
+      }
     }
   m_ImportPointer = 0;
   m_Capacity = 0;
   m_Size = 0;
 }
 
+template< typename TElementIdentifier, typename TElement >
+bool
+ImportImageContainer< TElementIdentifier, TElement >
+::ElementsAreConstructed(AllocationPolicyType policy)
+{
+  // The elements of a mapped file are the bytes of the file.
+  if ( PixelBufferAllocator::IsMappedPolicy(policy) )
+    {
+    return false;
+    }
+  return policy == PixelBufferAllocator::AlignedPolicy
+         || !PixelBufferTraits< TElement >::IsTriviallyConstructible;
+}
+
 template< typename TElementIdentifier, typename TElement >
 void
 ImportImageContainer< TElementIdentifier, TElement >
@@ -221,6 +308,7 @@ ImportImageContainer< TElementIdentifier, TElement >
      << ( m_ContainerManageMemory ? "true" : "false" ) << std::endl;
   os << indent << "Size: " << m_Size << std::endl;
   os << indent << "Capacity: " << m_Capacity << std::endl;
+  os << indent << "Allocation policy: " << m_AllocationPolicy << std::endl;
 }
 } // end namespace itk
 
@@ -126,16 +126,17 @@ public:
   /**
    * \author Hans J. Johnson
    * Function to return the stored value of type MetaDataObjectType.
+   * Subclasses may override it to compute the value on first access.
    * \return a constant reference to a MetaDataObjectType
    */
-  const MetaDataObjectType & GetMetaDataObjectValue(void) const;
+  virtual const MetaDataObjectType & GetMetaDataObjectValue(void) const;
 
   /**
    * \author Hans J. Johnson
    * Function to set the stored value of type MetaDataObjectType.
    * \param NewValue A constant reference to at MetaDataObjectType.
    */
-  void SetMetaDataObjectValue(const MetaDataObjectType & NewValue);
+  virtual void SetMetaDataObjectValue(const MetaDataObjectType & NewValue);
 
   /**
    * Defines the default behavior for printing out this element
@@ -89,6 +89,22 @@ public:
 
   static ThreadIdType  GetGlobalDefaultNumberOfThreads();
 
+  /** Set/Get whether the threads used by SingleMethodExecute() are taken
+   * from the process wide ThreadPool instead of being created and joined on
+   * every call. Reusing the pool workers removes the thread creation cost
+   * from each dispatch, which matters when a filter or a metric is executed
+   * many times, e.g. in an optimization loop. */
+  itkSetMacro(UseThreadPool, bool);
+  itkGetConstMacro(UseThreadPool, bool);
+  itkBooleanMacro(UseThreadPool);
+
+  /** Set/Get the value which is used to initialize UseThreadPool in the
+   * constructor. Unless it has been set explicitly, the default is read from
+   * the ITK_USE_THREADPOOL environment variable, and is off otherwise. */
+  static void SetGlobalDefaultUseThreadPool(bool flag);
+
+  static bool GetGlobalDefaultUseThreadPool();
+
   /** Execute the SingleMethod (as define by SetSingleMethod) using
    * m_NumberOfThreads threads. As a side effect the m_NumberOfThreads will be
    * checked against the current m_GlobalMaximumNumberOfThreads and clamped if
@@ -200,6 +216,14 @@ private:
    */
   ThreadIdType m_NumberOfThreads;
 
+  /** Whether SingleMethodExecute() dispatches to the ThreadPool. */
+  bool m_UseThreadPool;
+
+  /** Global variable defining the default value of m_UseThreadPool, and
+   * whether it has been initialized yet. */
+  static bool m_GlobalDefaultUseThreadPool;
+  static bool m_GlobalDefaultUseThreadPoolIsInitialized;
+
   /** Static function used as a "proxy callback" by the MultiThreader.  The
    * threading library will call this routine for each thread, which
    * will delegate the control to the prescribed SingleMethod. This
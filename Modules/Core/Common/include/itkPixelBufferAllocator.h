@@ -0,0 +1,224 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkPixelBufferAllocator_h
+#define __itkPixelBufferAllocator_h
+
+#include "itkMacro.h"
+#include "itkIntTypes.h"
+#include <cstddef>
+#include <complex>
+
+namespace itk
+{
+/** \class PixelBufferAllocator
+ * \brief Raw memory allocation strategies for image pixel buffers.
+ *
+ * PixelBufferAllocator provides the memory used by ImportImageContainer
+ * when its AllocationPolicy is not NewPolicy:
+ *
+ * - AlignedPolicy: the buffer starts on an Alignment byte boundary, so that
+ *   vectorized code can use aligned loads. The elements are default
+ *   constructed, as with new[].
+ * - UninitializedPolicy: as AlignedPolicy, but the element constructors are
+ *   not run for element types for which PixelBufferTraits reports a trivial
+ *   constructor.
+ * - PooledPolicy: as UninitializedPolicy, but released buffers are kept in a
+ *   process wide pool, bucketed by size, and handed out again to the next
+ *   allocation of the same bucket instead of being returned to the
+ *   system. The pool holds at most MaximumPooledSize bytes.
+ * - MappedReadOnlyPolicy and MappedCopyOnWritePolicy: the buffer is a view
+ *   of a file mapped in memory by MapFile(). These policies describe how a
+ *   buffer was obtained, they cannot be used to allocate one.
+ *
+ * The policy used by new containers is given by GetGlobalDefaultPolicy().
+ *
+ * \sa ImportImageContainer
+ * \ingroup ImageObjects
+ * \ingroup ITKCommon
+ */
+class ITKCommon_EXPORT PixelBufferAllocator
+{
+public:
+  typedef PixelBufferAllocator Self;
+
+  typedef enum { NewPolicy = 0, AlignedPolicy, UninitializedPolicy, PooledPolicy,
+                 MappedReadOnlyPolicy, MappedCopyOnWritePolicy } PolicyType;
+
+  /** Byte boundary on which the buffers returned by Allocate() start. */
+  itkStaticConstMacro(Alignment, unsigned int, 64);
+
+  /** Allocate size bytes aligned on Alignment. The returned memory is not
+   * initialized. Returns 0 on failure, or when policy is NewPolicy or one
+   * of the mapped policies. */
+  static void * Allocate(SizeValueType size, PolicyType policy);
+
+  /** Release a buffer returned by Allocate() or MapFile() with the same
+   * size and policy. */
+  static void Deallocate(void *buffer, SizeValueType size, PolicyType policy);
+
+  /** Map size bytes of the file fileName, starting at byte offset, in
+   * memory. With MappedReadOnlyPolicy the pages are shared with the file
+   * and must not be written. With MappedCopyOnWritePolicy they can be
+   * written, the modified pages are then private copies and the file is
+   * never changed. The pages are read from the file when first accessed.
+   * The mapping starts on a page boundary, so the returned pointer is only
+   * as aligned as offset: the caller must check that offset is a multiple
+   * of the alignment of the elements, see PixelBufferAlignment.
+   * Returns 0 on failure, or when policy is not a mapped policy. */
+  static void * MapFile(const char *fileName, SizeValueType offset, SizeValueType size,
+                        PolicyType policy);
+
+  /** Whether the buffers of the given policy are views of a mapped file. */
+  static bool IsMappedPolicy(PolicyType policy)
+  {
+    return policy == MappedReadOnlyPolicy || policy == MappedCopyOnWritePolicy;
+  }
+
+  /** Set/Get the policy used by the containers created from now on.
+   * Defaults to NewPolicy. */
+  static void SetGlobalDefaultPolicy(PolicyType policy);
+
+  static PolicyType GetGlobalDefaultPolicy();
+
+  /** Set/Get the maximum number of bytes kept in the pool. Buffers released
+   * while the pool is full are returned to the system. Lowering the value
+   * releases pooled buffers until the pool fits. Defaults to 1 GiB. */
+  static void SetMaximumPooledSize(SizeValueType size);
+
+  static SizeValueType GetMaximumPooledSize();
+
+  /** Number of bytes currently held by the pool. */
+  static SizeValueType GetPooledSize();
+
+  /** Return every pooled buffer to the system. */
+  static void ReleasePooledBuffers();
+
+private:
+  PixelBufferAllocator();                 //purposely not implemented
+  PixelBufferAllocator(const Self &);     //purposely not implemented
+  void operator=(const Self &);           //purposely not implemented
+};
+
+/** \class PixelBufferTraits
+ * \brief Tells whether the constructor of a pixel type can be skipped.
+ *
+ * IsTriviallyConstructible is true for the types whose default constructor
+ * leaves the object uninitialized, or only sets its value, so that not
+ * calling it is harmless when the pixels are written before being read. It
+ * is true for the fundamental types, and for the fixed size pixel types of
+ * ITK and std::complex when it is true for their components. Other pixel
+ * types may specialize this class.
+ *
+ * \ingroup ImageObjects
+ * \ingroup ITKCommon
+ */
+template< typename T >
+struct PixelBufferTraits {
+  static const bool IsTriviallyConstructible = false;
+};
+
+#define itkPixelBufferTraitsTrivialMacro(T)                    \
+  template< >                                                  \
+  struct PixelBufferTraits< T > {                              \
+    static const bool IsTriviallyConstructible = true;         \
+  }
+
+itkPixelBufferTraitsTrivialMacro(bool);
+itkPixelBufferTraitsTrivialMacro(char);
+itkPixelBufferTraitsTrivialMacro(signed char);
+itkPixelBufferTraitsTrivialMacro(unsigned char);
+itkPixelBufferTraitsTrivialMacro(short);
+itkPixelBufferTraitsTrivialMacro(unsigned short);
+itkPixelBufferTraitsTrivialMacro(int);
+itkPixelBufferTraitsTrivialMacro(unsigned int);
+itkPixelBufferTraitsTrivialMacro(long);
+itkPixelBufferTraitsTrivialMacro(unsigned long);
+itkPixelBufferTraitsTrivialMacro(long long);
+itkPixelBufferTraitsTrivialMacro(unsigned long long);
+itkPixelBufferTraitsTrivialMacro(float);
+itkPixelBufferTraitsTrivialMacro(double);
+itkPixelBufferTraitsTrivialMacro(long double);
+
+#undef itkPixelBufferTraitsTrivialMacro
+
+// The pixel types made of a fixed number of components are only declared,
+// so that including this header does not include them.
+template< typename TValueType, unsigned int VLength > class FixedArray;
+template< typename TComponent > class RGBPixel;
+template< typename TComponent > class RGBAPixel;
+template< typename T, unsigned int NVectorDimension > class Vector;
+template< typename T, unsigned int NVectorDimension > class CovariantVector;
+template< typename TComponent, unsigned int NDimension > class SymmetricSecondRankTensor;
+
+template< typename TValueType, unsigned int VLength >
+struct PixelBufferTraits< FixedArray< TValueType, VLength > > {
+  static const bool IsTriviallyConstructible = PixelBufferTraits< TValueType >::IsTriviallyConstructible;
+};
+
+template< typename TComponent >
+struct PixelBufferTraits< RGBPixel< TComponent > > {
+  static const bool IsTriviallyConstructible = PixelBufferTraits< TComponent >::IsTriviallyConstructible;
+};
+
+template< typename TComponent >
+struct PixelBufferTraits< RGBAPixel< TComponent > > {
+  static const bool IsTriviallyConstructible = PixelBufferTraits< TComponent >::IsTriviallyConstructible;
+};
+
+template< typename T, unsigned int NVectorDimension >
+struct PixelBufferTraits< Vector< T, NVectorDimension > > {
+  static const bool IsTriviallyConstructible = PixelBufferTraits< T >::IsTriviallyConstructible;
+};
+
+template< typename T, unsigned int NVectorDimension >
+struct PixelBufferTraits< CovariantVector< T, NVectorDimension > > {
+  static const bool IsTriviallyConstructible = PixelBufferTraits< T >::IsTriviallyConstructible;
+};
+
+template< typename TComponent, unsigned int NDimension >
+struct PixelBufferTraits< SymmetricSecondRankTensor< TComponent, NDimension > > {
+  static const bool IsTriviallyConstructible = PixelBufferTraits< TComponent >::IsTriviallyConstructible;
+};
+
+template< typename T >
+struct PixelBufferTraits< std::complex< T > > {
+  static const bool IsTriviallyConstructible = PixelBufferTraits< T >::IsTriviallyConstructible;
+};
+
+/** \class PixelBufferAlignment
+ * \brief The alignment, in bytes, required by the objects of type T.
+ *
+ * The alignment is computed from the padding the compiler puts before a T
+ * that follows a char, since alignof is not available.
+ *
+ * \ingroup ImageObjects
+ * \ingroup ITKCommon
+ */
+template< typename T >
+struct PixelBufferAlignment {
+private:
+  struct Padded {
+    char c;
+    T    t;
+  };
+public:
+  static const SizeValueType Value = sizeof( Padded ) - sizeof( T );
+};
+} // end namespace itk
+
+#endif
@@ -0,0 +1,119 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkThreadPool_h
+#define __itkThreadPool_h
+
+#include "itkConditionVariable.h"
+#include "itkIntTypes.h"
+#include <vector>
+
+namespace itk
+{
+/** \class ThreadPool
+ * \brief A set of persistent worker threads reused across dispatches.
+ *
+ * ThreadPool keeps worker threads alive between calls so that the cost of
+ * creating and joining a thread is paid once per worker instead of once per
+ * MultiThreader::SingleMethodExecute(). Idle workers are parked on a
+ * ConditionVariable until a job is assigned to them.
+ *
+ * A job is assigned with AssignWork(), which returns a handle that must be
+ * passed to WaitForJob() before the worker can be reused. When all the
+ * workers are busy (for example when a threaded filter runs a nested
+ * pipeline from inside its ThreadedGenerateData) a new worker is created, so
+ * AssignWork() never blocks waiting for another job to finish.
+ *
+ * The pool is shared by the whole process and is accessed through
+ * GetInstance(). It is used by MultiThreader when its UseThreadPool flag is
+ * on.
+ *
+ * \sa MultiThreader
+ * \ingroup OSSystemObjects
+ * \ingroup ITKCommon
+ */
+class ITKCommon_EXPORT ThreadPool:public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef ThreadPool                 Self;
+  typedef Object                     Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ThreadPool, Object);
+
+  /** Handle identifying a job assigned to a worker. */
+  typedef ThreadIdType JobHandleType;
+
+  /** Return the process wide thread pool, creating it on first use. */
+  static Pointer GetInstance();
+
+  /** Run f(data) on an idle worker and return a handle that must be passed
+   * to WaitForJob(). A new worker is created if none is idle. */
+  JobHandleType AssignWork(ThreadFunctionType f, void *data);
+
+  /** Block until the job identified by handle has returned, and release the
+   * worker for reuse. */
+  void WaitForJob(JobHandleType handle);
+
+  /** Number of worker threads currently owned by the pool. */
+  ThreadIdType GetNumberOfThreads() const;
+
+  /** Make sure at least n workers exist, so that the first dispatch does not
+   * pay the thread creation cost. */
+  void InitializeThreads(ThreadIdType n);
+
+protected:
+  ThreadPool();
+  ~ThreadPool();
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+private:
+  ThreadPool(const Self &);     //purposely not implemented
+  void operator=(const Self &); //purposely not implemented
+
+  /** State of one worker. All the fields are protected by m_Mutex. */
+  struct WorkerSlot {
+    enum { IDLE, ASSIGNED, RUNNING, DONE } State;
+    ThreadFunctionType            Function;
+    void *                        Data;
+    ConditionVariable::Pointer    WorkAvailable;
+    ThreadProcessIDType           ThreadHandle;
+    ThreadPool *                  Pool;
+  };
+
+  /** Create a worker; m_Mutex must be held by the caller. */
+  ThreadIdType AddWorker();
+
+  /** Loop executed by every worker thread. */
+  static ITK_THREAD_RETURN_TYPE WorkerProc(void *arg);
+
+  /** Slots are never removed while the pool is alive, so the pointers handed
+   * to the worker threads stay valid. */
+  std::vector< WorkerSlot * > m_Workers;
+
+  mutable SimpleMutexLock    m_Mutex;
+  ConditionVariable::Pointer m_JobDone;
+  bool                       m_ShuttingDown;
+
+  static Pointer         m_Instance;
+  static SimpleMutexLock m_InstanceMutex;
+};
+}  // end namespace itk
+#endif
@@ -26,6 +26,7 @@
  *
  *=========================================================================*/
 #include "itkMultiThreader.h"
+#include "itkThreadPool.h"
 #include "itkObjectFactory.h"
 #include "itkNumericTraits.h"
 #include "itksys/SystemTools.hxx"
@@ -55,6 +56,11 @@ ThreadIdType MultiThreader:: m_GlobalMaximumNumberOfThreads = ITK_MAX_THREADS;
 // => Not initialized.
 ThreadIdType MultiThreader:: m_GlobalDefaultNumberOfThreads = 0;
 
+// Initialize static members that control the global default use of the
+// thread pool. The environment is only queried on first use.
+bool MultiThreader:: m_GlobalDefaultUseThreadPool = false;
+bool MultiThreader:: m_GlobalDefaultUseThreadPoolIsInitialized = false;
+
 void MultiThreader::SetGlobalMaximumNumberOfThreads(ThreadIdType val)
 {
   m_GlobalMaximumNumberOfThreads = val;
@@ -87,6 +93,30 @@ void MultiThreader::SetGlobalDefaultNumberOfThreads(ThreadIdType val)
 
 }
 
+void MultiThreader::SetGlobalDefaultUseThreadPool(bool flag)
+{
+  m_GlobalDefaultUseThreadPool = flag;
+  m_GlobalDefaultUseThreadPoolIsInitialized = true;
+}
+
+bool MultiThreader::GetGlobalDefaultUseThreadPool()
+{
+  if ( !m_GlobalDefaultUseThreadPoolIsInitialized )
+    {
+    itksys_stl::string itkUseThreadPoolEnv;
+    if ( itksys::SystemTools::GetEnv("ITK_USE_THREADPOOL", itkUseThreadPoolEnv) )
+      {
+      itkUseThreadPoolEnv = itksys::SystemTools::UpperCase(itkUseThreadPoolEnv);
+      m_GlobalDefaultUseThreadPool = ( itkUseThreadPoolEnv != "NO"
+                                       && itkUseThreadPoolEnv != "OFF"
+                                       && itkUseThreadPoolEnv != "FALSE"
+                                       && itkUseThreadPoolEnv != "0" );
+      }
+    m_GlobalDefaultUseThreadPoolIsInitialized = true;
+    }
+  return m_GlobalDefaultUseThreadPool;
+}
+
 void MultiThreader::SetNumberOfThreads(ThreadIdType numberOfThreads)
 {
   if ( m_NumberOfThreads == numberOfThreads &&
@@ -208,6 +238,7 @@ MultiThreader::MultiThreader()
   m_SingleMethod = 0;
   m_SingleData = 0;
   m_NumberOfThreads = this->GetGlobalDefaultNumberOfThreads();
+  m_UseThreadPool = this->GetGlobalDefaultUseThreadPool();
 }
 
 MultiThreader::~MultiThreader()
@@ -244,6 +275,7 @@ void MultiThreader::SingleMethodExecute()
 {
   ThreadIdType                 thread_loop = 0;
   ThreadProcessIDType process_id[ITK_MAX_THREADS];
+  ThreadPool::JobHandleType    job_handle[ITK_MAX_THREADS];
 
   if ( !m_SingleMethod )
     {
@@ -254,6 +286,17 @@ void MultiThreader::SingleMethodExecute()
   // obey the global maximum number of threads limit
   m_NumberOfThreads = std::min( m_GlobalMaximumNumberOfThreads, m_NumberOfThreads );
 
+  // When the thread pool is used, the threads are not spawned but taken from
+  // the pool, and waiting for them does not join them.
+  ThreadPool::Pointer threadPool;
+  if ( m_UseThreadPool && m_NumberOfThreads > 1 )
+    {
+    threadPool = ThreadPool::GetInstance();
+    }
+
+  // Only the threads that were actually dispatched are waited for.
+  ThreadIdType numberOfDispatchedThreads = 1;
+
   // Spawn a set of threads through the SingleMethodProxy. Exceptions
   // thrown from a thread will be caught by the SingleMethodProxy. A
   // naive mechanism is in place for determining whether a thread
@@ -271,8 +314,17 @@ void MultiThreader::SingleMethodExecute()
       m_ThreadInfoArray[thread_loop].NumberOfThreads = m_NumberOfThreads;
       m_ThreadInfoArray[thread_loop].ThreadFunction = m_SingleMethod;
 
-      process_id[thread_loop] =
-        this->DispatchSingleMethodThread(&m_ThreadInfoArray[thread_loop]);
+      if ( threadPool )
+        {
+        job_handle[thread_loop] =
+          threadPool->AssignWork(this->SingleMethodProxy, &m_ThreadInfoArray[thread_loop]);
+        }
+      else
+        {
+        process_id[thread_loop] =
+          this->DispatchSingleMethodThread(&m_ThreadInfoArray[thread_loop]);
+        }
+      numberOfDispatchedThreads = thread_loop + 1;
       }
     }
   catch ( std::exception & e )
@@ -303,11 +355,18 @@ void MultiThreader::SingleMethodExecute()
     {
     // Need cleanup and rethrow ProcessAborted
     // close down other threads
-    for ( thread_loop = 1; thread_loop < m_NumberOfThreads; thread_loop++ )
+    for ( thread_loop = 1; thread_loop < numberOfDispatchedThreads; thread_loop++ )
       {
       try
         {
-        this->WaitForSingleMethodThread(process_id[thread_loop]);
+        if ( threadPool )
+          {
+          threadPool->WaitForJob(job_handle[thread_loop]);
+          }
+        else
+          {
+          this->WaitForSingleMethodThread(process_id[thread_loop]);
+          }
         }
       catch ( ... )
               {}
@@ -332,11 +391,18 @@ void MultiThreader::SingleMethodExecute()
 
   // The parent thread has finished this->SingleMethod() - so now it
   // waits for each of the other processes to exit
-  for ( thread_loop = 1; thread_loop < m_NumberOfThreads; thread_loop++ )
+  for ( thread_loop = 1; thread_loop < numberOfDispatchedThreads; thread_loop++ )
     {
     try
       {
-      this->WaitForSingleMethodThread(process_id[thread_loop]);
+      if ( threadPool )
+        {
+        threadPool->WaitForJob(job_handle[thread_loop]);
+        }
+      else
+        {
+        this->WaitForSingleMethodThread(process_id[thread_loop]);
+        }
       if ( m_ThreadInfoArray[thread_loop].ThreadExitCode
            != ThreadInfoStruct::SUCCESS )
         {
@@ -410,10 +476,13 @@ void MultiThreader::PrintSelf(std::ostream & os, Indent indent) const
   Superclass::PrintSelf(os, indent);
 
   os << indent << "Thread Count: " << m_NumberOfThreads << "\n";
+  os << indent << "Use Thread Pool: " << ( m_UseThreadPool ? "On" : "Off" ) << "\n";
   os << indent << "Global Maximum Number Of Threads: "
      << m_GlobalMaximumNumberOfThreads << std::endl;
   os << indent << "Global Default Number Of Threads: "
      << m_GlobalDefaultNumberOfThreads << std::endl;
+  os << indent << "Global Default Use Thread Pool: "
+     << ( m_GlobalDefaultUseThreadPool ? "On" : "Off" ) << std::endl;
 }
 
 
@@ -0,0 +1,315 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkPixelBufferAllocator.h"
+#include "itkSimpleFastMutexLock.h"
+#include <stdlib.h>
+#include <map>
+#include <vector>
+
+#if defined( _WIN32 )
+#include "itkWindows.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace itk
+{
+namespace
+{
+// Pooled buffers are bucketed by their size rounded up to this value, so
+// that images whose sizes differ by a few pixels share a bucket.
+const SizeValueType PooledBucketGranularity = 4096;
+
+typedef std::vector< void * >                       PooledBufferListType;
+typedef std::map< SizeValueType, PooledBufferListType > PooledBufferMapType;
+
+PixelBufferAllocator::PolicyType GlobalDefaultPolicy = PixelBufferAllocator::NewPolicy;
+
+SimpleFastMutexLock PoolLock;
+PooledBufferMapType PooledBuffers;
+SizeValueType       PooledSize = 0;
+SizeValueType       MaximumPooledSize = static_cast< SizeValueType >( 1 ) << 30;
+
+SizeValueType BucketSize(SizeValueType size)
+{
+  return ( ( size + PooledBucketGranularity - 1 ) / PooledBucketGranularity )
+         * PooledBucketGranularity;
+}
+
+// The buffer is over-allocated so that it can be aligned, and the pointer
+// returned by malloc is stored just before the aligned block.
+void * AlignedAllocate(SizeValueType size)
+{
+  const SizeValueType alignment = PixelBufferAllocator::Alignment;
+  char *              raw = static_cast< char * >( malloc(size + alignment + sizeof( void * )) );
+
+  if ( !raw )
+    {
+    return 0;
+    }
+  char *aligned = raw + sizeof( void * );
+  aligned += ( alignment - reinterpret_cast< size_t >( aligned ) % alignment ) % alignment;
+  reinterpret_cast< void ** >( aligned )[-1] = raw;
+  return aligned;
+}
+
+void AlignedFree(void *buffer)
+{
+  if ( buffer )
+    {
+    free( reinterpret_cast< void ** >( buffer )[-1] );
+    }
+}
+
+// Granularity of the file offsets at which a mapping can start.
+SizeValueType MappingGranularity()
+{
+#if defined( _WIN32 )
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwAllocationGranularity;
+#else
+  return static_cast< SizeValueType >( sysconf(_SC_PAGESIZE) );
+#endif
+}
+
+// PoolLock must be held by the caller.
+void ShrinkPool(SizeValueType maximumSize)
+{
+  PooledBufferMapType::iterator it = PooledBuffers.begin();
+  while ( PooledSize > maximumSize && it != PooledBuffers.end() )
+    {
+    while ( PooledSize > maximumSize && !it->second.empty() )
+      {
+      AlignedFree( it->second.back() );
+      it->second.pop_back();
+      PooledSize -= it->first;
+      }
+    if ( it->second.empty() )
+      {
+      PooledBuffers.erase(it++);
+      }
+    else
+      {
+      ++it;
+      }
+    }
+}
+}
+
+void *
+PixelBufferAllocator
+::Allocate(SizeValueType size, PolicyType policy)
+{
+  if ( policy == NewPolicy || IsMappedPolicy(policy) )
+    {
+    return 0;
+    }
+  if ( policy != PooledPolicy )
+    {
+    return AlignedAllocate(size);
+    }
+
+  const SizeValueType bucket = BucketSize(size);
+
+  PoolLock.Lock();
+  PooledBufferMapType::iterator it = PooledBuffers.find(bucket);
+  if ( it != PooledBuffers.end() && !it->second.empty() )
+    {
+    void *buffer = it->second.back();
+    it->second.pop_back();
+    PooledSize -= bucket;
+    PoolLock.Unlock();
+    return buffer;
+    }
+  PoolLock.Unlock();
+
+  return AlignedAllocate(bucket);
+}
+
+void
+PixelBufferAllocator
+::Deallocate(void *buffer, SizeValueType size, PolicyType policy)
+{
+  if ( !buffer )
+    {
+    return;
+    }
+  if ( IsMappedPolicy(policy) )
+    {
+    // The mapping starts at the granularity boundary preceding the buffer.
+    const SizeValueType delta = reinterpret_cast< size_t >( buffer ) % MappingGranularity();
+    char *              base = static_cast< char * >( buffer ) - delta;
+#if defined( _WIN32 )
+    UnmapViewOfFile(base);
+    (void)size;
+#else
+    munmap(base, size + delta);
+#endif
+    return;
+    }
+  if ( policy != PooledPolicy )
+    {
+    AlignedFree(buffer);
+    return;
+    }
+
+  const SizeValueType bucket = BucketSize(size);
+
+  PoolLock.Lock();
+  if ( PooledSize + bucket <= MaximumPooledSize )
+    {
+    PooledBuffers[bucket].push_back(buffer);
+    PooledSize += bucket;
+    buffer = 0;
+    }
+  PoolLock.Unlock();
+
+  AlignedFree(buffer);
+}
+
+void *
+PixelBufferAllocator
+::MapFile(const char *fileName, SizeValueType offset, SizeValueType size, PolicyType policy)
+{
+  if ( !IsMappedPolicy(policy) || size == 0 )
+    {
+    return 0;
+    }
+
+  const SizeValueType delta = offset % MappingGranularity();
+  const SizeValueType start = offset - delta;
+  char *              base = 0;
+
+#if defined( _WIN32 )
+  HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if ( file == INVALID_HANDLE_VALUE )
+    {
+    return 0;
+    }
+  // Pages past the end of the file cannot be accessed.
+  LARGE_INTEGER fileSize;
+  if ( !GetFileSizeEx(file, &fileSize)
+       || static_cast< unsigned long long >( fileSize.QuadPart ) < offset + size )
+    {
+    CloseHandle(file);
+    return 0;
+    }
+  const DWORD protection = ( policy == MappedReadOnlyPolicy ) ? PAGE_READONLY : PAGE_WRITECOPY;
+  HANDLE      mapping = CreateFileMappingA(file, NULL, protection, 0, 0, NULL);
+  if ( mapping )
+    {
+    const DWORD access = ( policy == MappedReadOnlyPolicy ) ? FILE_MAP_READ : FILE_MAP_COPY;
+    const unsigned long long longStart = start;
+    base = static_cast< char * >( MapViewOfFile( mapping, access,
+                                                 static_cast< DWORD >( longStart >> 32 ),
+                                                 static_cast< DWORD >( longStart & 0xffffffff ),
+                                                 static_cast< SIZE_T >( size + delta ) ) );
+    // The view keeps the mapping and the file open.
+    CloseHandle(mapping);
+    }
+  CloseHandle(file);
+#else
+  const int fd = open(fileName, O_RDONLY);
+  if ( fd < 0 )
+    {
+    return 0;
+    }
+  // Pages past the end of the file cannot be accessed.
+  struct stat fileStatus;
+  if ( fstat(fd, &fileStatus) != 0
+       || static_cast< SizeValueType >( fileStatus.st_size ) < offset + size )
+    {
+    close(fd);
+    return 0;
+    }
+  void *mapped;
+  if ( policy == MappedReadOnlyPolicy )
+    {
+    mapped = mmap(0, size + delta, PROT_READ, MAP_SHARED, fd, static_cast< off_t >( start ) );
+    }
+  else
+    {
+    mapped = mmap(0, size + delta, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd,
+                  static_cast< off_t >( start ) );
+    }
+  // The mapping keeps a reference to the file.
+  close(fd);
+  if ( mapped != MAP_FAILED )
+    {
+    base = static_cast< char * >( mapped );
+    }
+#endif
+
+  return base ? base + delta : 0;
+}
+
+void
+PixelBufferAllocator
+::SetGlobalDefaultPolicy(PolicyType policy)
+{
+  GlobalDefaultPolicy = policy;
+}
+
+PixelBufferAllocator::PolicyType
+PixelBufferAllocator
+::GetGlobalDefaultPolicy()
+{
+  return GlobalDefaultPolicy;
+}
+
+void
+PixelBufferAllocator
+::SetMaximumPooledSize(SizeValueType size)
+{
+  PoolLock.Lock();
+  MaximumPooledSize = size;
+  ShrinkPool(MaximumPooledSize);
+  PoolLock.Unlock();
+}
+
+SizeValueType
+PixelBufferAllocator
+::GetMaximumPooledSize()
+{
+  return MaximumPooledSize;
+}
+
+SizeValueType
+PixelBufferAllocator
+::GetPooledSize()
+{
+  PoolLock.Lock();
+  const SizeValueType size = PooledSize;
+  PoolLock.Unlock();
+  return size;
+}
+
+void
+PixelBufferAllocator
+::ReleasePooledBuffers()
+{
+  PoolLock.Lock();
+  ShrinkPool(0);
+  PoolLock.Unlock();
+}
+} // end namespace itk
@@ -0,0 +1,270 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkThreadPool.h"
+#include "itkObjectFactory.h"
+
+#if defined(ITK_USE_WIN32_THREADS)
+#include "itkWindows.h"
+#include <process.h>
+#endif
+
+namespace itk
+{
+#if defined(ITK_USE_PTHREADS)
+extern "C"
+{
+typedef void *( *ThreadPoolWorkerFunctionType )(void *);
+}
+#endif
+
+ThreadPool::Pointer ThreadPool:: m_Instance;
+SimpleMutexLock     ThreadPool:: m_InstanceMutex;
+
+ThreadPool::Pointer
+ThreadPool
+::GetInstance()
+{
+  m_InstanceMutex.Lock();
+  if ( m_Instance.IsNull() )
+    {
+    ThreadPool *rawPtr = new ThreadPool;
+    m_Instance = rawPtr;
+    rawPtr->UnRegister();
+    }
+  m_InstanceMutex.Unlock();
+  return m_Instance;
+}
+
+ThreadPool
+::ThreadPool()
+{
+  m_JobDone = ConditionVariable::New();
+  m_ShuttingDown = false;
+}
+
+ThreadPool
+::~ThreadPool()
+{
+  m_Mutex.Lock();
+  m_ShuttingDown = true;
+  for ( size_t i = 0; i < m_Workers.size(); i++ )
+    {
+    m_Workers[i]->WorkAvailable->Signal();
+    }
+  m_Mutex.Unlock();
+
+  for ( size_t i = 0; i < m_Workers.size(); i++ )
+    {
+#if defined(ITK_USE_PTHREADS)
+    pthread_join(m_Workers[i]->ThreadHandle, 0);
+#elif defined(ITK_USE_WIN32_THREADS)
+    WaitForSingleObject(m_Workers[i]->ThreadHandle, INFINITE);
+    CloseHandle(m_Workers[i]->ThreadHandle);
+#endif
+    delete m_Workers[i];
+    }
+  m_Workers.clear();
+}
+
+ThreadIdType
+ThreadPool
+::AddWorker()
+{
+  WorkerSlot *slot = new WorkerSlot;
+
+  slot->State = WorkerSlot::IDLE;
+  slot->Function = 0;
+  slot->Data = 0;
+  slot->WorkAvailable = ConditionVariable::New();
+  slot->Pool = this;
+
+#if defined(ITK_USE_PTHREADS)
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+#if !defined( __CYGWIN__ )
+  pthread_attr_setscope(&attr, PTHREAD_SCOPE_SYSTEM);
+#endif
+  const int threadError =
+    pthread_create( &slot->ThreadHandle, &attr,
+                    reinterpret_cast< ThreadPoolWorkerFunctionType >( ThreadPool::WorkerProc ),
+                    reinterpret_cast< void * >( slot ) );
+  pthread_attr_destroy(&attr);
+  if ( threadError != 0 )
+    {
+    delete slot;
+    itkExceptionMacro(<< "Unable to create a thread.  pthread_create() returned "
+                      << threadError);
+    }
+#elif defined(ITK_USE_WIN32_THREADS)
+  unsigned int threadId;
+  slot->ThreadHandle = (HANDLE)
+    _beginthreadex(0, 0, ( unsigned int (__stdcall *)(void *) )ThreadPool::WorkerProc,
+                   reinterpret_cast< void * >( slot ), 0, &threadId);
+  if ( slot->ThreadHandle == 0 )
+    {
+    delete slot;
+    itkExceptionMacro(<< "Error in thread creation !!!");
+    }
+#else
+  slot->ThreadHandle = 0;
+#endif
+
+  m_Workers.push_back(slot);
+  return static_cast< ThreadIdType >( m_Workers.size() - 1 );
+}
+
+void
+ThreadPool
+::InitializeThreads(ThreadIdType n)
+{
+  m_Mutex.Lock();
+  try
+    {
+    while ( m_Workers.size() < n )
+      {
+      this->AddWorker();
+      }
+    }
+  catch ( ... )
+    {
+    m_Mutex.Unlock();
+    throw;
+    }
+  m_Mutex.Unlock();
+}
+
+ThreadPool::JobHandleType
+ThreadPool
+::AssignWork(ThreadFunctionType f, void *data)
+{
+#if !defined(ITK_USE_PTHREADS) && !defined(ITK_USE_WIN32_THREADS)
+  // Without thread support the job is run immediately in the caller.
+  ( *f )(data);
+  return 0;
+#else
+  m_Mutex.Lock();
+
+  JobHandleType handle = 0;
+  while ( handle < m_Workers.size() && m_Workers[handle]->State != WorkerSlot::IDLE )
+    {
+    ++handle;
+    }
+  if ( handle == m_Workers.size() )
+    {
+    try
+      {
+      handle = this->AddWorker();
+      }
+    catch ( ... )
+      {
+      m_Mutex.Unlock();
+      throw;
+      }
+    }
+
+  WorkerSlot *slot = m_Workers[handle];
+  slot->Function = f;
+  slot->Data = data;
+  slot->State = WorkerSlot::ASSIGNED;
+  slot->WorkAvailable->Signal();
+
+  m_Mutex.Unlock();
+  return handle;
+#endif
+}
+
+void
+ThreadPool
+::WaitForJob(JobHandleType handle)
+{
+#if defined(ITK_USE_PTHREADS) || defined(ITK_USE_WIN32_THREADS)
+  m_Mutex.Lock();
+  if ( handle >= m_Workers.size() || m_Workers[handle]->State == WorkerSlot::IDLE )
+    {
+    m_Mutex.Unlock();
+    itkExceptionMacro(<< "No job is assigned to handle " << handle);
+    }
+  WorkerSlot *slot = m_Workers[handle];
+  while ( slot->State != WorkerSlot::DONE )
+    {
+    m_JobDone->Wait(&m_Mutex);
+    }
+  slot->State = WorkerSlot::IDLE;
+  slot->Function = 0;
+  slot->Data = 0;
+  m_Mutex.Unlock();
+#else
+  (void)handle;
+#endif
+}
+
+ThreadIdType
+ThreadPool
+::GetNumberOfThreads() const
+{
+  m_Mutex.Lock();
+  const ThreadIdType n = static_cast< ThreadIdType >( m_Workers.size() );
+  m_Mutex.Unlock();
+  return n;
+}
+
+ITK_THREAD_RETURN_TYPE
+ThreadPool
+::WorkerProc(void *arg)
+{
+  WorkerSlot *slot = reinterpret_cast< WorkerSlot * >( arg );
+  ThreadPool *pool = slot->Pool;
+
+  pool->m_Mutex.Lock();
+  while ( true )
+    {
+    while ( slot->State != WorkerSlot::ASSIGNED && !pool->m_ShuttingDown )
+      {
+      slot->WorkAvailable->Wait(&pool->m_Mutex);
+      }
+    if ( slot->State != WorkerSlot::ASSIGNED )
+      {
+      break;
+      }
+    slot->State = WorkerSlot::RUNNING;
+    ThreadFunctionType function = slot->Function;
+    void *             data = slot->Data;
+    pool->m_Mutex.Unlock();
+
+    // The function is expected to handle its own exceptions, as
+    // MultiThreader::SingleMethodProxy does.
+    ( *function )(data);
+
+    pool->m_Mutex.Lock();
+    slot->State = WorkerSlot::DONE;
+    pool->m_JobDone->Broadcast();
+    }
+  pool->m_Mutex.Unlock();
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+void
+ThreadPool
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Number Of Threads: " << this->GetNumberOfThreads() << std::endl;
+}
+} // end namespace itk
@@ -0,0 +1,134 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageSource.h"
+#include "itkImageRegionIterator.h"
+
+namespace itk
+{
+/** \class DynamicMultiThreadingTestSource
+ * Writes in each output pixel the number of times it has been visited, and
+ * counts the calls to ThreadedGenerateData() per thread.
+ */
+template< class TOutputImage >
+class DynamicMultiThreadingTestSource:public ImageSource< TOutputImage >
+{
+public:
+  typedef DynamicMultiThreadingTestSource Self;
+  typedef ImageSource< TOutputImage >     Superclass;
+  typedef SmartPointer< Self >            Pointer;
+  typedef SmartPointer< const Self >      ConstPointer;
+
+  itkNewMacro(Self);
+  itkTypeMacro(DynamicMultiThreadingTestSource, ImageSource);
+
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+
+  unsigned int m_Calls[ITK_MAX_THREADS];
+
+protected:
+  DynamicMultiThreadingTestSource() {}
+
+  void GenerateOutputInformation()
+  {
+    typename TOutputImage::SizeType size;
+    size.Fill(32);
+    typename TOutputImage::RegionType region;
+    region.SetSize(size);
+    this->GetOutput()->SetLargestPossibleRegion(region);
+  }
+
+  void BeforeThreadedGenerateData()
+  {
+    this->GetOutput()->FillBuffer(0);
+    for ( unsigned int i = 0; i < ITK_MAX_THREADS; i++ )
+      {
+      m_Calls[i] = 0;
+      }
+  }
+
+  void ThreadedGenerateData(const OutputImageRegionType & region, ThreadIdType threadId)
+  {
+    m_Calls[threadId]++;
+    ImageRegionIterator< TOutputImage > it(this->GetOutput(), region);
+    for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      it.Set( it.Get() + 1 );
+      }
+  }
+
+private:
+  DynamicMultiThreadingTestSource(const Self &); //purposely not implemented
+  void operator=(const Self &);                  //purposely not implemented
+};
+}
+
+int itkImageSourceDynamicMultiThreadingTest(int, char* [])
+{
+  typedef itk::Image< unsigned int, 3 >                      ImageType;
+  typedef itk::DynamicMultiThreadingTestSource< ImageType > SourceType;
+
+  SourceType::Pointer source = SourceType::New();
+  source->SetNumberOfThreads(4);
+
+  if ( source->GetDynamicMultiThreading() )
+    {
+    std::cerr << "DynamicMultiThreading should be off by default" << std::endl;
+    return EXIT_FAILURE;
+    }
+  source->DynamicMultiThreadingOn();
+  source->SetNumberOfChunksPerThread(4);
+  source->Print(std::cout);
+
+  source->Update();
+
+  // Every pixel must have been written exactly once.
+  itk::ImageRegionIterator< ImageType > it( source->GetOutput(),
+                                            source->GetOutput()->GetBufferedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    if ( it.Get() != 1 )
+      {
+      std::cerr << "Pixel " << it.GetIndex() << " was visited " << it.Get()
+                << " times" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // The pieces are split across the threads, and each thread only ever
+  // sees its own threadId.
+  unsigned int totalCalls = 0;
+  for ( unsigned int i = 0; i < ITK_MAX_THREADS; i++ )
+    {
+    if ( i >= source->GetNumberOfThreads() && source->m_Calls[i] != 0 )
+      {
+      std::cerr << "Unexpected threadId " << i << std::endl;
+      return EXIT_FAILURE;
+      }
+    totalCalls += source->m_Calls[i];
+    }
+  std::cout << "ThreadedGenerateData was called " << totalCalls << " times" << std::endl;
+  if ( totalCalls != source->GetNumberOfThreads() * 4 )
+    {
+    std::cerr << "Expected " << source->GetNumberOfThreads() * 4 << " pieces" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,171 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <iostream>
+#include "itkImage.h"
+#include "itkImageRegionIterator.h"
+#include "itkNumericTraitsRGBPixel.h"
+#include "itkNumericTraitsRGBAPixel.h"
+#include "itkNumericTraitsVectorPixel.h"
+#include "itkNumericTraitsCovariantVectorPixel.h"
+#include "itkSymmetricSecondRankTensor.h"
+
+namespace
+{
+template< class TImage >
+bool TestPolicy(itk::PixelBufferAllocator::PolicyType policy, const char *name)
+{
+  std::cout << "Testing " << name << " with pixel size "
+            << sizeof( typename TImage::PixelType ) << std::endl;
+
+  typename TImage::SizeType size;
+  size.Fill(17);
+  typename TImage::RegionType region;
+  region.SetSize(size);
+
+  typename TImage::Pointer image = TImage::New();
+  image->SetRegions(region);
+  image->GetPixelContainer()->SetAllocationPolicy(policy);
+  image->Allocate();
+
+  if ( policy != itk::PixelBufferAllocator::NewPolicy
+       && reinterpret_cast< size_t >( image->GetBufferPointer() )
+       % itk::PixelBufferAllocator::Alignment != 0 )
+    {
+    std::cerr << "Buffer " << static_cast< void * >( image->GetBufferPointer() )
+              << " is not aligned" << std::endl;
+    return false;
+    }
+
+  const typename TImage::PixelType value =
+    itk::NumericTraits< typename TImage::PixelType >::OneValue();
+  image->FillBuffer(value);
+
+  itk::ImageRegionIterator< TImage > it(image, region);
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    if ( it.Get() != value )
+      {
+      std::cerr << "Wrong value at " << it.GetIndex() << std::endl;
+      return false;
+      }
+    }
+
+  // Reallocating a larger buffer must keep the policy.
+  size.Fill(23);
+  region.SetSize(size);
+  image->SetRegions(region);
+  image->Allocate();
+  image->FillBuffer(value);
+  return true;
+}
+}
+
+int itkImportContainerAllocationPolicyTest(int, char * [])
+{
+  typedef itk::PixelBufferAllocator AllocatorType;
+
+  typedef itk::Image< float, 3 >                        FloatImageType;
+  typedef itk::Image< itk::RGBPixel< unsigned char >, 2 > RGBImageType;
+  typedef itk::Image< itk::RGBAPixel< unsigned char >, 2 > RGBAImageType;
+  typedef itk::Image< itk::Vector< float, 3 >, 3 >        VectorImageType;
+  typedef itk::Image< itk::CovariantVector< double, 2 >, 2 >
+                                                          CovariantVectorImageType;
+
+  // The constructors of the fixed size pixel types of fundamental
+  // components are skipped, but not those of their other components.
+  if ( !itk::PixelBufferTraits< itk::RGBPixel< unsigned char > >::IsTriviallyConstructible
+       || !itk::PixelBufferTraits< itk::RGBAPixel< float > >::IsTriviallyConstructible
+       || !itk::PixelBufferTraits< itk::Vector< double, 3 > >::IsTriviallyConstructible
+       || !itk::PixelBufferTraits< itk::CovariantVector< float, 2 > >::IsTriviallyConstructible
+       || !itk::PixelBufferTraits< itk::FixedArray< short, 5 > >::IsTriviallyConstructible
+       || !itk::PixelBufferTraits< itk::SymmetricSecondRankTensor< double, 3 > >::IsTriviallyConstructible
+       || !itk::PixelBufferTraits< std::complex< float > >::IsTriviallyConstructible
+       || !itk::PixelBufferTraits< itk::FixedArray< itk::Vector< float, 2 >, 2 > >::IsTriviallyConstructible
+       || itk::PixelBufferTraits< itk::FixedArray< std::string, 2 > >::IsTriviallyConstructible )
+    {
+    std::cerr << "Wrong PixelBufferTraits for a fixed size pixel type" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  bool pass = true;
+  pass &= TestPolicy< FloatImageType >(AllocatorType::NewPolicy, "NewPolicy");
+  pass &= TestPolicy< FloatImageType >(AllocatorType::AlignedPolicy, "AlignedPolicy");
+  pass &= TestPolicy< FloatImageType >(AllocatorType::UninitializedPolicy, "UninitializedPolicy");
+  pass &= TestPolicy< FloatImageType >(AllocatorType::PooledPolicy, "PooledPolicy");
+  pass &= TestPolicy< RGBImageType >(AllocatorType::AlignedPolicy, "AlignedPolicy");
+  pass &= TestPolicy< RGBImageType >(AllocatorType::PooledPolicy, "PooledPolicy");
+  pass &= TestPolicy< RGBAImageType >(AllocatorType::UninitializedPolicy, "UninitializedPolicy");
+  pass &= TestPolicy< VectorImageType >(AllocatorType::UninitializedPolicy, "UninitializedPolicy");
+  pass &= TestPolicy< CovariantVectorImageType >(AllocatorType::PooledPolicy, "PooledPolicy");
+  if ( !pass )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // A released pooled buffer must be handed out again to the next
+  // allocation of the same size.
+  AllocatorType::ReleasePooledBuffers();
+  AllocatorType::SetGlobalDefaultPolicy(AllocatorType::PooledPolicy);
+
+  FloatImageType::RegionType region;
+  FloatImageType::SizeType   size;
+  size.Fill(64);
+  region.SetSize(size);
+
+  FloatImageType::Pointer image = FloatImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+  const void *firstBuffer = image->GetBufferPointer();
+  image = 0;
+
+  std::cout << "Pooled size after release: " << AllocatorType::GetPooledSize() << std::endl;
+  if ( AllocatorType::GetPooledSize() < 64 * 64 * 64 * sizeof( float ) )
+    {
+    std::cerr << "The released buffer was not pooled" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  image = FloatImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+  if ( image->GetBufferPointer() != firstBuffer )
+    {
+    std::cerr << "The pooled buffer was not reused" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if ( AllocatorType::GetPooledSize() != 0 )
+    {
+    std::cerr << "The reused buffer is still accounted in the pool" << std::endl;
+    return EXIT_FAILURE;
+    }
+  image = 0;
+
+  // Buffers are not pooled beyond the maximum size.
+  AllocatorType::SetMaximumPooledSize(0);
+  if ( AllocatorType::GetPooledSize() != 0 )
+    {
+    std::cerr << "Lowering the maximum pooled size did not shrink the pool" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  AllocatorType::SetGlobalDefaultPolicy(AllocatorType::NewPolicy);
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
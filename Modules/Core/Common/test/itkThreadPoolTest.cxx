@@ -0,0 +1,150 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMultiThreader.h"
+#include "itkThreadPool.h"
+#include "itkTimeProbe.h"
+#include <stdlib.h>
+
+namespace
+{
+struct ThreadPoolTestUserData
+{
+  unsigned int m_Visited[ITK_MAX_THREADS];
+  bool         m_Throw;
+};
+
+ITK_THREAD_RETURN_TYPE ThreadPoolTestCallback(void *arg)
+{
+  itk::MultiThreader::ThreadInfoStruct *info =
+    static_cast< itk::MultiThreader::ThreadInfoStruct * >( arg );
+  ThreadPoolTestUserData *data = static_cast< ThreadPoolTestUserData * >( info->UserData );
+
+  data->m_Visited[info->ThreadID]++;
+  if ( data->m_Throw && info->ThreadID == info->NumberOfThreads - 1 )
+    {
+    itkGenericExceptionMacro(<< "Exception thrown on purpose");
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+bool RunDispatches(itk::MultiThreader *threader, ThreadPoolTestUserData & data,
+                   unsigned int numberOfDispatches)
+{
+  for ( unsigned int t = 0; t < ITK_MAX_THREADS; t++ )
+    {
+    data.m_Visited[t] = 0;
+    }
+  data.m_Throw = false;
+  threader->SetSingleMethod(ThreadPoolTestCallback, &data);
+  for ( unsigned int i = 0; i < numberOfDispatches; i++ )
+    {
+    threader->SingleMethodExecute();
+    }
+  for ( itk::ThreadIdType t = 0; t < threader->GetNumberOfThreads(); t++ )
+    {
+    if ( data.m_Visited[t] != numberOfDispatches )
+      {
+      std::cerr << "Thread " << t << " ran " << data.m_Visited[t]
+                << " times instead of " << numberOfDispatches << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+}
+
+//
+// Check that the MultiThreader gives the same result with and without the
+// thread pool, and report the per dispatch latency of both paths.
+//
+int itkThreadPoolTest(int argc, char* argv[])
+{
+  unsigned int numberOfDispatches = 1000;
+  if ( argc > 1 )
+    {
+    numberOfDispatches = atoi(argv[1]);
+    }
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads(4);
+  std::cout << "Using " << threader->GetNumberOfThreads() << " threads" << std::endl;
+
+  ThreadPoolTestUserData data;
+
+  itk::TimeProbe spawnProbe;
+  itk::TimeProbe poolProbe;
+
+  threader->UseThreadPoolOff();
+  spawnProbe.Start();
+  if ( !RunDispatches(threader, data, numberOfDispatches) )
+    {
+    return EXIT_FAILURE;
+    }
+  spawnProbe.Stop();
+
+  threader->UseThreadPoolOn();
+  itk::ThreadPool::GetInstance()->InitializeThreads(threader->GetNumberOfThreads() - 1);
+  poolProbe.Start();
+  if ( !RunDispatches(threader, data, numberOfDispatches) )
+    {
+    return EXIT_FAILURE;
+    }
+  poolProbe.Stop();
+
+  std::cout << "Mean time per dispatch over " << numberOfDispatches << " dispatches:" << std::endl;
+  std::cout << "  spawn and join "
+            << spawnProbe.GetTotal() / numberOfDispatches << " s" << std::endl;
+  std::cout << "  thread pool    "
+            << poolProbe.GetTotal() / numberOfDispatches << " s" << std::endl;
+
+  // The workers must be reused, not created for every dispatch.
+  const itk::ThreadIdType poolSize = itk::ThreadPool::GetInstance()->GetNumberOfThreads();
+  if ( poolSize > threader->GetNumberOfThreads() - 1 )
+    {
+    std::cerr << "The pool grew to " << poolSize << " threads" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // An exception in a pooled thread must be reported, and must leave the
+  // pool usable.
+  data.m_Throw = true;
+  threader->SetSingleMethod(ThreadPoolTestCallback, &data);
+  bool caught = false;
+  try
+    {
+    threader->SingleMethodExecute();
+    }
+  catch ( itk::ExceptionObject & excp )
+    {
+    std::cout << "Caught expected exception: " << excp.GetDescription() << std::endl;
+    caught = true;
+    }
+  if ( !caught )
+    {
+    std::cerr << "Exception in a pooled thread was not reported" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if ( !RunDispatches(threader, data, 10) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
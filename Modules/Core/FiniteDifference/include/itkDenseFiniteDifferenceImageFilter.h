@@ -50,6 +50,22 @@ namespace itk
  * have committed to iteration over each pixel in an image. We take advantage
  * of that knowledge to multithread the iteration and update methods.
  *
+ * \par Fused update
+ * When UseFusedUpdate is on, CalculateChange() computes the changes slab by
+ * slab and applies them to the output as soon as no other pixel needs the
+ * old values, in a single pass over the image. The slabs are the slices
+ * along the axis on which the output is split among the threads. Each thread
+ * keeps the changes of the last "radius + 1" slices in a ring of slabs, and
+ * holds back the changes of the "radius" slices at each end of its region,
+ * which the neighbouring threads read. ApplyUpdate() then applies only
+ * those. The full-size update buffer is not allocated. This requires a
+ * FiniteDifferenceFunction whose time step does not depend on the changes,
+ * like those of the anisotropic diffusion and curvature flow filters,
+ * because the time step is requested from the function before the changes
+ * are computed. It also bypasses ThreadedCalculateChange() and
+ * ThreadedApplyUpdate(), so subclasses that override them must leave it off,
+ * which is the default.
+ *
  * \par Inputs and Outputs
  * This is an image to image filter.  The specific types of the images are not
  * fixed at this level in the hierarchy.
@@ -101,6 +117,12 @@ public:
   /** The container type for the update buffer. */
   typedef OutputImageType UpdateBufferType;
 
+  /** Set/Get whether the changes are applied in the same pass as they are
+   * computed, without a full-size update buffer. Off by default. */
+  itkSetMacro(UseFusedUpdate, bool);
+  itkGetConstMacro(UseFusedUpdate, bool);
+  itkBooleanMacro(UseFusedUpdate);
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro( OutputTimesDoubleCheck,
@@ -113,7 +135,11 @@ public:
 #endif
 protected:
   DenseFiniteDifferenceImageFilter()
-  { m_UpdateBuffer = UpdateBufferType::New(); }
+  {
+    m_UpdateBuffer = UpdateBufferType::New();
+    m_UseFusedUpdate = false;
+    m_FusingUpdate = false;
+  }
   ~DenseFiniteDifferenceImageFilter() {}
   void PrintSelf(std::ostream & os, Indent indent) const;
 
@@ -161,6 +187,28 @@ protected:
   TimeStepType ThreadedCalculateChange(const ThreadRegionType & regionToProcess,
                                        ThreadIdType threadId);
 
+  /** Does the actual work of calculating and applying the change over a
+   * region supplied by the multithreading mechanism, when UseFusedUpdate
+   * is on. The changes of the slices that the neighbouring regions read
+   * are kept for ApplyUpdate().
+   * \sa CalculateChange */
+  virtual
+  TimeStepType ThreadedCalculateAndApplyChange(const TimeStepType & dt,
+                                               const ThreadRegionType & regionToProcess,
+                                               ThreadIdType threadId);
+
+  /** Compute the changes of the output pixels of a region into an update
+   * buffer whose buffered region contains it. */
+  void CalculateChangeOverRegion(const ThreadRegionType & region,
+                                 UpdateBufferType *updateBuffer,
+                                 void *globalData);
+
+  /** Add the changes of an update buffer, times "dt", to the output pixels
+   * of a region. */
+  void ApplyUpdateOverRegion(const TimeStepType & dt,
+                             const ThreadRegionType & region,
+                             const UpdateBufferType *updateBuffer);
+
 private:
   DenseFiniteDifferenceImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);                   //purposely not implemented
@@ -182,8 +230,26 @@ private:
    * which it then passes to ThreadedCalculateChange for processing. */
   static ITK_THREAD_RETURN_TYPE CalculateChangeThreaderCallback(void *arg);
 
+  /** This callback method passes the region from SplitRequestedRegion to
+   * ThreadedCalculateAndApplyChange. */
+  static ITK_THREAD_RETURN_TYPE CalculateAndApplyChangeThreaderCallback(void *arg);
+
+  /** This callback method applies the changes held back by
+   * ThreadedCalculateAndApplyChange. */
+  static ITK_THREAD_RETURN_TYPE ApplyHeldUpdatesThreaderCallback(void *arg);
+
   /** The buffer that holds the updates for an iteration of the algorithm. */
   typename UpdateBufferType::Pointer m_UpdateBuffer;
+
+  /** The slabs of changes held back by each thread in the fused update. */
+  typedef std::vector< typename UpdateBufferType::Pointer > UpdateSlabListType;
+  std::vector< UpdateSlabListType > m_HeldUpdates;
+
+  bool m_UseFusedUpdate;
+
+  /** Whether the current run fuses the updates, which is decided when the
+   * update buffer is allocated. */
+  bool m_FusingUpdate;
 };
 } // end namespace itk
 
@@ -68,6 +68,14 @@ void
 DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >
 ::AllocateUpdateBuffer()
 {
+  // The fused update needs slabs of changes only.
+  m_FusingUpdate = m_UseFusedUpdate;
+  if ( m_FusingUpdate )
+    {
+    m_UpdateBuffer->Initialize();
+    return;
+    }
+
   // The update buffer looks just like the output.
   typename TOutputImage::Pointer output = this->GetOutput();
 
@@ -91,8 +99,17 @@ DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >
   str.Filter = this;
   str.TimeStep = dt;
   this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
-  this->GetMultiThreader()->SetSingleMethod(this->ApplyUpdateThreaderCallback,
-                                            &str);
+  if ( m_FusingUpdate )
+    {
+    // Only the changes that the threads held back are left.
+    this->GetMultiThreader()->SetSingleMethod(this->ApplyHeldUpdatesThreaderCallback,
+                                              &str);
+    }
+  else
+    {
+    this->GetMultiThreader()->SetSingleMethod(this->ApplyUpdateThreaderCallback,
+                                              &str);
+    }
   // Multithread the execution
   this->GetMultiThreader()->SingleMethodExecute();
 
@@ -129,6 +146,32 @@ DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >
   return ITK_THREAD_RETURN_VALUE;
 }
 
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >
+::ApplyHeldUpdatesThreaderCallback(void *arg)
+{
+  ThreadIdType threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  ThreadIdType threadCount = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->NumberOfThreads;
+
+  DenseFDThreadStruct* str = (DenseFDThreadStruct *)
+      ( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  // The slabs of different threads are disjoint.
+  std::vector< UpdateSlabListType > & heldUpdates = str->Filter->m_HeldUpdates;
+  for ( size_t t = threadId; t < heldUpdates.size(); t += threadCount )
+    {
+    for ( size_t i = 0; i < heldUpdates[t].size(); ++i )
+      {
+      const UpdateBufferType *slab = heldUpdates[t][i];
+      str->Filter->ApplyUpdateOverRegion(str->TimeStep, slab->GetBufferedRegion(), slab);
+      }
+    heldUpdates[t].clear();
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 template< class TInputImage, class TOutputImage >
 typename
 DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >::TimeStepType
@@ -142,8 +185,23 @@ DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >
   str.TimeStep = NumericTraits< TimeStepType >::Zero;  // Not used during the
   // calculate change step.
   this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
-  this->GetMultiThreader()->SetSingleMethod(this->CalculateChangeThreaderCallback,
-                                            &str);
+  if ( m_FusingUpdate )
+    {
+    // The changes are applied as they are computed, so the time step must
+    // be known beforehand.
+    const typename FiniteDifferenceFunctionType::Pointer df = this->GetDifferenceFunction();
+    void *globalData = df->GetGlobalDataPointer();
+    str.TimeStep = df->ComputeGlobalTimeStep(globalData);
+    df->ReleaseGlobalDataPointer(globalData);
+
+    this->GetMultiThreader()->SetSingleMethod(this->CalculateAndApplyChangeThreaderCallback,
+                                              &str);
+    }
+  else
+    {
+    this->GetMultiThreader()->SetSingleMethod(this->CalculateChangeThreaderCallback,
+                                              &str);
+    }
 
   // Initialize the list of time step values that will be generated by the
   // various threads.  There is one distinct slot for each possible thread,
@@ -156,9 +214,22 @@ DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >
   str.ValidTimeStepList.clear();
   str.ValidTimeStepList.resize( threadCount, false );
 
+  if ( m_FusingUpdate )
+    {
+    m_HeldUpdates.resize(threadCount);
+    }
+
   // Multithread the execution
   this->GetMultiThreader()->SingleMethodExecute();
 
+  if ( m_FusingUpdate )
+    {
+    // The output has changed, and ApplyUpdate() must use the time step
+    // that was applied.
+    this->GetOutput()->Modified();
+    return str.TimeStep;
+    }
+
   // Resolve the single value time step to return
   TimeStepType dt = this->ResolveTimeStep( str.TimeStepList,
                                            str.ValidTimeStepList );
@@ -202,6 +273,33 @@ DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >
   return ITK_THREAD_RETURN_VALUE;
 }
 
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >
+::CalculateAndApplyChangeThreaderCallback(void *arg)
+{
+  ThreadIdType threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  ThreadIdType threadCount = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->NumberOfThreads;
+
+  DenseFDThreadStruct * str = (DenseFDThreadStruct *)
+      ( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  ThreadRegionType splitRegion;
+
+  ThreadIdType total = str->Filter->SplitRequestedRegion( threadId,
+                                                 threadCount,
+                                                 splitRegion );
+
+  if ( threadId < total )
+    {
+    str->TimeStepList[threadId] =
+      str->Filter->ThreadedCalculateAndApplyChange(str->TimeStep, splitRegion, threadId);
+    str->ValidTimeStepList[threadId] = true;
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 template< class TInputImage, class TOutputImage >
 void
 DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >
@@ -209,11 +307,21 @@ DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >
                       const ThreadRegionType & regionToProcess,
                       ThreadIdType)
 {
-  ImageRegionIterator< UpdateBufferType > u(m_UpdateBuffer,    regionToProcess);
-  ImageRegionIterator< OutputImageType >  o(this->GetOutput(), regionToProcess);
+  this->ApplyUpdateOverRegion(dt, regionToProcess, m_UpdateBuffer);
+}
+
+template< class TInputImage, class TOutputImage >
+void
+DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >
+::ApplyUpdateOverRegion(const TimeStepType& dt,
+                        const ThreadRegionType & region,
+                        const UpdateBufferType *updateBuffer)
+{
+  ImageRegionConstIterator< UpdateBufferType > u(updateBuffer,      region);
+  ImageRegionIterator< OutputImageType >       o(this->GetOutput(), region);
 
-  u = u.Begin();
-  o = o.Begin();
+  u.GoToBegin();
+  o.GoToBegin();
 
   while ( !u.IsAtEnd() )
     {
@@ -230,28 +338,141 @@ DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >::TimeStepType
 DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >
 ::ThreadedCalculateChange(const ThreadRegionType & regionToProcess, ThreadIdType)
 {
-  typedef typename OutputImageType::RegionType                    RegionType;
+  // Get the FiniteDifferenceFunction to use in calculations.
+  const typename FiniteDifferenceFunctionType::Pointer
+      df = this->GetDifferenceFunction();
+
+  // Ask the function object for a pointer to a data structure it
+  // will use to manage any global values it needs.  We'll pass this
+  // back to the function object at each calculation and then
+  // again so that the function object can use it to determine a
+  // time step for this iteration.
+  void * globalData = df->GetGlobalDataPointer();
+
+  this->CalculateChangeOverRegion(regionToProcess, m_UpdateBuffer, globalData);
+
+  // Ask the finite difference function to compute the time step for
+  // this iteration.  We give it the global data pointer to use, then
+  // ask it to free the global data memory.
+  TimeStepType timeStep = df->ComputeGlobalTimeStep(globalData);
+  df->ReleaseGlobalDataPointer(globalData);
+
+  return timeStep;
+}
+
+template< class TInputImage, class TOutputImage >
+typename
+DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >::TimeStepType
+DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >
+::ThreadedCalculateAndApplyChange(const TimeStepType & dt,
+                                  const ThreadRegionType & regionToProcess,
+                                  ThreadIdType threadId)
+{
+  typedef typename OutputImageType::SizeType SizeType;
+
+  const typename FiniteDifferenceFunctionType::Pointer
+      df = this->GetDifferenceFunction();
+
+  const SizeType radius = df->GetRadius();
+
+  void * globalData = df->GetGlobalDataPointer();
+
+  // The slabs are the slices along the axis on which the requested region
+  // was split, which is the outermost one where this region is smaller.
+  const ThreadRegionType & requestedRegion = this->GetOutput()->GetRequestedRegion();
+  // With a single region, any axis will do.
+  unsigned int axis = ImageDimension - 1;
+  while ( axis > 0 && regionToProcess.GetSize(axis) == 1 )
+    {
+    --axis;
+    }
+  for ( unsigned int d = ImageDimension; d > 0; --d )
+    {
+    if ( regionToProcess.GetSize(d - 1) != requestedRegion.GetSize(d - 1) )
+      {
+      axis = d - 1;
+      break;
+      }
+    }
+
+  const IndexValueType first = regionToProcess.GetIndex(axis);
+  const IndexValueType end = first + static_cast< IndexValueType >( regionToProcess.GetSize(axis) );
+  const IndexValueType halo = static_cast< IndexValueType >( radius[axis] );
+
+  // The changes of a slice can be applied once the slices up to "halo"
+  // slices after it have been computed. Those of the first and last "halo"
+  // slices are read by the neighbouring threads, and are held back until
+  // all the threads are done.
+  UpdateSlabListType & heldUpdates = m_HeldUpdates[threadId];
+  heldUpdates.clear();
+  UpdateSlabListType ring(halo + 1);
+
+  ThreadRegionType slabRegion = regionToProcess;
+  slabRegion.SetSize(axis, 1);
+  for ( IndexValueType s = first; s < end; ++s )
+    {
+    slabRegion.SetIndex(axis, s);
+
+    typename UpdateBufferType::Pointer slab;
+    if ( s < first + halo || s >= end - halo )
+      {
+      slab = UpdateBufferType::New();
+      slab->SetRegions(slabRegion);
+      slab->Allocate();
+      heldUpdates.push_back(slab);
+      }
+    else
+      {
+      // The slabs of the ring are reused for the following slices.
+      slab = ring[( s - first ) % ( halo + 1 )];
+      if ( slab.IsNull() )
+        {
+        slab = UpdateBufferType::New();
+        slab->SetRegions(slabRegion);
+        slab->Allocate();
+        ring[( s - first ) % ( halo + 1 )] = slab;
+        }
+      else
+        {
+        slab->SetRegions(slabRegion);
+        }
+      }
+
+    this->CalculateChangeOverRegion(slabRegion, slab, globalData);
+
+    const IndexValueType t = s - halo;
+    if ( t >= first + halo && t < end - halo )
+      {
+      const UpdateBufferType *done = ring[( t - first ) % ( halo + 1 )];
+      this->ApplyUpdateOverRegion(dt, done->GetBufferedRegion(), done);
+      }
+    }
+
+  TimeStepType timeStep = df->ComputeGlobalTimeStep(globalData);
+  df->ReleaseGlobalDataPointer(globalData);
+
+  return timeStep;
+}
+
+template< class TInputImage, class TOutputImage >
+void
+DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >
+::CalculateChangeOverRegion(const ThreadRegionType & region,
+                            UpdateBufferType *updateBuffer,
+                            void *globalData)
+{
   typedef typename OutputImageType::SizeType                      SizeType;
-  typedef typename OutputImageType::IndexType                     IndexType;
   typedef typename FiniteDifferenceFunctionType::NeighborhoodType NeighborhoodIteratorType;
 
   typedef ImageRegionIterator< UpdateBufferType > UpdateIteratorType;
 
   typename OutputImageType::Pointer output = this->GetOutput();
 
-  // Get the FiniteDifferenceFunction to use in calculations.
   const typename FiniteDifferenceFunctionType::Pointer
       df = this->GetDifferenceFunction();
 
   const SizeType radius = df->GetRadius();
 
-  // Ask the function object for a pointer to a data structure it
-  // will use to manage any global values it needs.  We'll pass this
-  // back to the function object at each calculation and then
-  // again so that the function object can use it to determine a
-  // time step for this iteration.
-  void * globalData = df->GetGlobalDataPointer();
-
   // Break the input into a series of regions.  The first region is free
   // of boundary conditions, the rest with boundary conditions.  We operate
   // on the output region because input has been copied to output.
@@ -262,13 +483,13 @@ DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >
 
   FaceCalculatorType faceCalculator;
 
-  FaceListType faceList = faceCalculator(output, regionToProcess, radius);
+  FaceListType faceList = faceCalculator(output, region, radius);
   typename FaceListType::iterator fIt = faceList.begin();
   typename FaceListType::iterator fEnd = faceList.end();
 
   // Process the non-boundary region.
   NeighborhoodIteratorType nD(radius, output, *fIt);
-  UpdateIteratorType       nU(m_UpdateBuffer,  *fIt);
+  UpdateIteratorType       nU(updateBuffer,  *fIt);
   nD.GoToBegin();
   while ( !nD.IsAtEnd() )
     {
@@ -281,7 +502,7 @@ DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >
   for ( ++fIt; fIt != fEnd; ++fIt )
     {
     NeighborhoodIteratorType bD(radius, output, *fIt);
-    UpdateIteratorType bU(m_UpdateBuffer, *fIt);
+    UpdateIteratorType bU(updateBuffer, *fIt);
 
     bD.GoToBegin();
     bU.GoToBegin();
@@ -292,14 +513,6 @@ DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >
       ++bU;
       }
     }
-
-  // Ask the finite difference function to compute the time step for
-  // this iteration.  We give it the global data pointer to use, then
-  // ask it to free the global data memory.
-  TimeStepType timeStep = df->ComputeGlobalTimeStep(globalData);
-  df->ReleaseGlobalDataPointer(globalData);
-
-  return timeStep;
 }
 
 template< class TInputImage, class TOutputImage >
@@ -308,6 +521,7 @@ DenseFiniteDifferenceImageFilter< TInputImage, TOutputImage >
 ::PrintSelf(std::ostream & os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+  os << indent << "UseFusedUpdate: " << m_UseFusedUpdate << std::endl;
 }
 } // end namespace itk
 
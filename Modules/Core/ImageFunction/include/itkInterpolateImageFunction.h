@@ -78,6 +78,9 @@ public:
   /** ContinuousIndex typedef support. */
   typedef typename Superclass::ContinuousIndexType ContinuousIndexType;
 
+  /** Size typedef support. */
+  typedef typename InputImageType::SizeType SizeType;
+
   /** RealType typedef support. */
   typedef typename NumericTraits< typename TInputImage::PixelType >::RealType RealType;
 
@@ -123,6 +126,19 @@ public:
     return ( static_cast< RealType >( this->GetInputImage()->GetPixel(index) ) );
   }
 
+  /** Radius of the neighborhood of pixels, around the pixel nearest to a
+   * continuous index, that EvaluateAtContinuousIndex() reads.
+   *
+   * Filters use it to request only the part of the input image that they
+   * interpolate. The default is the largest radius, for interpolators
+   * whose values depend on the whole image. */
+  virtual SizeType GetRadius() const
+  {
+    SizeType radius;
+    radius.Fill( NumericTraits< SizeValueType >::max() );
+    return radius;
+  }
+
 protected:
   InterpolateImageFunction(){}
   ~InterpolateImageFunction(){}
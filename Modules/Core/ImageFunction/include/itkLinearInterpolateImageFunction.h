@@ -82,6 +82,9 @@ public:
   /** ContinuousIndex typedef support. */
   typedef typename Superclass::ContinuousIndexType ContinuousIndexType;
 
+  /** Size typedef support. */
+  typedef typename Superclass::SizeType SizeType;
+
   /** Evaluate the function at a ContinuousIndex position
    *
    * Returns the linearly interpolated image intensity at a
@@ -97,6 +100,14 @@ public:
     return this->EvaluateOptimized(Dispatch< ImageDimension >(), index);
   }
 
+  /** The neighbors of the pixel nearest to the continuous index. */
+  virtual SizeType GetRadius() const
+  {
+    SizeType radius;
+    radius.Fill(1);
+    return radius;
+  }
+
 protected:
   LinearInterpolateImageFunction();
   ~LinearInterpolateImageFunction();
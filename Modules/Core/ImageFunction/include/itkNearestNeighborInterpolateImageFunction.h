@@ -67,6 +67,9 @@ public:
   /** ContinuousIndex typedef support. */
   typedef typename Superclass::ContinuousIndexType ContinuousIndexType;
 
+  /** Size typedef support. */
+  typedef typename Superclass::SizeType SizeType;
+
   /** Evaluate the function at a ContinuousIndex position
    *
    * Returns the interpolated image intensity at a
@@ -84,6 +87,14 @@ public:
     return static_cast< OutputType >( this->GetInputImage()->GetPixel(nindex) );
   }
 
+  /** Only the pixel nearest to the continuous index is read. */
+  virtual SizeType GetRadius() const
+  {
+    SizeType radius;
+    radius.Fill(0);
+    return radius;
+  }
+
 protected:
   NearestNeighborInterpolateImageFunction(){}
   ~NearestNeighborInterpolateImageFunction(){}
@@ -292,6 +292,9 @@ public:
   /** ContinuousIndex typedef support. */
   typedef typename Superclass::ContinuousIndexType ContinuousIndexType;
 
+  /** Size typedef support. */
+  typedef typename Superclass::SizeType SizeType;
+
   virtual void SetInputImage(const ImageType *image);
 
   /** Evaluate the function at a ContinuousIndex position
@@ -303,6 +306,14 @@ public:
   virtual OutputType EvaluateAtContinuousIndex(
     const ContinuousIndexType & index) const;
 
+  /** The radius of the kernel. */
+  virtual SizeType GetRadius() const
+  {
+    SizeType radius;
+    radius.Fill(VRadius);
+    return radius;
+  }
+
 protected:
   WindowedSincInterpolateImageFunction();
   virtual ~WindowedSincInterpolateImageFunction();
@@ -134,6 +134,24 @@ public:
   /** Transform from azimuth-elevation to cartesian. */
   OutputPointType     TransformPoint(const InputPointType  & point) const;
 
+  /** Transform a batch of points one by one: the matrix of the superclass
+   * does not describe this transform. */
+  virtual void TransformPoints(const InputPointType *inputPoints,
+                               OutputPointType *outputPoints,
+                               SizeValueType numberOfPoints) const
+  {
+    for ( SizeValueType i = 0; i < numberOfPoints; i++ )
+      {
+      outputPoints[i] = this->TransformPoint(inputPoints[i]);
+      }
+  }
+
+  /** The transform is not linear, even though its superclass is. */
+  virtual bool IsLinear() const
+  {
+    return false;
+  }
+
   /** Back transform from cartesian to azimuth-elevation.  */
   inline InputPointType  BackTransform(const OutputPointType  & point) const
   {
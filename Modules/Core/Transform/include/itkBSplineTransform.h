@@ -294,6 +294,13 @@ public:
   virtual void TransformPoint( const InputPointType & inputPoint, OutputPointType & outputPoint,
     WeightsType & weights, ParameterIndexArrayType & indices, bool & inside ) const;
 
+  /** Transform a batch of points. The buffer of the weights, the
+   * coefficient buffers and the offsets of a support region in them are
+   * set up once for the batch instead of once per point. */
+  virtual void TransformPoints(const InputPointType *inputPoints,
+                               OutputPointType *outputPoints,
+                               SizeValueType numberOfPoints) const;
+
   /** Get number of weights. */
   unsigned long GetNumberOfWeights() const
   {
@@ -386,9 +393,13 @@ public:
   /** Function to retrieve the transform domain mesh size. */
   itkGetConstMacro( TransformDomainMeshSize, MeshSizeType );
 
+  /** The coefficients of the grid are global parameters of the transform,
+   * unlike those of a displacement field, which are local to each point of
+   * the field. The registration metrics thus treat the transform like any
+   * other global transform, and sum its derivatives over all the points. */
   virtual bool HasLocalSupport() const
   {
-    return true;
+    return false;
   }
 
 protected:
@@ -718,6 +718,83 @@ BSplineTransform<TScalarType, NDimensions, VSplineOrder>
     }
 }
 
+// Transform a batch of points
+template <class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder>
+void
+BSplineTransform<TScalarType, NDimensions, VSplineOrder>
+::TransformPoints(const InputPointType *inputPoints, OutputPointType *outputPoints,
+  SizeValueType numberOfPoints) const
+{
+  if( !this->m_CoefficientImages[0]->GetBufferPointer() )
+    {
+    itkWarningMacro( "B-spline coefficients have not been set" );
+    for( SizeValueType n = 0; n < numberOfPoints; n++ )
+      {
+      outputPoints[n] = inputPoints[n];
+      }
+    return;
+    }
+
+  // The offsets of the coefficients of a support region from its first
+  // coefficient, in the order of the weights.
+  const unsigned long          numberOfWeights = this->m_WeightsFunction->GetNumberOfWeights();
+  const OffsetValueType *      offsetTable = this->m_CoefficientImages[0]->GetOffsetTable();
+  std::vector<OffsetValueType> supportOffsets( numberOfWeights );
+  for( unsigned long k = 0; k < numberOfWeights; k++ )
+    {
+    unsigned long remainder = k;
+    supportOffsets[k] = 0;
+    for( unsigned int j = 0; j < SpaceDimension; j++ )
+      {
+      supportOffsets[k] += ( remainder % ( SplineOrder + 1 ) ) * offsetTable[j];
+      remainder /= SplineOrder + 1;
+      }
+    }
+
+  const ParametersValueType *coefficients[SpaceDimension];
+  for( unsigned int j = 0; j < SpaceDimension; j++ )
+    {
+    coefficients[j] = this->m_CoefficientImages[j]->GetBufferPointer();
+    }
+
+  WeightsType         weights( numberOfWeights );
+  ContinuousIndexType index;
+  IndexType           supportIndex;
+  for( SizeValueType n = 0; n < numberOfPoints; n++ )
+    {
+    // outputPoints may be inputPoints
+    const InputPointType point = inputPoints[n];
+    this->m_CoefficientImages[0]->TransformPhysicalPointToContinuousIndex( point, index );
+
+    // NOTE: if the support region does not lie totally within the grid
+    // we assume zero displacement and return the input point
+    if( !this->InsideValidRegion( index ) )
+      {
+      outputPoints[n] = point;
+      continue;
+      }
+
+    this->m_WeightsFunction->Evaluate( index, weights, supportIndex );
+    const OffsetValueType start = this->m_CoefficientImages[0]->ComputeOffset( supportIndex );
+
+    OutputPointType outputPoint;
+    outputPoint.Fill( NumericTraits<ScalarType>::Zero );
+    for( unsigned long k = 0; k < numberOfWeights; k++ )
+      {
+      const OffsetValueType offset = start + supportOffsets[k];
+      for( unsigned int j = 0; j < SpaceDimension; j++ )
+        {
+        outputPoint[j] += static_cast<ScalarType>( weights[k] * coefficients[j][offset] );
+        }
+      }
+    for( unsigned int j = 0; j < SpaceDimension; j++ )
+      {
+      outputPoint[j] += point[j];
+      }
+    outputPoints[n] = outputPoint;
+    }
+}
+
 // Transform a point
 template <class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder>
 typename BSplineTransform<TScalarType, NDimensions, VSplineOrder>
@@ -773,6 +850,9 @@ BSplineTransform<TScalarType, NDimensions, VSplineOrder>
   IndexType startIndex =
     this->m_CoefficientImages[0]->GetLargestPossibleRegion().GetIndex();
 
+  const NumberOfParametersType numberOfParametersPerDimension =
+    this->GetNumberOfParametersPerDimension();
+
   SizeType cumulativeGridSizes;
   cumulativeGridSizes[0] = ( this->m_TransformDomainMeshSize[0] + SplineOrder );
   for( unsigned int d = 1; d < SpaceDimension; d++ )
@@ -795,7 +875,7 @@ BSplineTransform<TScalarType, NDimensions, VSplineOrder>
 
     for( unsigned int d = 0; d < SpaceDimension; d++ )
       {
-      jacobian( d, number ) = weights[counter];
+      jacobian( d, number + d * numberOfParametersPerDimension ) = weights[counter];
       }
     counter++;
     }
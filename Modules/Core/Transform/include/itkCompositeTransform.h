@@ -19,8 +19,10 @@
 #define __itkCompositeTransform_h
 
 #include "itkTransform.h"
+#include "itkSimpleFastMutexLock.h"
 
 #include <deque>
+#include <vector>
 
 namespace itk
 {
@@ -87,6 +89,18 @@ namespace itk
  *   transforms. Are there use cases where the user would *need* to insert
  *   transforms at the front of the queue? Or at arbitrary positions?
  *
+ * Flattened transforms:
+ * TransformPoints does not walk the queue itself but a flattened copy of
+ * it, in the order the transforms are applied, in which each run of
+ * consecutive linear transforms is replaced by the matrix and offset of
+ * their composition. A chain such as [affine, rigid, BSpline, affine] then
+ * costs two matrix products and one BSpline evaluation per point. The
+ * flattened transforms are checked once per batch, and rebuilt when this
+ * transform or one of the sub-transforms is modified. A rebuild publishes
+ * a new copy, so that the threads transforming points with the previous
+ * one are not affected. TransformPoint walks the queue, so that the threads
+ * transforming single points take no lock.
+ *
  * GetParameters efficiency optimization
  *  Can we optimize this to only query the sub-transforms when the params
  *  in the sub transforms have changed since the previous call? Can't use
@@ -153,6 +167,8 @@ public:
   /** Standard vnl_vector type for this class. */
   typedef typename Superclass::InputVnlVectorType  InputVnlVectorType;
   typedef typename Superclass::OutputVnlVectorType OutputVnlVectorType;
+  /** Matrix type of the folded linear transforms. */
+  typedef Matrix<TScalar, NDimensions, NDimensions> MatrixType;
   /** Transform queue type */
   typedef std::deque<TransformTypePointer> TransformQueueType;
   /** Optimization flags queue type */
@@ -298,6 +314,12 @@ public:
   */
   virtual OutputPointType TransformPoint( const InputPointType & inputPoint ) const;
 
+  /** Transform a batch of points through each transform in turn, with one
+   * call per transform instead of one per point and transform. */
+  virtual void TransformPoints( const InputPointType *inputPoints,
+                                OutputPointType *outputPoints,
+                                SizeValueType numberOfPoints ) const;
+
   /* Note: why was the 'isInsideTransformRegion' flag used below?
   {
     bool isInside = true;
@@ -433,7 +455,52 @@ private:
   CompositeTransform( const Self & ); // purposely not implemented
   void operator=( const Self & );     // purposely not implemented
 
+  /** One step of the flattened transforms: either a non-linear transform
+   * of the queue, or the matrix and offset of consecutive linear ones. */
+  struct FlattenedTransformType
+    {
+    typename TransformType::ConstPointer Transform;
+    MatrixType                           Matrix;
+    OutputVectorType                     Offset;
+    };
+  typedef std::vector<FlattenedTransformType> FlattenedTransformsType;
+
+  /** A built copy of the flattened transforms. A rebuild publishes a new
+   * copy, so that the threads still walking the previous one keep it
+   * alive and unchanged. */
+  class FlattenedTransforms : public LightObject
+    {
+  public:
+    typedef FlattenedTransforms      Self;
+    typedef SmartPointer<Self>       Pointer;
+    typedef SmartPointer<const Self> ConstPointer;
+
+    itkSimpleNewMacro( Self );
+
+    FlattenedTransformsType Steps;
+    TimeStamp               BuildTime;
+    };
+  typedef typename FlattenedTransforms::ConstPointer FlattenedTransformsConstPointer;
+
+  /** Whether the flattened transforms are newer than this transform and
+   * all the sub-transforms. Called with m_FlattenedTransformsLock held. */
+  bool FlattenedTransformsAreUpToDate() const;
+
+  /** Return the flattened transforms, rebuilt first if they are older than
+   * this transform or one of the sub-transforms. */
+  FlattenedTransformsConstPointer GetFlattenedTransforms() const;
+
+  /** Matrix and offset of a linear transform. */
+  void GetLinearTransformMatrixAndOffset( const TransformType *transform,
+                                          MatrixType & matrix,
+                                          OutputVectorType & offset ) const;
+
   mutable unsigned long m_PreviousTransformsToOptimizeUpdateTime;
+
+  /** The copy of the flattened transforms last built. Read and replaced
+   * only with m_FlattenedTransformsLock held. */
+  mutable FlattenedTransformsConstPointer m_FlattenedTransforms;
+  mutable SimpleFastMutexLock             m_FlattenedTransformsLock;
 };
 
 } // end namespace itk
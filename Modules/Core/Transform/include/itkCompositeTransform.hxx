@@ -19,7 +19,10 @@
 #define __itkCompositeTransform_hxx
 
 #include "itkCompositeTransform.h"
+#include "itkMutexLockHolder.h"
+#include "itkScaleTransform.h"
 #include <string.h> // for memcpy on some platforms
+#include <algorithm>
 
 namespace itk
 {
@@ -64,6 +67,131 @@ bool CompositeTransform<TScalar, NDimensions>
   return true;
 }
 
+/**
+ * Matrix and offset of a linear transform
+ */
+template
+<class TScalar, unsigned int NDimensions>
+void
+CompositeTransform<TScalar, NDimensions>
+::GetLinearTransformMatrixAndOffset( const TransformType *transform,
+                                     MatrixType & matrix,
+                                     OutputVectorType & offset ) const
+{
+  /* The matrix and offset of a MatrixOffsetTransformBase are exact. A
+   * ScaleTransform keeps its scaling center outside of them, though. */
+  typedef MatrixOffsetTransformBase<TScalar, NDimensions, NDimensions> MatrixOffsetTransformType;
+  typedef ScaleTransform<TScalar, NDimensions>                         ScaleTransformType;
+  const MatrixOffsetTransformType *matrixOffsetTransform =
+    dynamic_cast<const MatrixOffsetTransformType *>( transform );
+  if( matrixOffsetTransform
+      && !dynamic_cast<const ScaleTransformType *>( transform ) )
+    {
+    matrix = matrixOffsetTransform->GetMatrix();
+    offset = matrixOffsetTransform->GetOffset();
+    return;
+    }
+
+  /* Otherwise the offset is the image of the origin, and the columns of
+   * the matrix are the images of the unit vectors minus the offset. */
+  InputPointType origin;
+  origin.Fill( NumericTraits<TScalar>::Zero );
+  const OutputPointType transformedOrigin = transform->TransformPoint( origin );
+  offset = transformedOrigin.GetVectorFromOrigin();
+  for( unsigned int j = 0; j < NDimensions; j++ )
+    {
+    InputPointType unit( origin );
+    unit[j] = NumericTraits<TScalar>::One;
+    const OutputVectorType column = transform->TransformPoint( unit ) - transformedOrigin;
+    for( unsigned int i = 0; i < NDimensions; i++ )
+      {
+      matrix[i][j] = column[i];
+      }
+    }
+}
+
+/**
+ * Whether the flattened transforms are newer than the transforms
+ */
+template
+<class TScalar, unsigned int NDimensions>
+bool
+CompositeTransform<TScalar, NDimensions>
+::FlattenedTransformsAreUpToDate() const
+{
+  if( this->m_FlattenedTransforms.IsNull() )
+    {
+    return false;
+    }
+  const unsigned long flattenedTime = this->m_FlattenedTransforms->BuildTime.GetMTime();
+  if( this->GetMTime() > flattenedTime )
+    {
+    return false;
+    }
+  typename TransformQueueType::const_iterator it;
+  for( it = this->m_TransformQueue.begin();
+       it != this->m_TransformQueue.end(); ++it )
+    {
+    if( (*it)->GetMTime() > flattenedTime )
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+/**
+ * Get the flattened transforms, rebuilt if needed
+ */
+template
+<class TScalar, unsigned int NDimensions>
+typename CompositeTransform<TScalar, NDimensions>
+::FlattenedTransformsConstPointer
+CompositeTransform<TScalar, NDimensions>
+::GetFlattenedTransforms() const
+{
+  /* The check and the publication of a rebuilt copy both hold the lock. */
+  MutexLockHolder<SimpleFastMutexLock> holder( this->m_FlattenedTransformsLock );
+
+  if( this->FlattenedTransformsAreUpToDate() )
+    {
+    return this->m_FlattenedTransforms;
+    }
+
+  /* Apply in reverse queue order, folding consecutive linear transforms:
+   * M2 ( M1 x + o1 ) + o2 = ( M2 M1 ) x + ( M2 o1 + o2 ). */
+  typename FlattenedTransforms::Pointer flattened = FlattenedTransforms::New();
+  FlattenedTransformsType & steps = flattened->Steps;
+  typename TransformQueueType::const_iterator it = this->m_TransformQueue.end();
+  while( it != this->m_TransformQueue.begin() )
+    {
+    it--;
+    FlattenedTransformType step;
+    if( !(*it)->IsLinear() )
+      {
+      step.Transform = (*it).GetPointer();
+      steps.push_back( step );
+      continue;
+      }
+
+    this->GetLinearTransformMatrixAndOffset( (*it).GetPointer(), step.Matrix, step.Offset );
+    if( !steps.empty() && steps.back().Transform.IsNull() )
+      {
+      FlattenedTransformType & previous = steps.back();
+      previous.Offset = step.Matrix * previous.Offset + step.Offset;
+      previous.Matrix = step.Matrix * previous.Matrix;
+      }
+    else
+      {
+      steps.push_back( step );
+      }
+    }
+
+  flattened->BuildTime.Modified();
+  this->m_FlattenedTransforms = flattened.GetPointer();
+  return this->m_FlattenedTransforms;
+}
+
 /**
  * Transform point
  */
@@ -74,22 +202,76 @@ typename CompositeTransform<TScalar, NDimensions>
 CompositeTransform<TScalar, NDimensions>
 ::TransformPoint( const InputPointType& inputPoint ) const
 {
+  /* Apply in reverse queue order. A single point is transformed through
+   * the queue itself: checking and locking the flattened transforms would
+   * cost more than the virtual calls they save, and would serialize the
+   * threads that transform points one at a time. */
   OutputPointType outputPoint( inputPoint );
 
-  typename TransformQueueType::const_iterator it;
-  /* Apply in reverse queue order.  */
-  it = this->m_TransformQueue.end();
-
-  do
+  typename TransformQueueType::const_iterator it = this->m_TransformQueue.end();
+  while( it != this->m_TransformQueue.begin() )
     {
     it--;
     outputPoint = (*it)->TransformPoint( outputPoint );
     }
-  while( it != this->m_TransformQueue.begin() );
 
   return outputPoint;
 }
 
+/**
+ * Transform a batch of points
+ */
+template
+<class TScalar, unsigned int NDimensions>
+void
+CompositeTransform<TScalar, NDimensions>
+::TransformPoints( const InputPointType *inputPoints,
+                   OutputPointType *outputPoints,
+                   SizeValueType numberOfPoints ) const
+{
+  /* The flattened transforms are checked, and rebuilt if needed, once per
+   * batch. */
+  const FlattenedTransformsConstPointer flattened = this->GetFlattenedTransforms();
+
+  if( flattened->Steps.empty() )
+    {
+    if( inputPoints != outputPoints )
+      {
+      std::copy( inputPoints, inputPoints + numberOfPoints, outputPoints );
+      }
+    return;
+    }
+
+  /* The first transform reads the input points; the others transform the
+   * output points in place. */
+  const InputPointType *points = inputPoints;
+  typename FlattenedTransformsType::const_iterator it;
+  for( it = flattened->Steps.begin(); it != flattened->Steps.end(); ++it )
+    {
+    if( it->Transform )
+      {
+      it->Transform->TransformPoints( points, outputPoints, numberOfPoints );
+      }
+    else
+      {
+      for( SizeValueType n = 0; n < numberOfPoints; n++ )
+        {
+        const InputPointType point = points[n];
+        for( unsigned int i = 0; i < NDimensions; i++ )
+          {
+          TScalar value = it->Offset[i];
+          for( unsigned int j = 0; j < NDimensions; j++ )
+            {
+            value += it->Matrix[i][j] * point[j];
+            }
+          outputPoints[n][i] = value;
+          }
+        }
+      }
+    points = outputPoints;
+    }
+}
+
 /**
  * return an inverse transformation
  */
@@ -185,6 +185,50 @@ MatrixOffsetTransformBase<TScalarType, NInputDimensions, NOutputDimensions>
   return m_Matrix * point + m_Offset;
 }
 
+// Transform a batch of points
+template <class TScalarType, unsigned int NInputDimensions,
+          unsigned int NOutputDimensions>
+void
+MatrixOffsetTransformBase<TScalarType, NInputDimensions, NOutputDimensions>
+::TransformPoints(const InputPointType *inputPoints,
+                  OutputPointType *outputPoints,
+                  SizeValueType numberOfPoints) const
+{
+  // Plain copies of the matrix and offset let the compiler keep them in
+  // registers and unroll the products.
+  TScalarType matrix[NOutputDimensions][NInputDimensions];
+  TScalarType offset[NOutputDimensions];
+
+  for( unsigned int i = 0; i < NOutputDimensions; i++ )
+    {
+    for( unsigned int j = 0; j < NInputDimensions; j++ )
+      {
+      matrix[i][j] = m_Matrix[i][j];
+      }
+    offset[i] = m_Offset[i];
+    }
+
+  for( SizeValueType n = 0; n < numberOfPoints; n++ )
+    {
+    // The input is copied first, since outputPoints may be inputPoints.
+    TScalarType input[NInputDimensions];
+    for( unsigned int j = 0; j < NInputDimensions; j++ )
+      {
+      input[j] = inputPoints[n][j];
+      }
+    OutputPointType & output = outputPoints[n];
+    for( unsigned int i = 0; i < NOutputDimensions; i++ )
+      {
+      TScalarType value = offset[i];
+      for( unsigned int j = 0; j < NInputDimensions; j++ )
+        {
+        value += matrix[i][j] * input[j];
+        }
+      output[i] = value;
+      }
+    }
+}
+
 // Transform a vector
 template <class TScalarType, unsigned int NInputDimensions,
           unsigned int NOutputDimensions>
@@ -157,6 +157,18 @@ public:
    * vector. */
   OutputPointType     TransformPoint(const InputPointType  & point) const;
 
+  /** Transform a batch of points one by one: the offset of the superclass
+   * does not account for the scaling center. */
+  virtual void TransformPoints(const InputPointType *inputPoints,
+                               OutputPointType *outputPoints,
+                               SizeValueType numberOfPoints) const
+  {
+    for ( SizeValueType i = 0; i < numberOfPoints; i++ )
+      {
+      outputPoints[i] = this->TransformPoint(inputPoints[i]);
+      }
+  }
+
   using Superclass::TransformVector;
   OutputVectorType    TransformVector(const InputVectorType & vector) const;
 
@@ -195,6 +195,17 @@ public:
    */
   virtual OutputPointType TransformPoint(const InputPointType  &) const = 0;
 
+  /** Method to transform numberOfPoints points at once. The default
+   * implementation calls TransformPoint() for each point; transforms that
+   * can share work between the points, or avoid a virtual call per point,
+   * override it. outputPoints may be inputPoints when the input and output
+   * point types are the same, which lets a composition of transforms work
+   * in place.
+   * \warning This method must be thread-safe, like TransformPoint(). */
+  virtual void TransformPoints(const InputPointType *inputPoints,
+                               OutputPointType *outputPoints,
+                               SizeValueType numberOfPoints) const;
+
   /**  Method to transform a vector. */
   virtual OutputVectorType  TransformVector(const InputVectorType &) const = 0;
 
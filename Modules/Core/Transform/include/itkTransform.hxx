@@ -109,6 +109,24 @@ Transform<TScalarType, NInputDimensions, NOutputDimensions>
 }
 #endif
 
+/**
+ * TransformPoints
+ */
+template <class TScalarType,
+          unsigned int NInputDimensions,
+          unsigned int NOutputDimensions>
+void
+Transform<TScalarType, NInputDimensions, NOutputDimensions>
+::TransformPoints(const InputPointType *inputPoints,
+                  OutputPointType *outputPoints,
+                  SizeValueType numberOfPoints) const
+{
+  for( SizeValueType i = 0; i < numberOfPoints; i++ )
+    {
+    outputPoints[i] = this->TransformPoint(inputPoints[i]);
+    }
+}
+
 /**
  * UpdateTransformParameters
  */
@@ -19,7 +19,10 @@
 #include <iostream>
 
 #include "itkAffineTransform.h"
+#include "itkBSplineTransform.h"
 #include "itkCompositeTransform.h"
+#include "itkScaleTransform.h"
+#include "itkTranslationTransform.h"
 #include "itkArray2D.h"
 // #include "itkDisplacementFieldTransform.h"
 
@@ -830,6 +833,137 @@ int itkCompositeTransformTest(int, char *[] )
     }
   std::cout << "CreateAnother test passed." << std::endl;
 
+  /* Test that consecutive linear transforms, which are folded into a single
+   * matrix and offset, give the same points as the transforms applied in
+   * turn, also after one of them is modified. */
+  std::cout << "Test folding of linear transforms." << std::endl;
+  typedef itk::ScaleTransform<ScalarType, NDimensions>       ScaleType;
+  typedef itk::TranslationTransform<ScalarType, NDimensions> TranslationType;
+  typedef itk::BSplineTransform<ScalarType, NDimensions, 3>  BSplineType;
+
+  ScaleType::Pointer scale = ScaleType::New();
+  ScaleType::ScaleType scaleFactors;
+  scaleFactors[0] = 1.5;
+  scaleFactors[1] = 0.8;
+  scale->SetScale( scaleFactors );
+  ScaleType::InputPointType scaleCenter;
+  scaleCenter[0] = 3;
+  scaleCenter[1] = -2;
+  scale->SetCenter( scaleCenter );
+
+  TranslationType::Pointer translation = TranslationType::New();
+  TranslationType::OutputVectorType translationVector;
+  translationVector[0] = -4;
+  translationVector[1] = 1.5;
+  translation->Translate( translationVector );
+
+  BSplineType::Pointer bspline = BSplineType::New();
+  BSplineType::PhysicalDimensionsType bsplineDimensions;
+  bsplineDimensions.Fill( 20 );
+  BSplineType::MeshSizeType bsplineMeshSize;
+  bsplineMeshSize.Fill( 3 );
+  bspline->SetTransformDomainPhysicalDimensions( bsplineDimensions );
+  bspline->SetTransformDomainMeshSize( bsplineMeshSize );
+  BSplineType::ParametersType bsplineParameters( bspline->GetNumberOfParameters() );
+  for( unsigned int p = 0; p < bsplineParameters.Size(); p++ )
+    {
+    bsplineParameters[p] = ( p * 7 ) % 5 * 0.3 - 0.6;
+    }
+  bspline->SetParameters( bsplineParameters );
+
+  CompositeType::Pointer chain = CompositeType::New();
+  chain->AddTransform( affine );
+  chain->AddTransform( scale );
+  chain->AddTransform( bspline );
+  chain->AddTransform( translation );
+  chain->AddTransform( affine2 );
+
+  for( unsigned int modification = 0; modification < 2; modification++ )
+    {
+    if( modification == 1 )
+      {
+      scaleFactors[0] = 0.5;
+      scale->SetScale( scaleFactors );
+      }
+    CompositeType::InputPointType chainPoints[3];
+    CompositeType::OutputPointType batchedPoints[3];
+    for( unsigned int n = 0; n < 3; n++ )
+      {
+      chainPoints[n][0] = n * 4.0 + 1.0;
+      chainPoints[n][1] = 7.0 - n * 3.0;
+      }
+    chain->TransformPoints( chainPoints, batchedPoints, 3 );
+    for( unsigned int n = 0; n < 3; n++ )
+      {
+      CompositeType::OutputPointType chainTruth =
+        affine->TransformPoint( scale->TransformPoint( bspline->TransformPoint(
+          translation->TransformPoint( affine2->TransformPoint( chainPoints[n] ) ) ) ) );
+      if( !testPoint( chain->TransformPoint( chainPoints[n] ), chainTruth )
+          || !testPoint( batchedPoints[n], chainTruth ) )
+        {
+        std::cout << "Failed transforming " << chainPoints[n] << " through the chain: "
+                  << chain->TransformPoint( chainPoints[n] ) << " and "
+                  << batchedPoints[n] << " instead of " << chainTruth << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+  std::cout << "Folding of linear transforms test passed." << std::endl;
+
+  /* Test that the folding of float affine transforms with large offsets
+   * uses their matrices rather than differences of large transformed
+   * points, which would lose the precision of the matrices. */
+  std::cout << "Test folding of float linear transforms." << std::endl;
+  typedef itk::AffineTransform<float, NDimensions>     FloatAffineType;
+  typedef itk::CompositeTransform<float, NDimensions>  FloatCompositeType;
+  typedef itk::AffineTransform<double, NDimensions>    DoubleAffineType;
+
+  FloatCompositeType::Pointer floatChain = FloatCompositeType::New();
+  DoubleAffineType::Pointer   doubleAffines[2];
+  for( unsigned int t = 0; t < 2; t++ )
+    {
+    FloatAffineType::Pointer floatAffine = FloatAffineType::New();
+    FloatAffineType::ParametersType floatParameters( floatAffine->GetNumberOfParameters() );
+    floatParameters[0] = 0.7f + 0.1f * t;
+    floatParameters[1] = -0.3f;
+    floatParameters[2] = 0.2f;
+    floatParameters[3] = 0.9f - 0.2f * t;
+    floatParameters[4] = 12345.6f * ( t == 0 ? 1.0f : -1.0f );
+    floatParameters[5] = 23456.7f;
+    floatAffine->SetParameters( floatParameters );
+    floatChain->AddTransform( floatAffine );
+
+    doubleAffines[t] = DoubleAffineType::New();
+    DoubleAffineType::ParametersType doubleParameters( doubleAffines[t]->GetNumberOfParameters() );
+    for( unsigned int p = 0; p < doubleParameters.Size(); p++ )
+      {
+      doubleParameters[p] = floatParameters[p];
+      }
+    doubleAffines[t]->SetParameters( doubleParameters );
+    }
+
+  for( unsigned int n = 0; n < 3; n++ )
+    {
+    FloatCompositeType::InputPointType floatPoint;
+    DoubleAffineType::InputPointType   doublePoint;
+    floatPoint[0] = doublePoint[0] = 1000.0f * n - 700.0f;
+    floatPoint[1] = doublePoint[1] = 500.0f - 900.0f * n;
+    FloatCompositeType::OutputPointType floatResult;
+    floatChain->TransformPoints( &floatPoint, &floatResult, 1 );
+    const DoubleAffineType::OutputPointType   doubleResult =
+      doubleAffines[0]->TransformPoint( doubleAffines[1]->TransformPoint( doublePoint ) );
+    for( unsigned int d = 0; d < NDimensions; d++ )
+      {
+      if( vcl_abs( floatResult[d] - doubleResult[d] ) > 0.05 )
+        {
+        std::cout << "Failed transforming " << floatPoint << " through the float chain: "
+                  << floatResult << " instead of " << doubleResult << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+  std::cout << "Folding of float linear transforms test passed." << std::endl;
+
   /* Test printing */
   compositeTransform->Print(std::cout);
 
@@ -0,0 +1,159 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkAffineTransform.h"
+#include "itkBSplineTransform.h"
+#include "itkCompositeTransform.h"
+#include "itkScaleTransform.h"
+#include "itkTimeProbe.h"
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+const unsigned int Dimension = 3;
+
+typedef itk::Transform< double, Dimension, Dimension > TransformType;
+typedef TransformType::InputPointType                  PointType;
+typedef std::vector< PointType >                       PointContainerType;
+
+// Transform the points one at a time and in a batch, in and out of place,
+// compare the results and report the number of points per second of both.
+bool TestTransformPoints(const std::string & description, const TransformType *transform,
+                         const PointContainerType & points)
+{
+  const itk::SizeValueType numberOfPoints = points.size();
+  PointContainerType       expected(numberOfPoints);
+  PointContainerType       batched(numberOfPoints);
+  PointContainerType       inPlace(points);
+
+  itk::TimeProbe pointProbe;
+  pointProbe.Start();
+  for ( itk::SizeValueType i = 0; i < numberOfPoints; ++i )
+    {
+    expected[i] = transform->TransformPoint(points[i]);
+    }
+  pointProbe.Stop();
+
+  itk::TimeProbe batchProbe;
+  batchProbe.Start();
+  transform->TransformPoints(&points[0], &batched[0], numberOfPoints);
+  batchProbe.Stop();
+
+  transform->TransformPoints(&inPlace[0], &inPlace[0], numberOfPoints);
+
+  for ( itk::SizeValueType i = 0; i < numberOfPoints; ++i )
+    {
+    if ( expected[i].EuclideanDistanceTo(batched[i]) > 1e-9
+         || expected[i].EuclideanDistanceTo(inPlace[i]) > 1e-9 )
+      {
+      std::cerr << description << ": point " << points[i] << " is mapped to " << batched[i]
+                << " (" << inPlace[i] << " in place) instead of " << expected[i] << std::endl;
+      return false;
+      }
+    }
+
+  std::cout << description << ": "
+            << numberOfPoints / std::max( pointProbe.GetTotal(), 1e-9 ) << " points/s with TransformPoint, "
+            << numberOfPoints / std::max( batchProbe.GetTotal(), 1e-9 ) << " points/s with TransformPoints"
+            << std::endl;
+  return true;
+}
+}
+
+//
+// Check that TransformPoints() gives the same points as TransformPoint()
+// for the transforms that override it, and time both.
+//
+int itkTransformPointsTest(int, char* [])
+{
+  // Points of a 40x40x40 grid, some of them out of the B-spline domain.
+  PointContainerType points;
+  for ( unsigned int k = 0; k < 40; ++k )
+    {
+    for ( unsigned int j = 0; j < 40; ++j )
+      {
+      for ( unsigned int i = 0; i < 40; ++i )
+        {
+        PointType point;
+        point[0] = i * 2.7 - 4.0;
+        point[1] = j * 2.5;
+        point[2] = k * 2.3 + 1.0;
+        points.push_back(point);
+        }
+      }
+    }
+
+  typedef itk::AffineTransform< double, Dimension > AffineTransformType;
+  AffineTransformType::Pointer affine = AffineTransformType::New();
+  AffineTransformType::ParametersType affineParameters( affine->GetNumberOfParameters() );
+  for ( unsigned int p = 0; p < affineParameters.size(); ++p )
+    {
+    affineParameters[p] = ( p % 4 == 0 ? 1.0 : 0.0 ) + 0.03 * ( p % 5 ) - 0.05;
+    }
+  affine->SetParameters(affineParameters);
+
+  typedef itk::BSplineTransform< double, Dimension, 3 > BSplineTransformType;
+  BSplineTransformType::Pointer                bspline = BSplineTransformType::New();
+  BSplineTransformType::OriginType             origin;
+  BSplineTransformType::PhysicalDimensionsType dimensions;
+  BSplineTransformType::MeshSizeType           meshSize;
+  origin.Fill(0.0);
+  dimensions.Fill(90.0);
+  meshSize.Fill(6);
+  bspline->SetTransformDomainOrigin(origin);
+  bspline->SetTransformDomainPhysicalDimensions(dimensions);
+  bspline->SetTransformDomainMeshSize(meshSize);
+
+  BSplineTransformType::ParametersType bsplineParameters( bspline->GetNumberOfParameters() );
+  for ( unsigned int p = 0; p < bsplineParameters.size(); ++p )
+    {
+    bsplineParameters[p] = ( p * 37 ) % 11 * 0.2 - 1.0;
+    }
+  bspline->SetParameters(bsplineParameters);
+
+  // The center of a ScaleTransform is not part of the offset of its
+  // superclass.
+  typedef itk::ScaleTransform< double, Dimension > ScaleTransformType;
+  ScaleTransformType::Pointer   scale = ScaleTransformType::New();
+  ScaleTransformType::ScaleType scaleFactors;
+  PointType                     center;
+  for ( unsigned int d = 0; d < Dimension; ++d )
+    {
+    scaleFactors[d] = 0.8 + 0.25 * d;
+    center[d] = 10.0 + 7.0 * d;
+    }
+  scale->SetScale(scaleFactors);
+  scale->SetCenter(center);
+
+  typedef itk::CompositeTransform< double, Dimension > CompositeTransformType;
+  CompositeTransformType::Pointer composite = CompositeTransformType::New();
+  composite->AddTransform(affine);
+  composite->AddTransform(bspline);
+
+  if ( !TestTransformPoints("AffineTransform", affine, points)
+       || !TestTransformPoints("BSplineTransform", bspline, points)
+       || !TestTransformPoints("centered ScaleTransform", scale, points)
+       || !TestTransformPoints("CompositeTransform", composite, points) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -54,6 +54,11 @@ namespace itk
  *  dimensionality of the image.
  *
  *  \par
+ *  Since the time step does not depend on the changes, UseFusedUpdate is on
+ *  by default: the changes are applied in the pass that computes them,
+ *  without an update buffer the size of the image.
+ *
+ *  \par
  *  Set/GetConductanceParameter set a common parameter used by subclasses of
  *  itkAnisotropicDiffusionFunction.   See itkAnisotropicDiffusionFunction for
  *  detailed information.
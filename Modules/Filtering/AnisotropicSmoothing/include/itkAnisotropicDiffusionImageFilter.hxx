@@ -36,6 +36,10 @@ AnisotropicDiffusionImageFilter< TInputImage, TOutputImage >
   m_TimeStep = 0.5 / vcl_pow( 2.0, static_cast< double >( ImageDimension ) );
   m_FixedAverageGradientMagnitude = 1.0;
   m_GradientMagnitudeIsFixed = false;
+
+  // The time step is fixed, so the changes can be applied as they are
+  // computed, without an update buffer.
+  this->UseFusedUpdateOn();
 }
 
 /** Prepare for the iteration process. */
@@ -0,0 +1,158 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkCurvatureAnisotropicDiffusionImageFilter.h"
+#include "itkGradientAnisotropicDiffusionImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMinMaxCurvatureFlowImageFilter.h"
+#include "itkTimeProbe.h"
+#include "itkVectorGradientAnisotropicDiffusionImageFilter.h"
+
+namespace
+{
+typedef itk::Image< float, 3 >                      ImageType;
+typedef itk::Image< itk::Vector< float, 2 >, 3 >    VectorImageType;
+
+template< class TFilter >
+typename TFilter::OutputImageType::Pointer
+Run(TFilter *filter, bool fused, unsigned int numberOfThreads, double & seconds)
+{
+  filter->SetUseFusedUpdate(fused);
+  filter->SetNumberOfThreads(numberOfThreads);
+  filter->Modified();
+
+  itk::TimeProbe probe;
+  probe.Start();
+  filter->Update();
+  probe.Stop();
+  seconds = probe.GetTotal();
+
+  typename TFilter::OutputImageType::Pointer output = filter->GetOutput();
+  output->DisconnectPipeline();
+  return output;
+}
+
+// Run the filter with the update buffer and with the fused update, with
+// several numbers of threads, and compare the outputs pixel by pixel.
+template< class TFilter >
+bool TestFusedUpdate(const std::string & description, TFilter *filter)
+{
+  typedef typename TFilter::OutputImageType OutputImageType;
+
+  double                               bufferedSeconds;
+  typename OutputImageType::Pointer    expected = Run(filter, false, 4, bufferedSeconds);
+
+  const unsigned int numberOfThreads[] = { 1, 3, 4, 16 };
+  for ( unsigned int t = 0; t < sizeof( numberOfThreads ) / sizeof( numberOfThreads[0] ); t++ )
+    {
+    double                            fusedSeconds;
+    typename OutputImageType::Pointer output = Run(filter, true, numberOfThreads[t], fusedSeconds);
+
+    itk::ImageRegionConstIteratorWithIndex< OutputImageType > it( output, output->GetBufferedRegion() );
+    itk::ImageRegionConstIteratorWithIndex< OutputImageType > eit( expected, output->GetBufferedRegion() );
+    for ( ; !it.IsAtEnd(); ++it, ++eit )
+      {
+      if ( it.Get() != eit.Get() )
+        {
+        std::cerr << description << ", " << numberOfThreads[t] << " threads: value " << it.Get()
+                  << " at " << it.GetIndex() << " instead of " << eit.Get() << std::endl;
+        return false;
+        }
+      }
+    if ( numberOfThreads[t] == 4 )
+      {
+      std::cout << description << ": " << bufferedSeconds << " s with the update buffer, "
+                << fusedSeconds << " s fused" << std::endl;
+      }
+    }
+  return true;
+}
+}
+
+//
+// Check that the fused update of DenseFiniteDifferenceImageFilter gives the
+// same output as the update buffer, for stencils of radius 1 and 2, whatever
+// the number of threads, and time both.
+//
+int itkDenseFiniteDifferenceFusedUpdateTest(int, char* [])
+{
+  ImageType::Pointer       image = ImageType::New();
+  VectorImageType::Pointer vectorImage = VectorImageType::New();
+  ImageType::RegionType    region;
+  ImageType::SizeType      size;
+  size[0] = 37;
+  size[1] = 29;
+  size[2] = 31;
+  region.SetSize(size);
+  image->SetRegions(region);
+  image->Allocate();
+  vectorImage->SetRegions(region);
+  vectorImage->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, region );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType & index = it.GetIndex();
+    const float value = static_cast< float >( ( index[0] * 11 + index[1] * index[2] * 5 ) % 37 );
+    it.Set(value);
+    VectorImageType::PixelType vector;
+    vector[0] = value;
+    vector[1] = static_cast< float >( index[0] + index[2] );
+    vectorImage->SetPixel(index, vector);
+    }
+
+  typedef itk::GradientAnisotropicDiffusionImageFilter< ImageType, ImageType > GradientFilterType;
+  GradientFilterType::Pointer gradient = GradientFilterType::New();
+  gradient->SetInput(image);
+  gradient->SetNumberOfIterations(3);
+  gradient->SetTimeStep(0.05);
+  gradient->SetConductanceParameter(3.0);
+
+  typedef itk::CurvatureAnisotropicDiffusionImageFilter< ImageType, ImageType > CurvatureFilterType;
+  CurvatureFilterType::Pointer curvature = CurvatureFilterType::New();
+  curvature->SetInput(image);
+  curvature->SetNumberOfIterations(3);
+  curvature->SetTimeStep(0.05);
+  curvature->SetConductanceParameter(3.0);
+
+  typedef itk::MinMaxCurvatureFlowImageFilter< ImageType, ImageType > MinMaxFilterType;
+  MinMaxFilterType::Pointer minMax = MinMaxFilterType::New();
+  minMax->SetInput(image);
+  minMax->SetNumberOfIterations(3);
+  minMax->SetTimeStep(0.05);
+  minMax->SetStencilRadius(2);
+
+  typedef itk::VectorGradientAnisotropicDiffusionImageFilter< VectorImageType, VectorImageType >
+  VectorFilterType;
+  VectorFilterType::Pointer vectorGradient = VectorFilterType::New();
+  vectorGradient->SetInput(vectorImage);
+  vectorGradient->SetNumberOfIterations(3);
+  vectorGradient->SetTimeStep(0.05);
+  vectorGradient->SetConductanceParameter(3.0);
+
+  if ( !TestFusedUpdate("GradientAnisotropicDiffusionImageFilter", gradient.GetPointer())
+       || !TestFusedUpdate("CurvatureAnisotropicDiffusionImageFilter", curvature.GetPointer())
+       || !TestFusedUpdate("MinMaxCurvatureFlowImageFilter", minMax.GetPointer())
+       || !TestFusedUpdate("VectorGradientAnisotropicDiffusionImageFilter", vectorGradient.GetPointer()) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
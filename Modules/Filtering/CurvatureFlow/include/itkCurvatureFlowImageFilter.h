@@ -59,6 +59,10 @@ namespace itk
   * zero flux Neumann boundary condition when computing derivatives near the
   * data boundary.
   *
+  * Since the time step is fixed, UseFusedUpdate is on by default: the
+  * changes are applied in the pass that computes them, without an update
+  * buffer the size of the image.
+  *
   * This filter may be streamed. To support streaming this filter produces a
   * padded output which takes into account edge effects. The size of the
   * padding is m_NumberOfIterations on each edge. Users of this filter should
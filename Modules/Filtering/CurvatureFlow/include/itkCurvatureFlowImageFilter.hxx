@@ -38,6 +38,10 @@ CurvatureFlowImageFilter< TInputImage, TOutputImage >
 
   this->SetDifferenceFunction( static_cast< FiniteDifferenceFunctionType * >(
                                  cffp.GetPointer() ) );
+
+  // The time step is fixed, so the changes can be applied as they are
+  // computed, without an update buffer.
+  this->UseFusedUpdateOn();
 }
 
 /**
@@ -210,6 +210,13 @@ public:
   virtual OutputPointType TransformPoint( const InputPointType& thisPoint )
   const;
 
+  /** Transform a batch of points. The field and the interpolator are
+   * checked once, and each point is mapped to a continuous index of the
+   * field only once. */
+  virtual void TransformPoints( const InputPointType *inputPoints,
+                                OutputPointType *outputPoints,
+                                SizeValueType numberOfPoints ) const;
+
   /**  Method to transform a vector. */
   virtual OutputVectorType TransformVector(const InputVectorType &) const
   {
@@ -115,6 +115,46 @@ DisplacementFieldTransform<TScalar, NDimensions>
   return outputPoint;
 }
 
+/**
+ * Transform a batch of points
+ */
+template <class TScalar, unsigned int NDimensions>
+void
+DisplacementFieldTransform<TScalar, NDimensions>
+::TransformPoints( const InputPointType *inputPoints,
+                   OutputPointType *outputPoints,
+                   SizeValueType numberOfPoints ) const
+{
+  if( !this->m_DisplacementField )
+    {
+    itkExceptionMacro( "No displacement field is specified." );
+    }
+  if( !this->m_Interpolator )
+    {
+    itkExceptionMacro( "No interpolator is specified." );
+    }
+
+  typename InterpolatorType::ContinuousIndexType cidx;
+  typename InterpolatorType::PointType point;
+
+  for( SizeValueType i = 0; i < numberOfPoints; i++ )
+    {
+    point.CastFrom( inputPoints[i] );
+    this->m_DisplacementField->
+    TransformPhysicalPointToContinuousIndex( point, cidx );
+
+    OutputPointType outputPoint;
+    outputPoint.CastFrom( inputPoints[i] );
+    if( this->m_Interpolator->IsInsideBuffer( cidx ) )
+      {
+      typename InterpolatorType::OutputType displacement =
+        this->m_Interpolator->EvaluateAtContinuousIndex( cidx );
+      outputPoint += displacement;
+      }
+    outputPoints[i] = outputPoint;
+    }
+}
+
 /**
  * Transform covariant vector
  */
@@ -43,6 +43,15 @@ namespace itk
  * G. Farneback & C.-F. Westin, "On Implementation of Recursive Gaussian
  * Filters", so far unpublished.
  *
+ * The lines along the filtering direction are processed in blocks of
+ * NumberOfLinesPerBlock neighbouring lines. The lines of a block are
+ * gathered into an interleaved buffer, where the recursion runs on all of
+ * them in the innermost loop, and scattered back to the output. Along the
+ * non-contiguous directions of the image this reads and writes neighbouring
+ * pixels together instead of one pixel per cache line. Setting
+ * NumberOfLinesPerBlock to 1 processes one line at a time. The result does
+ * not depend on it.
+ *
  * \ingroup ImageFilters
  * \ingroup ITKImageFilterBase
  */
@@ -87,6 +96,12 @@ public:
   /** Set the direction in which the filter is to be applied. */
   itkSetMacro(Direction, unsigned int);
 
+  /** Set/Get the number of lines that are filtered together. The default
+   * is 8. */
+  itkSetClampMacro( NumberOfLinesPerBlock, unsigned int, 1,
+                    NumericTraits< unsigned int >::max() );
+  itkGetConstMacro(NumberOfLinesPerBlock, unsigned int);
+
   /** Set Input Image. */
   void SetInputImage(const TInputImage *);
 
@@ -130,6 +145,14 @@ protected:
   void FilterDataArray(RealType *outs, const RealType *data, RealType *scratch,
                        unsigned int ln);
 
+  /** Apply the Recursive Filter to a block of "count" lines of length
+   * "ln". The lines are interleaved: sample i of line k is at
+   * i * stride + k in "outs", "data" and "scratch", which hold
+   * ln * stride values. Each line gets the same result as from
+   * FilterDataArray(). */
+  void FilterDataBlock(RealType *outs, const RealType *data, RealType *scratch,
+                       unsigned int ln, unsigned int stride, unsigned int count);
+
 protected:
   /** Causal coefficients that multiply the input data. */
   ScalarRealType m_N0;
@@ -169,6 +192,9 @@ private:
   /** Direction in which the filter is to be applied
    * this should be in the range [0,ImageDimension-1]. */
   unsigned int m_Direction;
+
+  /** Number of lines that are filtered together. */
+  unsigned int m_NumberOfLinesPerBlock;
 };
 } // end namespace itk
 
@@ -23,6 +23,7 @@
 #include "itkImageLinearIteratorWithIndex.h"
 #include "itkProgressReporter.h"
 #include <new>
+#include <vector>
 
 namespace itk
 {
@@ -31,6 +32,7 @@ RecursiveSeparableImageFilter< TInputImage, TOutputImage >
 ::RecursiveSeparableImageFilter()
 {
   m_Direction = 0;
+  m_NumberOfLinesPerBlock = 8;
   this->SetNumberOfRequiredOutputs(1);
   this->SetNumberOfRequiredInputs(1);
 
@@ -152,6 +154,124 @@ RecursiveSeparableImageFilter< TInputImage, TOutputImage >
     }
 }
 
+/**
+ * Apply Recursive Filter to a block of interleaved lines
+ */
+template< typename TInputImage, typename TOutputImage >
+void
+RecursiveSeparableImageFilter< TInputImage, TOutputImage >
+::FilterDataBlock(RealType *outs, const RealType *data, RealType *scratch,
+                  unsigned int ln, unsigned int stride, unsigned int count)
+{
+  // Local copies of the coefficients, which the compiler can keep in
+  // registers across the stores to the buffers.
+  const ScalarRealType n0 = m_N0;
+  const ScalarRealType n1 = m_N1;
+  const ScalarRealType n2 = m_N2;
+  const ScalarRealType n3 = m_N3;
+  const ScalarRealType d1 = m_D1;
+  const ScalarRealType d2 = m_D2;
+  const ScalarRealType d3 = m_D3;
+  const ScalarRealType d4 = m_D4;
+  const ScalarRealType m1 = m_M1;
+  const ScalarRealType m2 = m_M2;
+  const ScalarRealType m3 = m_M3;
+  const ScalarRealType m4 = m_M4;
+
+  /**
+   * Causal direction pass, stored directly in the output. The expressions
+   * are those of FilterDataArray(), so that each line gets the same values.
+   */
+  for ( unsigned int k = 0; k < count; k++ )
+    {
+    const RealType *x = data + k;
+    RealType       *y = outs + k;
+
+    // this value is assumed to exist from the border to infinity.
+    const RealType outV1 = x[0];
+
+    y[0]          = RealType(outV1 * n0 + outV1 * n1 + outV1 * n2 + outV1 * n3);
+    y[stride]     = RealType(x[stride] * n0 + outV1 * n1 + outV1 * n2 + outV1 * n3);
+    y[2 * stride] = RealType(x[2 * stride] * n0 + x[stride] * n1 + outV1 * n2 + outV1 * n3);
+    y[3 * stride] = RealType(x[3 * stride] * n0 + x[2 * stride] * n1 + x[stride] * n2 + outV1 * n3);
+
+    // note that the outV1 value is multiplied by the Boundary coefficients m_BNi
+    y[0]          -= RealType(outV1 * m_BN1 + outV1 * m_BN2 + outV1 * m_BN3 + outV1 * m_BN4);
+    y[stride]     -= RealType(y[0] * d1 + outV1 * m_BN2 + outV1 * m_BN3 + outV1 * m_BN4);
+    y[2 * stride] -= RealType(y[stride] * d1 + y[0] * d2 + outV1 * m_BN3 + outV1 * m_BN4);
+    y[3 * stride] -= RealType(y[2 * stride] * d1 + y[stride] * d2 + y[0] * d3 + outV1 * m_BN4);
+    }
+
+  for ( unsigned int i = 4; i < ln; i++ )
+    {
+    const RealType *x0 = data + i * stride;
+    const RealType *x1 = x0 - stride;
+    const RealType *x2 = x1 - stride;
+    const RealType *x3 = x2 - stride;
+    RealType       *y0 = outs + i * stride;
+    const RealType *y1 = y0 - stride;
+    const RealType *y2 = y1 - stride;
+    const RealType *y3 = y2 - stride;
+    const RealType *y4 = y3 - stride;
+    for ( unsigned int k = 0; k < count; k++ )
+      {
+      y0[k]  = RealType(x0[k] * n0 + x1[k] * n1 + x2[k] * n2 + x3[k] * n3);
+      y0[k] -= RealType(y1[k] * d1 + y2[k] * d2 + y3[k] * d3 + y4[k] * d4);
+      }
+    }
+
+  /**
+   * AntiCausal direction pass, added to the output as it goes.
+   */
+  const unsigned int last = ( ln - 1 ) * stride;
+  for ( unsigned int k = 0; k < count; k++ )
+    {
+    const RealType *x = data + last + k;
+    RealType       *s = scratch + last + k;
+    RealType       *y = outs + last + k;
+
+    // this value is assumed to exist from the border to infinity.
+    const RealType outV2 = x[0];
+
+    *s = RealType(outV2 * m1 + outV2 * m2 + outV2 * m3 + outV2 * m4);
+    *( s - stride ) = RealType(x[0] * m1 + outV2 * m2 + outV2 * m3 + outV2 * m4);
+    *( s - 2 * stride ) = RealType(*( x - stride ) * m1 + x[0] * m2 + outV2 * m3 + outV2 * m4);
+    *( s - 3 * stride ) = RealType(*( x - 2 * stride ) * m1 + *( x - stride ) * m2 + x[0] * m3 + outV2 * m4);
+
+    // note that the outV2 value is multiplied by the Boundary coefficients m_BMi
+    *s -= RealType(outV2 * m_BM1 + outV2 * m_BM2 + outV2 * m_BM3 + outV2 * m_BM4);
+    *( s - stride ) -= RealType(*s * d1 + outV2 * m_BM2 + outV2 * m_BM3 + outV2 * m_BM4);
+    *( s - 2 * stride ) -= RealType(*( s - stride ) * d1 + *s * d2 + outV2 * m_BM3 + outV2 * m_BM4);
+    *( s - 3 * stride ) -= RealType(
+      *( s - 2 * stride ) * d1 + *( s - stride ) * d2 + *s * d3 + outV2 * m_BM4);
+
+    *y += *s;
+    *( y - stride ) += *( s - stride );
+    *( y - 2 * stride ) += *( s - 2 * stride );
+    *( y - 3 * stride ) += *( s - 3 * stride );
+    }
+
+  for ( unsigned int i = ln - 4; i > 0; i-- )
+    {
+    const RealType *x1 = data + i * stride;
+    const RealType *x2 = x1 + stride;
+    const RealType *x3 = x2 + stride;
+    const RealType *x4 = x3 + stride;
+    RealType       *s0 = scratch + ( i - 1 ) * stride;
+    const RealType *s1 = s0 + stride;
+    const RealType *s2 = s1 + stride;
+    const RealType *s3 = s2 + stride;
+    const RealType *s4 = s3 + stride;
+    RealType       *y0 = outs + ( i - 1 ) * stride;
+    for ( unsigned int k = 0; k < count; k++ )
+      {
+      s0[k]  = RealType(x1[k] * m1 + x2[k] * m2 + x3[k] * m3 + x4[k] * m4);
+      s0[k] -= RealType(s1[k] * d1 + s2[k] * d2 + s3[k] * d3 + s4[k] * d4);
+      y0[k] += s0[k];
+      }
+    }
+}
+
 //
 // we need all of the image in just the "Direction" we are separated into
 //
@@ -278,7 +398,7 @@ RecursiveSeparableImageFilter< TInputImage, TOutputImage >
 
 /**
  * Compute Recursive filter
- * line by line in one of the dimensions
+ * block of lines by block of lines in one of the dimensions
  */
 template< typename TInputImage, typename TOutputImage >
 void
@@ -297,51 +417,40 @@ RecursiveSeparableImageFilter< TInputImage, TOutputImage >
 
   RegionType region = outputRegionForThread;
 
-  InputConstIteratorType inputIterator(inputImage,  region);
-  OutputIteratorType     outputIterator(outputImage, region);
-
-  inputIterator.SetDirection(this->m_Direction);
-  outputIterator.SetDirection(this->m_Direction);
+  // One iterator walks over the beginnings of the lines, and one per line
+  // of a block walks along it. The lines that follow each other are
+  // neighbours in the lowest of the other dimensions.
+  InputConstIteratorType lineIterator(inputImage,  region);
+  lineIterator.SetDirection(this->m_Direction);
 
   const unsigned int ln = region.GetSize()[this->m_Direction];
+  const unsigned int linesPerBlock = this->m_NumberOfLinesPerBlock;
 
-  RealType *inps = 0;
-  RealType *outs = 0;
-  RealType *scratch = 0;
-
+  std::vector< InputConstIteratorType > inputIterators;
+  std::vector< OutputIteratorType >     outputIterators;
+  std::vector< RealType >               inps;
+  std::vector< RealType >               outs;
+  std::vector< RealType >               scratch;
   try
     {
-    inps = new RealType[ln];
-    }
-  catch ( std::bad_alloc & )
-    {
-    itkExceptionMacro("Problem allocating memory for internal computations");
-    }
-
-  try
-    {
-    outs = new RealType[ln];
-    }
-  catch ( std::bad_alloc & )
-    {
-    delete[] inps;
-    itkExceptionMacro("Problem allocating memory for internal computations");
-    }
-
-  try
-    {
-    scratch = new RealType[ln];
+    inputIterators.reserve(linesPerBlock);
+    outputIterators.reserve(linesPerBlock);
+    for ( unsigned int k = 0; k < linesPerBlock; k++ )
+      {
+      inputIterators.push_back( InputConstIteratorType(inputImage, region) );
+      inputIterators.back().SetDirection(this->m_Direction);
+      outputIterators.push_back( OutputIteratorType(outputImage, region) );
+      outputIterators.back().SetDirection(this->m_Direction);
+      }
+    inps.resize(ln * linesPerBlock);
+    outs.resize(ln * linesPerBlock);
+    scratch.resize(ln * linesPerBlock);
     }
   catch ( std::bad_alloc & )
     {
-    delete[] inps;
-    delete[] outs;
     itkExceptionMacro("Problem allocating memory for internal computations");
     }
 
-  inputIterator.GoToBegin();
-  outputIterator.GoToBegin();
-
   const typename TInputImage::OffsetValueType * offsetTable = inputImage->GetOffsetTable();
 
   const unsigned int numberOfLinesToProcess = offsetTable[TInputImage::ImageDimension] / ln;
@@ -349,30 +458,48 @@ RecursiveSeparableImageFilter< TInputImage, TOutputImage >
 
   try  // this try is intended to catch an eventual AbortException.
     {
-    while ( !inputIterator.IsAtEnd() && !outputIterator.IsAtEnd() )
+    lineIterator.GoToBegin();
+    while ( !lineIterator.IsAtEnd() )
       {
-      unsigned int i = 0;
-      while ( !inputIterator.IsAtEndOfLine() )
+      // Gather the lines of the block, interleaved.
+      unsigned int count = 0;
+      while ( count < linesPerBlock && !lineIterator.IsAtEnd() )
         {
-        inps[i++]      = inputIterator.Get();
-        ++inputIterator;
+        inputIterators[count].SetIndex( lineIterator.GetIndex() );
+        outputIterators[count].SetIndex( lineIterator.GetIndex() );
+        lineIterator.NextLine();
+        ++count;
         }
 
-      this->FilterDataArray(outs, inps, scratch, ln);
-
-      unsigned int j = 0;
-      while ( !outputIterator.IsAtEndOfLine() )
+      for ( unsigned int i = 0; i < ln; i++ )
         {
-        outputIterator.Set( static_cast< OutputPixelType >( outs[j++] ) );
-        ++outputIterator;
+        RealType *x = &inps[i * linesPerBlock];
+        for ( unsigned int k = 0; k < count; k++ )
+          {
+          x[k] = inputIterators[k].Get();
+          ++inputIterators[k];
+          }
         }
 
-      inputIterator.NextLine();
-      outputIterator.NextLine();
+      this->FilterDataBlock(&outs[0], &inps[0], &scratch[0], ln, linesPerBlock, count);
+
+      // Scatter them back to the output.
+      for ( unsigned int i = 0; i < ln; i++ )
+        {
+        const RealType *y = &outs[i * linesPerBlock];
+        for ( unsigned int k = 0; k < count; k++ )
+          {
+          outputIterators[k].Set( static_cast< OutputPixelType >( y[k] ) );
+          ++outputIterators[k];
+          }
+        }
 
       // Although the method name is CompletedPixel(),
       // this is being called after each line is processed
-      progress.CompletedPixel();
+      for ( unsigned int k = 0; k < count; k++ )
+        {
+        progress.CompletedPixel();
+        }
       }
     }
   catch ( ProcessAborted  & )
@@ -381,20 +508,11 @@ RecursiveSeparableImageFilter< TInputImage, TOutputImage >
     // progress reporter and rethrow it with the correct line number and file
     // name. We also invoke AbortEvent in case some observer was interested on
     // it.
-    // release locally allocated memory
-    delete[] outs;
-    delete[] inps;
-    delete[] scratch;
-    // Throw the final exception.
     ProcessAborted e(__FILE__, __LINE__);
     e.SetDescription("Process aborted.");
     e.SetLocation(ITK_LOCATION);
     throw e;
     }
-
-  delete[] outs;
-  delete[] inps;
-  delete[] scratch;
 }
 
 template< typename TInputImage, typename TOutputImage >
@@ -405,6 +523,7 @@ RecursiveSeparableImageFilter< TInputImage, TOutputImage >
   Superclass::PrintSelf(os, indent);
 
   os << indent << "Direction: " << m_Direction << std::endl;
+  os << indent << "NumberOfLinesPerBlock: " << m_NumberOfLinesPerBlock << std::endl;
 }
 } // end namespace itk
 
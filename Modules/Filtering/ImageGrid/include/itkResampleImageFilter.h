@@ -24,6 +24,7 @@
 #include "itkImageToImageFilter.h"
 #include "itkExtrapolateImageFunction.h"
 #include "itkLinearInterpolateImageFunction.h"
+#include "itkNearestNeighborInterpolateImageFunction.h"
 #include "itkBSplineInterpolateImageFunction.h"
 #include "itkSize.h"
 
@@ -68,6 +69,13 @@ namespace itk
  *
  * This filter is implemented as a multithreaded filter.  It provides a
  * ThreadedGenerateData() method for its implementation.
+ *
+ * With a linear transform, an Image input and output, and a
+ * LinearInterpolateImageFunction or NearestNeighborInterpolateImageFunction,
+ * the part of each output line that maps inside the input buffer, away
+ * from its border, is interpolated by the filter itself, with the same
+ * arithmetic as the interpolator but without virtual calls or bounds
+ * checks. The other pixels go through the interpolator as usual.
  * \warning For multithreading, the TransformPoint method of the
  * user-designated coordinate transform must be threadsafe.
  *
@@ -132,6 +140,9 @@ public:
   typedef typename LinearInterpolatorType::Pointer
   LinearInterpolatorPointerType;
 
+  typedef NearestNeighborInterpolateImageFunction< InputImageType,
+                                                   TInterpolatorPrecisionType >   NearestNeighborInterpolatorType;
+
   typedef BSplineInterpolateImageFunction< InputImageType,
                                            TInterpolatorPrecisionType >   BSplineInterpolatorType;
   typedef typename BSplineInterpolatorType::Pointer
@@ -265,6 +276,13 @@ public:
    * the output requested region.  As such, ResampleImageFilter needs
    * to provide an implementation for GenerateInputRequestedRegion()
    * in order to inform the pipeline execution model.
+   *
+   * The input requested region is the bounding box of the points that the
+   * output requested region maps to, enlarged by the radius of the
+   * interpolator: the mapped corners of the output region for a linear
+   * transform, a lattice of mapped points with a margin for the others.
+   * The whole input is requested when an extrapolator is set, or when the
+   * input or the output is a SpecialCoordinatesImage.
    * \sa ProcessObject::GenerateInputRequestedRegion() */
   virtual void GenerateInputRequestedRegion();
 
@@ -327,6 +345,43 @@ private:
   ResampleImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);      //purposely not implemented
 
+  /** The interpolators that LinearThreadedGenerateData() evaluates itself
+   * inside the input buffer. */
+  typedef enum {
+    GenericInterpolatorKernel,
+    LinearInterpolatorKernel,
+    NearestNeighborInterpolatorKernel
+    } InterpolatorKernelType;
+
+  typedef typename InterpolatorType::OutputType      InterpolatorOutputType;
+  typedef typename ContinuousInputIndexType::VectorType ContinuousInputIndexVectorType;
+
+  /** The pixels [begin, end) of an output line, starting at the continuous
+   * index start of the input and moving by delta, that the kernel can
+   * interpolate without leaving the input buffer. */
+  void ComputeInteriorSegment(const ContinuousInputIndexType & start,
+                              const ContinuousInputIndexVectorType & delta,
+                              SizeValueType lineLength,
+                              SizeValueType & begin,
+                              SizeValueType & end) const;
+
+  /** Interpolate count pixels of an output line inside the input buffer,
+   * from the continuous index inputIndex moving by delta, into output.
+   * inputIndex is left at the index of the next pixel. Dispatches once per
+   * segment to the loop of the kernel. */
+  void EvaluateInteriorSegment(ContinuousInputIndexType & inputIndex,
+                               const ContinuousInputIndexVectorType & delta,
+                               SizeValueType count,
+                               PixelType *output) const;
+
+  /** The loop of EvaluateInteriorSegment() for one kernel, chosen at
+   * compile time so that there is no branch per pixel. */
+  template< InterpolatorKernelType VKernel >
+  void EvaluateInteriorSegmentWithKernel(ContinuousInputIndexType & inputIndex,
+                                         const ContinuousInputIndexVectorType & delta,
+                                         SizeValueType count,
+                                         PixelType *output) const;
+
   SizeType                m_Size;      // Size of the output image
   TransformPointerType    m_Transform;         // Transform
   InterpolatorPointerType m_Interpolator;      // Image function for
@@ -344,6 +399,8 @@ private:
 
   bool                           m_InterpolatorIsBSpline;
   BSplineInterpolatorPointerType m_BSplineInterpolator;
+
+  InterpolatorKernelType m_InterpolatorKernel;
 };
 } // end namespace itk
 
@@ -25,6 +25,8 @@
 #include "itkImageRegionIteratorWithIndex.h"
 #include "itkImageLinearIteratorWithIndex.h"
 #include "itkSpecialCoordinatesImage.h"
+#include <algorithm>
+#include <cstring>
 
 namespace itk
 {
@@ -51,6 +53,7 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
 
   m_InterpolatorIsBSpline = false;
   m_BSplineInterpolator = NULL;
+  m_InterpolatorKernel = GenericInterpolatorKernel;
 
   m_Interpolator = dynamic_cast< InterpolatorType * >
                    ( LinearInterpolatorType::New().GetPointer() );
@@ -180,6 +183,26 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
     {
     m_InterpolatorIsBSpline = false;
     }
+
+  // Test for the interpolators that LinearThreadedGenerateData() can
+  // evaluate itself. Subclasses may interpolate differently: the class
+  // name must match too.
+  typedef Image< InputPixelType, InputImageDimension > InputBufferImageType;
+  m_InterpolatorKernel = GenericInterpolatorKernel;
+  if ( static_cast< unsigned int >( InputImageDimension ) == static_cast< unsigned int >( ImageDimension )
+       && dynamic_cast< const InputBufferImageType * >( this->GetInput() ) )
+    {
+    if ( dynamic_cast< LinearInterpolatorType * >( m_Interpolator.GetPointer() )
+         && !strcmp(m_Interpolator->GetNameOfClass(), "LinearInterpolateImageFunction") )
+      {
+      m_InterpolatorKernel = LinearInterpolatorKernel;
+      }
+    else if ( dynamic_cast< NearestNeighborInterpolatorType * >( m_Interpolator.GetPointer() )
+              && !strcmp(m_Interpolator->GetNameOfClass(), "NearestNeighborInterpolateImageFunction") )
+      {
+      m_InterpolatorKernel = NearestNeighborInterpolatorKernel;
+      }
+    }
 }
 
 /**
@@ -260,14 +283,17 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
   // Get ths input pointers
   InputImageConstPointer inputPtr = this->GetInput();
 
-  // Create an iterator that will walk the output region for this thread.
-  typedef ImageRegionIteratorWithIndex< TOutputImage > OutputIterator;
+  // Create an iterator that will walk the output region for this thread,
+  // one line at a time: the points of a line are transformed together.
+  typedef ImageLinearIteratorWithIndex< TOutputImage > OutputIterator;
   OutputIterator outIt(outputPtr, outputRegionForThread);
+  outIt.SetDirection(0);
 
   // Define a few indices that will be used to translate from an input pixel
   // to an output pixel
-  PointType outputPoint;         // Coordinates of current output pixel
-  PointType inputPoint;          // Coordinates of current input pixel
+  const SizeValueType      lineLength = outputRegionForThread.GetSize(0);
+  std::vector< PointType > outputPoints(lineLength); // Coordinates of the output pixels of a line
+  std::vector< PointType > inputPoints(lineLength);  // Coordinates of the matching input pixels
 
   ContinuousInputIndexType inputIndex;
 
@@ -290,51 +316,34 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
 
   while ( !outIt.IsAtEnd() )
     {
-    // Determine the index of the current output pixel
-    outputPtr->TransformIndexToPhysicalPoint(outIt.GetIndex(), outputPoint);
-
-    // Compute corresponding input pixel position
-    inputPoint = this->m_Transform->TransformPoint(outputPoint);
-    inputPtr->TransformPhysicalPointToContinuousIndex(inputPoint, inputIndex);
-
-    PixelType        pixval;
-    OutputType       value;
-    // Evaluate input at right position and copy to the output
-    if ( m_Interpolator->IsInsideBuffer(inputIndex) )
+    // Determine the positions of the output pixels of the line
+    IndexType index = outIt.GetIndex();
+    for ( SizeValueType i = 0; i < lineLength; ++i, ++index[0] )
       {
-      if ( m_InterpolatorIsBSpline )
-        {
-        value = m_BSplineInterpolator
-                 ->EvaluateAtContinuousIndex(inputIndex, threadId);
-        }
-      else
-        {
-        value = m_Interpolator ->EvaluateAtContinuousIndex(inputIndex);
-        }
-      // Check boundaries and assign
-      if ( value < minOutputValue )
-        {
-        pixval = minValue;
-        }
-      else if ( value > maxOutputValue )
-        {
-        pixval = maxValue;
-        }
-      else
-        {
-        pixval = static_cast< PixelType >( value );
-        }
-      outIt.Set(pixval);
+      outputPtr->TransformIndexToPhysicalPoint(index, outputPoints[i]);
       }
-    else
+
+    // Compute the corresponding input pixel positions
+    this->m_Transform->TransformPoints(&outputPoints[0], &inputPoints[0], lineLength);
+
+    for ( SizeValueType i = 0; !outIt.IsAtEndOfLine(); ++i )
       {
-      if( m_Extrapolator.IsNull() )
-        {
-        outIt.Set( m_DefaultPixelValue ); // default background value
-        }
-      else
+      inputPtr->TransformPhysicalPointToContinuousIndex(inputPoints[i], inputIndex);
+
+      PixelType        pixval;
+      OutputType       value;
+      // Evaluate input at right position and copy to the output
+      if ( m_Interpolator->IsInsideBuffer(inputIndex) )
         {
-        value = m_Extrapolator->EvaluateAtContinuousIndex( inputIndex );
+        if ( m_InterpolatorIsBSpline )
+          {
+          value = m_BSplineInterpolator
+                   ->EvaluateAtContinuousIndex(inputIndex, threadId);
+          }
+        else
+          {
+          value = m_Interpolator ->EvaluateAtContinuousIndex(inputIndex);
+          }
         // Check boundaries and assign
         if ( value < minOutputValue )
           {
@@ -350,10 +359,36 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
           }
         outIt.Set(pixval);
         }
-      }
+      else
+        {
+        if( m_Extrapolator.IsNull() )
+          {
+          outIt.Set( m_DefaultPixelValue ); // default background value
+          }
+        else
+          {
+          value = m_Extrapolator->EvaluateAtContinuousIndex( inputIndex );
+          // Check boundaries and assign
+          if ( value < minOutputValue )
+            {
+            pixval = minValue;
+            }
+          else if ( value > maxOutputValue )
+            {
+            pixval = maxValue;
+            }
+          else
+            {
+            pixval = static_cast< PixelType >( value );
+            }
+          outIt.Set(pixval);
+          }
+        }
 
-    progress.CompletedPixel();
-    ++outIt;
+      progress.CompletedPixel();
+      ++outIt;
+      }
+    outIt.NextLine();
     }
 
   return;
@@ -447,6 +482,16 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
                                                     tmpInputIndex);
   delta = tmpInputIndex - inputIndex;
 
+  // The part of each line inside the input buffer is interpolated by the
+  // kernel of the interpolator, when there is one, straight into the
+  // output buffer.
+  typedef Image< PixelType, ImageDimension > OutputBufferImageType;
+  OutputBufferImageType *outputBufferImage =
+    dynamic_cast< OutputBufferImageType * >( outputPtr.GetPointer() );
+  const bool           useKernel = m_InterpolatorKernel != GenericInterpolatorKernel
+                                   && outputBufferImage != NULL;
+  const SizeValueType  lineLength = outputRegionForThread.GetSize(0);
+
   while ( !outIt.IsAtEnd() )
     {
     // Determine the continuous index of the first pixel of output
@@ -462,8 +507,39 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
     inputPoint = this->m_Transform->TransformPoint(outputPoint);
     inputPtr->TransformPhysicalPointToContinuousIndex(inputPoint, inputIndex);
 
-    while ( !outIt.IsAtEndOfLine() )
+    SizeValueType interiorBegin = lineLength;
+    SizeValueType interiorEnd = lineLength;
+    if ( useKernel )
       {
+      this->ComputeInteriorSegment(inputIndex, delta, lineLength, interiorBegin, interiorEnd);
+      }
+
+    for ( SizeValueType i = 0; !outIt.IsAtEndOfLine(); ++i )
+      {
+      if ( i == interiorBegin )
+        {
+        const SizeValueType count = interiorEnd - interiorBegin;
+        this->EvaluateInteriorSegment( inputIndex, delta, count,
+                                       outputBufferImage->GetBufferPointer()
+                                       + outputBufferImage->ComputeOffset( outIt.GetIndex() ) );
+        for ( SizeValueType j = 0; j < count; ++j )
+          {
+          progress.CompletedPixel();
+          }
+        i = interiorEnd - 1;
+        if ( interiorEnd == lineLength )
+          {
+          outIt.GoToEndOfLine();
+          }
+        else
+          {
+          IndexType nextIndex = outIt.GetIndex();
+          nextIndex[0] += static_cast< IndexValueType >( count );
+          outIt.SetIndex(nextIndex);
+          }
+        continue;
+        }
+
       PixelType  pixval;
       OutputType value;
       // Evaluate input at right position and copy to the output
@@ -530,12 +606,228 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
   return;
 }
 
+/**
+ * Part of an output line that the interpolator kernel can evaluate
+ */
+template< class TInputImage,
+          class TOutputImage,
+          class TInterpolatorPrecisionType >
+void
+ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
+::ComputeInteriorSegment(const ContinuousInputIndexType & start,
+                         const ContinuousInputIndexVectorType & delta,
+                         SizeValueType lineLength,
+                         SizeValueType & begin,
+                         SizeValueType & end) const
+{
+  // The continuous indices where the kernel reads only pixels of the
+  // buffer: [first, last + 1) for linear interpolation, which reads the
+  // pixels at floor(index) and floor(index) + 1, and
+  // [first - 0.5, last + 0.5) for the nearest neighbor. They are narrowed
+  // by a tolerance that covers the round-off errors of adding delta along
+  // the line, so that both ends are left to the interpolator.
+  const double                 tolerance = 1e-3;
+  const InputImageRegionType & bufferedRegion = this->GetInput()->GetBufferedRegion();
+
+  double first = 0.0;
+  double last = static_cast< double >( lineLength ) - 1.0;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    double lower = static_cast< double >( bufferedRegion.GetIndex(d) );
+    double upper = lower + static_cast< double >( bufferedRegion.GetSize(d) ) - 1.0;
+    if ( m_InterpolatorKernel == LinearInterpolatorKernel )
+      {
+      upper -= 1.0;
+      }
+    else
+      {
+      lower -= 0.5;
+      upper += 0.5;
+      }
+    lower += tolerance;
+    upper -= tolerance;
+
+    const double index = static_cast< double >( start[d] );
+    const double step = static_cast< double >( delta[d] );
+    if ( vnl_math_abs(step) < 1e-12 )
+      {
+      // Test for negative of a positive so we can catch NaN's.
+      if ( !( index >= lower && index <= upper ) )
+        {
+        last = -1.0;
+        }
+      continue;
+      }
+    double a = ( lower - index ) / step;
+    double b = ( upper - index ) / step;
+    if ( step < 0.0 )
+      {
+      std::swap(a, b);
+      }
+    if ( !( a <= b ) )
+      {
+      last = -1.0;
+      continue;
+      }
+    first = vnl_math_max( first, vcl_ceil(a) );
+    last = vnl_math_min( last, vcl_floor(b) );
+    }
+
+  if ( first > last )
+    {
+    begin = lineLength;
+    end = lineLength;
+    return;
+    }
+  begin = static_cast< SizeValueType >( first );
+  end = static_cast< SizeValueType >( last ) + 1;
+}
+
+/**
+ * Interpolate a part of an output line inside the input buffer
+ */
+template< class TInputImage,
+          class TOutputImage,
+          class TInterpolatorPrecisionType >
+void
+ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
+::EvaluateInteriorSegment(ContinuousInputIndexType & inputIndex,
+                          const ContinuousInputIndexVectorType & delta,
+                          SizeValueType count,
+                          PixelType *output) const
+{
+  if ( m_InterpolatorKernel == LinearInterpolatorKernel )
+    {
+    this->EvaluateInteriorSegmentWithKernel< LinearInterpolatorKernel >(inputIndex, delta, count, output);
+    }
+  else
+    {
+    this->EvaluateInteriorSegmentWithKernel< NearestNeighborInterpolatorKernel >(inputIndex, delta, count, output);
+    }
+}
+
+/**
+ * Interpolate a part of an output line inside the input buffer with the
+ * given kernel
+ */
+template< class TInputImage,
+          class TOutputImage,
+          class TInterpolatorPrecisionType >
+template< typename ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
+          ::InterpolatorKernelType VKernel >
+void
+ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
+::EvaluateInteriorSegmentWithKernel(ContinuousInputIndexType & inputIndex,
+                                    const ContinuousInputIndexVectorType & delta,
+                                    SizeValueType count,
+                                    PixelType *output) const
+{
+  typedef Image< InputPixelType, InputImageDimension > InputBufferImageType;
+  const InputBufferImageType *inputImage =
+    dynamic_cast< const InputBufferImageType * >( this->GetInput() );
+  const InputPixelType *        inputBuffer = inputImage->GetBufferPointer();
+  const OffsetValueType *       offsetTable = inputImage->GetOffsetTable();
+  const typename InputBufferImageType::IndexType & bufferStart =
+    inputImage->GetBufferedRegion().GetIndex();
+
+  const PixelType minValue =  NumericTraits< PixelType >::NonpositiveMin();
+  const PixelType maxValue =  NumericTraits< PixelType >::max();
+  const InterpolatorOutputType minOutputValue = static_cast< InterpolatorOutputType >( minValue );
+  const InterpolatorOutputType maxOutputValue = static_cast< InterpolatorOutputType >( maxValue );
+
+  // The dimensions along which linear interpolation weights the upper
+  // neighbor: LinearInterpolateImageFunction skips the others, where the
+  // index is a whole number. It stays one along the line when delta is a
+  // whole number too.
+  unsigned int activeDimensions[ImageDimension];
+  unsigned int numberOfActiveDimensions = 0;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    if ( inputIndex[d] != vcl_floor(inputIndex[d]) || delta[d] != vcl_floor(delta[d]) )
+      {
+      activeDimensions[numberOfActiveDimensions++] = d;
+      }
+    }
+
+  // Offsets of the corners of the cell of a linear interpolation, bit j of
+  // the corner number selecting the upper neighbor along the j-th active
+  // dimension.
+  const unsigned int numberOfCorners = 1 << numberOfActiveDimensions;
+  OffsetValueType    cornerOffsets[1 << ImageDimension];
+  for ( unsigned int k = 0; k < numberOfCorners; k++ )
+    {
+    cornerOffsets[k] = 0;
+    for ( unsigned int j = 0; j < numberOfActiveDimensions; j++ )
+      {
+      if ( k & ( 1 << j ) )
+        {
+        cornerOffsets[k] += offsetTable[activeDimensions[j]];
+        }
+      }
+    }
+
+  for ( SizeValueType i = 0; i < count; ++i, inputIndex += delta )
+    {
+    InterpolatorOutputType value;
+    OffsetValueType        offset = 0;
+    if ( VKernel == LinearInterpolatorKernel )
+      {
+      // Interpolate along the lowest dimension first, as
+      // LinearInterpolateImageFunction does, for the same results.
+      double distance[ImageDimension];
+      for ( unsigned int d = 0; d < ImageDimension; d++ )
+        {
+        const IndexValueType base = Math::Floor< IndexValueType >(inputIndex[d]);
+        distance[d] = inputIndex[d] - static_cast< double >( base );
+        offset += ( base - bufferStart[d] ) * offsetTable[d];
+        }
+      InterpolatorOutputType values[1 << ImageDimension];
+      for ( unsigned int k = 0; k < numberOfCorners; k++ )
+        {
+        values[k] = inputBuffer[offset + cornerOffsets[k]];
+        }
+      for ( unsigned int j = 0; j < numberOfActiveDimensions; j++ )
+        {
+        const unsigned int step = 1 << j;
+        const double       weight = distance[activeDimensions[j]];
+        for ( unsigned int k = 0; k < numberOfCorners; k += 2 * step )
+          {
+          values[k] = values[k] + ( values[k + step] - values[k] ) * weight;
+          }
+        }
+      value = values[0];
+      }
+    else
+      {
+      for ( unsigned int d = 0; d < ImageDimension; d++ )
+        {
+        offset += ( Math::Round< IndexValueType >(inputIndex[d]) - bufferStart[d] ) * offsetTable[d];
+        }
+      value = static_cast< InterpolatorOutputType >( inputBuffer[offset] );
+      }
+
+    if ( value < minOutputValue )
+      {
+      output[i] = minValue;
+      }
+    else if ( value > maxOutputValue )
+      {
+      output[i] = maxValue;
+      }
+    else
+      {
+      output[i] = static_cast< PixelType >( value );
+      }
+    }
+}
+
 /**
  * Inform pipeline of necessary input image region
  *
- * Determining the actual input region is non-trivial, especially
- * when we cannot assume anything about the transform being used.
- * So we do the easy thing and request the entire input image.
+ * The output requested region is mapped to the input through the
+ * transform: exactly for linear transforms, by sampling for the others.
+ * The entire input image is requested when that mapping cannot be
+ * bounded.
  */
 template< class TInputImage,
           class TOutputImage,
@@ -555,11 +847,147 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
   // get pointers to the input and output
   InputImagePointer inputPtr  =
     const_cast< TInputImage * >( this->GetInput() );
+  OutputImagePointer outputPtr = this->GetOutput();
 
-  // Request the entire input image
+  // Request the entire input image, unless the part of it that the output
+  // requested region maps to can be bounded
   inputPtr->SetRequestedRegionToLargestPossibleRegion();
 
-  return;
+  // The extrapolator reads the border of the buffered region, which must
+  // then be the border of the image.
+  if ( !m_Transform || !m_Interpolator || m_Extrapolator
+       || outputPtr->GetRequestedRegion().GetNumberOfPixels() == 0 )
+    {
+    return;
+    }
+
+  // The index to physical point mapping of special coordinates images is
+  // not the one of Image.
+  typedef SpecialCoordinatesImage< PixelType, ImageDimension >
+  OutputSpecialCoordinatesImageType;
+  typedef SpecialCoordinatesImage< InputPixelType, InputImageDimension >
+  InputSpecialCoordinatesImageType;
+  if ( dynamic_cast< const InputSpecialCoordinatesImageType * >( this->GetInput() )
+       || dynamic_cast< const OutputSpecialCoordinatesImageType * >( this->GetOutput() ) )
+    {
+    return;
+    }
+
+  // Map output pixels to input continuous indices: the corners of the
+  // output requested region for a linear transform, which maps the region
+  // inside their convex hull; a lattice of pixels of the region for any
+  // other transform.
+  const OutputImageRegionType & outputRegion = outputPtr->GetRequestedRegion();
+  const bool                    isLinear = m_Transform->IsLinear();
+  const unsigned int            maximumNumberOfSamples = 8;
+
+  unsigned int numberOfSamples[ImageDimension];
+  SizeValueType totalNumberOfSamples = 1;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    numberOfSamples[d] = isLinear ? 2 : maximumNumberOfSamples;
+    if ( outputRegion.GetSize(d) < numberOfSamples[d] )
+      {
+      numberOfSamples[d] = outputRegion.GetSize(d);
+      }
+    totalNumberOfSamples *= numberOfSamples[d];
+    }
+
+  std::vector< PointType > outputPoints(totalNumberOfSamples);
+  std::vector< PointType > inputPoints(totalNumberOfSamples);
+  for ( SizeValueType n = 0; n < totalNumberOfSamples; n++ )
+    {
+    IndexType     index = outputRegion.GetIndex();
+    SizeValueType rest = n;
+    for ( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      const SizeValueType sample = rest % numberOfSamples[d];
+      rest /= numberOfSamples[d];
+      if ( numberOfSamples[d] > 1 )
+        {
+        index[d] += static_cast< IndexValueType >(
+          sample * ( outputRegion.GetSize(d) - 1 ) / ( numberOfSamples[d] - 1 ) );
+        }
+      }
+    outputPtr->TransformIndexToPhysicalPoint(index, outputPoints[n]);
+    }
+  m_Transform->TransformPoints(&outputPoints[0], &inputPoints[0], totalNumberOfSamples);
+
+  std::vector< ContinuousInputIndexType > inputIndices(totalNumberOfSamples);
+  for ( SizeValueType n = 0; n < totalNumberOfSamples; n++ )
+    {
+    inputPtr->TransformPhysicalPointToContinuousIndex(inputPoints[n], inputIndices[n]);
+    }
+
+  // The bounding box of the mapped samples. For a nonlinear transform, the
+  // pixels between the samples may map outside of it: it is enlarged by the
+  // largest distance between the mappings of neighboring samples.
+  double lower[InputImageDimension];
+  double upper[InputImageDimension];
+  double margin[InputImageDimension];
+  for ( unsigned int i = 0; i < InputImageDimension; i++ )
+    {
+    lower[i] = NumericTraits< double >::max();
+    upper[i] = NumericTraits< double >::NonpositiveMin();
+    margin[i] = 0.0;
+    }
+  for ( SizeValueType n = 0; n < totalNumberOfSamples; n++ )
+    {
+    for ( unsigned int i = 0; i < InputImageDimension; i++ )
+      {
+      // Test for negative of a positive so we can catch NaN's.
+      if ( !( vnl_math_abs(inputIndices[n][i]) < NumericTraits< double >::max() ) )
+        {
+        return;
+        }
+      lower[i] = vnl_math_min( lower[i], static_cast< double >( inputIndices[n][i] ) );
+      upper[i] = vnl_math_max( upper[i], static_cast< double >( inputIndices[n][i] ) );
+      }
+    if ( isLinear )
+      {
+      continue;
+      }
+    SizeValueType stride = 1;
+    for ( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      if ( ( n / stride ) % numberOfSamples[d] + 1 < numberOfSamples[d] )
+        {
+        for ( unsigned int i = 0; i < InputImageDimension; i++ )
+          {
+          margin[i] = vnl_math_max( margin[i], static_cast< double >(
+                                      vnl_math_abs(inputIndices[n + stride][i] - inputIndices[n][i]) ) );
+          }
+        }
+      stride *= numberOfSamples[d];
+      }
+    }
+
+  // Add the neighborhood read by the interpolator, and one pixel to absorb
+  // round-off errors, and crop to the input image.
+  const typename InterpolatorType::SizeType radius = m_Interpolator->GetRadius();
+  const InputImageRegionType & largestRegion = inputPtr->GetLargestPossibleRegion();
+  InputImageRegionType         inputRegion;
+  for ( unsigned int i = 0; i < InputImageDimension; i++ )
+    {
+    const double largestLower = static_cast< double >( largestRegion.GetIndex(i) );
+    const double largestUpper = largestLower + static_cast< double >( largestRegion.GetSize(i) ) - 1.0;
+    const double padding = margin[i] + static_cast< double >( radius[i] ) + 1.0;
+
+    double first = vcl_floor(lower[i] - padding + 0.5);
+    double last = vcl_ceil(upper[i] + padding - 0.5);
+    if ( first > largestUpper || last < largestLower )
+      {
+      // No output pixel maps inside the input image: request a single pixel
+      first = largestLower;
+      last = largestLower;
+      }
+    first = vnl_math_max(first, largestLower);
+    last = vnl_math_min(last, largestUpper);
+    inputRegion.SetIndex( i, static_cast< IndexValueType >( first ) );
+    inputRegion.SetSize( i, static_cast< SizeValueType >( last - first + 1.0 ) );
+    }
+
+  inputPtr->SetRequestedRegion(inputRegion);
 }
 
 /**
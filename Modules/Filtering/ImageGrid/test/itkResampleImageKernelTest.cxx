@@ -0,0 +1,172 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkAffineTransform.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkResampleImageFilter.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+// Interpolators that ResampleImageFilter does not recognize, and calls for
+// every pixel.
+template< class TImage >
+class VirtualLinearInterpolator:
+  public itk::LinearInterpolateImageFunction< TImage, double >
+{
+public:
+  typedef VirtualLinearInterpolator                            Self;
+  typedef itk::LinearInterpolateImageFunction< TImage, double > Superclass;
+  typedef itk::SmartPointer< Self >                            Pointer;
+  itkTypeMacro(VirtualLinearInterpolator, LinearInterpolateImageFunction);
+  itkNewMacro(Self);
+};
+
+template< class TImage >
+class VirtualNearestNeighborInterpolator:
+  public itk::NearestNeighborInterpolateImageFunction< TImage, double >
+{
+public:
+  typedef VirtualNearestNeighborInterpolator                            Self;
+  typedef itk::NearestNeighborInterpolateImageFunction< TImage, double > Superclass;
+  typedef itk::SmartPointer< Self >                                     Pointer;
+  itkTypeMacro(VirtualNearestNeighborInterpolator, NearestNeighborInterpolateImageFunction);
+  itkNewMacro(Self);
+};
+
+template< class TImage >
+typename TImage::Pointer Resample(const TImage *image,
+                                  const itk::Transform< double, TImage::ImageDimension,
+                                                        TImage::ImageDimension > *transform,
+                                  itk::InterpolateImageFunction< TImage, double > *interpolator,
+                                  double & seconds)
+{
+  typedef itk::ResampleImageFilter< TImage, TImage > ResampleFilterType;
+  typename ResampleFilterType::Pointer resample = ResampleFilterType::New();
+  resample->SetInput(image);
+  resample->SetTransform(transform);
+  resample->SetInterpolator(interpolator);
+  resample->SetOutputParametersFromImage(image);
+  resample->SetDefaultPixelValue(7);
+
+  itk::TimeProbe probe;
+  probe.Start();
+  resample->Update();
+  probe.Stop();
+  seconds = probe.GetTotal();
+
+  typename TImage::Pointer output = resample->GetOutput();
+  output->DisconnectPipeline();
+  return output;
+}
+
+// Resample through the interpolators and through the kernels of the filter,
+// which must give the same pixels.
+template< class TPixel, unsigned int VDimension >
+bool TestKernels(unsigned int size)
+{
+  typedef itk::Image< TPixel, VDimension > ImageType;
+  typename ImageType::Pointer    image = ImageType::New();
+  typename ImageType::RegionType region;
+  typename ImageType::SizeType   imageSize;
+  imageSize.Fill(size);
+  region.SetSize(imageSize);
+  image->SetRegions(region);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, region );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    long value = 0;
+    for ( unsigned int d = 0; d < VDimension; d++ )
+      {
+      value = value * 31 + it.GetIndex()[d] * ( d + 3 );
+      }
+    it.Set( static_cast< TPixel >( value % 97 ) );
+    }
+
+  // Rotated, scaled and translated so that the output covers the border of
+  // the input, and translated by a whole number of pixels, where the
+  // interpolation weights are 0.
+  typedef itk::AffineTransform< double, VDimension > AffineTransformType;
+  typename AffineTransformType::Pointer affine = AffineTransformType::New();
+  affine->Rotate(0, 1, 0.3);
+  affine->Scale(1.1);
+  typename AffineTransformType::OutputVectorType translation;
+  translation.Fill(-2.5);
+  affine->Translate(translation);
+
+  typename AffineTransformType::Pointer shift = AffineTransformType::New();
+  translation.Fill(3.0);
+  shift->Translate(translation);
+
+  const typename AffineTransformType::Pointer transforms[] = { affine, shift };
+  for ( unsigned int t = 0; t < 2; t++ )
+    {
+    double kernelTime;
+    double interpolatorTime;
+    typename ImageType::Pointer kernelLinear = Resample< ImageType >(
+      image, transforms[t], itk::LinearInterpolateImageFunction< ImageType, double >::New(), kernelTime);
+    typename ImageType::Pointer virtualLinear = Resample< ImageType >(
+      image, transforms[t], VirtualLinearInterpolator< ImageType >::New(), interpolatorTime);
+    std::cout << VDimension << "-D linear: " << interpolatorTime << " s with the interpolator, "
+              << kernelTime << " s with the kernel" << std::endl;
+
+    typename ImageType::Pointer kernelNearest = Resample< ImageType >(
+      image, transforms[t], itk::NearestNeighborInterpolateImageFunction< ImageType, double >::New(), kernelTime);
+    typename ImageType::Pointer virtualNearest = Resample< ImageType >(
+      image, transforms[t], VirtualNearestNeighborInterpolator< ImageType >::New(), interpolatorTime);
+    std::cout << VDimension << "-D nearest neighbor: " << interpolatorTime << " s with the interpolator, "
+              << kernelTime << " s with the kernel" << std::endl;
+
+    itk::ImageRegionConstIteratorWithIndex< ImageType > lit( kernelLinear, region );
+    itk::ImageRegionConstIteratorWithIndex< ImageType > vlit( virtualLinear, region );
+    itk::ImageRegionConstIteratorWithIndex< ImageType > nit( kernelNearest, region );
+    itk::ImageRegionConstIteratorWithIndex< ImageType > vnit( virtualNearest, region );
+    for ( ; !lit.IsAtEnd(); ++lit, ++vlit, ++nit, ++vnit )
+      {
+      if ( lit.Get() != vlit.Get() || nit.Get() != vnit.Get() )
+        {
+        std::cerr << VDimension << "-D, transform " << t << ": at " << lit.GetIndex()
+                  << ", the kernels give " << lit.Get() << " and " << nit.Get()
+                  << " instead of " << vlit.Get() << " and " << vnit.Get() << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+}
+
+//
+// Check that the linear and nearest neighbor kernels of ResampleImageFilter
+// give the same pixels as the interpolators, and time both.
+//
+int itkResampleImageKernelTest(int, char* [])
+{
+  if ( !TestKernels< float, 2 >(300)
+       || !TestKernels< unsigned char, 2 >(300)
+       || !TestKernels< float, 3 >(60)
+       || !TestKernels< short, 3 >(60) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
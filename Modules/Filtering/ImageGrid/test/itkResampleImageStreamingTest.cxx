@@ -0,0 +1,185 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkAffineTransform.h"
+#include "itkBSplineTransform.h"
+#include "itkCastImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkNearestNeighborInterpolateImageFunction.h"
+#include "itkResampleImageFilter.h"
+#include "itkStreamingImageFilter.h"
+
+namespace
+{
+const unsigned int Dimension = 3;
+
+typedef float                                                       PixelType;
+typedef itk::Image< PixelType, Dimension >                          ImageType;
+typedef itk::ResampleImageFilter< ImageType, ImageType >            ResampleFilterType;
+typedef ResampleFilterType::TransformType                           TransformType;
+typedef ResampleFilterType::InterpolatorType                        InterpolatorType;
+typedef itk::CastImageFilter< ImageType, ImageType >                CastFilterType;
+typedef itk::StreamingImageFilter< ImageType, ImageType >           StreamerType;
+typedef itk::LinearInterpolateImageFunction< ImageType, double >    LinearInterpolatorType;
+typedef itk::NearestNeighborInterpolateImageFunction< ImageType, double >
+                                                                    NearestInterpolatorType;
+
+// Resample the output of a filter, which produces only the region that is
+// requested from it, by streaming, and compare with the interpolation of
+// the whole image, pixel by pixel.
+bool TestResample(const std::string & description, const ImageType *image,
+                  const TransformType *transform, InterpolatorType *interpolator)
+{
+  CastFilterType::Pointer caster = CastFilterType::New();
+  caster->SetInput(image);
+
+  ResampleFilterType::Pointer resample = ResampleFilterType::New();
+  resample->SetInput( caster->GetOutput() );
+  resample->SetTransform(transform);
+  resample->SetInterpolator(interpolator);
+  resample->SetOutputParametersFromImage(image);
+  resample->SetDefaultPixelValue(-1);
+
+  // A small output region needs a small part of the input.
+  ImageType::RegionType roi = image->GetLargestPossibleRegion();
+  roi.SetIndex(0, 20);
+  roi.SetSize(0, 5);
+  roi.SetIndex(2, 10);
+  roi.SetSize(2, 3);
+  resample->GetOutput()->UpdateOutputInformation();
+  resample->GetOutput()->SetRequestedRegion(roi);
+  resample->GetOutput()->PropagateRequestedRegion();
+  const ImageType::RegionType inputRegion = caster->GetOutput()->GetRequestedRegion();
+  if ( inputRegion.GetNumberOfPixels() * 4 > image->GetLargestPossibleRegion().GetNumberOfPixels() )
+    {
+    std::cerr << description << ": the input region " << inputRegion
+              << " requested for the output region " << roi << " is too large" << std::endl;
+    return false;
+    }
+
+  StreamerType::Pointer streamer = StreamerType::New();
+  streamer->SetInput( resample->GetOutput() );
+  streamer->SetNumberOfStreamDivisions(7);
+  streamer->Update();
+
+  InterpolatorType::Pointer reference = static_cast< InterpolatorType * >(
+    interpolator->CreateAnother().GetPointer() );
+  reference->SetInputImage(image);
+
+  itk::ImageRegionConstIteratorWithIndex< ImageType > it( streamer->GetOutput(),
+                                                          streamer->GetOutput()->GetLargestPossibleRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    ImageType::PointType point;
+    image->TransformIndexToPhysicalPoint(it.GetIndex(), point);
+    point = transform->TransformPoint(point);
+
+    double expected = -1;
+    if ( reference->IsInsideBuffer(point) )
+      {
+      expected = reference->Evaluate(point);
+      }
+    if ( vnl_math_abs(expected - it.Get()) > 1e-3 )
+      {
+      std::cerr << description << ": value " << it.Get() << " at " << it.GetIndex()
+                << " instead of " << expected << std::endl;
+      return false;
+      }
+    }
+
+  std::cout << description << ": OK, input region " << inputRegion.GetSize()
+            << " for output region " << roi.GetSize() << std::endl;
+  return true;
+}
+}
+
+//
+// Stream ResampleImageFilter with linear and nonlinear transforms, and check
+// that each chunk of the output requests only the part of the input that it
+// maps to, and that the result does not depend on it.
+//
+int itkResampleImageStreamingTest(int, char* [])
+{
+  ImageType::Pointer    image = ImageType::New();
+  ImageType::RegionType region;
+  ImageType::SizeType   size;
+  size[0] = 64;
+  size[1] = 40;
+  size[2] = 48;
+  region.SetSize(size);
+  image->SetRegions(region);
+  image->Allocate();
+
+  ImageType::SpacingType spacing;
+  spacing[0] = 1.0;
+  spacing[1] = 1.5;
+  spacing[2] = 0.75;
+  image->SetSpacing(spacing);
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, region );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType & index = it.GetIndex();
+    it.Set( static_cast< PixelType >( ( index[0] * 7 + index[1] * index[2] ) % 101 ) );
+    }
+
+  typedef itk::AffineTransform< double, Dimension > AffineTransformType;
+  AffineTransformType::Pointer         affine = AffineTransformType::New();
+  AffineTransformType::OutputVectorType axis;
+  axis[0] = 0.2;
+  axis[1] = 0.3;
+  axis[2] = 1.0;
+  affine->Rotate3D(axis, 0.2);
+  AffineTransformType::OutputVectorType translation;
+  translation[0] = 3.0;
+  translation[1] = -2.0;
+  translation[2] = 1.5;
+  affine->Translate(translation);
+
+  typedef itk::BSplineTransform< double, Dimension, 3 > BSplineTransformType;
+  BSplineTransformType::Pointer                bspline = BSplineTransformType::New();
+  BSplineTransformType::PhysicalDimensionsType dimensions;
+  BSplineTransformType::MeshSizeType           meshSize;
+  for ( unsigned int d = 0; d < Dimension; d++ )
+    {
+    dimensions[d] = spacing[d] * ( size[d] - 1 );
+    }
+  meshSize.Fill(4);
+  bspline->SetTransformDomainPhysicalDimensions(dimensions);
+  bspline->SetTransformDomainMeshSize(meshSize);
+  BSplineTransformType::ParametersType parameters( bspline->GetNumberOfParameters() );
+  for ( unsigned int p = 0; p < parameters.size(); ++p )
+    {
+    parameters[p] = ( p * 13 ) % 7 * 0.5 - 1.5;
+    }
+  bspline->SetParameters(parameters);
+
+  LinearInterpolatorType::Pointer  linear = LinearInterpolatorType::New();
+  NearestInterpolatorType::Pointer nearest = NearestInterpolatorType::New();
+
+  if ( !TestResample("Affine, linear", image, affine, linear)
+       || !TestResample("Affine, nearest neighbor", image, affine, nearest)
+       || !TestResample("BSpline, linear", image, bspline, linear)
+       || !TestResample("BSpline, nearest neighbor", image, bspline, nearest) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -19,6 +19,7 @@
 #define __itkLabelImageToLabelMapFilter_h
 
 #include "itkImageToImageFilter.h"
+#include <vector>
 #include "itkLabelMap.h"
 #include "itkLabelObject.h"
 
@@ -123,6 +124,34 @@ private:
   OutputImagePixelType m_BackgroundValue;
 
   typename std::vector< OutputImagePointer > m_TemporaryImages;
+
+  /** A label object of a temporary image whose lines must be added to the
+   * object with the same label in the output. */
+  struct LabelObjectMergeType {
+    LabelObjectType *Target;
+    LabelObjectType *Source;
+  };
+  typedef std::vector< LabelObjectMergeType > LabelObjectMergeVectorType;
+
+  /** Orders the merges by label, keeping the order of the temporary
+   * images for a given label. */
+  struct LabelObjectMergeLabelLess {
+    bool operator()(const LabelObjectMergeType & a, const LabelObjectMergeType & b) const
+    {
+      return a.Target->GetLabel() < b.Target->GetLabel();
+    }
+  };
+
+  struct MergeThreadStruct {
+    LabelImageToLabelMapFilter *Filter;
+    const LabelObjectMergeVectorType *Merges;
+  };
+
+  /** Add the lines of the temporary images in the output, for a part of
+   * the labels. */
+  static ITK_THREAD_RETURN_TYPE MergeThreaderCallback(void *arg);
+  void ThreadedMerge(const LabelObjectMergeVectorType & merges,
+                     ThreadIdType threadId, ThreadIdType threadCount);
 }; // end of class
 } // end namespace itk
 
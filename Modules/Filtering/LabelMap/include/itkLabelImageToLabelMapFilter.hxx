@@ -22,6 +22,7 @@
 #include "itkNumericTraits.h"
 #include "itkProgressReporter.h"
 #include "itkImageLinearConstIteratorWithIndex.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -134,7 +135,11 @@ LabelImageToLabelMapFilter< TInputImage, TOutputImage >
   OutputImageType *output = this->GetOutput();
 
   // merge the lines from the temporary images in the output image
-  // don't use the first image - that's the output image
+  // don't use the first image - that's the output image.
+  // The objects with a new label are simply taken by the output, which
+  // must be done one at a time, and the other ones are merged later by all
+  // the threads.
+  LabelObjectMergeVectorType merges;
   for ( ThreadIdType i = 1; i < this->GetNumberOfThreads(); i++ )
     {
     for ( typename OutputImageType::Iterator it( m_TemporaryImages[i] );
@@ -144,14 +149,10 @@ LabelImageToLabelMapFilter< TInputImage, TOutputImage >
       LabelObjectType *labelObject = it.GetLabelObject();
       if ( output->HasLabel( labelObject->GetLabel() ) )
         {
-        // merge the lines in the output's object
-        LabelObjectType * lo = output->GetLabelObject( labelObject->GetLabel() );
-        typename LabelObjectType::ConstLineIterator lit( labelObject );
-        while( ! lit.IsAtEnd() )
-          {
-          lo->AddLine( lit.GetLine() );
-          ++lit;
-          }
+        LabelObjectMergeType merge;
+        merge.Target = output->GetLabelObject( labelObject->GetLabel() );
+        merge.Source = labelObject;
+        merges.push_back(merge);
         }
       else
         {
@@ -161,10 +162,76 @@ LabelImageToLabelMapFilter< TInputImage, TOutputImage >
       }
     }
 
+  if ( !merges.empty() )
+    {
+    // a label is merged by a single thread, with the lines in the same order
+    // as if the temporary images were merged one after the other
+    std::stable_sort( merges.begin(), merges.end(), LabelObjectMergeLabelLess() );
+
+    MergeThreadStruct str;
+    str.Filter = this;
+    str.Merges = &merges;
+
+    this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
+    this->GetMultiThreader()->SetSingleMethod(this->MergeThreaderCallback, &str);
+    this->GetMultiThreader()->SingleMethodExecute();
+    }
+
   // release the data in the temp images
   m_TemporaryImages.clear();
 }
 
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+LabelImageToLabelMapFilter< TInputImage, TOutputImage >
+::MergeThreaderCallback(void *arg)
+{
+  ThreadIdType threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  ThreadIdType threadCount = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->NumberOfThreads;
+
+  MergeThreadStruct *str = (MergeThreadStruct *)
+    ( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  str->Filter->ThreadedMerge(*str->Merges, threadId, threadCount);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TInputImage, class TOutputImage >
+void
+LabelImageToLabelMapFilter< TInputImage, TOutputImage >
+::ThreadedMerge(const LabelObjectMergeVectorType & merges,
+                ThreadIdType threadId, ThreadIdType threadCount)
+{
+  // split the merges in contiguous ranges, and move the boundaries of the
+  // ranges so that all the merges of a label are in the same range
+  const SizeValueType numberOfMerges = merges.size();
+  SizeValueType begin = numberOfMerges * threadId / threadCount;
+  SizeValueType end = numberOfMerges * ( threadId + 1 ) / threadCount;
+  while ( begin > 0 && begin < numberOfMerges
+          && merges[begin].Target == merges[begin - 1].Target )
+    {
+    ++begin;
+    }
+  while ( end > 0 && end < numberOfMerges
+          && merges[end].Target == merges[end - 1].Target )
+    {
+    ++end;
+    }
+
+  for ( SizeValueType m = begin; m < end; ++m )
+    {
+    // merge the lines in the output's object
+    LabelObjectType *lo = merges[m].Target;
+    typename LabelObjectType::ConstLineIterator lit( merges[m].Source );
+    while( ! lit.IsAtEnd() )
+      {
+      lo->AddLine( lit.GetLine() );
+      ++lit;
+      }
+    }
+}
+
 template< class TInputImage, class TOutputImage >
 void
 LabelImageToLabelMapFilter< TInputImage, TOutputImage >
@@ -31,6 +31,7 @@
 #include "itkImageToImageFilter.h"
 #include "itkProgressReporter.h"
 #include "itkFastMutexLock.h"
+#include <vector>
 
 namespace itk
 {
@@ -43,6 +44,10 @@ namespace itk
  * With that class, the developer doesn't need to take care of iterating over all the objects in
  * the image, or to manage by hand the threads.
  *
+ * The label objects are copied in an array before the threads are started,
+ * and the threads take them by batches, so the lock is only taken once per
+ * batch, and not once per object.
+ *
  * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
  *
  * This implementation was taken from the Insight Journal paper:
@@ -124,7 +129,13 @@ private:
   LabelMapFilter(const Self &); //purposely not implemented
   void operator=(const Self &); //purposely not implemented
 
-  typename InputImageType::Iterator m_LabelObjectIterator;
+  typedef std::vector< LabelObjectType * > LabelObjectVectorType;
+
+  LabelObjectVectorType m_LabelObjects;
+
+  SizeValueType m_NextLabelObject;
+
+  SizeValueType m_LabelObjectBatchSize;
 
   ProgressReporter *m_Progress;
 };
@@ -28,6 +28,7 @@
 #ifndef __itkLabelMapFilter_hxx
 #define __itkLabelMapFilter_hxx
 #include "itkLabelMapFilter.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -36,6 +37,8 @@ LabelMapFilter< TInputImage, TOutputImage >
 ::LabelMapFilter()
 {
   m_Progress = NULL;
+  m_NextLabelObject = 0;
+  m_LabelObjectBatchSize = 1;
 }
 
 template< class TInputImage, class TOutputImage >
@@ -79,9 +82,22 @@ void
 LabelMapFilter< TInputImage, TOutputImage >
 ::BeforeThreadedGenerateData()
 {
-  // initialize the iterator
-  m_LabelObjectIterator =  typename InputImageType::Iterator(this->GetLabelMap());
-//  m_LabelObjectIterator = typename InputImageType::Iterator(this->GetLabelMap());
+  // copy the label objects in an array, so the threads only have to share
+  // an index in that array
+  InputImageType *labelMap = this->GetLabelMap();
+  const SizeValueType numberOfLabelObjects = labelMap->GetNumberOfLabelObjects();
+  m_LabelObjects.clear();
+  m_LabelObjects.reserve(numberOfLabelObjects);
+  for ( typename InputImageType::Iterator it(labelMap); !it.IsAtEnd(); ++it )
+    {
+    m_LabelObjects.push_back( it.GetLabelObject() );
+    }
+  m_NextLabelObject = 0;
+
+  // a few dozen batches per thread, to keep the load balanced when the
+  // objects have very different sizes
+  const SizeValueType numberOfBatches = 32 * this->GetNumberOfThreads();
+  m_LabelObjectBatchSize = std::max( numberOfLabelObjects / numberOfBatches, SizeValueType(1) );
 
   // and the mutex
   m_LabelObjectContainerLock = FastMutexLock::New();
@@ -92,7 +108,7 @@ LabelMapFilter< TInputImage, TOutputImage >
     delete m_Progress;
     }
   // initialize the progress reporter
-  m_Progress = new ProgressReporter( this, 0, this->GetLabelMap()->GetNumberOfLabelObjects() );
+  m_Progress = new ProgressReporter(this, 0, numberOfLabelObjects);
 }
 
 template< class TInputImage, class TOutputImage >
@@ -103,6 +119,9 @@ LabelMapFilter< TInputImage, TOutputImage >
   // destroy progress reporter
   delete m_Progress;
   m_Progress = NULL;
+
+  // and release the array of label objects
+  LabelObjectVectorType().swap(m_LabelObjects);
 }
 
 template< class TInputImage, class TOutputImage >
@@ -110,34 +129,40 @@ void
 LabelMapFilter< TInputImage, TOutputImage >
 ::ThreadedGenerateData( const OutputImageRegionType &, ThreadIdType itkNotUsed(threadId) )
 {
+  const SizeValueType numberOfLabelObjects = m_LabelObjects.size();
+
   while ( true )
     {
     // first lock the mutex
     m_LabelObjectContainerLock->Lock();
 
-    if ( m_LabelObjectIterator.IsAtEnd() )
+    if ( m_NextLabelObject >= numberOfLabelObjects )
       {
       // no more objects. Release the lock and return
       m_LabelObjectContainerLock->Unlock();
       return;
       }
 
-    // get the label object
-    LabelObjectType *labelObject = m_LabelObjectIterator.GetLabelObject();
+    // take the next batch of objects
+    const SizeValueType begin = m_NextLabelObject;
+    const SizeValueType end = std::min(begin + m_LabelObjectBatchSize, numberOfLabelObjects);
+    m_NextLabelObject = end;
 
-    // increment the iterator now, so it will not be invalidated if the object
-    // is destroyed
-    ++m_LabelObjectIterator;
-
-    // pretend one more object is processed, even if it will be done later, to
+    // pretend the objects are processed, even if it will be done later, to
     // simplify the lock management
-    m_Progress->CompletedPixel();
+    for ( SizeValueType i = begin; i < end; ++i )
+      {
+      m_Progress->CompletedPixel();
+      }
 
-    // unlock the mutex, so the other threads can get an object
+    // unlock the mutex, so the other threads can get a batch
     m_LabelObjectContainerLock->Unlock();
 
-    // and run the user defined method for that object
-    this->ThreadedProcessLabelObject(labelObject);
+    // and run the user defined method for the objects of the batch
+    for ( SizeValueType i = begin; i < end; ++i )
+      {
+      this->ThreadedProcessLabelObject(m_LabelObjects[i]);
+      }
     }
 }
 
@@ -22,6 +22,7 @@
 #include "itkNumericTraits.h"
 #include "itkProgressReporter.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -48,12 +49,18 @@ void
 LabelMapToLabelImageFilter< TInputImage, TOutputImage >
 ::ThreadedProcessLabelObject(LabelObjectType *labelObject)
 {
-  const typename LabelObjectType::LabelType & label = labelObject->GetLabel();
-  typename LabelObjectType::ConstIndexIterator it( labelObject );
-  while( !it.IsAtEnd() )
+  OutputImageType *output = this->GetOutput();
+  const OutputImagePixelType label = static_cast< OutputImagePixelType >( labelObject->GetLabel() );
+
+  // the lines are contiguous in the output buffer, so they are filled
+  // without computing the offset of every pixel
+  typename LabelObjectType::ConstLineIterator lit( labelObject );
+  while( !lit.IsAtEnd() )
     {
-    this->GetOutput()->SetPixel( it.GetIndex(), label );
-    ++it;
+    const typename LabelObjectType::LineType & line = lit.GetLine();
+    OutputImagePixelType *begin = output->GetBufferPointer() + output->ComputeOffset( line.GetIndex() );
+    std::fill(begin, begin + line.GetLength(), label);
+    ++lit;
     }
 }
 } // end namespace itk
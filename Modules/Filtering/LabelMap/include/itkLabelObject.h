@@ -18,7 +18,7 @@
 #ifndef __itkLabelObject_h
 #define __itkLabelObject_h
 
-#include <deque>
+#include <vector>
 #include "itkLightObject.h"
 #include "itkLabelObjectLine.h"
 #include "itkWeakPointer.h"
@@ -41,6 +41,9 @@ namespace itk
  *
  * All the subclasses of LabelObject have to reinplement the CopyAttributesFrom() method.
  *
+ * The lines are stored contiguously, so iterating over them reads a
+ * single array.
+ *
  * The pixels locations belonging to the LabelObject can be obtained using:
  * \code
  * for(unsigned int pixelId = 0; pixelId < labelObject->Size(); pixelId++)
@@ -90,6 +93,9 @@ public:
 
   itkStaticConstMacro(LABEL, AttributeType, 0);
 
+  /** The container of the lines, contiguous in memory. */
+  typedef std::vector< LineType > LineContainerType;
+
   static AttributeType GetAttributeFromName(const std::string & s);
 
   static std::string GetNameFromAttribute(const AttributeType & a);
@@ -244,7 +250,6 @@ public:
     }
 
   private:
-    typedef typename std::deque< LineType >            LineContainerType;
     typedef typename LineContainerType::const_iterator InternalIteratorType;
     InternalIteratorType m_Iterator;
     InternalIteratorType m_Begin;
@@ -339,7 +344,6 @@ public:
 
   private:
 
-    typedef typename std::deque< LineType >            LineContainerType;
     typedef typename LineContainerType::const_iterator InternalIteratorType;
     void NextValidLine()
     {
@@ -368,8 +372,6 @@ private:
   LabelObject(const Self &);    //purposely not implemented
   void operator=(const Self &); //purposely not implemented
 
-  typedef typename std::deque< LineType >    LineContainerType;
-
   LineContainerType m_LineContainer;
   LabelType         m_Label;
 };
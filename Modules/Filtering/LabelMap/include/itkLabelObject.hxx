@@ -291,9 +291,11 @@ LabelObject< TLabel, VImageDimension >::Optimize()
 {
   if ( !m_LineContainer.empty() )
     {
-    // first copy the lines in another container and clear the current one
-    LineContainerType lineContainer = m_LineContainer;
-    m_LineContainer.clear();
+    // first move the lines in another container, leaving the current one
+    // empty
+    LineContainerType lineContainer;
+    lineContainer.swap(m_LineContainer);
+    m_LineContainer.reserve( lineContainer.size() );
 
     // reorder the lines
     typename Functor::LabelObjectLineComparator< LineType > comparator;
@@ -105,48 +105,55 @@ StatisticsLabelMapFilter< TImage, TFeatureImage >
 
   typename HistogramType::MeasurementVectorType mv;
   mv.SetSize(1);
-  // iterate over all the indexes
-  typename LabelObjectType::ConstIndexIterator it( labelObject );
-  while( ! it.IsAtEnd() )
+  // iterate over all the lines, and over the pixels of each line in the
+  // feature image buffer
+  typename LabelObjectType::ConstLineIterator lit( labelObject );
+  while( ! lit.IsAtEnd() )
     {
-    const IndexType & idx = it.GetIndex();
-    const FeatureImagePixelType & v = featureImage->GetPixel(idx);
-    mv[0] = v;
-    histogram->IncreaseFrequencyOfMeasurement(mv, 1);
-
-    // update min and max
-    if ( v <= min )
-      {
-      min = v;
-      minIdx = idx;
-      }
-    if ( v >= max )
+    IndexType idx = lit.GetLine().GetIndex();
+    const SizeValueType length = lit.GetLine().GetLength();
+    const FeatureImagePixelType *featureLine =
+      featureImage->GetBufferPointer() + featureImage->ComputeOffset(idx);
+    for ( SizeValueType p = 0; p < length; ++p, ++idx[0] )
       {
-      max = v;
-      maxIdx = idx;
-      }
+      const FeatureImagePixelType & v = featureLine[p];
+      mv[0] = v;
+      histogram->IncreaseFrequencyOfMeasurement(mv, 1);
 
-    //increase the sums
-    sum += v;
-    sum2 += vcl_pow( (double)v, 2 );
-    sum3 += vcl_pow( (double)v, 3 );
-    sum4 += vcl_pow( (double)v, 4 );
+      // update min and max
+      if ( v <= min )
+        {
+        min = v;
+        minIdx = idx;
+        }
+      if ( v >= max )
+        {
+        max = v;
+        maxIdx = idx;
+        }
 
-    // moments
-    PointType physicalPosition;
-    output->TransformIndexToPhysicalPoint(idx, physicalPosition);
-    for ( unsigned int i = 0; i < ImageDimension; i++ )
-      {
-      centerOfGravity[i] += physicalPosition[i] * v;
-      centralMoments[i][i] += v * physicalPosition[i] * physicalPosition[i];
-      for ( unsigned int j = i + 1; j < ImageDimension; j++ )
+      //increase the sums
+      sum += v;
+      sum2 += vcl_pow( (double)v, 2 );
+      sum3 += vcl_pow( (double)v, 3 );
+      sum4 += vcl_pow( (double)v, 4 );
+
+      // moments
+      PointType physicalPosition;
+      output->TransformIndexToPhysicalPoint(idx, physicalPosition);
+      for ( unsigned int i = 0; i < ImageDimension; i++ )
         {
-        double weight = v * physicalPosition[i] * physicalPosition[j];
-        centralMoments[i][j] += weight;
-        centralMoments[j][i] += weight;
+        centerOfGravity[i] += physicalPosition[i] * v;
+        centralMoments[i][i] += v * physicalPosition[i] * physicalPosition[i];
+        for ( unsigned int j = i + 1; j < ImageDimension; j++ )
+          {
+          double weight = v * physicalPosition[i] * physicalPosition[j];
+          centralMoments[i][j] += weight;
+          centralMoments[j][i] += weight;
+          }
         }
       }
-    ++it;
+    ++lit;
     }
 
   // final computations
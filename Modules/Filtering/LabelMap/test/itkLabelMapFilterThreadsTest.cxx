@@ -0,0 +1,141 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkLabelImageToLabelMapFilter.h"
+#include "itkLabelMapToLabelImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTimeProbe.h"
+
+//
+// Convert a label image with many small objects and a few large ones, which
+// are split between the threads, to a label map and back with several
+// numbers of threads, and check that the results do not depend on it.
+//
+int itkLabelMapFilterThreadsTest(int, char* [])
+{
+  const unsigned int Dimension = 3;
+
+  typedef itk::Image< unsigned short, Dimension >            ImageType;
+  typedef itk::LabelObject< unsigned short, Dimension >      LabelObjectType;
+  typedef itk::LabelMap< LabelObjectType >                   LabelMapType;
+  typedef itk::LabelImageToLabelMapFilter< ImageType, LabelMapType > ToLabelMapType;
+  typedef itk::LabelMapToLabelImageFilter< LabelMapType, ImageType > ToLabelImageType;
+
+  ImageType::Pointer    image = ImageType::New();
+  ImageType::RegionType region;
+  ImageType::SizeType   size;
+  size.Fill(64);
+  region.SetSize(size);
+  image->SetRegions(region);
+  image->Allocate();
+
+  // small blocks of 4x4x4 pixels, and planes of 3 large objects crossing
+  // the whole image
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, region );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType & index = it.GetIndex();
+    if ( index[0] % 16 == 0 )
+      {
+      it.Set( 60001 + index[1] % 3 );
+      }
+    else if ( ( index[0] + index[1] + index[2] ) % 5 == 0 )
+      {
+      it.Set(0);
+      }
+    else
+      {
+      it.Set( 1 + index[0] / 4 + 16 * ( index[1] / 4 ) + 256 * ( index[2] / 4 ) );
+      }
+    }
+
+  LabelMapType::Pointer reference;
+  const itk::ThreadIdType threads[] = { 1, 2, 3, 4, 8 };
+  for ( unsigned int t = 0; t < sizeof( threads ) / sizeof( threads[0] ); t++ )
+    {
+    ToLabelMapType::Pointer toLabelMap = ToLabelMapType::New();
+    toLabelMap->SetInput(image);
+    toLabelMap->SetBackgroundValue(0);
+    toLabelMap->SetNumberOfThreads(threads[t]);
+
+    ToLabelImageType::Pointer toLabelImage = ToLabelImageType::New();
+    toLabelImage->SetInput( toLabelMap->GetOutput() );
+    toLabelImage->SetNumberOfThreads(threads[t]);
+
+    itk::TimeProbe probe;
+    probe.Start();
+    toLabelImage->Update();
+    probe.Stop();
+    std::cout << threads[t] << " threads: " << probe.GetTotal() << " s, "
+              << toLabelMap->GetOutput()->GetNumberOfLabelObjects() << " objects" << std::endl;
+
+    LabelMapType *labelMap = toLabelMap->GetOutput();
+    if ( t == 0 )
+      {
+      reference = labelMap;
+      }
+    else
+      {
+      // the same objects, with the same lines in the same order
+      if ( labelMap->GetNumberOfLabelObjects() != reference->GetNumberOfLabelObjects() )
+        {
+        std::cerr << threads[t] << " threads: " << labelMap->GetNumberOfLabelObjects()
+                  << " objects instead of " << reference->GetNumberOfLabelObjects() << std::endl;
+        return EXIT_FAILURE;
+        }
+      for ( LabelMapType::Iterator lit( reference ); !lit.IsAtEnd(); ++lit )
+        {
+        const LabelObjectType *expected = lit.GetLabelObject();
+        if ( !labelMap->HasLabel( expected->GetLabel() ) )
+          {
+          std::cerr << threads[t] << " threads: no object " << expected->GetLabel() << std::endl;
+          return EXIT_FAILURE;
+          }
+        const LabelObjectType *labelObject = labelMap->GetLabelObject( expected->GetLabel() );
+        bool same = labelObject->GetNumberOfLines() == expected->GetNumberOfLines();
+        for ( itk::SizeValueType l = 0; same && l < expected->GetNumberOfLines(); l++ )
+          {
+          same = labelObject->GetLine(l).GetIndex() == expected->GetLine(l).GetIndex()
+                 && labelObject->GetLine(l).GetLength() == expected->GetLine(l).GetLength();
+          }
+        if ( !same )
+          {
+          std::cerr << threads[t] << " threads: the lines of object " << expected->GetLabel()
+                    << " differ" << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+
+    // and back to the input image
+    itk::ImageRegionConstIteratorWithIndex< ImageType > iit( image, region );
+    itk::ImageRegionConstIteratorWithIndex< ImageType > oit( toLabelImage->GetOutput(), region );
+    for ( ; !iit.IsAtEnd(); ++iit, ++oit )
+      {
+      if ( iit.Get() != oit.Get() )
+        {
+        std::cerr << threads[t] << " threads: label " << oit.Get() << " at " << oit.GetIndex()
+                  << " instead of " << iit.Get() << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,146 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkLabelImageToLabelMapFilter.h"
+#include "itkStatisticsLabelMapFilter.h"
+#include "itkStatisticsLabelObject.h"
+#include "itkLabelMapToLabelImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include <map>
+
+//
+// Compute the statistics of the objects of a label map, whose region does
+// not start at the origin, and compare them with the values computed from
+// the pixels of the images. Also check that the label map is converted back
+// to the same label image.
+//
+int itkStatisticsLabelMapFilterTest(int, char* [])
+{
+  const unsigned int Dimension = 3;
+
+  typedef itk::Image< unsigned char, Dimension >                    ImageType;
+  typedef itk::Image< float, Dimension >                            FeatureImageType;
+  typedef itk::StatisticsLabelObject< unsigned char, Dimension >    LabelObjectType;
+  typedef itk::LabelMap< LabelObjectType >                          LabelMapType;
+  typedef itk::LabelImageToLabelMapFilter< ImageType, LabelMapType > ToLabelMapType;
+  typedef itk::StatisticsLabelMapFilter< LabelMapType, FeatureImageType > StatisticsType;
+  typedef itk::LabelMapToLabelImageFilter< LabelMapType, ImageType > ToLabelImageType;
+
+  ImageType::RegionType region;
+  region.SetIndex(0, -7);
+  region.SetIndex(1, 3);
+  region.SetIndex(2, 11);
+  region.SetSize(0, 37);
+  region.SetSize(1, 23);
+  region.SetSize(2, 17);
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+
+  FeatureImageType::Pointer feature = FeatureImageType::New();
+  feature->SetRegions(region);
+  feature->Allocate();
+
+  // expected sums, minimums and maximums
+  std::map< unsigned char, double >                  sums;
+  std::map< unsigned char, float >                   minimums;
+  std::map< unsigned char, float >                   maximums;
+  std::map< unsigned char, ImageType::IndexType >    minimumIndexes;
+
+  itk::ImageRegionIteratorWithIndex< ImageType >        it( image, region );
+  itk::ImageRegionIteratorWithIndex< FeatureImageType > fit( feature, region );
+  for ( ; !it.IsAtEnd(); ++it, ++fit )
+    {
+    const ImageType::IndexType & index = it.GetIndex();
+    const unsigned char label = ( index[0] * index[0] + 3 * index[1] + index[2] / 4 ) % 9;
+    const float         value = static_cast< float >( ( index[0] * 13 + index[1] * 7 + index[2] * 5 ) % 31 ) - 10.5f;
+    it.Set(label);
+    fit.Set(value);
+    if ( label == 0 )
+      {
+      continue;
+      }
+    if ( sums.find(label) == sums.end() )
+      {
+      sums[label] = 0;
+      minimums[label] = value;
+      maximums[label] = value;
+      minimumIndexes[label] = index;
+      }
+    sums[label] += value;
+    if ( value <= minimums[label] )
+      {
+      minimums[label] = value;
+      minimumIndexes[label] = index;
+      }
+    maximums[label] = std::max(maximums[label], value);
+    }
+
+  ToLabelMapType::Pointer toLabelMap = ToLabelMapType::New();
+  toLabelMap->SetInput(image);
+  toLabelMap->SetBackgroundValue(0);
+
+  StatisticsType::Pointer statistics = StatisticsType::New();
+  statistics->SetInput( toLabelMap->GetOutput() );
+  statistics->SetFeatureImage(feature);
+  statistics->Update();
+
+  LabelMapType *labelMap = statistics->GetOutput();
+  if ( labelMap->GetNumberOfLabelObjects() != sums.size() )
+    {
+    std::cerr << labelMap->GetNumberOfLabelObjects() << " objects instead of " << sums.size() << std::endl;
+    return EXIT_FAILURE;
+    }
+  for ( std::map< unsigned char, double >::const_iterator sit = sums.begin(); sit != sums.end(); ++sit )
+    {
+    const unsigned char    label = sit->first;
+    const LabelObjectType *labelObject = labelMap->GetLabelObject(label);
+    if ( vnl_math_abs(labelObject->GetSum() - sit->second) > 1e-6
+         || labelObject->GetMinimum() != minimums[label]
+         || labelObject->GetMaximum() != maximums[label]
+         || labelObject->GetMinimumIndex() != minimumIndexes[label] )
+      {
+      std::cerr << "Object " << (int)label << ": sum " << labelObject->GetSum()
+                << ", minimum " << labelObject->GetMinimum() << " at " << labelObject->GetMinimumIndex()
+                << ", maximum " << labelObject->GetMaximum() << " instead of " << sit->second
+                << ", " << minimums[label] << " at " << minimumIndexes[label]
+                << ", " << maximums[label] << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  ToLabelImageType::Pointer toLabelImage = ToLabelImageType::New();
+  toLabelImage->SetInput(labelMap);
+  toLabelImage->Update();
+
+  itk::ImageRegionConstIteratorWithIndex< ImageType > iit( image, region );
+  itk::ImageRegionConstIteratorWithIndex< ImageType > oit( toLabelImage->GetOutput(), region );
+  for ( ; !iit.IsAtEnd(); ++iit, ++oit )
+    {
+    if ( iit.Get() != oit.Get() )
+      {
+      std::cerr << "Label " << (int)oit.Get() << " at " << oit.GetIndex()
+                << " instead of " << (int)iit.Get() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
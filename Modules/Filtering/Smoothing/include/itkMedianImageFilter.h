@@ -20,6 +20,8 @@
 
 #include "itkBoxImageFilter.h"
 #include "itkImage.h"
+#include "itkImageToImageFilterDetail.h"
+#include "itkTieredRankHistogram.h"
 
 namespace itk
 {
@@ -35,6 +37,12 @@ namespace itk
  * This filter requires that the input pixel type provides an operator<()
  * (LessThan Comparable).
  *
+ * For the integer pixel types of at most 16 bits, the filter slides a
+ * TieredRankHistogram along each line of the image: only the pixels that
+ * enter and leave the neighborhood are counted, and the median is found
+ * from the previous one. For the other types, the pixels of each
+ * neighborhood are partially sorted. Both give the same result.
+ *
  * \sa Image
  * \sa Neighborhood
  * \sa NeighborhoodOperator
@@ -112,6 +120,25 @@ protected:
                             ThreadIdType threadId);
 
 private:
+  typedef ImageToImageFilterDetail::BooleanDispatch< true >  HistogramDispatch;
+  typedef ImageToImageFilterDetail::BooleanDispatch< false > SortDispatch;
+
+  /** Use the histogram when the pixel type and the image support it. */
+  void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                            ThreadIdType threadId, const HistogramDispatch &);
+
+  void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                            ThreadIdType threadId, const SortDispatch &);
+
+  /** Median of each neighborhood from a histogram that slides along the
+   * lines of an Image. */
+  void HistogramThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                                     ThreadIdType threadId);
+
+  /** Median of each neighborhood by partial sorting. */
+  void SortThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                                ThreadIdType threadId);
+
   MedianImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);    //purposely not implemented
 };
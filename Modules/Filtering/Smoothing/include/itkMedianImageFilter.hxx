@@ -22,6 +22,7 @@
 #include "itkConstNeighborhoodIterator.h"
 #include "itkNeighborhoodInnerProduct.h"
 #include "itkImageRegionIterator.h"
+#include "itkImageLinearIteratorWithIndex.h"
 #include "itkNeighborhoodAlgorithm.h"
 #include "itkOffset.h"
 #include "itkProgressReporter.h"
@@ -41,6 +42,166 @@ void
 MedianImageFilter< TInputImage, TOutputImage >
 ::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
                        ThreadIdType threadId)
+{
+  typedef ImageToImageFilterDetail::BooleanDispatch<
+    Function::TieredRankHistogramTraits< InputPixelType >::IsSupported > DispatchType;
+
+  this->ThreadedGenerateData( outputRegionForThread, threadId, DispatchType() );
+}
+
+template< class TInputImage, class TOutputImage >
+void
+MedianImageFilter< TInputImage, TOutputImage >
+::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                       ThreadIdType threadId, const HistogramDispatch &)
+{
+  // The histogram reads the pixels from the buffer of an Image.
+  typedef Image< InputPixelType, InputImageDimension > BufferedImageType;
+  if ( dynamic_cast< const BufferedImageType * >( this->GetInput() ) )
+    {
+    this->HistogramThreadedGenerateData(outputRegionForThread, threadId);
+    }
+  else
+    {
+    this->SortThreadedGenerateData(outputRegionForThread, threadId);
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+void
+MedianImageFilter< TInputImage, TOutputImage >
+::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                       ThreadIdType threadId, const SortDispatch &)
+{
+  this->SortThreadedGenerateData(outputRegionForThread, threadId);
+}
+
+template< class TInputImage, class TOutputImage >
+void
+MedianImageFilter< TInputImage, TOutputImage >
+::HistogramThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                                ThreadIdType threadId)
+{
+  typedef Image< InputPixelType, InputImageDimension > BufferedImageType;
+  typedef typename BufferedImageType::IndexType        BufferedIndexType;
+
+  typename OutputImageType::Pointer output = this->GetOutput();
+  const BufferedImageType *input = static_cast< const BufferedImageType * >( this->GetInput() );
+
+  const InputSizeType          radius = this->GetRadius();
+  const InputImageRegionType & bufferedRegion = input->GetBufferedRegion();
+  const InputPixelType *       buffer = input->GetBufferPointer();
+  const OffsetValueType *      offsetTable = input->GetOffsetTable();
+
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+
+  // The neighborhood is made of rows along the first dimension. Outside of
+  // the buffer, the nearest pixel is used, like the
+  // ZeroFluxNeumannBoundaryCondition of the neighborhood iterators.
+  SizeValueType numberOfRows = 1;
+  for ( unsigned int d = 1; d < InputImageDimension; ++d )
+    {
+    numberOfRows *= 2 * radius[d] + 1;
+    }
+  const SizeValueType neighborhoodSize = numberOfRows * ( 2 * radius[0] + 1 );
+  const SizeValueType medianPosition = neighborhoodSize / 2;
+
+  std::vector< OffsetValueType > rowOffsets(numberOfRows);
+
+  const OffsetValueType bufferStart = bufferedRegion.GetIndex(0);
+  const OffsetValueType bufferEnd = bufferStart + static_cast< OffsetValueType >( bufferedRegion.GetSize(0) );
+  const OffsetValueType lineStart = outputRegionForThread.GetIndex(0);
+  const OffsetValueType lineEnd = lineStart + static_cast< OffsetValueType >( outputRegionForThread.GetSize(0) );
+  const OffsetValueType r0 = static_cast< OffsetValueType >( radius[0] );
+
+  // Offsets of the columns of the neighborhoods, from the start of the
+  // rows, for the positions from lineStart - r0 to lineEnd + r0.
+  std::vector< OffsetValueType > columnOffsets(lineEnd - lineStart + 2 * r0);
+  for ( OffsetValueType x = lineStart - r0; x < lineEnd + r0; ++x )
+    {
+    columnOffsets[x - lineStart + r0] =
+      std::min( std::max( x, bufferStart ), bufferEnd - 1 ) - bufferStart;
+    }
+  const OffsetValueType *columns = &columnOffsets[r0];
+
+  Function::TieredRankHistogram< InputPixelType > histogram;
+
+  ImageLinearIteratorWithIndex< OutputImageType > it(output, outputRegionForThread);
+  it.SetDirection(0);
+  for ( it.GoToBegin(); !it.IsAtEnd(); it.NextLine() )
+    {
+    const BufferedIndexType lineIndex = it.GetIndex();
+
+    // Offsets of the rows of the neighborhoods of the line.
+    BufferedIndexType rowIndex;
+    rowIndex.Fill(0);
+    for ( unsigned int d = 1; d < InputImageDimension; ++d )
+      {
+      rowIndex[d] = -static_cast< OffsetValueType >( radius[d] );
+      }
+    for ( SizeValueType r = 0; r < numberOfRows; ++r )
+      {
+      OffsetValueType offset = 0;
+      for ( unsigned int d = 1; d < InputImageDimension; ++d )
+        {
+        const OffsetValueType start = bufferedRegion.GetIndex(d);
+        const OffsetValueType end = start + static_cast< OffsetValueType >( bufferedRegion.GetSize(d) );
+        offset += ( std::min( std::max( lineIndex[d] + rowIndex[d], start ), end - 1 ) - start ) * offsetTable[d];
+        }
+      rowOffsets[r] = offset;
+
+      for ( unsigned int d = 1; d < InputImageDimension; ++d )
+        {
+        if ( ++rowIndex[d] <= static_cast< OffsetValueType >( radius[d] ) )
+          {
+          break;
+          }
+        rowIndex[d] = -static_cast< OffsetValueType >( radius[d] );
+        }
+      }
+
+    // Fill the histogram with the neighborhood of the first pixel.
+    for ( OffsetValueType x = -r0; x <= r0; ++x )
+      {
+      for ( SizeValueType r = 0; r < numberOfRows; ++r )
+        {
+        histogram.AddPixel(buffer[rowOffsets[r] + columns[x]]);
+        }
+      }
+
+    // Slide it along the line.
+    for ( OffsetValueType x = 0; !it.IsAtEndOfLine(); ++x, ++it )
+      {
+      it.Set( static_cast< OutputPixelType >( histogram.GetValue(medianPosition) ) );
+      progress.CompletedPixel();
+
+      if ( x + 1 < lineEnd - lineStart && columns[x - r0] != columns[x + r0 + 1] )
+        {
+        for ( SizeValueType r = 0; r < numberOfRows; ++r )
+          {
+          histogram.RemovePixel(buffer[rowOffsets[r] + columns[x - r0]]);
+          histogram.AddPixel(buffer[rowOffsets[r] + columns[x + r0 + 1]]);
+          }
+        }
+      }
+
+    // Empty the histogram for the next line.
+    const OffsetValueType last = lineEnd - lineStart - 1;
+    for ( OffsetValueType x = last - r0; x <= last + r0; ++x )
+      {
+      for ( SizeValueType r = 0; r < numberOfRows; ++r )
+        {
+        histogram.RemovePixel(buffer[rowOffsets[r] + columns[x]]);
+        }
+      }
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+void
+MedianImageFilter< TInputImage, TOutputImage >
+::SortThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                           ThreadIdType threadId)
 {
   // Allocate output
   typename OutputImageType::Pointer output = this->GetOutput();
@@ -0,0 +1,184 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkTieredRankHistogram_h
+#define __itkTieredRankHistogram_h
+
+#include "itkIntTypes.h"
+#include "itkMacro.h"
+#include "itkNumericTraits.h"
+
+#include <vector>
+
+namespace itk
+{
+namespace Function
+{
+/** \class TieredRankHistogramTraits
+ * \brief Tells whether a pixel type can be counted in a
+ * TieredRankHistogram: the integer types of at most 16 bits.
+ *
+ * \ingroup ITKSmoothing
+ */
+template< class TInputPixel >
+struct TieredRankHistogramTraits
+{
+  itkStaticConstMacro(IsSupported, bool, false);
+};
+
+template< >
+struct TieredRankHistogramTraits< char >
+{
+  itkStaticConstMacro(IsSupported, bool, true);
+};
+
+template< >
+struct TieredRankHistogramTraits< signed char >
+{
+  itkStaticConstMacro(IsSupported, bool, true);
+};
+
+template< >
+struct TieredRankHistogramTraits< unsigned char >
+{
+  itkStaticConstMacro(IsSupported, bool, true);
+};
+
+template< >
+struct TieredRankHistogramTraits< short >
+{
+  itkStaticConstMacro(IsSupported, bool, true);
+};
+
+template< >
+struct TieredRankHistogramTraits< unsigned short >
+{
+  itkStaticConstMacro(IsSupported, bool, true);
+};
+
+/** \class TieredRankHistogram
+ * \brief Histogram of the pixels of a moving window, which gives the
+ * pixel of any rank.
+ *
+ * There is one bin for each value of the pixel type, and the bins are
+ * grouped in tiers: 16 tiers of 16 bins for 8 bit pixels, 256 tiers of 256
+ * bins for 16 bit pixels. The histogram keeps track of the bin of the last
+ * requested rank and of the number of pixels below it. GetValue() moves
+ * from there, by whole tiers where it can, so that the cost of a query
+ * depends on how far the value has moved rather than on the number of
+ * pixels in the window.
+ *
+ * Only the types of TieredRankHistogramTraits are supported.
+ *
+ * \ingroup ITKSmoothing
+ */
+template< class TInputPixel >
+class TieredRankHistogram
+{
+public:
+  TieredRankHistogram():
+    m_Bins(NumberOfBins, 0),
+    m_Tiers(NumberOfBins >> TierShift, 0),
+    m_Bin(0),
+    m_Below(0)
+  {}
+
+  void AddPixel(const TInputPixel & p)
+  {
+    const unsigned int bin = BinOf(p);
+
+    ++m_Bins[bin];
+    ++m_Tiers[bin >> TierShift];
+    if ( bin < m_Bin )
+      {
+      ++m_Below;
+      }
+  }
+
+  void RemovePixel(const TInputPixel & p)
+  {
+    const unsigned int bin = BinOf(p);
+
+    --m_Bins[bin];
+    --m_Tiers[bin >> TierShift];
+    if ( bin < m_Bin )
+      {
+      --m_Below;
+      }
+  }
+
+  /** Value of the pixel of the given rank, from 0 for the smallest, like
+   * std::nth_element. The rank must be lower than the number of pixels. */
+  TInputPixel GetValue(SizeValueType rank)
+  {
+    // Move down while too many pixels are below the bin.
+    while ( m_Below > rank )
+      {
+      if ( ( m_Bin & TierMask ) == 0 && m_Below - m_Tiers[( m_Bin >> TierShift ) - 1] > rank )
+        {
+        m_Below -= m_Tiers[( m_Bin >> TierShift ) - 1];
+        m_Bin -= TierMask + 1;
+        }
+      else
+        {
+        --m_Bin;
+        m_Below -= m_Bins[m_Bin];
+        }
+      }
+
+    // Move up while the pixel of that rank is above the bin.
+    while ( m_Below + m_Bins[m_Bin] <= rank )
+      {
+      if ( ( m_Bin & TierMask ) == 0 && m_Below + m_Tiers[m_Bin >> TierShift] <= rank )
+        {
+        m_Below += m_Tiers[m_Bin >> TierShift];
+        m_Bin += TierMask + 1;
+        }
+      else
+        {
+        m_Below += m_Bins[m_Bin];
+        ++m_Bin;
+        }
+      }
+
+    return static_cast< TInputPixel >( static_cast< int >( m_Bin )
+                                       + static_cast< int >( NumericTraits< TInputPixel >::NonpositiveMin() ) );
+  }
+
+private:
+  itkStaticConstMacro(NumberOfBins, unsigned int, 1u << ( 8 * sizeof( TInputPixel ) ) );
+  itkStaticConstMacro(TierShift, unsigned int, 4 * sizeof( TInputPixel ) );
+  itkStaticConstMacro(TierMask, unsigned int, ( 1u << ( 4 * sizeof( TInputPixel ) ) ) - 1);
+
+  static unsigned int BinOf(const TInputPixel & p)
+  {
+    return static_cast< unsigned int >( static_cast< int >( p )
+                                        - static_cast< int >( NumericTraits< TInputPixel >::NonpositiveMin() ) );
+  }
+
+  std::vector< SizeValueType > m_Bins;
+  std::vector< SizeValueType > m_Tiers;
+
+  // The bin of the last requested rank, and the number of pixels in the
+  // bins below it.
+  unsigned int  m_Bin;
+  SizeValueType m_Below;
+};
+} // end namespace Function
+} // end namespace itk
+
+#endif
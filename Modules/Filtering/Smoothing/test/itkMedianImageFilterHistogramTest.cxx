@@ -0,0 +1,150 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMedianImageFilter.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+// Median filter an image of integers, which goes through the histogram,
+// and the same image as floats, which goes through the sorting, and
+// compare the results.
+template< class TPixel, unsigned int VDimension >
+bool TestHistogram(const typename itk::Image< TPixel, VDimension >::SizeType & size,
+                   const typename itk::Image< TPixel, VDimension >::SizeType & radius,
+                   unsigned int numberOfThreads)
+{
+  typedef itk::Image< TPixel, VDimension >                 ImageType;
+  typedef itk::Image< float, VDimension >                  FloatImageType;
+  typedef itk::MedianImageFilter< ImageType, ImageType >   FilterType;
+  typedef itk::MedianImageFilter< FloatImageType, FloatImageType > FloatFilterType;
+
+  typename ImageType::Pointer      image = ImageType::New();
+  typename FloatImageType::Pointer floatImage = FloatImageType::New();
+  typename ImageType::RegionType   region;
+  region.SetSize(size);
+  image->SetRegions(region);
+  image->Allocate();
+  floatImage->SetRegions(region);
+  floatImage->Allocate();
+
+  // Values spread over the whole range of the type, with the extremes.
+  const double minimum = itk::NumericTraits< TPixel >::NonpositiveMin();
+  const double range = static_cast< double >( itk::NumericTraits< TPixel >::max() ) - minimum;
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, region );
+  unsigned long                                  n = 0;
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it, ++n )
+    {
+    const TPixel value = static_cast< TPixel >( minimum + ( n * 7919 % 1009 ) / 1008.0 * range );
+    it.Set(value);
+    floatImage->SetPixel( it.GetIndex(), static_cast< float >( value ) );
+    }
+
+  typename FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(image);
+  filter->SetRadius(radius);
+  filter->SetNumberOfThreads(numberOfThreads);
+  itk::TimeProbe histogramProbe;
+  histogramProbe.Start();
+  filter->Update();
+  histogramProbe.Stop();
+
+  typename FloatFilterType::Pointer floatFilter = FloatFilterType::New();
+  floatFilter->SetInput(floatImage);
+  floatFilter->SetRadius(radius);
+  floatFilter->SetNumberOfThreads(numberOfThreads);
+  itk::TimeProbe sortProbe;
+  sortProbe.Start();
+  floatFilter->Update();
+  sortProbe.Stop();
+
+  itk::ImageRegionConstIteratorWithIndex< ImageType > oit( filter->GetOutput(), region );
+  for ( oit.GoToBegin(); !oit.IsAtEnd(); ++oit )
+    {
+    const float expected = floatFilter->GetOutput()->GetPixel( oit.GetIndex() );
+    if ( static_cast< float >( oit.Get() ) != expected )
+      {
+      std::cerr << "Size " << size << ", radius " << radius << ": median "
+                << static_cast< double >( oit.Get() ) << " at " << oit.GetIndex()
+                << " instead of " << expected << std::endl;
+      return false;
+      }
+    }
+
+  std::cout << sizeof( TPixel ) * 8 << " bit, size " << size << ", radius " << radius << ": "
+            << histogramProbe.GetTotal() << " s with the histogram, "
+            << sortProbe.GetTotal() << " s by sorting" << std::endl;
+  return true;
+}
+}
+
+//
+// Check that the median of the integer pixels, which MedianImageFilter
+// computes with a sliding histogram, is the same as the one it finds by
+// sorting, for 8 and 16 bit pixels, inside and on the border of the image,
+// and time both.
+//
+int itkMedianImageFilterHistogramTest(int, char* [])
+{
+  itk::Size< 2 > size2;
+  itk::Size< 2 > radius2;
+  size2[0] = 57;
+  size2[1] = 43;
+  radius2[0] = 3;
+  radius2[1] = 2;
+
+  itk::Size< 3 > size3;
+  itk::Size< 3 > radius3;
+  size3[0] = 31;
+  size3[1] = 24;
+  size3[2] = 19;
+  radius3[0] = 2;
+  radius3[1] = 3;
+  radius3[2] = 1;
+
+  // Where most of the neighborhoods reach out of the image.
+  itk::Size< 3 > smallSize3;
+  itk::Size< 3 > largeRadius3;
+  smallSize3[0] = 5;
+  smallSize3[1] = 4;
+  smallSize3[2] = 3;
+  largeRadius3[0] = 2;
+  largeRadius3[1] = 1;
+  largeRadius3[2] = 1;
+
+  itk::Size< 3 > ctSize3;
+  itk::Size< 3 > ctRadius3;
+  ctSize3.Fill(80);
+  ctRadius3.Fill(3);
+
+  if ( !TestHistogram< unsigned char, 2 >(size2, radius2, 1)
+       || !TestHistogram< char, 2 >(size2, radius2, 3)
+       || !TestHistogram< signed char, 3 >(size3, radius3, 2)
+       || !TestHistogram< short, 3 >(size3, radius3, 1)
+       || !TestHistogram< unsigned short, 3 >(size3, radius3, 4)
+       || !TestHistogram< unsigned char, 3 >(smallSize3, largeRadius3, 1)
+       || !TestHistogram< short, 3 >(smallSize3, largeRadius3, 2)
+       || !TestHistogram< short, 3 >(ctSize3, ctRadius3, 1) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
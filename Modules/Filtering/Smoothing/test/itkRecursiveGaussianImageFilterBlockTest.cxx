@@ -0,0 +1,207 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkRecursiveGaussianImageFilter.h"
+#include "itkTimeProbe.h"
+#include "itkVectorImage.h"
+
+namespace
+{
+// Filters one line at a time with FilterDataArray(), as a reference.
+template< class TImage >
+class LineByLineGaussianImageFilter:
+  public itk::RecursiveGaussianImageFilter< TImage, TImage >
+{
+public:
+  typedef LineByLineGaussianImageFilter                       Self;
+  typedef itk::RecursiveGaussianImageFilter< TImage, TImage > Superclass;
+  typedef itk::SmartPointer< Self >                           Pointer;
+  typedef typename Superclass::RealType                       RealType;
+  typedef typename Superclass::OutputImageRegionType          OutputImageRegionType;
+  itkTypeMacro(LineByLineGaussianImageFilter, RecursiveGaussianImageFilter);
+  itkNewMacro(Self);
+
+protected:
+  LineByLineGaussianImageFilter() {}
+  void ThreadedGenerateData(const OutputImageRegionType & region, itk::ThreadIdType)
+  {
+    itk::ImageLinearConstIteratorWithIndex< TImage > inputIterator(this->GetInput(), region);
+    itk::ImageLinearIteratorWithIndex< TImage >      outputIterator(this->GetOutput(), region);
+    inputIterator.SetDirection( this->GetDirection() );
+    outputIterator.SetDirection( this->GetDirection() );
+
+    const unsigned int      ln = region.GetSize()[this->GetDirection()];
+    std::vector< RealType > inps(ln);
+    std::vector< RealType > outs(ln);
+    std::vector< RealType > scratch(ln);
+    for ( ; !inputIterator.IsAtEnd(); inputIterator.NextLine(), outputIterator.NextLine() )
+      {
+      for ( unsigned int i = 0; !inputIterator.IsAtEndOfLine(); ++inputIterator )
+        {
+        inps[i++] = inputIterator.Get();
+        }
+      this->FilterDataArray(&outs[0], &inps[0], &scratch[0], ln);
+      for ( unsigned int i = 0; !outputIterator.IsAtEndOfLine(); ++outputIterator )
+        {
+        outputIterator.Set( static_cast< typename TImage::PixelType >( outs[i++] ) );
+        }
+      }
+  }
+};
+
+double Difference(float a, float b)
+{
+  return vnl_math_abs(a - b);
+}
+
+double Difference(const itk::VariableLengthVector< float > & a, const itk::VariableLengthVector< float > & b)
+{
+  double difference = 0.0;
+  for ( unsigned int c = 0; c < a.Size(); c++ )
+    {
+    difference = vnl_math_max( difference, static_cast< double >( vnl_math_abs(a[c] - b[c]) ) );
+    }
+  return difference;
+}
+
+// Filter the image along each direction with several numbers of lines per
+// block, and compare with the filter that goes line by line.
+template< class TImage >
+bool TestBlocks(const std::string & description, const TImage *image)
+{
+  typedef itk::RecursiveGaussianImageFilter< TImage, TImage > FilterType;
+  typedef LineByLineGaussianImageFilter< TImage >             ReferenceFilterType;
+
+  const unsigned int linesPerBlock[] = { 1, 3, 8, 16 };
+  for ( unsigned int direction = 0; direction < TImage::ImageDimension; direction++ )
+    {
+    for ( unsigned int order = 0; order < 3; order++ )
+      {
+      typename ReferenceFilterType::Pointer reference = ReferenceFilterType::New();
+      reference->SetInput(image);
+      reference->SetDirection(direction);
+      reference->SetOrder( static_cast< typename FilterType::OrderEnumType >( order ) );
+      reference->SetSigma(2.5);
+      reference->Update();
+
+      for ( unsigned int b = 0; b < sizeof( linesPerBlock ) / sizeof( linesPerBlock[0] ); b++ )
+        {
+        typename FilterType::Pointer filter = FilterType::New();
+        filter->SetInput(image);
+        filter->SetDirection(direction);
+        filter->SetOrder( static_cast< typename FilterType::OrderEnumType >( order ) );
+        filter->SetSigma(2.5);
+        filter->SetNumberOfLinesPerBlock(linesPerBlock[b]);
+        filter->Update();
+
+        itk::ImageRegionConstIteratorWithIndex< TImage > it( filter->GetOutput(),
+                                                             image->GetLargestPossibleRegion() );
+        itk::ImageRegionConstIteratorWithIndex< TImage > rit( reference->GetOutput(),
+                                                              image->GetLargestPossibleRegion() );
+        for ( ; !it.IsAtEnd(); ++it, ++rit )
+          {
+          if ( Difference( it.Get(), rit.Get() ) > 1e-5 )
+            {
+            std::cerr << description << ", direction " << direction << ", order " << order
+                      << ", " << linesPerBlock[b] << " lines per block: value " << it.Get()
+                      << " at " << it.GetIndex() << " instead of " << rit.Get() << std::endl;
+            return false;
+            }
+          }
+        }
+      }
+    }
+  std::cout << description << ": OK" << std::endl;
+  return true;
+}
+}
+
+//
+// Check that RecursiveGaussianImageFilter gives the same result whatever
+// the number of lines that it filters together, and time the filtering
+// along each direction of a volume with one and eight lines per block.
+//
+int itkRecursiveGaussianImageFilterBlockTest(int, char* [])
+{
+  typedef itk::Image< float, 3 >       ImageType;
+  typedef itk::VectorImage< float, 3 > VectorImageType;
+
+  ImageType::Pointer       image = ImageType::New();
+  VectorImageType::Pointer vectorImage = VectorImageType::New();
+  ImageType::RegionType    region;
+  ImageType::SizeType      size;
+  size[0] = 23;
+  size[1] = 17;
+  size[2] = 12;
+  region.SetSize(size);
+  image->SetRegions(region);
+  image->Allocate();
+  vectorImage->SetRegions(region);
+  vectorImage->SetNumberOfComponentsPerPixel(2);
+  vectorImage->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, region );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType & index = it.GetIndex();
+    const float                  value = static_cast< float >( ( index[0] * 7 + index[1] * index[2] * 3 ) % 29 );
+    it.Set(value);
+    VectorImageType::PixelType pixel(2);
+    pixel[0] = value;
+    pixel[1] = -2.0f * value + index[2];
+    vectorImage->SetPixel(index, pixel);
+    }
+
+  if ( !TestBlocks< ImageType >("Image", image)
+       || !TestBlocks< VectorImageType >("VectorImage", vectorImage) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  ImageType::Pointer largeImage = ImageType::New();
+  size.Fill(160);
+  region.SetSize(size);
+  largeImage->SetRegions(region);
+  largeImage->Allocate();
+  largeImage->FillBuffer(1.0f);
+
+  typedef itk::RecursiveGaussianImageFilter< ImageType, ImageType > FilterType;
+  for ( unsigned int direction = 0; direction < 3; direction++ )
+    {
+    double seconds[2];
+    for ( unsigned int b = 0; b < 2; b++ )
+      {
+      FilterType::Pointer filter = FilterType::New();
+      filter->SetInput(largeImage);
+      filter->SetDirection(direction);
+      filter->SetSigma(3.0);
+      filter->SetNumberOfLinesPerBlock(b == 0 ? 1 : 8);
+      itk::TimeProbe probe;
+      probe.Start();
+      filter->Update();
+      probe.Stop();
+      seconds[b] = probe.GetTotal();
+      }
+    std::cout << "Direction " << direction << ": " << seconds[0] << " s line by line, "
+              << seconds[1] << " s with 8 lines per block" << std::endl;
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
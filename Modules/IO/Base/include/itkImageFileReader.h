@@ -77,6 +77,24 @@ public:
  * raw binary format) have no accepted suffix, so you will have to
  * manually create the ImageIO instance of the write type.
  *
+ * When the pixels of the file must be converted, and the ImageIO can read
+ * parts of the file, the file is read in blocks of at most
+ * ConversionBufferSize bytes which are converted one after the other into
+ * the output buffer. When it cannot, a conversion to a pixel type at least
+ * as large is done in place in the output buffer. Only in the remaining
+ * cases is the whole file read into a temporary buffer. The conversion
+ * itself is split over NumberOfThreads threads.
+ *
+ * With UseMemoryMapping on, a file whose pixels are stored exactly as the
+ * output buffer lays them out (same pixel type, uncompressed, contiguous and
+ * in the byte order of the machine, as reported by
+ * ImageIOBase::GetMappablePixelDataLocation()) is mapped in memory instead
+ * of being read: the output covers the whole image and its pixels are only
+ * loaded from the file when they are accessed. The mapping is copy-on-write
+ * unless ReadOnlyMemoryMapping is on, in which case the pixels of the
+ * output must not be modified, by in place filters in particular. Other
+ * files are read as usual.
+ *
  * \sa ImageSeriesReader
  * \sa ImageIOBase
  *
@@ -149,6 +167,25 @@ public:
   itkSetMacro(UseStreaming, bool);
   itkGetConstReferenceMacro(UseStreaming, bool);
   itkBooleanMacro(UseStreaming);
+
+  /** Set/Get the maximum size, in bytes, of the blocks of the file read
+   * before their conversion to the output pixel type, when the ImageIO can
+   * read parts of the file. Defaults to 16 MiB. */
+  itkSetMacro(ConversionBufferSize, SizeValueType);
+  itkGetConstMacro(ConversionBufferSize, SizeValueType);
+
+  /** Set/Get whether the file is mapped in memory instead of being read,
+   * when its pixels can be used as they are stored. Off by default. */
+  itkSetMacro(UseMemoryMapping, bool);
+  itkGetConstMacro(UseMemoryMapping, bool);
+  itkBooleanMacro(UseMemoryMapping);
+
+  /** Set/Get whether the file is mapped read-only rather than
+   * copy-on-write. A read-only mapping shares its pages with the file, but
+   * writing to the output buffer then crashes. Off by default. */
+  itkSetMacro(ReadOnlyMemoryMapping, bool);
+  itkGetConstMacro(ReadOnlyMemoryMapping, bool);
+  itkBooleanMacro(ReadOnlyMemoryMapping);
 protected:
   ImageFileReader();
   ~ImageFileReader();
@@ -157,6 +194,12 @@ protected:
   /** Convert a block of pixels from one type to another. */
   void DoConvertBuffer(void *buffer, size_t numberOfPixels);
 
+  /** Convert a block of pixels from one type to another, into outputData. */
+  void DoConvertBuffer(void *inputData, OutputImagePixelType *outputData, size_t numberOfPixels);
+
+  /** Convert a block of pixels with the threads of the MultiThreader. */
+  void ConvertBuffer(void *inputData, OutputImagePixelType *outputData, size_t numberOfPixels);
+
   /** Test whether the given filename exist and it is readable, this
     * is intended to be called before attempting to use  ImageIO
     * classes for actually reading the file. If the file doesn't exist
@@ -173,15 +216,61 @@ protected:
                                // ImageIO is user specified
 
   bool m_UseStreaming;
+
+  SizeValueType m_ConversionBufferSize;
+
+  bool m_UseMemoryMapping;
+  bool m_ReadOnlyMemoryMapping;
 private:
   ImageFileReader(const Self &); //purposely not implemented
   void operator=(const Self &);  //purposely not implemented
 
+  /** Check whether the ImageIO can read exactly this region. */
+  bool CanReadIORegion(const ImageIORegion & region);
+
+  /** Read the current IORegion in blocks of at most ConversionBufferSize
+   * bytes, and convert each of them into the output buffer. Returns false,
+   * without reading anything, when the ImageIO cannot read the blocks. */
+  bool ReadAndConvertInBlocks(size_t numberOfOutputPixels);
+
+  /** Read the current IORegion at the end of the output buffer and convert
+   * it in place. Returns false, without reading anything, when the file
+   * pixels do not fit or cannot be converted in place. */
+  bool ReadAndConvertInPlace(size_t numberOfOutputPixels);
+
+  /** Number of output buffer elements per pixel. */
+  size_t GetNumberOfOutputElementsPerPixel();
+
+  /** Check whether the file can be mapped into the output buffer, and find
+   * the location of its pixel data. */
+  bool CanMapFile();
+
+  /** Map the pixel data of the file into the output buffer. Returns false
+   * when the file cannot be mapped. */
+  bool MapFile();
+
+  /** Internal structure used for passing the buffers to the threads. */
+  struct ConvertThreadStruct {
+    Self *                 Reader;
+    char *                 InputData;
+    OutputImagePixelType * OutputData;
+    size_t                 NumberOfPixels;
+  };
+
+  /** Static function used as a "callback" by the MultiThreader. Each thread
+   * converts its share of the pixels. */
+  static ITK_THREAD_RETURN_TYPE ConvertBufferThreaderCallback(void *arg);
+
   std::string m_ExceptionMessage;
 
   // The region that the ImageIO class will return when we ask to
   // produce the requested region.
   ImageIORegion m_ActualIORegion;
+
+  // Where the pixels to map are stored, when m_MapFile is true.
+  bool          m_MapFile;
+  std::string   m_MappedFileName;
+  SizeValueType m_MappedFileOffset;
 };
 } //namespace ITK
 
@@ -26,6 +26,7 @@
 #include "itkVectorImage.h"
 
 #include "itksys/SystemTools.hxx"
+#include "vnl/vnl_math.h"
 #include <fstream>
 
 namespace itk
@@ -38,6 +39,11 @@ ImageFileReader< TOutputImage, ConvertPixelTraits >
   this->SetFileName("");
   m_UserSpecifiedImageIO = false;
   m_UseStreaming = true;
+  m_ConversionBufferSize = 16 * 1024 * 1024;
+  m_UseMemoryMapping = false;
+  m_ReadOnlyMemoryMapping = false;
+  m_MapFile = false;
+  m_MappedFileOffset = 0;
 }
 
 template< class TOutputImage, class ConvertPixelTraits >
@@ -63,6 +69,9 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
 
   os << indent << "UserSpecifiedImageIO flag: " << m_UserSpecifiedImageIO << "\n";
   os << indent << "m_UseStreaming: " << m_UseStreaming << "\n";
+  os << indent << "ConversionBufferSize: " << m_ConversionBufferSize << "\n";
+  os << indent << "UseMemoryMapping: " << m_UseMemoryMapping << "\n";
+  os << indent << "ReadOnlyMemoryMapping: " << m_ReadOnlyMemoryMapping << "\n";
 }
 
 template< class TOutputImage, class ConvertPixelTraits >
@@ -305,8 +314,8 @@ ImageFileReader< TOutputImage, ConvertPixelTraits >
   // Tell the IO if we should use streaming while reading
   m_ImageIO->SetUseStreamedReading(m_UseStreaming);
 
-  // Delegate to the ImageIO the computation of how the
-  // requested region must be enlarged.
+  // Delegate to the ImageIO the computation of how the requested
+  // region must be enlarged.
   m_ActualIORegion  =
     m_ImageIO->GenerateStreamableReadRegionFromRequestedRegion(ioRequestedRegion);
 
@@ -341,6 +350,16 @@ ImageFileReader< TOutputImage, ConvertPixelTraits >
     throw e;
     }
 
+  // A mapped file costs nothing until its pixels are accessed: map all of
+  // it. m_ActualIORegion remains the region read if the mapping fails.
+  m_MapFile = this->CanMapFile();
+  if ( m_MapFile )
+    {
+    itkDebugMacro (<< "RequestedRegion is set to the largest region to map the file");
+    out->SetRequestedRegion(largestRegion);
+    return;
+    }
+
   itkDebugMacro (
     << "RequestedRegion is set to:" << streamableRegion << " while the m_ActualIORegion is: " << m_ActualIORegion);
 
@@ -357,6 +376,22 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
                  << "Allocating the buffer with the EnlargedRequestedRegion \n"
                  << output->GetRequestedRegion() << "\n");
 
+  if ( m_MapFile )
+    {
+    if ( this->MapFile() )
+      {
+      return;
+      }
+
+    // Read only the region the ImageIO streams, as if mapping had not
+    // been attempted.
+    typedef ImageIORegionAdaptor< TOutputImage::ImageDimension > ImageIOAdaptor;
+    ImageRegionType streamableRegion;
+    ImageIOAdaptor::Convert( m_ActualIORegion, streamableRegion,
+                             output->GetLargestPossibleRegion().GetIndex() );
+    output->SetRequestedRegion(streamableRegion);
+    }
+
   // allocated the output image to the size of the enlarge requested region
   this->AllocateOutputs();
 
@@ -379,14 +414,34 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
   // Tell the ImageIO to read the file
   m_ImageIO->SetFileName( this->GetFileName().c_str() );
 
-  itkDebugMacro (<< "Setting imageIO IORegion to: " << m_ActualIORegion);
-  m_ImageIO->SetIORegion(m_ActualIORegion);
+  const size_t numberOfOutputPixels = output->GetBufferedRegion().GetNumberOfPixels();
+
+  // When the file has more dimensions than the image, only the first slice
+  // of the extra dimensions ends up in the output: read only this slice
+  // when the ImageIO can.
+  ImageIORegion ioRegion = m_ActualIORegion;
+  if ( ioRegion.GetNumberOfPixels() != numberOfOutputPixels )
+    {
+    ImageIORegion firstSliceRegion = ioRegion;
+    for ( unsigned int i = TOutputImage::ImageDimension; i < ioRegion.GetImageDimension(); ++i )
+      {
+      firstSliceRegion.SetSize(i, 1);
+      }
+    if ( firstSliceRegion.GetNumberOfPixels() == numberOfOutputPixels
+         && this->CanReadIORegion(firstSliceRegion) )
+      {
+      ioRegion = firstSliceRegion;
+      }
+    }
+
+  itkDebugMacro (<< "Setting imageIO IORegion to: " << ioRegion);
+  m_ImageIO->SetIORegion(ioRegion);
 
   char *loadBuffer = 0;
   // the size of the buffer is computed based on the actual number of
   // pixels to be read and the actual size of the pixels to be read
   // (as opposed to the sizes of the output)
-  size_t sizeOfActualIORegion = m_ActualIORegion.GetNumberOfPixels()
+  size_t sizeOfActualIORegion = ioRegion.GetNumberOfPixels()
                                 * ( m_ImageIO->GetComponentSize() * m_ImageIO->GetNumberOfComponents() );
 
   try
@@ -409,16 +464,20 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
                      << " m_ImageIO->NumComponents "
                      << m_ImageIO->GetNumberOfComponents() );
 
-      loadBuffer = new char[sizeOfActualIORegion];
-      m_ImageIO->Read( static_cast< void * >( loadBuffer ) );
-
-      // See note below as to why the buffered region is needed and
-      // not actualIOregion
-      this->DoConvertBuffer( static_cast< void * >( loadBuffer ),
-                             output->GetBufferedRegion().GetNumberOfPixels() );
+      if ( !this->ReadAndConvertInBlocks(numberOfOutputPixels)
+           && !this->ReadAndConvertInPlace(numberOfOutputPixels) )
+        {
+        loadBuffer = new char[sizeOfActualIORegion];
+        m_ImageIO->Read( static_cast< void * >( loadBuffer ) );
+
+        // See note below as to why the buffered region is needed and
+        // not actualIOregion
+        this->ConvertBuffer( static_cast< void * >( loadBuffer ),
+                             output->GetBufferPointer(),
+                             numberOfOutputPixels );
+        }
       }
-    else if ( m_ActualIORegion.GetNumberOfPixels() !=
-              output->GetBufferedRegion().GetNumberOfPixels() )
+    else if ( ioRegion.GetNumberOfPixels() != numberOfOutputPixels )
       {
       // NOTE:
       // for the number of pixels read and the number of pixels
@@ -427,17 +486,15 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
 
       itkDebugMacro(<< "Buffer required because file dimension is greater then image dimension");
 
-      OutputImagePixelType *outputBuffer = output->GetPixelContainer()->GetBufferPointer();
-
+      // Only the first pixels read are output: copy them into the output
+      // buffer rather than keeping the whole buffer read.
       loadBuffer = new char[sizeOfActualIORegion];
       m_ImageIO->Read( static_cast< void * >( loadBuffer ) );
 
-      // we use std::copy here as it should be optimized to memcpy for
-      // plain old data, but still is oop
+      const size_t numberOfElements = output->GetPixelContainer()->Size();
       std::copy(reinterpret_cast< const OutputImagePixelType * >( loadBuffer ),
-                reinterpret_cast< const OutputImagePixelType * >( loadBuffer )
-                +  output->GetBufferedRegion().GetNumberOfPixels(),
-                outputBuffer);
+                reinterpret_cast< const OutputImagePixelType * >( loadBuffer ) + numberOfElements,
+                output->GetBufferPointer());
       }
     else
       {
@@ -470,15 +527,342 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
     }
 }
 
+template< class TOutputImage, class ConvertPixelTraits >
+bool
+ImageFileReader< TOutputImage, ConvertPixelTraits >
+::CanReadIORegion(const ImageIORegion & region)
+{
+  if ( !m_ImageIO->CanStreamRead() )
+    {
+    return false;
+    }
+
+  // The ImageIO only reports which regions it can read when asked to
+  // stream.
+  const bool useStreamedReading = m_ImageIO->GetUseStreamedReading();
+  m_ImageIO->SetUseStreamedReading(true);
+  const bool canRead = ( m_ImageIO->GenerateStreamableReadRegionFromRequestedRegion(region) == region );
+  m_ImageIO->SetUseStreamedReading(useStreamedReading);
+  return canRead;
+}
+
+template< class TOutputImage, class ConvertPixelTraits >
+size_t
+ImageFileReader< TOutputImage, ConvertPixelTraits >
+::GetNumberOfOutputElementsPerPixel()
+{
+  // A VectorImage stores the components of a pixel as consecutive
+  // elements of the buffer.
+  if ( strcmp(this->GetOutput()->GetNameOfClass(), "VectorImage") == 0 )
+    {
+    return m_ImageIO->GetNumberOfComponents();
+    }
+  return 1;
+}
+
+template< class TOutputImage, class ConvertPixelTraits >
+bool
+ImageFileReader< TOutputImage, ConvertPixelTraits >
+::CanMapFile()
+{
+  if ( !m_UseMemoryMapping )
+    {
+    return false;
+    }
+
+  // The pixels of the file must be those of the output buffer. When the
+  // file has more dimensions than the image, the output holds its first
+  // pixels.
+  const ImageIOBase::IOComponentType ioType =
+    ImageIOBase::MapPixelType< typename ConvertPixelTraits::ComponentType >::CType;
+  if ( m_ImageIO->GetComponentType() != ioType
+       || m_ImageIO->GetNumberOfComponents() != ConvertPixelTraits::GetNumberOfComponents()
+       || sizeof( OutputImagePixelType ) * this->GetNumberOfOutputElementsPerPixel()
+       != m_ImageIO->GetComponentSize() * m_ImageIO->GetNumberOfComponents()
+       || static_cast< SizeValueType >( m_ImageIO->GetImageSizeInPixels() )
+       < this->GetOutput()->GetLargestPossibleRegion().GetNumberOfPixels() )
+    {
+    return false;
+    }
+
+  if ( !m_ImageIO->GetMappablePixelDataLocation(m_MappedFileName, m_MappedFileOffset) )
+    {
+    return false;
+    }
+
+  // The header of a MetaImage or NRRD file can end at any byte, and the
+  // mapped pixels are as aligned as their offset in the file. Misaligned
+  // pixels are read instead.
+  typedef typename TOutputImage::PixelContainer::Element ElementType;
+  return m_MappedFileOffset % m_ImageIO->GetComponentSize() == 0
+         && m_MappedFileOffset % PixelBufferAlignment< ElementType >::Value == 0;
+}
+
+template< class TOutputImage, class ConvertPixelTraits >
+bool
+ImageFileReader< TOutputImage, ConvertPixelTraits >
+::MapFile()
+{
+  typename TOutputImage::Pointer output = this->GetOutput();
+
+  typedef typename TOutputImage::PixelContainer PixelContainerType;
+  PixelContainerType *pixelContainer = output->GetPixelContainer();
+
+  // A buffer provided by someone else, for instance an ImageSeriesReader,
+  // must be filled.
+  if ( !pixelContainer->GetContainerManageMemory()
+       || output->GetRequestedRegion() != output->GetLargestPossibleRegion() )
+    {
+    return false;
+    }
+
+  const PixelBufferAllocator::PolicyType policy = m_ReadOnlyMemoryMapping
+                                                  ? PixelBufferAllocator::MappedReadOnlyPolicy
+                                                  : PixelBufferAllocator::MappedCopyOnWritePolicy;
+  const size_t numberOfElements =
+    output->GetLargestPossibleRegion().GetNumberOfPixels() * this->GetNumberOfOutputElementsPerPixel();
+  if ( !pixelContainer->MapFile(m_MappedFileName.c_str(), m_MappedFileOffset, numberOfElements, policy) )
+    {
+    itkDebugMacro(<< "Cannot map " << m_MappedFileName << ", reading it instead");
+    return false;
+    }
+
+  output->SetBufferedRegion( output->GetLargestPossibleRegion() );
+  itkDebugMacro(<< "Mapped " << m_MappedFileName << " from offset " << m_MappedFileOffset);
+  return true;
+}
+
+template< class TOutputImage, class ConvertPixelTraits >
+bool
+ImageFileReader< TOutputImage, ConvertPixelTraits >
+::ReadAndConvertInBlocks(size_t numberOfOutputPixels)
+{
+  const ImageIORegion ioRegion = m_ImageIO->GetIORegion();
+  const size_t        inputPixelSize = m_ImageIO->GetComponentSize() * m_ImageIO->GetNumberOfComponents();
+
+  if ( ioRegion.GetNumberOfPixels() == 0 )
+    {
+    return false;
+    }
+
+  // The blocks are slabs along the last dimension larger than one, so that
+  // each one is a contiguous part of the buffer.
+  int blockDimension = ioRegion.GetImageDimension() - 1;
+  while ( blockDimension > 0 && ioRegion.GetSize(blockDimension) == 1 )
+    {
+    --blockDimension;
+    }
+  if ( blockDimension < 0 )
+    {
+    return false;
+    }
+
+  size_t numberOfPixelsPerSlice = 1;
+  for ( int i = 0; i < blockDimension; ++i )
+    {
+    numberOfPixelsPerSlice *= ioRegion.GetSize(i);
+    }
+  const size_t numberOfSlices = ioRegion.GetSize(blockDimension);
+  size_t       numberOfSlicesPerBlock = m_ConversionBufferSize / ( numberOfPixelsPerSlice * inputPixelSize );
+  if ( numberOfSlicesPerBlock == 0 )
+    {
+    numberOfSlicesPerBlock = 1;
+    }
+  if ( numberOfSlicesPerBlock >= numberOfSlices )
+    {
+    // A single block is a plain read of the whole region.
+    return false;
+    }
+
+  ImageIORegion blockRegion = ioRegion;
+  for ( size_t slice = 0; slice < numberOfSlices; slice += numberOfSlicesPerBlock )
+    {
+    blockRegion.SetIndex( blockDimension, ioRegion.GetIndex(blockDimension) + slice );
+    blockRegion.SetSize( blockDimension, vnl_math_min(numberOfSlicesPerBlock, numberOfSlices - slice) );
+    if ( !this->CanReadIORegion(blockRegion) )
+      {
+      return false;
+      }
+    }
+
+  itkDebugMacro(<< "Reading and converting " << numberOfSlices << " slices by blocks of "
+                << numberOfSlicesPerBlock);
+
+  std::vector< char >   blockBuffer(numberOfSlicesPerBlock * numberOfPixelsPerSlice * inputPixelSize);
+  OutputImagePixelType *outputData = this->GetOutput()->GetBufferPointer();
+  const size_t          numberOfElementsPerPixel = this->GetNumberOfOutputElementsPerPixel();
+
+  size_t numberOfPixelsConverted = 0;
+  for ( size_t slice = 0; slice < numberOfSlices && numberOfPixelsConverted < numberOfOutputPixels;
+        slice += numberOfSlicesPerBlock )
+    {
+    blockRegion.SetIndex( blockDimension, ioRegion.GetIndex(blockDimension) + slice );
+    blockRegion.SetSize( blockDimension, vnl_math_min(numberOfSlicesPerBlock, numberOfSlices - slice) );
+    m_ImageIO->SetIORegion(blockRegion);
+    m_ImageIO->Read( &blockBuffer[0] );
+
+    // See the note in GenerateData(): only the first pixels read go to
+    // the output when the file has more dimensions than the image.
+    const size_t numberOfPixels = vnl_math_min( static_cast< size_t >( blockRegion.GetNumberOfPixels() ),
+                                                numberOfOutputPixels - numberOfPixelsConverted );
+    this->ConvertBuffer( &blockBuffer[0],
+                         outputData + numberOfPixelsConverted * numberOfElementsPerPixel,
+                         numberOfPixels );
+    numberOfPixelsConverted += numberOfPixels;
+    }
+  m_ImageIO->SetIORegion(ioRegion);
+
+  return true;
+}
+
+template< class TOutputImage, class ConvertPixelTraits >
+bool
+ImageFileReader< TOutputImage, ConvertPixelTraits >
+::ReadAndConvertInPlace(size_t numberOfOutputPixels)
+{
+  typedef typename ConvertPixelTraits::ComponentType OutputComponentType;
+
+  const size_t numberOfElementsPerPixel = this->GetNumberOfOutputElementsPerPixel();
+  const bool   isVectorImage = ( strcmp(this->GetOutput()->GetNameOfClass(), "VectorImage") == 0 );
+
+  // Each input component must be read before the output component written
+  // over it: this holds when the components are converted one to one, in
+  // order, into components at least as large. This excludes the
+  // conversions that combine components, and the tensors, which are
+  // reordered.
+  const unsigned int numberOfComponents = m_ImageIO->GetNumberOfComponents();
+  if ( m_ImageIO->GetIORegion().GetNumberOfPixels() != numberOfOutputPixels
+       || sizeof( OutputComponentType ) < m_ImageIO->GetComponentSize()
+       || ( !isVectorImage
+            && ( numberOfComponents != ConvertPixelTraits::GetNumberOfComponents()
+                 || numberOfComponents > 4
+                 || sizeof( OutputImagePixelType ) != numberOfComponents * sizeof( OutputComponentType ) ) ) )
+    {
+    return false;
+    }
+
+  const size_t inputPixelSize = m_ImageIO->GetComponentSize() * numberOfComponents;
+  const size_t outputPixelSize = sizeof( OutputImagePixelType ) * numberOfElementsPerPixel;
+  const size_t outputOffset = numberOfOutputPixels * ( outputPixelSize - inputPixelSize );
+
+  itkDebugMacro(<< "Converting the buffer in place");
+
+  // Read the file pixels at the end of the output buffer.
+  OutputImagePixelType *outputData = this->GetOutput()->GetBufferPointer();
+  char *                inputData = reinterpret_cast< char * >( outputData ) + outputOffset;
+  m_ImageIO->Read(inputData);
+
+  // The outputs of pixels [begin, end) can be written in parallel when they
+  // end before the first input not yet converted, the one of pixel begin.
+  // That is true for the whole buffer when the pixel sizes are the same,
+  // and otherwise for a constant fraction of the pixels left, until too few
+  // are left to be worth the threads.
+  const size_t minimumNumberOfPixelsPerBlock = 65536;
+  size_t       begin = 0;
+  while ( begin < numberOfOutputPixels )
+    {
+    size_t end = numberOfOutputPixels;
+    if ( outputPixelSize != inputPixelSize )
+      {
+      end = ( outputOffset + begin * inputPixelSize ) / outputPixelSize;
+      if ( end < begin + minimumNumberOfPixelsPerBlock )
+        {
+        // convert the rest serially, in order
+        this->DoConvertBuffer( inputData + begin * inputPixelSize,
+                               outputData + begin * numberOfElementsPerPixel,
+                               numberOfOutputPixels - begin );
+        break;
+        }
+      }
+    this->ConvertBuffer( inputData + begin * inputPixelSize,
+                         outputData + begin * numberOfElementsPerPixel,
+                         end - begin );
+    begin = end;
+    }
+
+  return true;
+}
+
+template< class TOutputImage, class ConvertPixelTraits >
+void
+ImageFileReader< TOutputImage, ConvertPixelTraits >
+::ConvertBuffer(void *inputData, OutputImagePixelType *outputData, size_t numberOfPixels)
+{
+  // Below this number of pixels per thread, starting the threads costs
+  // more than it saves.
+  const size_t minimumNumberOfPixelsPerThread = 65536;
+
+  ThreadIdType numberOfThreads = this->GetNumberOfThreads();
+  if ( numberOfThreads > numberOfPixels / minimumNumberOfPixelsPerThread )
+    {
+    numberOfThreads = static_cast< ThreadIdType >( numberOfPixels / minimumNumberOfPixelsPerThread );
+    }
+
+  if ( numberOfThreads <= 1 )
+    {
+    this->DoConvertBuffer(inputData, outputData, numberOfPixels);
+    return;
+    }
+
+  // Report an unsupported conversion here rather than from the threads.
+  this->DoConvertBuffer(inputData, outputData, 0);
+
+  ConvertThreadStruct str;
+  str.Reader = this;
+  str.InputData = static_cast< char * >( inputData );
+  str.OutputData = outputData;
+  str.NumberOfPixels = numberOfPixels;
+
+  this->GetMultiThreader()->SetNumberOfThreads(numberOfThreads);
+  this->GetMultiThreader()->SetSingleMethod(this->ConvertBufferThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+}
+
+template< class TOutputImage, class ConvertPixelTraits >
+ITK_THREAD_RETURN_TYPE
+ImageFileReader< TOutputImage, ConvertPixelTraits >
+::ConvertBufferThreaderCallback(void *arg)
+{
+  ConvertThreadStruct *str;
+  ThreadIdType         threadId, threadCount;
+
+  threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  threadCount = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->NumberOfThreads;
+
+  str = (ConvertThreadStruct *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  const size_t begin = str->NumberOfPixels * threadId / threadCount;
+  const size_t end = str->NumberOfPixels * ( threadId + 1 ) / threadCount;
+
+  const size_t inputPixelSize = str->Reader->m_ImageIO->GetComponentSize()
+                                * str->Reader->m_ImageIO->GetNumberOfComponents();
+  const size_t numberOfElementsPerPixel = str->Reader->GetNumberOfOutputElementsPerPixel();
+
+  str->Reader->DoConvertBuffer( str->InputData + begin * inputPixelSize,
+                                str->OutputData + begin * numberOfElementsPerPixel,
+                                end - begin );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TOutputImage, class ConvertPixelTraits >
+void
+ImageFileReader< TOutputImage, ConvertPixelTraits >
+::DoConvertBuffer(void *inputData,
+                  size_t numberOfPixels)
+{
+  this->DoConvertBuffer( inputData,
+                         this->GetOutput()->GetPixelContainer()->GetBufferPointer(),
+                         numberOfPixels );
+}
+
 template< class TOutputImage, class ConvertPixelTraits >
 void
 ImageFileReader< TOutputImage, ConvertPixelTraits >
 ::DoConvertBuffer(void *inputData,
+                  OutputImagePixelType *outputData,
                   size_t numberOfPixels)
 {
-  // get the pointer to the destination buffer
-  OutputImagePixelType *outputData =
-    this->GetOutput()->GetPixelContainer()->GetBufferPointer();
   bool isVectorImage(strcmp(this->GetOutput()->GetNameOfClass(),
                             "VectorImage") == 0);
   // TODO:
@@ -179,6 +179,13 @@ public:
   itkGetConstReferenceMacro(UseCompression, bool);
   itkBooleanMacro(UseCompression);
 
+  /** Set the parallel block compression On or Off. This only matters when
+   * UseCompression is on, and for the ImageIOs that support it. \sa
+   * ImageIOBase::SetUseParallelCompression() */
+  itkSetMacro(UseParallelCompression, bool);
+  itkGetConstReferenceMacro(UseParallelCompression, bool);
+  itkBooleanMacro(UseParallelCompression);
+
   /** By default the MetaDataDictionary is taken from the input image and
    *  passed to the ImageIO. In some cases, however, a user may prefer to
    *  introduce her/his own MetaDataDictionary. This is often the case of
@@ -213,6 +220,7 @@ private:
   bool m_FactorySpecifiedImageIO;           //track whether the factory
                                             //  mechanism set the ImageIO
   bool m_UseCompression;
+  bool m_UseParallelCompression;
   bool m_UseInputMetaDataDictionary;        // whether to use the
                                             // MetaDataDictionary from the
                                             // input or not.
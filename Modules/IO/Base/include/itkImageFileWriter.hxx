@@ -43,6 +43,7 @@ ImageFileWriter< TInputImage >
   m_PasteIORegion(TInputImage::ImageDimension)
 {
   m_UseCompression = false;
+  m_UseParallelCompression = false;
   m_UseInputMetaDataDictionary = true;
   m_FactorySpecifiedImageIO = false;
   m_UserSpecifiedIORegion = false;
@@ -226,6 +227,7 @@ ImageFileWriter< TInputImage >
 
   // configure compression
   m_ImageIO->SetUseCompression(m_UseCompression);
+  m_ImageIO->SetUseParallelCompression(m_UseParallelCompression);
 
   // configure meta dictionary
   if ( m_UseInputMetaDataDictionary )
@@ -449,6 +451,15 @@ ImageFileWriter< TInputImage >
     os << indent << "Compression: Off\n";
     }
 
+  if ( m_UseParallelCompression )
+    {
+    os << indent << "ParallelCompression: On\n";
+    }
+  else
+    {
+    os << indent << "ParallelCompression: Off\n";
+    }
+
   if ( m_UseInputMetaDataDictionary )
     {
     os << indent << "UseInputMetaDataDictionary: On\n";
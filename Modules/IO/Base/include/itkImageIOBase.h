@@ -192,6 +192,21 @@ public:
   itkGetConstMacro(UseCompression, bool);
   itkBooleanMacro(UseCompression);
 
+  /** Set/Get a boolean to compress the data in independent blocks that
+   * are deflated in parallel, when UseCompression is on. The ImageIOs that
+   * support it also record where the blocks are, so that a part of the
+   * data can be read without decompressing what precedes it. Other
+   * ImageIOs ignore it. */
+  itkSetMacro(UseParallelCompression, bool);
+  itkGetConstMacro(UseParallelCompression, bool);
+  itkBooleanMacro(UseParallelCompression);
+
+  /** Set/Get the number of uncompressed bytes per block when
+   * UseParallelCompression is on. An ImageIO may use larger blocks to
+   * bound the size of its index. */
+  itkSetMacro(CompressionBlockSize, SizeValueType);
+  itkGetConstMacro(CompressionBlockSize, SizeValueType);
+
   /** Set/Get a boolean to use streaming while reading or not. */
   itkSetMacro(UseStreamedReading, bool);
   itkGetConstMacro(UseStreamedReading, bool);
@@ -322,6 +337,20 @@ public:
   /** Reads the data from disk into the memory buffer provided. */
   virtual void Read(void *buffer) = 0;
 
+  /** Get where the pixel data of the file whose information was read are
+   * stored, when Read() would copy them unchanged: the whole image is
+   * stored contiguously, uncompressed, in the byte order of this machine
+   * and with the component type and the number of components reported by
+   * this ImageIO. dataFileName is then the file that holds the data and
+   * offset the position of their first byte in it, so that the file can be
+   * mapped in memory instead of being read. Returns false otherwise, which
+   * is the default. */
+  virtual bool GetMappablePixelDataLocation(std::string & itkNotUsed(dataFileName),
+                                            SizeValueType & itkNotUsed(offset))
+  {
+    return false;
+  }
+
   /*-------- This part of the interfaces deals with writing data ----- */
 
   /** Determine the file type. Returns true if this ImageIO can read the
@@ -550,6 +579,12 @@ protected:
   /** Should we compress the data? */
   bool m_UseCompression;
 
+  /** Should the data be compressed in blocks, in parallel? */
+  bool m_UseParallelCompression;
+
+  /** Uncompressed size of the blocks compressed in parallel. */
+  SizeValueType m_CompressionBlockSize;
+
   /** Should we use streaming for reading */
   bool m_UseStreamedReading;
 
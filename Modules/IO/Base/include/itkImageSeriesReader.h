@@ -23,6 +23,7 @@
 #include <string>
 #include "itkMetaDataDictionary.h"
 #include "itkImageFileReader.h"
+#include "itkSimpleFastMutexLock.h"
 
 namespace itk
 {
@@ -34,6 +35,19 @@ namespace itk
  * the files, but the image data must have the same Size for all
  * dimensions.
  *
+ * When UseParallelRead is on, the slices are read concurrently by up to
+ * NumberOfThreads workers, each claiming the next unread slice until none
+ * is left. Each worker reads with its own ImageIO, created by the
+ * ImageIOFactory, directly into the place of the slice in the output
+ * buffer whenever the file pixels need no conversion and the ImageIO can
+ * read exactly the requested slice region; other slices go through an
+ * ImageFileReader as in the serial path. The output image and
+ * MetaDataDictionaryArray are identical to the ones of the serial path.
+ *
+ * An ImageIO set with SetImageIO() may carry settings that cannot be
+ * copied to other instances: the slices are then read serially with it,
+ * even when UseParallelRead is on.
+ *
  * \sa GDCMSeriesFileNames
  * \sa NumericSeriesFileNames
  * \ingroup IOFilters
@@ -153,9 +167,17 @@ public:
   itkSetMacro(UseStreaming, bool);
   itkGetConstReferenceMacro(UseStreaming, bool);
   itkBooleanMacro(UseStreaming);
+
+  /** Set/Get whether the slices are read concurrently, by up to
+   * NumberOfThreads workers. Off by default. Ignored when an ImageIO is
+   * set with SetImageIO(). */
+  itkSetMacro(UseParallelRead, bool);
+  itkGetConstMacro(UseParallelRead, bool);
+  itkBooleanMacro(UseParallelRead);
 protected:
   ImageSeriesReader():m_ImageIO(0), m_ReverseOrder(false),
-    m_UseStreaming(true), m_MetaDataDictionaryArrayUpdate(true) {}
+    m_UseStreaming(true), m_UseParallelRead(false),
+    m_MetaDataDictionaryArrayUpdate(true) {}
   ~ImageSeriesReader();
   void PrintSelf(std::ostream & os, Indent indent) const;
 
@@ -183,6 +205,8 @@ protected:
   DictionaryArrayType m_MetaDataDictionaryArray;
 
   bool m_UseStreaming;
+
+  bool m_UseParallelRead;
 private:
   ImageSeriesReader(const Self &); //purposely not implemented
   void operator=(const Self &);    //purposely not implemented
@@ -191,6 +215,47 @@ private:
 
   int ComputeMovingDimensionIndex(ReaderType *reader);
 
+  /** State shared by the slice reads of one execution of GenerateData().
+   * NextSlice, NumberOfSlicesRead, the abort flag and the exception are
+   * protected by Lock. */
+  struct ReadSlicesStruct {
+    Self *              Reader;
+    TOutputImage *      Output;
+    ImageRegionType     RequestedRegion;
+    ImageRegionType     SliceRegionToRequest;
+    SizeType            ValidSize;
+    bool                NeedToUpdateMetaDataDictionaryArray;
+    int                 NumberOfSlices;
+    int                 NumberOfSlicesToRead;
+    ThreadIdType        NumberOfThreadsPerSlice;
+    std::vector< ImageIOBase::Pointer > ImageIOs;
+    int                 NextSlice;
+    int                 NumberOfSlicesRead;
+    bool                Aborted;
+    bool                ExceptionOccurred;
+    ExceptionObject     Exception;
+    SimpleFastMutexLock Lock;
+  };
+
+  /** Read the slice into its place in the output buffer, and store its
+   * MetaDataDictionary in the array when needed. imageIO may be null to
+   * use the factory mechanism. Returns true if pixels were read. */
+  bool ReadSlice(const ReadSlicesStruct & str, int slice, ImageIOBase *imageIO);
+
+  /** Read the slice with imageIO directly into its place in the output
+   * buffer, and store its MetaDataDictionary in the array when needed.
+   * imageIO is replaced by one created by the factory when it cannot read
+   * the file. Returns false, without writing anything, when the slice
+   * cannot be read this way; otherwise sliceRead tells whether pixels
+   * were read. */
+  bool ReadSliceWithImageIO(const ReadSlicesStruct & str, int slice,
+                            ImageIOBase::Pointer & imageIO, bool & sliceRead);
+
+  /** Static function used as a "callback" by the MultiThreader when
+   * UseParallelRead is on. Each thread reads the slices it claims until
+   * all the slices have been read. */
+  static ITK_THREAD_RETURN_TYPE ReadSlicesThreaderCallback(void *arg);
+
   /** Modified time of the MetaDataDictionaryArray */
   TimeStamp m_MetaDataDictionaryArrayMTime;
 
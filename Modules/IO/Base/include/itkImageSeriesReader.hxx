@@ -26,6 +26,7 @@
 #include "vnl/vnl_math.h"
 #include "itkProgressReporter.h"
 #include "itkMetaDataObject.h"
+#include "itkImageIOFactory.h"
 
 namespace itk
 {
@@ -54,6 +55,7 @@ void ImageSeriesReader< TOutputImage >
 
   os << indent << "ReverseOrder: " << m_ReverseOrder << std::endl;
   os << indent << "UseStreaming: " << m_UseStreaming << std::endl;
+  os << indent << "UseParallelRead: " << m_UseParallelRead << std::endl;
 
   if ( m_ImageIO )
     {
@@ -281,12 +283,14 @@ void ImageSeriesReader< TOutputImage >
 {
   TOutputImage *output = this->GetOutput();
 
-  ImageRegionType requestedRegion = output->GetRequestedRegion();
-  ImageRegionType largestRegion = output->GetLargestPossibleRegion();
-  ImageRegionType sliceRegionToRequest = output->GetRequestedRegion();
+  ReadSlicesStruct str;
+  str.Reader = this;
+  str.Output = output;
+  str.RequestedRegion = output->GetRequestedRegion();
+  str.SliceRegionToRequest = output->GetRequestedRegion();
 
   // Each file must have the same size.
-  SizeType validSize = largestRegion.GetSize();
+  str.ValidSize = output->GetLargestPossibleRegion().GetSize();
 
   // If more than one file is being read, then the input dimension
   // will be less than the output dimension.  In this case, set
@@ -295,155 +299,411 @@ void ImageSeriesReader< TOutputImage >
   // not be done because it will lower the dimension of the output image.
   if ( TOutputImage::ImageDimension != this->m_NumberOfDimensionsInImage )
     {
-    validSize[this->m_NumberOfDimensionsInImage] = 1;
-    sliceRegionToRequest.SetSize(this->m_NumberOfDimensionsInImage, 1);
-    sliceRegionToRequest.SetIndex(this->m_NumberOfDimensionsInImage, 0);
+    str.ValidSize[this->m_NumberOfDimensionsInImage] = 1;
+    str.SliceRegionToRequest.SetSize(this->m_NumberOfDimensionsInImage, 1);
+    str.SliceRegionToRequest.SetIndex(this->m_NumberOfDimensionsInImage, 0);
     }
 
   // Allocate the output buffer
-  output->SetBufferedRegion(requestedRegion);
+  output->SetBufferedRegion(str.RequestedRegion);
   output->Allocate();
 
-  // progress reported on a per slice basis
-  ProgressReporter progress(this, 0,
-                            requestedRegion.GetSize(TOutputImage::ImageDimension-1),
-                            100);
-
   // We utilize the modified time of the output information to
   // know when the meta array needs to be updated, when the output
   // information is updated so should the meta array.
   // Each file can not be read in the UpdateOutputInformation methods
   // due to the poor performance of reading each file a second time there.
-  bool needToUpdateMetaDataDictionaryArray =
+  str.NeedToUpdateMetaDataDictionaryArray =
     this->m_OutputInformationMTime > this->m_MetaDataDictionaryArrayMTime
     && m_MetaDataDictionaryArrayUpdate;
 
-  typename  TOutputImage::InternalPixelType *outputBuffer = output->GetBufferPointer();
-  IndexType                           sliceStartIndex = requestedRegion.GetIndex();
-  const int                           numberOfFiles = static_cast< int >( m_FileNames.size() );
+  str.NumberOfSlices = static_cast< int >( m_FileNames.size() );
+  str.NumberOfSlicesToRead = str.RequestedRegion.GetSize(TOutputImage::ImageDimension - 1);
+
+  // Each slice stores its dictionary at its own index, so that the slices
+  // can be read in any order.
+  if ( str.NeedToUpdateMetaDataDictionaryArray )
+    {
+    for ( unsigned int i = 0; i < m_MetaDataDictionaryArray.size(); i++ )
+      {
+      delete m_MetaDataDictionaryArray[i];
+      }
+    m_MetaDataDictionaryArray.assign(m_FileNames.size(), 0);
+    }
 
-  for ( int i = 0; i != numberOfFiles; ++i )
+  // An ImageIO set by the user cannot be shared by the workers, and its
+  // settings cannot be copied to other instances: read serially with it.
+  if ( m_UseParallelRead && !m_ImageIO
+       && this->GetNumberOfThreads() > 1 && str.NumberOfSlices > 1
+       && TOutputImage::ImageDimension != this->m_NumberOfDimensionsInImage )
     {
-    if ( TOutputImage::ImageDimension != this->m_NumberOfDimensionsInImage )
+    ThreadIdType numberOfWorkers = this->GetNumberOfThreads();
+    if ( numberOfWorkers > static_cast< ThreadIdType >( str.NumberOfSlices ) )
       {
-      sliceStartIndex[this->m_NumberOfDimensionsInImage] = i;
+      numberOfWorkers = str.NumberOfSlices;
       }
 
-    const bool insideRequestedRegion = requestedRegion.IsInside(sliceStartIndex);
-    const int  iFileName = ( m_ReverseOrder ? numberOfFiles - i - 1 : i );
+    // An ImageIO is not thread safe: each worker creates its own instance.
+    // The first one is created here, so that the factories are registered
+    // before the workers start.
+    str.ImageIOs.resize(numberOfWorkers);
+    str.ImageIOs[0] = ImageIOFactory::CreateImageIO( m_FileNames[0].c_str(), ImageIOFactory::ReadMode );
 
-    // check if we need this slice
-    if ( !insideRequestedRegion && !needToUpdateMetaDataDictionaryArray )
+    // The slices are already read in parallel.
+    str.NumberOfThreadsPerSlice = 1;
+    str.NextSlice = 1; // the first thread reads slice 0
+    str.NumberOfSlicesRead = 0;
+    str.Aborted = false;
+    str.ExceptionOccurred = false;
+
+    this->GetMultiThreader()->SetNumberOfThreads(numberOfWorkers);
+    this->GetMultiThreader()->SetSingleMethod(this->ReadSlicesThreaderCallback, &str);
+    this->GetMultiThreader()->SingleMethodExecute();
+
+    if ( str.ExceptionOccurred )
+      {
+      throw str.Exception;
+      }
+    // The abort may also be requested when the first thread reports the
+    // last slice.
+    if ( str.Aborted || this->GetAbortGenerateData() )
       {
-      continue;
+      ProcessAborted e(__FILE__, __LINE__);
+      e.SetDescription( "Object " + std::string( this->GetNameOfClass() ) + ": AbortGenerateDataOn" );
+      throw e;
       }
+    }
+  else
+    {
+    str.NumberOfThreadsPerSlice = this->GetNumberOfThreads();
 
-    // configure reader
-    typename ReaderType::Pointer reader = ReaderType::New();
-    reader->SetFileName( m_FileNames[iFileName].c_str() );
+    // progress reported on a per slice basis
+    ProgressReporter progress(this, 0, str.NumberOfSlicesToRead, 100);
 
-    TOutputImage * readerOutput = reader->GetOutput();
+    for ( int i = 0; i != str.NumberOfSlices; ++i )
+      {
+      if ( this->ReadSlice(str, i, m_ImageIO) )
+        {
+        // report progress for read slices
+        progress.CompletedPixel();
+        }
+      }
+    }
 
-    if ( m_ImageIO )
+  // update the time if we modified the meta array
+  if ( str.NeedToUpdateMetaDataDictionaryArray )
+    {
+    m_MetaDataDictionaryArrayMTime.Modified();
+    }
+}
+
+template< class TOutputImage >
+bool ImageSeriesReader< TOutputImage >
+::ReadSlice(const ReadSlicesStruct & str, int slice, ImageIOBase *imageIO)
+{
+  TOutputImage *output = str.Output;
+
+  const ImageRegionType & requestedRegion = str.RequestedRegion;
+  const ImageRegionType & sliceRegionToRequest = str.SliceRegionToRequest;
+
+  IndexType sliceStartIndex = requestedRegion.GetIndex();
+  if ( TOutputImage::ImageDimension != this->m_NumberOfDimensionsInImage )
+    {
+    sliceStartIndex[this->m_NumberOfDimensionsInImage] = slice;
+    }
+
+  const bool insideRequestedRegion = requestedRegion.IsInside(sliceStartIndex);
+  const int  iFileName = ( m_ReverseOrder ? str.NumberOfSlices - slice - 1 : slice );
+
+  // check if we need this slice
+  if ( !insideRequestedRegion && !str.NeedToUpdateMetaDataDictionaryArray )
+    {
+    return false;
+    }
+
+  // configure reader
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( m_FileNames[iFileName].c_str() );
+
+  TOutputImage * readerOutput = reader->GetOutput();
+
+  if ( imageIO )
+    {
+    reader->SetImageIO(imageIO);
+    }
+  reader->SetUseStreaming(m_UseStreaming);
+  reader->SetNumberOfThreads(str.NumberOfThreadsPerSlice);
+  readerOutput->SetRequestedRegion(sliceRegionToRequest);
+
+  // update the data or info
+  if ( !insideRequestedRegion )
+    {
+    reader->UpdateOutputInformation();
+    }
+  else
+    {
+    // read the meta data information
+    readerOutput->UpdateOutputInformation();
+
+    // propagate the requested region to determin what the region
+    // will actually be read
+    readerOutput->PropagateRequestedRegion();
+
+    // check that the size of each slice is the same
+    if ( readerOutput->GetLargestPossibleRegion().GetSize() != str.ValidSize )
       {
-      reader->SetImageIO(m_ImageIO);
+      itkExceptionMacro( << "Size mismatch! The size of  "
+                         << m_FileNames[iFileName].c_str()
+                         << " is "
+                         << readerOutput->GetLargestPossibleRegion().GetSize()
+                         << " and does not match the required size "
+                         << str.ValidSize
+                         << " from file "
+                         << m_FileNames[m_ReverseOrder ? m_FileNames.size() - 1 : 0].c_str() );
       }
-    reader->SetUseStreaming(m_UseStreaming);
-    readerOutput->SetRequestedRegion(sliceRegionToRequest);
 
-    // update the data or info
-    if ( !insideRequestedRegion )
+    // get the size of the region to be read
+    SizeType readSize = readerOutput->GetRequestedRegion().GetSize();
+
+    if( readSize == sliceRegionToRequest.GetSize() )
       {
-      reader->UpdateOutputInformation();
+      // if the buffer of the ImageReader is going to match that of
+      // ourselves, then set the ImageReader's buffer to a section
+      // of ours
+
+      const size_t  numberOfPixelsInSlice = sliceRegionToRequest.GetNumberOfPixels();
+
+      typedef typename TOutputImage::AccessorFunctorType AccessorFunctorType;
+      const size_t      numberOfInternalComponentsPerPixel =  AccessorFunctorType::GetVectorLength( output );
+
+      const ptrdiff_t   sliceOffset = ( TOutputImage::ImageDimension != this->m_NumberOfDimensionsInImage ) ?
+        ( slice - requestedRegion.GetIndex(this->m_NumberOfDimensionsInImage)) : 0;
+      const ptrdiff_t  numberOfPixelComponentsUpToSlice =  numberOfPixelsInSlice * numberOfInternalComponentsPerPixel * sliceOffset;
+      const bool       bufferDelete = false;
+
+
+      typename  TOutputImage::InternalPixelType * outputSliceBuffer =
+        output->GetBufferPointer() + numberOfPixelComponentsUpToSlice;
+
+      readerOutput->GetPixelContainer()->SetImportPointer( outputSliceBuffer, numberOfPixelsInSlice, bufferDelete );
+      readerOutput->UpdateOutputData();
       }
     else
       {
-      // read the meta data information
-      readerOutput->UpdateOutputInformation();
+      // the read region isn't going to match exactly what we need
+      // to update to buffer created by the reader, then copy
+
+      reader->Update();
 
-      // propagate the requested region to determin what the region
-      // will actually be read
-      readerOutput->PropagateRequestedRegion();
+      // output of buffer copy
+      ImageRegionType outRegion = requestedRegion;
+      outRegion.SetIndex( sliceStartIndex );
 
-      // check that the size of each slice is the same
-      if ( readerOutput->GetLargestPossibleRegion().GetSize() != validSize )
+      // set the moving dimension to a size of 1
+      if ( TOutputImage::ImageDimension != this->m_NumberOfDimensionsInImage )
         {
-        itkExceptionMacro( << "Size mismatch! The size of  "
-                           << m_FileNames[iFileName].c_str()
-                           << " is "
-                           << readerOutput->GetLargestPossibleRegion().GetSize()
-                           << " and does not match the required size "
-                           << validSize
-                           << " from file "
-                           << m_FileNames[m_ReverseOrder ? m_FileNames.size() - 1 : 0].c_str() );
+        outRegion.SetSize(this->m_NumberOfDimensionsInImage, 1);
         }
 
-      // get the size of the region to be read
-      SizeType readSize = readerOutput->GetRequestedRegion().GetSize();
+      ImageAlgorithm::Copy( readerOutput, output, sliceRegionToRequest, outRegion );
+      }
+    } // end !insidedRequestedRegion
 
-      if( readSize == sliceRegionToRequest.GetSize() )
-        {
-        // if the buffer of the ImageReader is going to match that of
-        // ourselves, then set the ImageReader's buffer to a section
-        // of ours
+  // Deep copy the MetaDataDictionary into the array
+  if ( reader->GetImageIO() &&  str.NeedToUpdateMetaDataDictionaryArray )
+    {
+    m_MetaDataDictionaryArray[slice] = new DictionaryType( reader->GetImageIO()->GetMetaDataDictionary() );
+    }
+
+  return insideRequestedRegion;
+}
+
+template< class TOutputImage >
+bool ImageSeriesReader< TOutputImage >
+::ReadSliceWithImageIO(const ReadSlicesStruct & str, int slice,
+                       ImageIOBase::Pointer & imageIO, bool & sliceRead)
+{
+  TOutputImage *output = str.Output;
+
+  const ImageRegionType & requestedRegion = str.RequestedRegion;
+  const ImageRegionType & sliceRegionToRequest = str.SliceRegionToRequest;
 
-        const size_t  numberOfPixelsInSlice = sliceRegionToRequest.GetNumberOfPixels();
+  IndexType sliceStartIndex = requestedRegion.GetIndex();
+  sliceStartIndex[this->m_NumberOfDimensionsInImage] = slice;
 
-        typedef typename TOutputImage::AccessorFunctorType AccessorFunctorType;
-        const size_t      numberOfInternalComponentsPerPixel =  AccessorFunctorType::GetVectorLength( output );
+  const bool insideRequestedRegion = requestedRegion.IsInside(sliceStartIndex);
+  const int  iFileName = ( m_ReverseOrder ? str.NumberOfSlices - slice - 1 : slice );
+
+  // check if we need this slice
+  if ( !insideRequestedRegion && !str.NeedToUpdateMetaDataDictionaryArray )
+    {
+    sliceRead = false;
+    return true;
+    }
+
+  const char *fileName = m_FileNames[iFileName].c_str();
+  if ( !imageIO || !imageIO->CanReadFile(fileName) )
+    {
+    imageIO = ImageIOFactory::CreateImageIO(fileName, ImageIOFactory::ReadMode);
+    if ( !imageIO )
+      {
+      // let the ImageFileReader report the error
+      return false;
+      }
+    }
 
-        const ptrdiff_t   sliceOffset = ( TOutputImage::ImageDimension != this->m_NumberOfDimensionsInImage ) ?
-          ( i - requestedRegion.GetIndex(this->m_NumberOfDimensionsInImage)) : 0;
-        const ptrdiff_t  numberOfPixelComponentsUpToSlice =  numberOfPixelsInSlice * numberOfInternalComponentsPerPixel * sliceOffset;
-        const bool       bufferDelete = false;
+  imageIO->SetFileName(fileName);
+  imageIO->ReadImageInformation();
 
+  if ( insideRequestedRegion )
+    {
+    // The file pixels must be those of the output buffer, and the slice
+    // must have the expected size; otherwise the ImageFileReader converts
+    // them or reports the error.
+    typedef DefaultConvertPixelTraits< typename TOutputImage::IOPixelType > ConvertPixelTraits;
+    typedef typename TOutputImage::AccessorFunctorType                      AccessorFunctorType;
+    const size_t numberOfInternalComponentsPerPixel = AccessorFunctorType::GetVectorLength(output);
+
+    const unsigned int numberOfDimensionsIO = imageIO->GetNumberOfDimensions();
+    if ( numberOfDimensionsIO > TOutputImage::ImageDimension
+         || imageIO->GetComponentType()
+         != ImageIOBase::MapPixelType< typename ConvertPixelTraits::ComponentType >::CType
+         || imageIO->GetNumberOfComponents() != ConvertPixelTraits::GetNumberOfComponents()
+         || sizeof( typename TOutputImage::InternalPixelType ) * numberOfInternalComponentsPerPixel
+         != imageIO->GetComponentSize() * imageIO->GetNumberOfComponents() )
+      {
+      return false;
+      }
+    for ( unsigned int i = 0; i < TOutputImage::ImageDimension; ++i )
+      {
+      const SizeValueType size = ( i < numberOfDimensionsIO ) ? imageIO->GetDimensions(i) : 1;
+      if ( size != str.ValidSize[i] )
+        {
+        return false;
+        }
+      }
 
-        typename  TOutputImage::InternalPixelType * outputSliceBuffer = outputBuffer + numberOfPixelComponentsUpToSlice;
+    ImageIORegion ioRegion(numberOfDimensionsIO);
+    ImageIORegion largestIORegion(numberOfDimensionsIO);
+    for ( unsigned int i = 0; i < numberOfDimensionsIO; ++i )
+      {
+      ioRegion.SetIndex( i, sliceRegionToRequest.GetIndex(i) );
+      ioRegion.SetSize( i, sliceRegionToRequest.GetSize(i) );
+      largestIORegion.SetIndex(i, 0);
+      largestIORegion.SetSize( i, imageIO->GetDimensions(i) );
+      }
 
-        readerOutput->GetPixelContainer()->SetImportPointer( outputSliceBuffer, numberOfPixelsInSlice, bufferDelete );
-        readerOutput->UpdateOutputData();
+    // A part of the file can only be read by an ImageIO that streams.
+    if ( !( ioRegion == largestIORegion ) )
+      {
+      if ( !imageIO->CanStreamRead() )
+        {
+        return false;
         }
-      else
+      imageIO->SetUseStreamedReading(true);
+      if ( !( imageIO->GenerateStreamableReadRegionFromRequestedRegion(ioRegion) == ioRegion ) )
         {
-        // the read region isn't going to match exactly what we need
-        // to update to buffer created by the reader, then copy
+        return false;
+        }
+      }
 
-        reader->Update();
+    const size_t    numberOfPixelsInSlice = sliceRegionToRequest.GetNumberOfPixels();
+    const ptrdiff_t sliceOffset = slice - requestedRegion.GetIndex(this->m_NumberOfDimensionsInImage);
 
-        // output of buffer copy
-        ImageRegionType outRegion = requestedRegion;
-        outRegion.SetIndex( sliceStartIndex );
+    imageIO->SetIORegion(ioRegion);
+    imageIO->Read( output->GetBufferPointer()
+                   + numberOfPixelsInSlice * numberOfInternalComponentsPerPixel * sliceOffset );
+    }
 
-        // set the moving dimension to a size of 1
-        if ( TOutputImage::ImageDimension != this->m_NumberOfDimensionsInImage )
-          {
-          outRegion.SetSize(this->m_NumberOfDimensionsInImage, 1);
-          }
+  // Deep copy the MetaDataDictionary into the array
+  if ( str.NeedToUpdateMetaDataDictionaryArray )
+    {
+    m_MetaDataDictionaryArray[slice] = new DictionaryType( imageIO->GetMetaDataDictionary() );
+    }
 
-        ImageAlgorithm::Copy( readerOutput, output, sliceRegionToRequest, outRegion );
+  sliceRead = insideRequestedRegion;
+  return true;
+}
 
-        }
+// Callback routine used by the threading library when UseParallelRead is
+// on. Each thread reads slices until none is left; the first exception or
+// an abort request stops the other threads, and GenerateData rethrows it.
+template< class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+ImageSeriesReader< TOutputImage >
+::ReadSlicesThreaderCallback(void *arg)
+{
+  ReadSlicesStruct *str;
+  ThreadIdType      threadId;
 
-      // report progress for read slices
-      progress.CompletedPixel();
+  threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
 
-     } // end !insidedRequestedRegion
+  str = (ReadSlicesStruct *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
 
-    // Deep copy the MetaDataDictionary into the array
-    if ( reader->GetImageIO() &&  needToUpdateMetaDataDictionaryArray )
+  // The first thread reports the progress: it reads the first slice, so
+  // that the observers are invoked at least once.
+  bool readFirstSlice = ( threadId == 0 );
+  while ( true )
+    {
+    str->Lock.Lock();
+    if ( str->Reader->GetAbortGenerateData() )
       {
-      DictionaryRawPointer newDictionary = new DictionaryType;
-      *newDictionary = reader->GetImageIO()->GetMetaDataDictionary();
-      m_MetaDataDictionaryArray.push_back(newDictionary);
+      str->Aborted = true;
+      str->NextSlice = str->NumberOfSlices;
+      }
+    int slice;
+    if ( readFirstSlice )
+      {
+      slice = ( str->Aborted || str->ExceptionOccurred ) ? str->NumberOfSlices : 0;
+      readFirstSlice = false;
+      }
+    else
+      {
+      slice = str->NextSlice++;
+      }
+    str->Lock.Unlock();
+    if ( slice >= str->NumberOfSlices )
+      {
+      break;
       }
 
-    } // end per slice loop
-
-  // update the time if we modified the meta array
-  if ( needToUpdateMetaDataDictionaryArray )
-    {
-    m_MetaDataDictionaryArrayMTime.Modified();
+    try
+      {
+      bool sliceRead;
+      if ( !str->Reader->ReadSliceWithImageIO(*str, slice, str->ImageIOs[threadId], sliceRead) )
+        {
+        sliceRead = str->Reader->ReadSlice(*str, slice, 0);
+        }
+      if ( sliceRead )
+        {
+        str->Lock.Lock();
+        const int numberOfSlicesRead = ++str->NumberOfSlicesRead;
+        str->Lock.Unlock();
+
+        // Like ProgressReporter, only the first thread, which is the
+        // calling one, invokes the observers. It reports the slices read
+        // by all the threads.
+        if ( threadId == 0 )
+          {
+          str->Reader->UpdateProgress( static_cast< float >( numberOfSlicesRead )
+                                       / static_cast< float >( str->NumberOfSlicesToRead ) );
+          }
+        }
+      }
+    catch ( ExceptionObject & e )
+      {
+      str->Lock.Lock();
+      if ( !str->ExceptionOccurred )
+        {
+        str->ExceptionOccurred = true;
+        str->Exception = e;
+        }
+      str->NextSlice = str->NumberOfSlices;
+      str->Lock.Unlock();
+      }
     }
+
+  return ITK_THREAD_RETURN_VALUE;
 }
 
 template< class TOutputImage >
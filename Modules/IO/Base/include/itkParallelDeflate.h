@@ -0,0 +1,88 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkParallelDeflate_h
+#define __itkParallelDeflate_h
+
+#include "itkIntTypes.h"
+#include "itkMultiThreader.h"
+#include <vector>
+
+namespace itk
+{
+/** \class ParallelDeflate
+ * \brief Deflate and inflate a buffer as independent blocks, in parallel.
+ *
+ * Deflate() cuts the data in blocks of a fixed number of bytes, deflates
+ * the blocks with several threads, and concatenates them into a single
+ * zlib or gzip stream, which any inflater reads as usual. Every block but
+ * the last ends with a full flush: the next block starts on a byte
+ * boundary and does not refer to the data before it.
+ *
+ * The offsets of the blocks in the stream are returned in a
+ * BlockIndexType. With it, InflateBlocks() decompresses any range of the
+ * data from the blocks that overlap the range only, again in parallel.
+ *
+ * \ingroup IOFilters
+ * \ingroup ITKIOBase
+ */
+class ITK_EXPORT ParallelDeflate
+{
+public:
+  typedef enum { ZlibFormat, GzipFormat } FormatType;
+
+  typedef std::vector< unsigned char > BufferType;
+  typedef std::vector< SizeValueType > OffsetContainerType;
+
+  /** Where the blocks of a stream written by Deflate() are. The offsets
+   * are counted from the start of the stream, header included. */
+  struct BlockIndexType {
+    SizeValueType       BlockSize;
+    SizeValueType       UncompressedSize;
+    SizeValueType       CompressedSize;
+    OffsetContainerType BlockOffsets;
+  };
+
+  /** Compress size bytes of data into compressed, in blocks of blockSize
+   * bytes. level is the zlib compression level. */
+  static void Deflate(const void *data, SizeValueType size, SizeValueType blockSize,
+                      FormatType format, int level, ThreadIdType numberOfThreads,
+                      BufferType & compressed, BlockIndexType & index);
+
+  /** The part [compressedBegin, compressedEnd) of the stream that holds
+   * the bytes [begin, end) of the uncompressed data. */
+  static void GetCompressedRange(const BlockIndexType & index,
+                                 SizeValueType begin, SizeValueType end,
+                                 SizeValueType & compressedBegin,
+                                 SizeValueType & compressedEnd);
+
+  /** Decompress the bytes [begin, end) of the data into output.
+   * compressed holds the part of the stream that starts at compressedOffset
+   * and covers the range given by GetCompressedRange(). */
+  static void InflateBlocks(const BlockIndexType & index,
+                            const unsigned char *compressed, SizeValueType compressedOffset,
+                            SizeValueType begin, SizeValueType end, void *output,
+                            ThreadIdType numberOfThreads);
+
+private:
+  ParallelDeflate();                  //purposely not implemented
+  ParallelDeflate(const ParallelDeflate &); //purposely not implemented
+  void operator=(const ParallelDeflate &);  //purposely not implemented
+};
+} // end namespace itk
+
+#endif // __itkParallelDeflate_h
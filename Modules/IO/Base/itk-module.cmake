@@ -10,6 +10,7 @@ NumericSeriesFileNames, and RegularExpressionSeriesFileNames.")
 itk_module(ITKIOBase
   DEPENDS
     ITKCommon
+    ITKZLIB
   TEST_DEPENDS
     ITKTestKernel
     ITKImageIntensity
@@ -49,6 +49,8 @@ void ImageIOBase::Reset(const bool)
     }
   m_NumberOfDimensions = 0;
   m_UseCompression = false;
+  m_UseParallelCompression = false;
+  m_CompressionBlockSize = 1024 * 1024;
   m_UseStreamedReading = false;
   m_UseStreamedWriting = false;
 }
@@ -1006,6 +1008,15 @@ void ImageIOBase::PrintSelf(std::ostream & os, Indent indent) const
     {
     os << indent << "UseCompression: Off" << std::endl;
     }
+  if ( m_UseParallelCompression )
+    {
+    os << indent << "UseParallelCompression: On" << std::endl;
+    }
+  else
+    {
+    os << indent << "UseParallelCompression: Off" << std::endl;
+    }
+  os << indent << "CompressionBlockSize: " << m_CompressionBlockSize << std::endl;
   if ( m_UseStreamedReading )
     {
     os << indent << "UseStreamedReading: On" << std::endl;
@@ -0,0 +1,443 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkParallelDeflate.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itk_zlib.h"
+#include <algorithm>
+#include <string.h>
+
+namespace itk
+{
+namespace
+{
+// zlib counts the bytes it reads or writes at once in a uInt.
+const SizeValueType MaximumChunkSize = 1 << 30;
+
+// State shared by the threads of Deflate(). NextBlock and Failed are
+// protected by Lock.
+struct DeflateStruct {
+  const unsigned char *                 Data;
+  SizeValueType                         Size;
+  SizeValueType                         BlockSize;
+  SizeValueType                         NumberOfBlocks;
+  int                                   Level;
+  bool                                  Gzip;
+  std::vector< ParallelDeflate::BufferType > Blocks;
+  std::vector< unsigned long >          Checks;
+  SizeValueType                         NextBlock;
+  bool                                  Failed;
+  SimpleFastMutexLock                   Lock;
+};
+
+// State shared by the threads of InflateBlocks().
+struct InflateStruct {
+  const ParallelDeflate::BlockIndexType *Index;
+  const unsigned char *                  Compressed;
+  SizeValueType                          CompressedOffset;
+  SizeValueType                          Begin;
+  SizeValueType                          End;
+  unsigned char *                        Output;
+  SizeValueType                          LastBlock;
+  SizeValueType                          NextBlock;
+  bool                                   Failed;
+  SimpleFastMutexLock                    Lock;
+};
+
+// Deflate one block as raw deflate data. The last block finishes the
+// stream, the others end with a full flush.
+bool DeflateBlock(const unsigned char *data, SizeValueType size, bool last, int level,
+                  ParallelDeflate::BufferType & output)
+{
+  z_stream z;
+
+  memset( &z, 0, sizeof( z ) );
+  if ( deflateInit2(&z, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK )
+    {
+    return false;
+    }
+
+  // Incompressible data grow by a few bytes per stored block of 16 KB; the
+  // buffer is enlarged if that is not enough.
+  output.resize(size + size / 1000 + 64);
+
+  SizeValueType produced = 0;
+  SizeValueType remaining = size;
+  bool          ok = true;
+  do
+    {
+    const SizeValueType chunk = std::min(remaining, MaximumChunkSize);
+    z.next_in = const_cast< Bytef * >( data + ( size - remaining ) );
+    z.avail_in = static_cast< uInt >( chunk );
+    remaining -= chunk;
+    const int flush = remaining > 0 ? Z_NO_FLUSH : ( last ? Z_FINISH : Z_FULL_FLUSH );
+    while ( true )
+      {
+      if ( produced == output.size() )
+        {
+        output.resize(output.size() * 2);
+        }
+      const SizeValueType available = std::min(output.size() - produced, MaximumChunkSize);
+      z.next_out = &output[0] + produced;
+      z.avail_out = static_cast< uInt >( available );
+      const int status = deflate(&z, flush);
+      produced += available - z.avail_out;
+      if ( status == Z_STREAM_ERROR )
+        {
+        ok = false;
+        break;
+        }
+      if ( flush == Z_FINISH ? status == Z_STREAM_END : ( z.avail_in == 0 && z.avail_out != 0 ) )
+        {
+        break;
+        }
+      }
+    }
+  while ( ok && remaining > 0 );
+
+  deflateEnd(&z);
+  output.resize(produced);
+  return ok;
+}
+
+// The zlib or gzip check value of the data of a block.
+unsigned long BlockCheck(const unsigned char *data, SizeValueType size, bool gzip)
+{
+  unsigned long check = gzip ? crc32(0, Z_NULL, 0) : adler32(0, Z_NULL, 0);
+
+  for ( SizeValueType done = 0; done < size; done += MaximumChunkSize )
+    {
+    const uInt chunk = static_cast< uInt >( std::min(size - done, MaximumChunkSize) );
+    check = gzip ? crc32(check, data + done, chunk) : adler32(check, data + done, chunk);
+    }
+  return check;
+}
+
+// Inflate the raw deflate data of one block into output.
+bool InflateBlock(const unsigned char *compressed, SizeValueType compressedSize,
+                  unsigned char *output, SizeValueType size)
+{
+  z_stream z;
+
+  memset( &z, 0, sizeof( z ) );
+  if ( inflateInit2(&z, -MAX_WBITS) != Z_OK )
+    {
+    return false;
+    }
+
+  SizeValueType consumed = 0;
+  SizeValueType produced = 0;
+  bool          ok = true;
+  while ( produced < size )
+    {
+    if ( z.avail_in == 0 )
+      {
+      const SizeValueType chunk = std::min(compressedSize - consumed, MaximumChunkSize);
+      z.next_in = const_cast< Bytef * >( compressed + consumed );
+      z.avail_in = static_cast< uInt >( chunk );
+      consumed += chunk;
+      }
+    const SizeValueType available = std::min(size - produced, MaximumChunkSize);
+    z.next_out = output + produced;
+    z.avail_out = static_cast< uInt >( available );
+    const int status = inflate(&z, Z_NO_FLUSH);
+    produced += available - z.avail_out;
+    if ( status == Z_STREAM_END )
+      {
+      break;
+      }
+    if ( status != Z_OK )
+      {
+      ok = false;
+      break;
+      }
+    }
+
+  inflateEnd(&z);
+  return ok && produced == size;
+}
+
+ITK_THREAD_RETURN_TYPE DeflateThreaderCallback(void *arg)
+{
+  DeflateStruct *str = (DeflateStruct *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  while ( true )
+    {
+    str->Lock.Lock();
+    const SizeValueType block = str->NextBlock++;
+    const bool          failed = str->Failed;
+    str->Lock.Unlock();
+    if ( block >= str->NumberOfBlocks || failed )
+      {
+      break;
+      }
+
+    const SizeValueType  begin = block * str->BlockSize;
+    const SizeValueType  size = std::min(str->BlockSize, str->Size - begin);
+    const unsigned char *data = str->Data + begin;
+    bool                 ok;
+    try
+      {
+      ok = DeflateBlock(data, size, block + 1 == str->NumberOfBlocks, str->Level, str->Blocks[block]);
+      str->Checks[block] = BlockCheck(data, size, str->Gzip);
+      }
+    catch ( ... )
+      {
+      ok = false;
+      }
+    if ( !ok )
+      {
+      str->Lock.Lock();
+      str->Failed = true;
+      str->Lock.Unlock();
+      }
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+ITK_THREAD_RETURN_TYPE InflateThreaderCallback(void *arg)
+{
+  InflateStruct *str = (InflateStruct *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  const ParallelDeflate::BlockIndexType & index = *str->Index;
+  ParallelDeflate::BufferType             partialBlock;
+  while ( true )
+    {
+    str->Lock.Lock();
+    const SizeValueType block = str->NextBlock++;
+    const bool          failed = str->Failed;
+    str->Lock.Unlock();
+    if ( block > str->LastBlock || failed )
+      {
+      break;
+      }
+
+    const SizeValueType blockBegin = block * index.BlockSize;
+    const SizeValueType blockSize = std::min(index.BlockSize, index.UncompressedSize - blockBegin);
+    const SizeValueType compressedBegin = index.BlockOffsets[block];
+    const SizeValueType compressedEnd = block + 1 < index.BlockOffsets.size()
+                                        ? index.BlockOffsets[block + 1] : index.CompressedSize;
+    const unsigned char *compressed = str->Compressed + ( compressedBegin - str->CompressedOffset );
+
+    bool ok;
+    try
+      {
+      if ( blockBegin >= str->Begin && blockBegin + blockSize <= str->End )
+        {
+        ok = InflateBlock(compressed, compressedEnd - compressedBegin,
+                          str->Output + ( blockBegin - str->Begin ), blockSize);
+        }
+      else
+        {
+        // Only a part of the block is wanted.
+        partialBlock.resize(blockSize);
+        ok = InflateBlock(compressed, compressedEnd - compressedBegin, &partialBlock[0], blockSize);
+        const SizeValueType begin = std::max(blockBegin, str->Begin);
+        const SizeValueType end = std::min(blockBegin + blockSize, str->End);
+        memcpy(str->Output + ( begin - str->Begin ), &partialBlock[begin - blockBegin], end - begin);
+        }
+      }
+    catch ( ... )
+      {
+      ok = false;
+      }
+    if ( !ok )
+      {
+      str->Lock.Lock();
+      str->Failed = true;
+      str->Lock.Unlock();
+      }
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+void AppendLittleEndian32(ParallelDeflate::BufferType & buffer, unsigned long value)
+{
+  for ( unsigned int i = 0; i < 4; i++ )
+    {
+    buffer.push_back( static_cast< unsigned char >( ( value >> ( 8 * i ) ) & 0xff ) );
+    }
+}
+
+void Execute(ThreadFunctionType method, void *data, ThreadIdType numberOfThreads, SizeValueType numberOfBlocks)
+{
+  if ( numberOfThreads < 1 )
+    {
+    numberOfThreads = 1;
+    }
+  if ( numberOfBlocks < numberOfThreads )
+    {
+    numberOfThreads = static_cast< ThreadIdType >( numberOfBlocks );
+    }
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads(numberOfThreads);
+  threader->SetSingleMethod(method, data);
+  threader->SingleMethodExecute();
+}
+}
+
+void ParallelDeflate
+::Deflate(const void *data, SizeValueType size, SizeValueType blockSize,
+          FormatType format, int level, ThreadIdType numberOfThreads,
+          BufferType & compressed, BlockIndexType & index)
+{
+  if ( blockSize == 0 )
+    {
+    itkGenericExceptionMacro(<< "ParallelDeflate: the block size must be positive");
+    }
+
+  DeflateStruct str;
+  str.Data = static_cast< const unsigned char * >( data );
+  str.Size = size;
+  str.BlockSize = blockSize;
+  str.NumberOfBlocks = std::max( ( size + blockSize - 1 ) / blockSize, static_cast< SizeValueType >( 1 ) );
+  str.Level = level;
+  str.Gzip = ( format == GzipFormat );
+  str.Blocks.resize(str.NumberOfBlocks);
+  str.Checks.resize(str.NumberOfBlocks);
+  str.NextBlock = 0;
+  str.Failed = false;
+
+  Execute(DeflateThreaderCallback, &str, numberOfThreads, str.NumberOfBlocks);
+
+  if ( str.Failed )
+    {
+    itkGenericExceptionMacro(<< "ParallelDeflate: deflate failed");
+    }
+
+  // The header, as zlib and gzip write it.
+  compressed.clear();
+  if ( str.Gzip )
+    {
+    const unsigned char header[10] = { 0x1f, 0x8b, Z_DEFLATED, 0, 0, 0, 0, 0, 0, 0xff };
+    compressed.insert(compressed.end(), header, header + 10);
+    }
+  else
+    {
+    unsigned int levelFlags = 2;
+    if ( level >= 0 && level < 2 )
+      {
+      levelFlags = 0;
+      }
+    else if ( level >= 2 && level < 6 )
+      {
+      levelFlags = 1;
+      }
+    else if ( level > 6 )
+      {
+      levelFlags = 3;
+      }
+    unsigned int header = ( ( Z_DEFLATED + ( ( MAX_WBITS - 8 ) << 4 ) ) << 8 ) | ( levelFlags << 6 );
+    header += 31 - ( header % 31 );
+    compressed.push_back( static_cast< unsigned char >( header >> 8 ) );
+    compressed.push_back( static_cast< unsigned char >( header & 0xff ) );
+    }
+
+  index.BlockSize = blockSize;
+  index.UncompressedSize = size;
+  index.BlockOffsets.resize(str.NumberOfBlocks);
+
+  SizeValueType totalSize = compressed.size();
+  for ( SizeValueType i = 0; i < str.NumberOfBlocks; i++ )
+    {
+    index.BlockOffsets[i] = totalSize;
+    totalSize += str.Blocks[i].size();
+    }
+  compressed.reserve(totalSize + 8);
+
+  unsigned long check = str.Checks[0];
+  for ( SizeValueType i = 0; i < str.NumberOfBlocks; i++ )
+    {
+    compressed.insert( compressed.end(), str.Blocks[i].begin(), str.Blocks[i].end() );
+    BufferType().swap(str.Blocks[i]);
+    if ( i > 0 )
+      {
+      const z_off_t blockLength = static_cast< z_off_t >( std::min(blockSize, size - i * blockSize) );
+      check = str.Gzip ? crc32_combine(check, str.Checks[i], blockLength)
+                       : adler32_combine(check, str.Checks[i], blockLength);
+      }
+    }
+
+  if ( str.Gzip )
+    {
+    AppendLittleEndian32(compressed, check);
+    AppendLittleEndian32(compressed, static_cast< unsigned long >( size & 0xffffffffUL ) );
+    }
+  else
+    {
+    for ( int shift = 24; shift >= 0; shift -= 8 )
+      {
+      compressed.push_back( static_cast< unsigned char >( ( check >> shift ) & 0xff ) );
+      }
+    }
+  index.CompressedSize = compressed.size();
+}
+
+void ParallelDeflate
+::GetCompressedRange(const BlockIndexType & index,
+                     SizeValueType begin, SizeValueType end,
+                     SizeValueType & compressedBegin,
+                     SizeValueType & compressedEnd)
+{
+  if ( begin >= end || index.BlockOffsets.empty() )
+    {
+    compressedBegin = compressedEnd = 0;
+    return;
+    }
+  const SizeValueType firstBlock = begin / index.BlockSize;
+  const SizeValueType lastBlock = ( end - 1 ) / index.BlockSize;
+  compressedBegin = index.BlockOffsets[firstBlock];
+  compressedEnd = lastBlock + 1 < index.BlockOffsets.size()
+                  ? index.BlockOffsets[lastBlock + 1] : index.CompressedSize;
+}
+
+void ParallelDeflate
+::InflateBlocks(const BlockIndexType & index,
+                const unsigned char *compressed, SizeValueType compressedOffset,
+                SizeValueType begin, SizeValueType end, void *output,
+                ThreadIdType numberOfThreads)
+{
+  if ( begin >= end )
+    {
+    return;
+    }
+  if ( end > index.UncompressedSize || index.BlockSize == 0
+       || ( end - 1 ) / index.BlockSize >= index.BlockOffsets.size() )
+    {
+    itkGenericExceptionMacro(<< "ParallelDeflate: the range [" << begin << ", " << end
+                             << ") is not in the indexed data");
+    }
+
+  InflateStruct str;
+  str.Index = &index;
+  str.Compressed = compressed;
+  str.CompressedOffset = compressedOffset;
+  str.Begin = begin;
+  str.End = end;
+  str.Output = static_cast< unsigned char * >( output );
+  str.NextBlock = begin / index.BlockSize;
+  str.LastBlock = ( end - 1 ) / index.BlockSize;
+  str.Failed = false;
+
+  Execute(InflateThreaderCallback, &str, numberOfThreads, str.LastBlock - str.NextBlock + 1);
+
+  if ( str.Failed )
+    {
+    itkGenericExceptionMacro(<< "ParallelDeflate: the compressed data are corrupted");
+    }
+}
+} // end namespace itk
@@ -0,0 +1,153 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIterator.h"
+
+namespace
+{
+typedef itk::Image< short, 3 > FileImageType;
+
+// Compare the pixels of image with the first ones of the file image, in
+// buffer order.
+template< class TImage >
+bool CheckImage(const std::string & description, const FileImageType *fileImage, const TImage *image)
+{
+  itk::ImageRegionConstIterator< FileImageType > fit( fileImage, fileImage->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< TImage >        it( image, image->GetLargestPossibleRegion() );
+  for ( it.GoToBegin(), fit.GoToBegin(); !it.IsAtEnd(); ++it, ++fit )
+    {
+    const typename TImage::PixelType expected = static_cast< typename TImage::PixelType >( fit.Get() );
+    if ( it.Get() != expected )
+      {
+      std::cerr << description << ": value " << static_cast< double >( it.Get() ) << " at "
+                << it.GetIndex() << " instead of " << static_cast< double >( expected ) << std::endl;
+      return false;
+      }
+    }
+  std::cout << description << ": OK" << std::endl;
+  return true;
+}
+
+template< class TImage >
+typename TImage::Pointer Read(const std::string & fileName, itk::SizeValueType conversionBufferSize)
+{
+  typedef itk::ImageFileReader< TImage > ReaderType;
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(fileName);
+  reader->SetConversionBufferSize(conversionBufferSize);
+  reader->SetNumberOfThreads(4);
+  // Ask for the whole file, so that the reader has to find out by itself
+  // that it can read the first slice alone.
+  reader->UseStreamingOff();
+  reader->Update();
+  return reader->GetOutput();
+}
+}
+
+//
+// Read a file with each of the conversion paths of ImageFileReader, and
+// check the pixels: by blocks, in place, through a temporary buffer, and
+// without conversion when the file has more dimensions than the image.
+//
+int itkImageFileReaderConversionTest(int argc, char* argv[])
+{
+  if ( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const std::string rawFileName = std::string(argv[1]) + "/itkImageFileReaderConversionTest.mha";
+  const std::string compressedFileName = std::string(argv[1]) + "/itkImageFileReaderConversionTestCompressed.mha";
+
+  FileImageType::Pointer    fileImage = FileImageType::New();
+  FileImageType::RegionType region;
+  FileImageType::SizeType   size;
+  size[0] = 64;
+  size[1] = 48;
+  size[2] = 40;
+  region.SetSize(size);
+  fileImage->SetRegions(region);
+  fileImage->Allocate();
+
+  itk::ImageRegionIterator< FileImageType > fit( fileImage, region );
+  long value = 0;
+  for ( fit.GoToBegin(); !fit.IsAtEnd(); ++fit, ++value )
+    {
+    fit.Set( static_cast< short >( ( value * 7 ) % 30000 - 15000 ) );
+    }
+
+  typedef itk::ImageFileWriter< FileImageType > WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(fileImage);
+  try
+    {
+    writer->SetFileName(rawFileName);
+    writer->Update();
+    writer->SetFileName(compressedFileName);
+    writer->UseCompressionOn();
+    writer->Update();
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // three slices, or ten rows of a slice, per block
+  const itk::SizeValueType smallBuffer = 3 * size[0] * size[1] * sizeof( short );
+  const itk::SizeValueType sliceBuffer = 10 * size[0] * sizeof( short );
+
+  try
+    {
+    typedef itk::Image< float, 3 >       FloatImageType;
+    typedef itk::Image< float, 2 >       FloatSliceType;
+    typedef itk::Image< short, 2 >       ShortSliceType;
+    typedef itk::Image< signed char, 3 > CharImageType;
+
+    bool ok = true;
+    ok &= CheckImage( "blocks", fileImage.GetPointer(),
+                      Read< FloatImageType >(rawFileName, smallBuffer).GetPointer() );
+    ok &= CheckImage( "in place", fileImage.GetPointer(),
+                      Read< FloatImageType >(compressedFileName, smallBuffer).GetPointer() );
+    ok &= CheckImage( "temporary buffer", fileImage.GetPointer(),
+                      Read< CharImageType >(compressedFileName, smallBuffer).GetPointer() );
+    ok &= CheckImage( "first slice by blocks", fileImage.GetPointer(),
+                      Read< FloatSliceType >(rawFileName, sliceBuffer).GetPointer() );
+    ok &= CheckImage( "first slice through a temporary buffer", fileImage.GetPointer(),
+                      Read< FloatSliceType >(compressedFileName, sliceBuffer).GetPointer() );
+    ok &= CheckImage( "first slice read alone", fileImage.GetPointer(),
+                      Read< ShortSliceType >(rawFileName, sliceBuffer).GetPointer() );
+    ok &= CheckImage( "first slice copied from the whole file", fileImage.GetPointer(),
+                      Read< ShortSliceType >(compressedFileName, sliceBuffer).GetPointer() );
+    if ( !ok )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
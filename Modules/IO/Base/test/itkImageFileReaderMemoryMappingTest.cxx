@@ -0,0 +1,280 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIterator.h"
+#include "itkByteSwapper.h"
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+typedef itk::Image< short, 3 >           ImageType;
+typedef itk::ImageFileReader< ImageType > ReaderType;
+
+bool CheckImage(const std::string & description, const ImageType *expected, const ImageType *image)
+{
+  itk::ImageRegionConstIterator< ImageType > eit( expected, expected->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< ImageType > it( image, image->GetLargestPossibleRegion() );
+  if ( image->GetBufferedRegion() != expected->GetLargestPossibleRegion() )
+    {
+    std::cerr << description << ": buffered region " << image->GetBufferedRegion() << std::endl;
+    return false;
+    }
+  for ( it.GoToBegin(), eit.GoToBegin(); !it.IsAtEnd(); ++it, ++eit )
+    {
+    if ( it.Get() != eit.Get() )
+      {
+      std::cerr << description << ": value " << it.Get() << " at " << it.GetIndex()
+                << " instead of " << eit.Get() << std::endl;
+      return false;
+      }
+    }
+  std::cout << description << ": OK" << std::endl;
+  return true;
+}
+
+ReaderType::Pointer Read(const std::string & fileName, bool useMemoryMapping, bool readOnly)
+{
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(fileName);
+  reader->SetUseMemoryMapping(useMemoryMapping);
+  reader->SetReadOnlyMemoryMapping(readOnly);
+  reader->Update();
+  return reader;
+}
+
+// Read the slab into a buffer that the output does not own, as an
+// ImageSeriesReader does.
+ReaderType::Pointer ReadIntoProvidedBuffer(const std::string & fileName, bool useMemoryMapping,
+                                           const ImageType::RegionType & slab,
+                                           std::vector< short > & providedBuffer)
+{
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(fileName);
+  reader->SetUseMemoryMapping(useMemoryMapping);
+  ImageType *output = reader->GetOutput();
+  output->UpdateOutputInformation();
+  output->SetRequestedRegion(slab);
+  output->PropagateRequestedRegion();
+  output->GetPixelContainer()->SetImportPointer( &providedBuffer[0], providedBuffer.size(), false );
+  output->UpdateOutputData();
+  return reader;
+}
+
+// Write, map and read back the image with the given file name.
+bool TestFile(const std::string & fileName, const ImageType *image, bool compress)
+{
+  typedef itk::ImageFileWriter< ImageType > WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(image);
+  writer->SetFileName(fileName);
+  writer->SetUseCompression(compress);
+  writer->Update();
+
+  // A copy-on-write mapping can be modified without changing the file.
+  ReaderType::Pointer copyOnWriteReader = Read(fileName, true, false);
+  if ( !CheckImage(fileName + " copy-on-write", image, copyOnWriteReader->GetOutput()) )
+    {
+    return false;
+    }
+  copyOnWriteReader->GetOutput()->GetBufferPointer()[0] += 1;
+  if ( !CheckImage( fileName + " after writing to the copy-on-write mapping", image,
+                    Read(fileName, false, false)->GetOutput() ) )
+    {
+    return false;
+    }
+
+  ReaderType::Pointer readOnlyReader = Read(fileName, true, true);
+  if ( !CheckImage(fileName + " read-only", image, readOnlyReader->GetOutput()) )
+    {
+    return false;
+    }
+
+  std::string        dataFileName;
+  itk::SizeValueType offset;
+  const bool         mappable =
+    readOnlyReader->GetImageIO()->GetMappablePixelDataLocation(dataFileName, offset);
+  if ( mappable == compress )
+    {
+    std::cerr << fileName << ( compress ? " should not" : " should" ) << " be mappable" << std::endl;
+    return false;
+    }
+  if ( !mappable )
+    {
+    return true;
+    }
+
+  // The pages of a read-only mapping are those of the file: a change of the
+  // file is seen by the image. Pixels that are misaligned in the file are
+  // read instead.
+  const itk::SizeValueType lastPixel = image->GetLargestPossibleRegion().GetNumberOfPixels() - 1;
+  const short              newValue = image->GetBufferPointer()[lastPixel] + 1;
+  std::fstream             file(dataFileName.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+  file.seekp( offset + lastPixel * sizeof( short ) );
+  file.write( reinterpret_cast< const char * >( &newValue ), sizeof( short ) );
+  file.close();
+  const bool mapped = readOnlyReader->GetOutput()->GetBufferPointer()[lastPixel] == newValue;
+  if ( mapped != ( offset % sizeof( short ) == 0 ) )
+    {
+    std::cerr << fileName << ( mapped ? " was" : " was not" ) << " mapped from "
+              << dataFileName << " at offset " << offset << std::endl;
+    return false;
+    }
+  std::cout << fileName << ( mapped ? " mapped from " : " read instead of mapped from " )
+            << dataFileName << " at offset " << offset << std::endl;
+
+  // A buffer provided by someone else cannot be replaced by a mapping:
+  // the reader must then read the same region as without mapping.
+  ImageType::RegionType slab = image->GetLargestPossibleRegion();
+  slab.SetIndex(2, 2);
+  slab.SetSize(2, 2);
+  std::vector< short > providedBuffer( image->GetLargestPossibleRegion().GetNumberOfPixels() );
+  ReaderType::Pointer  slabReader = ReadIntoProvidedBuffer(fileName, true, slab, providedBuffer);
+  const ImageType *    slabImage = slabReader->GetOutput();
+  const ImageType::RegionType expectedRegion =
+    ReadIntoProvidedBuffer(fileName, false, slab, providedBuffer)->GetOutput()->GetBufferedRegion();
+  if ( slabImage->GetBufferedRegion() != expectedRegion )
+    {
+    std::cerr << fileName << ": buffered region " << slabImage->GetBufferedRegion()
+              << " instead of " << expectedRegion << std::endl;
+    return false;
+    }
+  itk::ImageRegionConstIterator< ImageType > sit( image, slab );
+  itk::ImageRegionConstIterator< ImageType > rit( slabImage, slab );
+  for ( sit.GoToBegin(), rit.GoToBegin(); !sit.IsAtEnd(); ++sit, ++rit )
+    {
+    if ( sit.Get() != rit.Get() )
+      {
+      std::cerr << fileName << ": slab value " << rit.Get() << " at " << sit.GetIndex()
+                << " instead of " << sit.Get() << std::endl;
+      return false;
+      }
+    }
+  std::cout << fileName << " read into a provided buffer: OK" << std::endl;
+  return true;
+}
+
+// Write a MetaImage file whose header has an odd length, so that the
+// pixels are not aligned in the file. The reader must not map them.
+bool TestOddHeader(const std::string & fileName, const ImageType *image)
+{
+  const ImageType::SizeType size = image->GetLargestPossibleRegion().GetSize();
+  std::ostringstream        header;
+  header << "ObjectType = Image\n"
+         << "NDims = 3\n"
+         << "BinaryData = True\n"
+         << "BinaryDataByteOrderMSB = "
+         << ( itk::ByteSwapper< short >::SystemIsBigEndian() ? "True" : "False" ) << "\n"
+         << "DimSize = " << size[0] << " " << size[1] << " " << size[2] << "\n"
+         << "ElementType = MET_SHORT\n";
+  if ( header.str().size() % 2 == 0 )
+    {
+    header << "Comment = odd header\n";
+    }
+  else
+    {
+    header << "Comment = odd headers\n";
+    }
+  header << "ElementDataFile = LOCAL\n";
+
+  std::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary);
+  file << header.str();
+  file.write( reinterpret_cast< const char * >( image->GetBufferPointer() ),
+              image->GetLargestPossibleRegion().GetNumberOfPixels() * sizeof( short ) );
+  file.close();
+
+  ReaderType::Pointer reader = Read(fileName, true, true);
+  if ( !CheckImage(fileName + " with an odd header", image, reader->GetOutput()) )
+    {
+    return false;
+    }
+
+  std::string        dataFileName;
+  itk::SizeValueType offset;
+  if ( !reader->GetImageIO()->GetMappablePixelDataLocation(dataFileName, offset) || offset % 2 == 0 )
+    {
+    std::cerr << fileName << ": the pixels should be mappable at an odd offset" << std::endl;
+    return false;
+    }
+  if ( reinterpret_cast< size_t >( reader->GetOutput()->GetBufferPointer() ) % sizeof( short ) != 0 )
+    {
+    std::cerr << fileName << ": the buffer is misaligned" << std::endl;
+    return false;
+    }
+  std::cout << fileName << " read instead of mapped at offset " << offset << std::endl;
+  return true;
+}
+}
+
+//
+// Map files of the formats that report the location of their pixels, and
+// check the pixels, that a copy-on-write mapping leaves the file alone and
+// that a read-only mapping shares the pages of the file. Compressed files,
+// and pixels that are misaligned in the file, are read as usual.
+//
+int itkImageFileReaderMemoryMappingTest(int argc, char* argv[])
+{
+  if ( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ImageType::Pointer    image = ImageType::New();
+  ImageType::RegionType region;
+  ImageType::SizeType   size;
+  size[0] = 33;
+  size[1] = 20;
+  size[2] = 7;
+  region.SetSize(size);
+  image->SetRegions(region);
+  image->Allocate();
+
+  itk::ImageRegionIterator< ImageType > it( image, region );
+  long value = 0;
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it, ++value )
+    {
+    it.Set( static_cast< short >( ( value * 13 ) % 20000 - 10000 ) );
+    }
+
+  const std::string baseName = std::string(argv[1]) + "/itkImageFileReaderMemoryMappingTest";
+  try
+    {
+    if ( !TestFile(baseName + ".mha", image, false)
+         || !TestFile(baseName + ".mhd", image, false)
+         || !TestFile(baseName + ".nrrd", image, false)
+         || !TestFile(baseName + "Detached.nhdr", image, false)
+         || !TestFile(baseName + ".nii", image, false)
+         || !TestFile(baseName + "Compressed.mha", image, true)
+         || !TestOddHeader(baseName + "OddHeader.mha", image) )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,188 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIterator.h"
+#include "itkMetaImageIO.h"
+#include "itkParallelDeflate.h"
+#include "itkStreamingImageFilter.h"
+#include <algorithm>
+
+namespace
+{
+typedef itk::Image< short, 3 >           ImageType;
+typedef itk::ImageFileReader< ImageType > ReaderType;
+
+bool CheckImage(const std::string & description, const ImageType *expected, const ImageType *image)
+{
+  itk::ImageRegionConstIterator< ImageType > eit( expected, expected->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for ( it.GoToBegin(), eit.GoToBegin(); !it.IsAtEnd(); ++it, ++eit )
+    {
+    if ( it.Get() != eit.Get() )
+      {
+      std::cerr << description << ": value " << it.Get() << " at " << it.GetIndex()
+                << " instead of " << eit.Get() << std::endl;
+      return false;
+      }
+    }
+  std::cout << description << ": OK" << std::endl;
+  return true;
+}
+
+// Deflate a buffer and inflate parts of it back.
+bool TestParallelDeflate(itk::ParallelDeflate::FormatType format)
+{
+  std::vector< unsigned char > data(100000);
+  for ( unsigned int i = 0; i < data.size(); ++i )
+    {
+    data[i] = static_cast< unsigned char >( ( i * i ) % 251 / 16 );
+    }
+
+  itk::ParallelDeflate::BufferType     compressed;
+  itk::ParallelDeflate::BlockIndexType index;
+  itk::ParallelDeflate::Deflate(&data[0], data.size(), 7000, format, 6, 4, compressed, index);
+  if ( index.BlockOffsets.size() != 15 || index.CompressedSize != compressed.size() )
+    {
+    std::cerr << "ParallelDeflate: " << index.BlockOffsets.size() << " blocks, "
+              << index.CompressedSize << " bytes" << std::endl;
+    return false;
+    }
+
+  const itk::SizeValueType ranges[][2] = { { 0, 100000 }, { 6999, 7001 }, { 12345, 54321 }, { 99999, 100000 } };
+  for ( unsigned int r = 0; r < sizeof( ranges ) / sizeof( ranges[0] ); ++r )
+    {
+    itk::SizeValueType compressedBegin;
+    itk::SizeValueType compressedEnd;
+    itk::ParallelDeflate::GetCompressedRange(index, ranges[r][0], ranges[r][1], compressedBegin, compressedEnd);
+
+    std::vector< unsigned char > output(ranges[r][1] - ranges[r][0]);
+    itk::ParallelDeflate::InflateBlocks(index, &compressed[compressedBegin], compressedBegin,
+                                        ranges[r][0], ranges[r][1], &output[0], 3);
+    if ( !std::equal( output.begin(), output.end(), data.begin() + ranges[r][0] ) )
+      {
+      std::cerr << "ParallelDeflate: wrong bytes in [" << ranges[r][0] << ", " << ranges[r][1] << ")" << std::endl;
+      return false;
+      }
+    }
+  std::cout << "ParallelDeflate: OK" << std::endl;
+  return true;
+}
+
+// Write the image with parallel compression and read it back, as a whole
+// and, when the file has an index of its blocks, by streaming.
+bool TestFile(const std::string & fileName, const ImageType *image, bool indexed)
+{
+  typedef itk::ImageFileWriter< ImageType > WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(image);
+  writer->SetFileName(fileName);
+  writer->UseCompressionOn();
+  writer->UseParallelCompressionOn();
+  if ( indexed )
+    {
+    itk::MetaImageIO::Pointer io = itk::MetaImageIO::New();
+    io->SetCompressionBlockSize(2048);
+    writer->SetImageIO(io);
+    }
+  writer->Update();
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(fileName);
+  reader->Update();
+  if ( !CheckImage(fileName, image, reader->GetOutput()) )
+    {
+    return false;
+    }
+  if ( !indexed )
+    {
+    return true;
+    }
+
+  ReaderType::Pointer streamingReader = ReaderType::New();
+  streamingReader->SetFileName(fileName);
+  streamingReader->UseStreamingOn();
+  streamingReader->UpdateOutputInformation();
+  if ( !streamingReader->GetImageIO()->CanStreamRead() )
+    {
+    std::cerr << fileName << " has no index of its compressed blocks" << std::endl;
+    return false;
+    }
+
+  typedef itk::StreamingImageFilter< ImageType, ImageType > StreamerType;
+  StreamerType::Pointer streamer = StreamerType::New();
+  streamer->SetInput( streamingReader->GetOutput() );
+  streamer->SetNumberOfStreamDivisions(7);
+  streamer->Update();
+  return CheckImage(fileName + " streamed", image, streamer->GetOutput());
+}
+}
+
+//
+// Compress MetaImage and NIfTI files with several threads and read them
+// back. The MetaImage files keep the offsets of their blocks, which lets
+// the reader decompress the requested region only.
+//
+int itkImageFileWriterParallelCompressionTest(int argc, char* argv[])
+{
+  if ( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ImageType::Pointer    image = ImageType::New();
+  ImageType::RegionType region;
+  ImageType::SizeType   size;
+  size[0] = 41;
+  size[1] = 30;
+  size[2] = 19;
+  region.SetSize(size);
+  image->SetRegions(region);
+  image->Allocate();
+
+  itk::ImageRegionIterator< ImageType > it( image, region );
+  long value = 0;
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it, ++value )
+    {
+    it.Set( static_cast< short >( ( value * value ) % 1000 - 500 ) );
+    }
+
+  const std::string baseName = std::string(argv[1]) + "/itkImageFileWriterParallelCompressionTest";
+  try
+    {
+    if ( !TestParallelDeflate(itk::ParallelDeflate::ZlibFormat)
+         || !TestParallelDeflate(itk::ParallelDeflate::GzipFormat)
+         || !TestFile(baseName + ".mha", image, true)
+         || !TestFile(baseName + ".mhd", image, true)
+         || !TestFile(baseName + ".nii.gz", image, false)
+         || !TestFile(baseName + ".hdr.gz", image, false) )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
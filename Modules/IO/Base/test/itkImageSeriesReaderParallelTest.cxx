@@ -0,0 +1,253 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageSeriesReader.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkCommand.h"
+#include "itkThreadSupport.h"
+
+namespace
+{
+// Check that the progress increases, and that it is reported from the
+// calling thread only, so at most once per slice. Optionally abort at the
+// first report of a slice.
+class ProgressWatcher
+{
+public:
+  ProgressWatcher(itk::ProcessObject *process, bool abort):
+    m_Process(process), m_Abort(abort), m_LastProgress(0.0f),
+    m_NumberOfSteps(0), m_Decreased(false), m_OtherThread(false)
+  {
+#if defined( ITK_USE_PTHREADS )
+    m_Thread = pthread_self();
+#elif defined( ITK_USE_WIN32_THREADS )
+    m_Thread = GetCurrentThreadId();
+#endif
+  }
+
+  void ShowProgress()
+  {
+#if defined( ITK_USE_PTHREADS )
+    if ( !pthread_equal( m_Thread, pthread_self() ) )
+      {
+      m_OtherThread = true;
+      }
+#elif defined( ITK_USE_WIN32_THREADS )
+    if ( m_Thread != GetCurrentThreadId() )
+      {
+      m_OtherThread = true;
+      }
+#endif
+    const float progress = m_Process->GetProgress();
+    if ( progress < m_LastProgress )
+      {
+      m_Decreased = true;
+      }
+    if ( progress > 0.0f && progress < 1.0f )
+      {
+      ++m_NumberOfSteps;
+      }
+    if ( progress > 0.0f && m_Abort )
+      {
+      m_Process->AbortGenerateDataOn();
+      }
+    m_LastProgress = progress;
+  }
+
+  itk::ProcessObject *m_Process;
+  bool                m_Abort;
+  float               m_LastProgress;
+  unsigned int        m_NumberOfSteps;
+  bool                m_Decreased;
+  bool                m_OtherThread;
+#if defined( ITK_USE_PTHREADS )
+  pthread_t           m_Thread;
+#elif defined( ITK_USE_WIN32_THREADS )
+  DWORD               m_Thread;
+#endif
+};
+
+template< class TPixel >
+int ReadSeriesSeriallyAndInParallel(const std::vector< std::string > & fileNames)
+{
+  typedef itk::Image< TPixel, 3 >             ImageType;
+  typedef itk::ImageSeriesReader< ImageType > ReaderType;
+
+  for ( int reverse = 0; reverse < 2; ++reverse )
+    {
+    typename ReaderType::Pointer serialReader = ReaderType::New();
+    serialReader->SetFileNames(fileNames);
+    serialReader->SetReverseOrder(reverse != 0);
+
+    typename ReaderType::Pointer parallelReader = ReaderType::New();
+    parallelReader->SetFileNames(fileNames);
+    parallelReader->SetReverseOrder(reverse != 0);
+    parallelReader->UseParallelReadOn();
+    parallelReader->SetNumberOfThreads(4);
+    parallelReader->Print(std::cout);
+
+    ProgressWatcher watcher(parallelReader, false);
+    typename itk::SimpleMemberCommand< ProgressWatcher >::Pointer command =
+      itk::SimpleMemberCommand< ProgressWatcher >::New();
+    command->SetCallbackFunction(&watcher, &ProgressWatcher::ShowProgress);
+    parallelReader->AddObserver(itk::ProgressEvent(), command);
+
+    try
+      {
+      serialReader->Update();
+      parallelReader->Update();
+      }
+    catch ( itk::ExceptionObject & e )
+      {
+      std::cerr << e << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    if ( watcher.m_OtherThread )
+      {
+      std::cerr << "The progress was reported from a worker thread" << std::endl;
+      return EXIT_FAILURE;
+      }
+    if ( watcher.m_Decreased || watcher.m_NumberOfSteps > fileNames.size() - 1 )
+      {
+      std::cerr << "Expected at most " << fileNames.size() - 1
+                << " increasing progress steps, got " << watcher.m_NumberOfSteps
+                << ( watcher.m_Decreased ? " with a decrease" : "" ) << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    const ImageType *serial = serialReader->GetOutput();
+    const ImageType *parallel = parallelReader->GetOutput();
+    if ( serial->GetLargestPossibleRegion() != parallel->GetLargestPossibleRegion() )
+      {
+      std::cerr << "The regions differ: " << serial->GetLargestPossibleRegion()
+                << " and " << parallel->GetLargestPossibleRegion() << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    itk::ImageRegionConstIterator< ImageType > sit( serial, serial->GetLargestPossibleRegion() );
+    itk::ImageRegionConstIterator< ImageType > pit( parallel, serial->GetLargestPossibleRegion() );
+    for ( sit.GoToBegin(), pit.GoToBegin(); !sit.IsAtEnd(); ++sit, ++pit )
+      {
+      if ( sit.Get() != pit.Get() )
+        {
+        std::cerr << "Parallel value " << pit.Get() << " at " << sit.GetIndex()
+                  << " differs from " << sit.Get() << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+
+    const typename ReaderType::DictionaryArrayType & serialDictionaries =
+      *serialReader->GetMetaDataDictionaryArray();
+    const typename ReaderType::DictionaryArrayType & parallelDictionaries =
+      *parallelReader->GetMetaDataDictionaryArray();
+    if ( serialDictionaries.size() != fileNames.size()
+         || parallelDictionaries.size() != fileNames.size() )
+      {
+      std::cerr << "Expected " << fileNames.size() << " dictionaries, got "
+                << serialDictionaries.size() << " and "
+                << parallelDictionaries.size() << std::endl;
+      return EXIT_FAILURE;
+      }
+    for ( unsigned int i = 0; i < fileNames.size(); ++i )
+      {
+      if ( serialDictionaries[i]->GetKeys() != parallelDictionaries[i]->GetKeys() )
+        {
+        std::cerr << "The dictionaries of slice " << i << " differ" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // An abort request must stop the parallel reader.
+  typename ReaderType::Pointer abortedReader = ReaderType::New();
+  abortedReader->SetFileNames(fileNames);
+  abortedReader->UseParallelReadOn();
+  abortedReader->SetNumberOfThreads(4);
+  ProgressWatcher abortingWatcher(abortedReader, true);
+  typename itk::SimpleMemberCommand< ProgressWatcher >::Pointer abortCommand =
+    itk::SimpleMemberCommand< ProgressWatcher >::New();
+  abortCommand->SetCallbackFunction(&abortingWatcher, &ProgressWatcher::ShowProgress);
+  abortedReader->AddObserver(itk::ProgressEvent(), abortCommand);
+  try
+    {
+    abortedReader->Update();
+    std::cerr << "Aborting the parallel read did not throw" << std::endl;
+    return EXIT_FAILURE;
+    }
+  catch ( itk::ProcessAborted & e )
+    {
+    std::cout << "Caught expected abort: " << e.GetDescription() << std::endl;
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cerr << "Expected ProcessAborted, caught " << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A missing file must be reported by the parallel reader too.
+  std::vector< std::string > failingFileNames = fileNames;
+  failingFileNames.push_back("ThisFileDoesNotExist.dcm");
+  typename ReaderType::Pointer failingReader = ReaderType::New();
+  failingReader->SetFileNames(failingFileNames);
+  failingReader->UseParallelReadOn();
+  failingReader->SetNumberOfThreads(4);
+  try
+    {
+    failingReader->Update();
+    std::cerr << "Reading a missing file did not throw" << std::endl;
+    return EXIT_FAILURE;
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cout << "Caught expected exception: " << e.GetDescription() << std::endl;
+    }
+
+  return EXIT_SUCCESS;
+}
+}
+
+//
+// Read the same series serially and in parallel, in both orders, and check
+// that the images and the MetaDataDictionaryArrays are identical. The
+// series is read both with the pixel type of the files, straight into the
+// output buffer, and with a pixel type that needs a conversion.
+//
+int itkImageSeriesReaderParallelTest(int ac, char* av[])
+{
+  if ( ac < 3 )
+    {
+    std::cerr << "Usage: " << av[0] << " inputFileName(s)" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::vector< std::string > fileNames;
+  for ( int i = 1; i < ac; ++i )
+    {
+    fileNames.push_back(av[i]);
+    }
+
+  if ( ReadSeriesSeriallyAndInParallel< unsigned char >(fileNames) == EXIT_FAILURE
+       || ReadSeriesSeriallyAndInParallel< short >(fileNames) == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
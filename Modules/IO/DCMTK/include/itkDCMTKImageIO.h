@@ -0,0 +1,172 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkDCMTKImageIO_h
+#define __itkDCMTKImageIO_h
+
+#include "itkImageIOBase.h"
+#include <string>
+#include <vector>
+
+class DcmFileFormat;
+
+namespace itk
+{
+/** \class DCMTKImageIO
+ *
+ *  \brief ImageIO class for reading DICOM images with the DCMTK library.
+ *
+ * The file is parsed once, without loading the values of the large
+ * elements, and the pixel data are then decoded one frame at a time with
+ * DcmElement::getUncompressedFrame(). A requested region covering a few
+ * frames of a multi-frame object only decodes these frames, never the
+ * whole Pixel Data element, so that the reader can be streamed along the
+ * frames (the third dimension). The rows and columns are always read
+ * whole.
+ *
+ * Encapsulated transfer syntaxes are decoded by the JPEG and RLE codecs of
+ * DCMTK, which are registered when the first instance is created.
+ *
+ * The geometry is taken from the functional groups of enhanced multi-frame
+ * objects when they are present, and from the top level dataset
+ * otherwise. The values of the public, non binary, top level elements are
+ * stored in the MetaDataDictionary, with the "gggg|eeee" keys used by
+ * GDCMImageIO.
+ *
+ * The stored values are rescaled with the Rescale Slope and Intercept of
+ * their frame, into the smallest integer type that holds the rescaled range
+ * of all the frames when all the values are integers, and into float
+ * (double for 32 bit data) otherwise.
+ *
+ * YBR_FULL colors, and YBR_FULL_422 colors once decompressed, are converted
+ * to RGB. The other YBR photometric interpretations, which are stored with
+ * subsampled chrominance, are not supported.
+ *
+ * \warning Writing is not supported, GDCMImageIO should be used instead.
+ *
+ * \sa DCMTKSeriesFileNames
+ * \ingroup IOFilters
+ * \ingroup ITKIODCMTK
+ */
+class ITK_EXPORT DCMTKImageIO:public ImageIOBase
+{
+public:
+  /** Standard class typedefs. */
+  typedef DCMTKImageIO         Self;
+  typedef ImageIOBase          Superclass;
+  typedef SmartPointer< Self > Pointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(DCMTKImageIO, ImageIOBase);
+
+  /*-------- This part of the interface deals with reading data. ------ */
+
+  /** Determine the file type. Returns true if this ImageIO can read the
+   * file specified. */
+  virtual bool CanReadFile(const char *);
+
+  /** The frames can be read separately. */
+  virtual bool CanStreamRead()
+  {
+    return true;
+  }
+
+  /** Set the spacing and dimension information for the current filename. */
+  virtual void ReadImageInformation();
+
+  /** Reads the frames of the IORegion into the memory buffer provided. */
+  virtual void Read(void *buffer);
+
+  /** Extend the requested region to whole frames. */
+  virtual ImageIORegion
+  GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requested) const;
+
+  /** Number of frames in the file. */
+  itkGetConstMacro(NumberOfFrames, unsigned int);
+
+  /** Rescale Slope and Rescale Intercept applied to the stored values of
+   * the first frame. Enhanced multi-frame objects may rescale each frame
+   * differently. */
+  itkGetConstMacro(RescaleSlope, double);
+  itkGetConstMacro(RescaleIntercept, double);
+
+  /** Get the component type of the stored values. This differs from
+   * ComponentType which may change as a function of rescale slope and
+   * intercept. */
+  itkGetEnumMacro(InternalComponentType, IOComponentType);
+
+  /*-------- This part of the interfaces deals with writing data. ----- */
+
+  /** Writing is not supported: always returns false. */
+  virtual bool CanWriteFile(const char *)
+  {
+    return false;
+  }
+
+  /** Not supported, throws an exception. */
+  virtual void WriteImageInformation();
+
+  /** Not supported, throws an exception. */
+  virtual void Write(const void *buffer);
+
+protected:
+  DCMTKImageIO();
+  ~DCMTKImageIO();
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+private:
+  DCMTKImageIO(const Self &);   //purposely not implemented
+  void operator=(const Self &); //purposely not implemented
+
+  /** Parse m_FileName, unless it was already parsed and did not change
+   * since. */
+  void OpenFile();
+
+  /** Release the parsed file. */
+  void CloseFile();
+
+  /** Rescale and copy the stored values of frame frameNumber into buffer. */
+  void ConvertFrame(const char *frame, unsigned int frameNumber, char *buffer) const;
+
+  /** Convert the YBR_FULL colors of a decoded frame to RGB, in place. */
+  void ConvertYBRFullToRGB(char *frame) const;
+
+  DcmFileFormat *m_DcmFile;
+  std::string    m_ParsedFileName;
+  long int       m_ParsedModifiedTime;
+
+  unsigned int m_NumberOfFrames;
+  unsigned int m_BitsStored;
+  bool         m_PlanarConfiguration;
+  double       m_RescaleSlope;
+  double       m_RescaleIntercept;
+
+  /** Rescale Slope and Intercept of each frame. */
+  std::vector< double > m_FrameRescaleSlope;
+  std::vector< double > m_FrameRescaleIntercept;
+
+  IOComponentType m_InternalComponentType;
+
+  /** Buffer receiving the stored values of a frame. */
+  std::vector< char > m_FrameBuffer;
+};
+} // end namespace itk
+
+#endif // __itkDCMTKImageIO_h
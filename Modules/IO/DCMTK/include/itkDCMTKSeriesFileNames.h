@@ -0,0 +1,126 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkDCMTKSeriesFileNames_h
+#define __itkDCMTKSeriesFileNames_h
+
+#include "itkProcessObject.h"
+#include "itkObjectFactory.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace itk
+{
+/** \class DCMTKSeriesFileNames
+ * \brief Generate a sequence of filenames from a DICOM series, with DCMTK.
+ *
+ * The DICOM files of the input directory are grouped by Series Instance
+ * UID, and the files of each series are ordered with the same strategy as
+ * GDCMSeriesFileNames:
+ *
+ *   1. By the position of the slices along the normal given by the Image
+ *      Orientation (Patient) of the first file, when every file has an
+ *      Image Position (Patient).
+ *   2. Otherwise by Instance Number, when every file has one.
+ *   3. Otherwise by file name.
+ *
+ * Only the short elements of the headers are loaded, never the pixel data.
+ *
+ * \sa DCMTKImageIO
+ * \ingroup IOFilters
+ * \ingroup ITKIODCMTK
+ */
+class ITK_EXPORT DCMTKSeriesFileNames:public ProcessObject
+{
+public:
+  /** Standard class typedefs. */
+  typedef DCMTKSeriesFileNames Self;
+  typedef ProcessObject        Superclass;
+  typedef SmartPointer< Self > Pointer;
+
+  typedef std::vector< std::string > FileNamesContainerType;
+  typedef std::vector< std::string > SeriesUIDContainerType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(DCMTKSeriesFileNames, ProcessObject);
+
+  /** Set the directory that contains the DICOM series. */
+  void SetInputDirectory(const std::string & name);
+
+  /** Set the directory that contains the DICOM series. */
+  void SetDirectory(const std::string & name)
+  {
+    this->SetInputDirectory(name);
+  }
+
+  /** Returns the ordered file names of the first series found. */
+  const FileNamesContainerType & GetInputFileNames();
+
+  /** Returns the ordered file names of the series with the given Series
+   * Instance UID. */
+  const FileNamesContainerType & GetFileNames(const std::string & seriesUID);
+
+  /** Returns the Series Instance UIDs found in the input directory. */
+  const SeriesUIDContainerType & GetSeriesUIDs();
+
+  /** Recursively parse the input directory */
+  itkSetMacro(Recursive, bool);
+  itkGetConstMacro(Recursive, bool);
+  itkBooleanMacro(Recursive);
+
+protected:
+  DCMTKSeriesFileNames();
+  ~DCMTKSeriesFileNames() {}
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+private:
+  DCMTKSeriesFileNames(const Self &); //purposely not implemented
+  void operator=(const Self &);       //purposely not implemented
+
+  /** Parse the input directory again when it or the settings changed. */
+  void ScanDirectory();
+
+  void AddFile(const std::string & fileName);
+
+  void AddDirectory(const std::string & directory);
+
+  struct SliceInformation {
+    std::string m_FileName;
+    double      m_Position[3];
+    double      m_Orientation[6];
+    long        m_InstanceNumber;
+    bool        m_HasPosition;
+    bool        m_HasInstanceNumber;
+  };
+  typedef std::vector< SliceInformation >             SliceContainerType;
+  typedef std::map< std::string, SliceContainerType > SeriesMapType;
+
+  std::string m_InputDirectory;
+  bool        m_Recursive;
+
+  SeriesMapType          m_Series;
+  SeriesUIDContainerType m_SeriesUIDs;
+  FileNamesContainerType m_FileNames;
+  TimeStamp              m_ScanTime;
+};
+} // end namespace itk
+
+#endif // __itkDCMTKSeriesFileNames_h
@@ -1,13 +1,16 @@
-set(DOCUMENTATION "This module contains the third party <a
-href=\"http://dicom.offis.de/dcmtk/\">DCMTK</a> DCMTK is a collection of libraries and applications implementing large parts the DICOM standard.")
+set(DOCUMENTATION "This module contains ITK ImageIO classes for the <a
+href=\"http://dicom.offis.de/dcmtk/\">DCMTK</a> based reader of the medical
+imaging DICOM standard. Multi-frame objects are decoded one frame at a time,
+which allows streaming.")
 
-itk_module(ITKDCMTK
+itk_module(ITKIODCMTK
   DEPENDS
-     ITKDCMTK
-     ITKIOBase
+    ITKDCMTK
+    ITKIOBase
   TEST_DEPENDS
-     ITKTestKernel
-     ITKImageIntensity
+    ITKTestKernel
+    ITKImageIntensity
+  EXCLUDE_FROM_ALL
   DESCRIPTION
     "${DOCUMENTATION}"
 )
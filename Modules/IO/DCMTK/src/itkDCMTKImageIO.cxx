@@ -0,0 +1,717 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "dcmtk/config/osconfig.h"
+#include "dcmtk/dcmdata/dctk.h"
+#include "dcmtk/dcmdata/dcfcache.h"
+#include "dcmtk/dcmdata/dcrledrg.h"
+#include "dcmtk/dcmjpeg/djdecode.h"
+
+#include "itkDCMTKImageIO.h"
+#include "itkMetaDataObject.h"
+#include "itkNumericTraits.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itksys/SystemTools.hxx"
+#include "vnl/vnl_vector.h"
+#include "vnl/vnl_cross.h"
+#include "vnl/vnl_math.h"
+#include "vcl_cmath.h"
+
+#include <fstream>
+#include <stdio.h>
+#include <string.h>
+
+namespace itk
+{
+namespace
+{
+SimpleFastMutexLock CodecRegistrationLock;
+bool                CodecsRegistered = false;
+
+// The decoders of the encapsulated transfer syntaxes are registered once
+// for the whole process.
+void RegisterCodecs()
+{
+  CodecRegistrationLock.Lock();
+  if ( !CodecsRegistered )
+    {
+    DJDecoderRegistration::registerCodecs();
+    DcmRLEDecoderRegistration::registerCodecs();
+    CodecsRegistered = true;
+    }
+  CodecRegistrationLock.Unlock();
+}
+
+// Enhanced multi-frame objects store their attributes in functional group
+// macros: look for tag in the macro sequence of the per-frame functional
+// group, then of the shared functional group, and finally at the top level
+// of the dataset.
+bool FindFloat64(DcmItem *dataset, DcmItem *perFrame, DcmItem *shared,
+                 const DcmTagKey & macroSequence, const DcmTagKey & tag,
+                 double *values, unsigned long count)
+{
+  DcmItem *candidates[3] = { 0, 0, dataset };
+  DcmItem *macro = 0;
+
+  if ( perFrame && perFrame->findAndGetSequenceItem(macroSequence, macro, 0).good() )
+    {
+    candidates[0] = macro;
+    }
+  macro = 0;
+  if ( shared && shared->findAndGetSequenceItem(macroSequence, macro, 0).good() )
+    {
+    candidates[1] = macro;
+    }
+
+  for ( unsigned int c = 0; c < 3; c++ )
+    {
+    if ( !candidates[c] )
+      {
+      continue;
+      }
+    bool found = true;
+    for ( unsigned long i = 0; i < count && found; i++ )
+      {
+      Float64 value;
+      found = candidates[c]->findAndGetFloat64(tag, value, i).good();
+      values[i] = value;
+      }
+    if ( found )
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+// Convert YBR_FULL values to RGB, PS 3.3 C.7.6.3.1.2, for unsigned values
+// of bitsStored bits.
+template< typename T >
+void YBRFullToRGB(T *frame, SizeValueType numberOfPixels, bool planar, unsigned int bitsStored)
+{
+  const double half = vcl_pow(2.0, static_cast< double >( bitsStored - 1 ));
+  const double maximum = 2.0 * half - 1.0;
+
+  const SizeValueType componentStride = planar ? numberOfPixels : 1;
+  const SizeValueType pixelStride = planar ? 1 : 3;
+
+  for ( SizeValueType p = 0; p < numberOfPixels; p++ )
+    {
+    T *          pixel = frame + p * pixelStride;
+    const double y = pixel[0];
+    const double cb = pixel[componentStride] - half;
+    const double cr = pixel[2 * componentStride] - half;
+
+    const double rgb[3] = {
+      y + 1.402 * cr,
+      y - 0.344136 * cb - 0.714136 * cr,
+      y + 1.772 * cb
+      };
+    for ( unsigned int c = 0; c < 3; c++ )
+      {
+      const double value = vnl_math_min( vnl_math_max(rgb[c], 0.0), maximum );
+      pixel[c * componentStride] = static_cast< T >( value + 0.5 );
+      }
+    }
+}
+
+// Smallest integer component type holding [minimum, maximum] that is not
+// smaller than minimumSize bytes. Returns UNKNOWNCOMPONENTTYPE when none
+// does.
+ImageIOBase::IOComponentType IntegerComponentType(double minimum, double maximum,
+                                                  unsigned int minimumSize)
+{
+  const ImageIOBase::IOComponentType types[6] = {
+    ImageIOBase::UCHAR, ImageIOBase::CHAR,
+    ImageIOBase::USHORT, ImageIOBase::SHORT,
+    ImageIOBase::UINT, ImageIOBase::INT
+    };
+  const double       lower[6] = { 0, -128, 0, -32768, 0, -2147483648.0 };
+  const double       upper[6] = { 255, 127, 65535, 32767, 4294967295.0, 2147483647 };
+  const unsigned int sizes[6] = { 1, 1, 2, 2, 4, 4 };
+
+  for ( unsigned int i = 0; i < 6; i++ )
+    {
+    if ( sizes[i] >= minimumSize && lower[i] <= minimum && maximum <= upper[i] )
+      {
+      return types[i];
+      }
+    }
+  return ImageIOBase::UNKNOWNCOMPONENTTYPE;
+}
+
+// Keep the BitsStored low order bits of a stored value, sign extended for
+// the signed types.
+template< typename T >
+inline T StoredBits(T value, unsigned int bitsStored)
+{
+  const unsigned long mask = ( 1UL << bitsStored ) - 1;
+  const unsigned long bits = static_cast< unsigned long >( value ) & mask;
+
+  if ( NumericTraits< T >::is_signed && ( bits >> ( bitsStored - 1 ) ) )
+    {
+    return static_cast< T >( static_cast< long >( bits ) - static_cast< long >( mask ) - 1 );
+    }
+  return static_cast< T >( bits );
+}
+
+template< typename TStored, typename TOutput >
+void ConvertFrameValues(const char *frame, char *buffer,
+                        SizeValueType numberOfPixels, unsigned int numberOfComponents,
+                        bool planar, unsigned int bitsStored,
+                        double slope, double intercept)
+{
+  const TStored *in = reinterpret_cast< const TStored * >( frame );
+  TOutput *      out = reinterpret_cast< TOutput * >( buffer );
+  const bool     mask = bitsStored < 8 * sizeof( TStored );
+  const bool     rescale = slope != 1.0 || intercept != 0.0;
+
+  for ( SizeValueType p = 0; p < numberOfPixels; p++ )
+    {
+    for ( unsigned int c = 0; c < numberOfComponents; c++ )
+      {
+      TStored value = planar ? in[c * numberOfPixels + p] : in[p * numberOfComponents + c];
+      if ( mask )
+        {
+        value = StoredBits(value, bitsStored);
+        }
+      *out++ = rescale ? static_cast< TOutput >( slope * value + intercept ) : static_cast< TOutput >( value );
+      }
+    }
+}
+
+template< typename TStored >
+void ConvertFrameToOutputType(ImageIOBase::IOComponentType outputType,
+                              const char *frame, char *buffer,
+                              SizeValueType numberOfPixels, unsigned int numberOfComponents,
+                              bool planar, unsigned int bitsStored,
+                              double slope, double intercept)
+{
+#define itkDCMTKConvertCase(type, outputPixelType)                                   \
+    case ImageIOBase::type:                                                        \
+      ConvertFrameValues< TStored, outputPixelType >(frame, buffer, numberOfPixels,  \
+                                                     numberOfComponents, planar,     \
+                                                     bitsStored, slope, intercept); \
+      break
+
+  switch ( outputType )
+    {
+    itkDCMTKConvertCase(UCHAR, unsigned char);
+    itkDCMTKConvertCase(CHAR, char);
+    itkDCMTKConvertCase(USHORT, unsigned short);
+    itkDCMTKConvertCase(SHORT, short);
+    itkDCMTKConvertCase(UINT, unsigned int);
+    itkDCMTKConvertCase(INT, int);
+    itkDCMTKConvertCase(FLOAT, float);
+    itkDCMTKConvertCase(DOUBLE, double);
+    default:
+      itkGenericExceptionMacro(<< "Unexpected component type " << outputType);
+    }
+
+#undef itkDCMTKConvertCase
+}
+}
+
+DCMTKImageIO::DCMTKImageIO()
+{
+  RegisterCodecs();
+
+  // needed for getting the 3 coordinates of the origin, even if it is a 2D
+  // slice.
+  this->SetNumberOfDimensions(3);
+  m_ByteOrder = LittleEndian;
+  m_FileType = Binary;
+
+  m_DcmFile = 0;
+  m_ParsedModifiedTime = 0;
+
+  m_NumberOfFrames = 0;
+  m_BitsStored = 0;
+  m_PlanarConfiguration = false;
+  m_RescaleSlope = 1.0;
+  m_RescaleIntercept = 0.0;
+  m_InternalComponentType = UNKNOWNCOMPONENTTYPE;
+
+  this->AddSupportedReadExtension(".dcm");
+  this->AddSupportedReadExtension(".DCM");
+  this->AddSupportedReadExtension(".dicom");
+  this->AddSupportedReadExtension(".DICOM");
+}
+
+DCMTKImageIO::~DCMTKImageIO()
+{
+  this->CloseFile();
+}
+
+bool DCMTKImageIO::CanReadFile(const char *filename)
+{
+  if ( !filename || *filename == 0 )
+    {
+    itkDebugMacro(<< "No filename specified.");
+    return false;
+    }
+
+  std::ifstream file(filename, std::ios::in | std::ios::binary);
+  if ( file.fail() )
+    {
+    return false;
+    }
+
+  // DICOM files start with a 128 bytes preamble followed by "DICM".
+  char magic[4];
+  file.seekg(128, std::ios::beg);
+  file.read(magic, 4);
+  if ( file.good() && strncmp(magic, "DICM", 4) == 0 )
+    {
+    return true;
+    }
+  file.close();
+
+  // ACR-NEMA files, and DICOM files without the preamble, can only be
+  // recognized by parsing them. Nothing but the short values is loaded.
+  DcmFileFormat dcmFile;
+  if ( dcmFile.loadFile(filename, EXS_Unknown, EGL_noChange, 64).bad() )
+    {
+    return false;
+    }
+  DcmDataset *dataset = dcmFile.getDataset();
+  return dataset->tagExists(DCM_Rows) && dataset->tagExists(DCM_Columns)
+         && dataset->tagExists(DCM_PixelData);
+}
+
+void DCMTKImageIO::OpenFile()
+{
+  const long int modifiedTime = itksys::SystemTools::ModifiedTime( m_FileName.c_str() );
+
+  if ( m_DcmFile && m_ParsedFileName == m_FileName && m_ParsedModifiedTime == modifiedTime )
+    {
+    return;
+    }
+  this->CloseFile();
+
+  // The values longer than DCM_MaxReadLength, such as the pixel data, are
+  // left in the file and only read when they are accessed.
+  DcmFileFormat *dcmFile = new DcmFileFormat;
+  OFCondition    status = dcmFile->loadFile(m_FileName.c_str(), EXS_Unknown, EGL_noChange, DCM_MaxReadLength);
+  if ( status.bad() )
+    {
+    delete dcmFile;
+    itkExceptionMacro(<< "Cannot read " << m_FileName << ": " << status.text());
+    }
+
+  m_DcmFile = dcmFile;
+  m_ParsedFileName = m_FileName;
+  m_ParsedModifiedTime = modifiedTime;
+}
+
+void DCMTKImageIO::CloseFile()
+{
+  delete m_DcmFile;
+  m_DcmFile = 0;
+  m_ParsedFileName = "";
+  m_FrameBuffer.clear();
+}
+
+void DCMTKImageIO::ReadImageInformation()
+{
+  this->OpenFile();
+  DcmDataset *dataset = m_DcmFile->getDataset();
+
+  Uint16 rows = 0;
+  Uint16 columns = 0;
+  Uint16 samplesPerPixel = 1;
+  Uint16 bitsAllocated = 0;
+  Uint16 bitsStored = 0;
+  Uint16 pixelRepresentation = 0;
+  Uint16 planarConfiguration = 0;
+  if ( dataset->findAndGetUint16(DCM_Rows, rows).bad()
+       || dataset->findAndGetUint16(DCM_Columns, columns).bad()
+       || dataset->findAndGetUint16(DCM_BitsAllocated, bitsAllocated).bad()
+       || !dataset->tagExists(DCM_PixelData) )
+    {
+    itkExceptionMacro(<< m_FileName << " does not contain an image");
+    }
+  dataset->findAndGetUint16(DCM_SamplesPerPixel, samplesPerPixel);
+  dataset->findAndGetUint16(DCM_PixelRepresentation, pixelRepresentation);
+  dataset->findAndGetUint16(DCM_PlanarConfiguration, planarConfiguration);
+  if ( dataset->findAndGetUint16(DCM_BitsStored, bitsStored).bad() )
+    {
+    bitsStored = bitsAllocated;
+    }
+
+  Sint32 numberOfFrames = 1;
+  if ( dataset->findAndGetSint32(DCM_NumberOfFrames, numberOfFrames).bad() || numberOfFrames < 1 )
+    {
+    numberOfFrames = 1;
+    }
+  m_NumberOfFrames = numberOfFrames;
+  m_BitsStored = bitsStored;
+
+  switch ( bitsAllocated )
+    {
+    case 8:
+      m_InternalComponentType = pixelRepresentation ? CHAR : UCHAR;
+      break;
+    case 16:
+      m_InternalComponentType = pixelRepresentation ? SHORT : USHORT;
+      break;
+    case 32:
+      m_InternalComponentType = pixelRepresentation ? INT : UINT;
+      break;
+    default:
+      itkExceptionMacro(<< "Unsupported Bits Allocated: " << bitsAllocated);
+    }
+
+  OFString photometricInterpretation;
+  dataset->findAndGetOFString(DCM_PhotometricInterpretation, photometricInterpretation);
+  if ( photometricInterpretation == "PALETTE COLOR" )
+    {
+    itkWarningMacro(<< "The palette is not applied, the indices are read.");
+    }
+
+  // The native color images are stored as in the file. The JPEG decoders
+  // return the colors by pixel, the RLE decoder by plane.
+  const E_TransferSyntax transferSyntax = dataset->getOriginalXfer();
+
+  // YBR_FULL is converted to RGB as the frames are decoded, as is
+  // YBR_FULL_422 once a JPEG decoder has upsampled it. The other YBR
+  // models are subsampled in the file, or come from codecs which are not
+  // registered.
+  if ( photometricInterpretation.substr(0, 3) == "YBR"
+       && photometricInterpretation != "YBR_FULL"
+       && !( photometricInterpretation == "YBR_FULL_422" && DcmXfer(transferSyntax).isEncapsulated() ) )
+    {
+    itkExceptionMacro(<< "Unsupported Photometric Interpretation " << photometricInterpretation.c_str()
+                      << " in " << m_FileName);
+    }
+  if ( photometricInterpretation.substr(0, 3) == "YBR"
+       && ( samplesPerPixel != 3 || pixelRepresentation != 0 || bitsAllocated > 16 ) )
+    {
+    itkExceptionMacro(<< "Unexpected pixel format for Photometric Interpretation "
+                      << photometricInterpretation.c_str() << " in " << m_FileName);
+    }
+  if ( !DcmXfer(transferSyntax).isEncapsulated() )
+    {
+    m_PlanarConfiguration = planarConfiguration == 1;
+    }
+  else
+    {
+    m_PlanarConfiguration = transferSyntax == EXS_RLELossless;
+    }
+
+  m_NumberOfComponents = samplesPerPixel;
+  this->SetPixelType(samplesPerPixel == 1 ? SCALAR : RGB);
+
+  m_Dimensions[0] = columns;
+  m_Dimensions[1] = rows;
+  m_Dimensions[2] = m_NumberOfFrames;
+
+  // Geometry, taken from the first frames of enhanced multi-frame objects.
+  DcmItem *shared = 0;
+  DcmItem *firstFrame = 0;
+  DcmItem *secondFrame = 0;
+  dataset->findAndGetSequenceItem(DCM_SharedFunctionalGroupsSequence, shared, 0);
+  dataset->findAndGetSequenceItem(DCM_PerFrameFunctionalGroupsSequence, firstFrame, 0);
+  if ( m_NumberOfFrames > 1 )
+    {
+    dataset->findAndGetSequenceItem(DCM_PerFrameFunctionalGroupsSequence, secondFrame, 1);
+    }
+
+  double pixelSpacing[2] = { 1.0, 1.0 };
+  FindFloat64(dataset, firstFrame, shared, DCM_PixelMeasuresSequence, DCM_PixelSpacing, pixelSpacing, 2);
+  // Pixel Spacing is the spacing between the rows, then the columns.
+  m_Spacing[0] = pixelSpacing[1];
+  m_Spacing[1] = pixelSpacing[0];
+
+  double orientation[6] = { 1.0, 0.0, 0.0, 0.0, 1.0, 0.0 };
+  FindFloat64(dataset, firstFrame, shared, DCM_PlaneOrientationSequence,
+              DCM_ImageOrientationPatient, orientation, 6);
+  vnl_vector< double > rowDirection(orientation, 3);
+  vnl_vector< double > columnDirection(orientation + 3, 3);
+  vnl_vector< double > sliceDirection = vnl_cross_3d(rowDirection, columnDirection);
+  this->SetDirection(0, rowDirection);
+  this->SetDirection(1, columnDirection);
+  this->SetDirection(2, sliceDirection);
+
+  double origin[3] = { 0.0, 0.0, 0.0 };
+  FindFloat64(dataset, firstFrame, shared, DCM_PlanePositionSequence,
+              DCM_ImagePositionPatient, origin, 3);
+  m_Origin[0] = origin[0];
+  m_Origin[1] = origin[1];
+  m_Origin[2] = origin[2];
+
+  // The spacing between the frames is the distance between the first two
+  // positions along the normal, or as declared when they are not known.
+  double secondOrigin[3];
+  double sliceSpacing = 1.0;
+  if ( secondFrame
+       && FindFloat64(0, secondFrame, 0, DCM_PlanePositionSequence,
+                      DCM_ImagePositionPatient, secondOrigin, 3) )
+    {
+    sliceSpacing = vnl_math_abs( ( secondOrigin[0] - origin[0] ) * sliceDirection[0]
+                            + ( secondOrigin[1] - origin[1] ) * sliceDirection[1]
+                            + ( secondOrigin[2] - origin[2] ) * sliceDirection[2] );
+    }
+  else if ( !FindFloat64(dataset, firstFrame, shared, DCM_PixelMeasuresSequence,
+                         DCM_SpacingBetweenSlices, &sliceSpacing, 1) )
+    {
+    FindFloat64(dataset, firstFrame, shared, DCM_PixelMeasuresSequence,
+                DCM_SliceThickness, &sliceSpacing, 1);
+    }
+  m_Spacing[2] = sliceSpacing > 0.0 ? sliceSpacing : 1.0;
+
+  // Rescale slope and intercept of each frame. The frames of enhanced
+  // multi-frame objects each have their own Pixel Value Transformation.
+  m_FrameRescaleSlope.assign(m_NumberOfFrames, 1.0);
+  m_FrameRescaleIntercept.assign(m_NumberOfFrames, 0.0);
+  for ( unsigned int f = 0; f < m_NumberOfFrames; f++ )
+    {
+    DcmItem *frameItem = firstFrame;
+    if ( f > 0 )
+      {
+      frameItem = 0;
+      dataset->findAndGetSequenceItem(DCM_PerFrameFunctionalGroupsSequence, frameItem, f);
+      }
+    FindFloat64(dataset, frameItem, shared, DCM_PixelValueTransformationSequence,
+                DCM_RescaleSlope, &m_FrameRescaleSlope[f], 1);
+    FindFloat64(dataset, frameItem, shared, DCM_PixelValueTransformationSequence,
+                DCM_RescaleIntercept, &m_FrameRescaleIntercept[f], 1);
+    }
+  m_RescaleSlope = m_FrameRescaleSlope[0];
+  m_RescaleIntercept = m_FrameRescaleIntercept[0];
+
+  // Output component type, holding the rescaled values of all the frames.
+  const double range = vcl_pow(2.0, static_cast< double >( bitsStored ));
+  const double storedMinimum = pixelRepresentation ? -range / 2 : 0.0;
+  const double storedMaximum = pixelRepresentation ? range / 2 - 1 : range - 1;
+
+  bool   rescaled = false;
+  bool   integer = true;
+  double minimum = NumericTraits< double >::max();
+  double maximum = NumericTraits< double >::NonpositiveMin();
+  for ( unsigned int f = 0; f < m_NumberOfFrames; f++ )
+    {
+    const double slope = m_FrameRescaleSlope[f];
+    const double intercept = m_FrameRescaleIntercept[f];
+    const double a = slope * storedMinimum + intercept;
+    const double b = slope * storedMaximum + intercept;
+
+    rescaled = rescaled || slope != 1.0 || intercept != 0.0;
+    integer = integer && slope == vcl_floor(slope) && intercept == vcl_floor(intercept);
+    minimum = vnl_math_min( minimum, vnl_math_min(a, b) );
+    maximum = vnl_math_max( maximum, vnl_math_max(a, b) );
+    }
+
+  m_ComponentType = m_InternalComponentType;
+  if ( rescaled )
+    {
+    m_ComponentType = UNKNOWNCOMPONENTTYPE;
+    if ( integer )
+      {
+      m_ComponentType = IntegerComponentType(minimum, maximum, bitsAllocated / 8);
+      }
+    if ( m_ComponentType == UNKNOWNCOMPONENTTYPE )
+      {
+      m_ComponentType = bitsAllocated == 32 ? DOUBLE : FLOAT;
+      }
+    }
+
+  // Copy of the public top level elements. The binary ones and the
+  // sequences are skipped, so that no large value is loaded.
+  MetaDataDictionary & dico = this->GetMetaDataDictionary();
+  for ( unsigned long i = 0; i < dataset->card(); i++ )
+    {
+    DcmElement *   element = dataset->getElement(i);
+    const DcmTag & tag = element->getTag();
+    if ( tag.isPrivate() || tag == DCM_PixelData )
+      {
+      continue;
+      }
+    switch ( element->ident() )
+      {
+      case EVR_SQ:
+      case EVR_OB:
+      case EVR_OW:
+      case EVR_OF:
+      case EVR_ox:
+      case EVR_UN:
+      case EVR_UNKNOWN:
+      case EVR_pixelSQ:
+        continue;
+      default:
+        break;
+      }
+    OFString value;
+    if ( element->getOFStringArray(value).good() )
+      {
+      char key[10];
+      sprintf(key, "%04x|%04x", tag.getGroup(), tag.getElement());
+      EncapsulateMetaData< std::string >( dico, key, std::string( value.c_str() ) );
+      }
+    }
+}
+
+ImageIORegion
+DCMTKImageIO::GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requested) const
+{
+  ImageIORegion streamableRegion = Superclass::GenerateStreamableReadRegionFromRequestedRegion(requested);
+
+  // Only whole frames are decoded, along the third dimension the requested
+  // frames are enough.
+  if ( streamableRegion.GetImageDimension() > 2 && requested.GetImageDimension() > 2 )
+    {
+    streamableRegion.SetIndex( 2, requested.GetIndex(2) );
+    streamableRegion.SetSize( 2, requested.GetSize(2) );
+    }
+  return streamableRegion;
+}
+
+void DCMTKImageIO::Read(void *buffer)
+{
+  this->OpenFile();
+  DcmDataset *dataset = m_DcmFile->getDataset();
+
+  DcmElement *pixelData = 0;
+  if ( dataset->findAndGetElement(DCM_PixelData, pixelData).bad() || !pixelData )
+    {
+    itkExceptionMacro(<< m_FileName << " does not contain pixel data");
+    }
+
+  Uint32      frameSize = 0;
+  OFCondition status = pixelData->getUncompressedFrameSize(dataset, frameSize);
+  if ( status.bad() )
+    {
+    itkExceptionMacro(<< "Cannot decode the frames of " << m_FileName << ": " << status.text());
+    }
+  m_FrameBuffer.resize(frameSize);
+
+  SizeValueType firstFrame = 0;
+  SizeValueType numberOfFrames = 1;
+  if ( m_IORegion.GetImageDimension() > 2 )
+    {
+    firstFrame = m_IORegion.GetIndex(2);
+    numberOfFrames = m_IORegion.GetSize(2);
+    }
+  if ( firstFrame + numberOfFrames > m_NumberOfFrames )
+    {
+    itkExceptionMacro(<< "Requested frames " << firstFrame << " to " << firstFrame + numberOfFrames - 1
+                      << " of " << m_FileName << ", which has " << m_NumberOfFrames << " frames");
+    }
+
+  const SizeValueType outputFrameSize =
+    static_cast< SizeValueType >( m_Dimensions[0] ) * m_Dimensions[1] * this->GetPixelSize();
+
+  // The cache keeps the file open from one frame to the next, and the start
+  // fragment of the next frame is returned by each call.
+  DcmFileCache cache;
+  Uint32       startFragment = 0;
+  for ( SizeValueType f = 0; f < numberOfFrames; f++ )
+    {
+    OFString colorModel;
+    status = pixelData->getUncompressedFrame(dataset, static_cast< Uint32 >( firstFrame + f ),
+                                             startFragment, &m_FrameBuffer[0], frameSize,
+                                             colorModel, &cache);
+    if ( status.bad() )
+      {
+      itkExceptionMacro(<< "Cannot decode frame " << firstFrame + f << " of " << m_FileName
+                        << ": " << status.text());
+      }
+    // The decoders report the color model of the decoded frame: JPEG
+    // decoders may already have converted the colors to RGB.
+    if ( colorModel == "YBR_FULL" || colorModel == "YBR_FULL_422" )
+      {
+      this->ConvertYBRFullToRGB(&m_FrameBuffer[0]);
+      }
+    this->ConvertFrame(&m_FrameBuffer[0], static_cast< unsigned int >( firstFrame + f ),
+                       static_cast< char * >( buffer ) + f * outputFrameSize);
+    }
+}
+
+void DCMTKImageIO::ConvertYBRFullToRGB(char *frame) const
+{
+  const SizeValueType numberOfPixels = static_cast< SizeValueType >( m_Dimensions[0] ) * m_Dimensions[1];
+
+  if ( m_NumberOfComponents != 3 )
+    {
+    itkExceptionMacro(<< "YBR colors with " << m_NumberOfComponents << " components in " << m_FileName);
+    }
+  switch ( m_InternalComponentType )
+    {
+    case UCHAR:
+      YBRFullToRGB(reinterpret_cast< unsigned char * >( frame ), numberOfPixels,
+                   m_PlanarConfiguration, m_BitsStored);
+      break;
+    case USHORT:
+      YBRFullToRGB(reinterpret_cast< unsigned short * >( frame ), numberOfPixels,
+                   m_PlanarConfiguration, m_BitsStored);
+      break;
+    default:
+      itkExceptionMacro(<< "Unexpected component type " << m_InternalComponentType
+                        << " for YBR colors in " << m_FileName);
+    }
+}
+
+void DCMTKImageIO::ConvertFrame(const char *frame, unsigned int frameNumber, char *buffer) const
+{
+  const SizeValueType numberOfPixels = static_cast< SizeValueType >( m_Dimensions[0] ) * m_Dimensions[1];
+  const double        slope = m_FrameRescaleSlope[frameNumber];
+  const double        intercept = m_FrameRescaleIntercept[frameNumber];
+
+#define itkDCMTKConvertStoredCase(type, storedPixelType)                                   \
+    case type:                                                                           \
+      ConvertFrameToOutputType< storedPixelType >(m_ComponentType, frame, buffer,          \
+                                                  numberOfPixels, m_NumberOfComponents,     \
+                                                  m_PlanarConfiguration, m_BitsStored,      \
+                                                  slope, intercept);                        \
+      break
+
+  switch ( m_InternalComponentType )
+    {
+    itkDCMTKConvertStoredCase(UCHAR, unsigned char);
+    itkDCMTKConvertStoredCase(CHAR, signed char);
+    itkDCMTKConvertStoredCase(USHORT, unsigned short);
+    itkDCMTKConvertStoredCase(SHORT, short);
+    itkDCMTKConvertStoredCase(UINT, unsigned int);
+    itkDCMTKConvertStoredCase(INT, int);
+    default:
+      itkExceptionMacro(<< "Unexpected stored component type " << m_InternalComponentType);
+    }
+
+#undef itkDCMTKConvertStoredCase
+}
+
+void DCMTKImageIO::WriteImageInformation()
+{
+  itkExceptionMacro(<< "DCMTKImageIO does not support writing, use GDCMImageIO");
+}
+
+void DCMTKImageIO::Write(const void *)
+{
+  itkExceptionMacro(<< "DCMTKImageIO does not support writing, use GDCMImageIO");
+}
+
+void DCMTKImageIO::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Internal Component Type: " << this->GetComponentTypeAsString(m_InternalComponentType)
+     << std::endl;
+  os << indent << "NumberOfFrames: " << m_NumberOfFrames << std::endl;
+  os << indent << "BitsStored: " << m_BitsStored << std::endl;
+  os << indent << "RescaleSlope: " << m_RescaleSlope << std::endl;
+  os << indent << "RescaleIntercept: " << m_RescaleIntercept << std::endl;
+}
+} // end namespace itk
@@ -0,0 +1,264 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "dcmtk/config/osconfig.h"
+#include "dcmtk/dcmdata/dctk.h"
+
+#include "itkDCMTKSeriesFileNames.h"
+#include "itksys/Directory.hxx"
+#include "itksys/SystemTools.hxx"
+
+#include <algorithm>
+
+namespace itk
+{
+namespace
+{
+// The values longer than this are not loaded while sorting the files.
+const Uint32 HeaderMaxReadLength = 256;
+
+class PositionAlongNormal
+{
+public:
+  PositionAlongNormal(const double *orientation)
+  {
+    m_Normal[0] = orientation[1] * orientation[5] - orientation[2] * orientation[4];
+    m_Normal[1] = orientation[2] * orientation[3] - orientation[0] * orientation[5];
+    m_Normal[2] = orientation[0] * orientation[4] - orientation[1] * orientation[3];
+  }
+
+  double operator()(const double *position) const
+  {
+    return m_Normal[0] * position[0] + m_Normal[1] * position[1] + m_Normal[2] * position[2];
+  }
+
+private:
+  double m_Normal[3];
+};
+
+template< class TSlice >
+class SliceByPosition
+{
+public:
+  SliceByPosition(const PositionAlongNormal & position):m_Position(position) {}
+
+  bool operator()(const TSlice & a, const TSlice & b) const
+  {
+    return m_Position(a.m_Position) < m_Position(b.m_Position);
+  }
+
+private:
+  PositionAlongNormal m_Position;
+};
+
+template< class TSlice >
+bool SliceByInstanceNumber(const TSlice & a, const TSlice & b)
+{
+  return a.m_InstanceNumber < b.m_InstanceNumber;
+}
+
+template< class TSlice >
+bool SliceByFileName(const TSlice & a, const TSlice & b)
+{
+  return a.m_FileName < b.m_FileName;
+}
+}
+
+DCMTKSeriesFileNames::DCMTKSeriesFileNames()
+{
+  m_Recursive = false;
+}
+
+void DCMTKSeriesFileNames::SetInputDirectory(const std::string & name)
+{
+  if ( name == "" )
+    {
+    itkWarningMacro(<< "You need to specify a directory where the DICOM files are located");
+    return;
+    }
+  if ( !itksys::SystemTools::FileIsDirectory( name.c_str() ) )
+    {
+    itkWarningMacro(<< name << " is not a directory");
+    return;
+    }
+  if ( m_InputDirectory != name )
+    {
+    m_InputDirectory = name;
+    this->Modified();
+    }
+}
+
+void DCMTKSeriesFileNames::AddFile(const std::string & fileName)
+{
+  DcmFileFormat dcmFile;
+
+  if ( dcmFile.loadFile(fileName.c_str(), EXS_Unknown, EGL_noChange, HeaderMaxReadLength).bad() )
+    {
+    return;
+    }
+  DcmDataset *dataset = dcmFile.getDataset();
+  if ( !dataset->tagExists(DCM_PixelData) )
+    {
+    return;
+    }
+
+  OFString seriesUID;
+  dataset->findAndGetOFString(DCM_SeriesInstanceUID, seriesUID);
+
+  SliceInformation slice;
+  slice.m_FileName = fileName;
+  slice.m_HasPosition = true;
+  for ( unsigned long i = 0; i < 3; i++ )
+    {
+    slice.m_HasPosition &= dataset->findAndGetFloat64(DCM_ImagePositionPatient, slice.m_Position[i], i).good();
+    }
+  for ( unsigned long i = 0; i < 6; i++ )
+    {
+    slice.m_HasPosition &= dataset->findAndGetFloat64(DCM_ImageOrientationPatient, slice.m_Orientation[i], i).good();
+    }
+  Sint32 instanceNumber = 0;
+  slice.m_HasInstanceNumber = dataset->findAndGetSint32(DCM_InstanceNumber, instanceNumber).good();
+  slice.m_InstanceNumber = instanceNumber;
+
+  m_Series[seriesUID.c_str()].push_back(slice);
+}
+
+void DCMTKSeriesFileNames::AddDirectory(const std::string & directory)
+{
+  itksys::Directory dir;
+
+  if ( !dir.Load( directory.c_str() ) )
+    {
+    return;
+    }
+  for ( unsigned long i = 0; i < dir.GetNumberOfFiles(); i++ )
+    {
+    const std::string name = dir.GetFile(i);
+    if ( name == "." || name == ".." )
+      {
+      continue;
+      }
+    const std::string path = directory + "/" + name;
+    if ( itksys::SystemTools::FileIsDirectory( path.c_str() ) )
+      {
+      if ( m_Recursive )
+        {
+        this->AddDirectory(path);
+        }
+      }
+    else
+      {
+      this->AddFile(path);
+      }
+    }
+}
+
+void DCMTKSeriesFileNames::ScanDirectory()
+{
+  if ( m_ScanTime.GetMTime() > this->GetMTime() )
+    {
+    return;
+    }
+
+  m_Series.clear();
+  m_SeriesUIDs.clear();
+  if ( m_InputDirectory != "" )
+    {
+    this->AddDirectory(m_InputDirectory);
+    }
+
+  for ( SeriesMapType::iterator it = m_Series.begin(); it != m_Series.end(); ++it )
+    {
+    m_SeriesUIDs.push_back(it->first);
+
+    SliceContainerType & slices = it->second;
+    bool                 havePositions = true;
+    bool                 haveInstanceNumbers = true;
+    for ( SliceContainerType::const_iterator s = slices.begin(); s != slices.end(); ++s )
+      {
+      havePositions &= s->m_HasPosition;
+      haveInstanceNumbers &= s->m_HasInstanceNumber;
+      }
+
+    if ( havePositions )
+      {
+      const PositionAlongNormal position(slices[0].m_Orientation);
+      std::sort( slices.begin(), slices.end(), SliceByPosition< SliceInformation >(position) );
+      }
+    else if ( haveInstanceNumbers )
+      {
+      std::sort( slices.begin(), slices.end(), SliceByInstanceNumber< SliceInformation > );
+      }
+    else
+      {
+      std::sort( slices.begin(), slices.end(), SliceByFileName< SliceInformation > );
+      }
+    }
+
+  m_ScanTime.Modified();
+}
+
+const DCMTKSeriesFileNames::SeriesUIDContainerType &
+DCMTKSeriesFileNames::GetSeriesUIDs()
+{
+  this->ScanDirectory();
+  return m_SeriesUIDs;
+}
+
+const DCMTKSeriesFileNames::FileNamesContainerType &
+DCMTKSeriesFileNames::GetFileNames(const std::string & seriesUID)
+{
+  this->ScanDirectory();
+
+  m_FileNames.clear();
+  SeriesMapType::const_iterator it = m_Series.find(seriesUID);
+  if ( it == m_Series.end() )
+    {
+    itkWarningMacro(<< "No series " << seriesUID << " in " << m_InputDirectory);
+    return m_FileNames;
+    }
+  for ( SliceContainerType::const_iterator s = it->second.begin(); s != it->second.end(); ++s )
+    {
+    m_FileNames.push_back(s->m_FileName);
+    }
+  return m_FileNames;
+}
+
+const DCMTKSeriesFileNames::FileNamesContainerType &
+DCMTKSeriesFileNames::GetInputFileNames()
+{
+  this->ScanDirectory();
+
+  if ( m_SeriesUIDs.empty() )
+    {
+    m_FileNames.clear();
+    return m_FileNames;
+    }
+  return this->GetFileNames(m_SeriesUIDs[0]);
+}
+
+void DCMTKSeriesFileNames::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "InputDirectory: " << m_InputDirectory << std::endl;
+  os << indent << "Recursive: " << ( m_Recursive ? "On" : "Off" ) << std::endl;
+  for ( unsigned int i = 0; i < m_SeriesUIDs.size(); i++ )
+    {
+    os << indent << "SeriesUIDs[" << i << "]: " << m_SeriesUIDs[i] << std::endl;
+    }
+}
+} // end namespace itk
@@ -0,0 +1,144 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageFileReader.h"
+#include "itkImageSeriesReader.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkPipelineMonitorImageFilter.h"
+#include "itkStreamingImageFilter.h"
+#include "itkDCMTKImageIO.h"
+#include "itkDCMTKSeriesFileNames.h"
+
+//
+// Read a DICOM file whole and frame by frame, and check that both give the
+// same image. Then read the series of a directory.
+//
+int itkDCMTKImageIOTest(int ac, char* av[])
+{
+  if ( ac < 3 )
+    {
+    std::cerr << "Usage: " << av[0] << " DicomImage DicomDirectory\n";
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::Image< float, 3 >                     ImageType;
+  typedef itk::ImageFileReader< ImageType >          ReaderType;
+  typedef itk::ImageSeriesReader< ImageType >        SeriesReaderType;
+  typedef itk::PipelineMonitorImageFilter< ImageType > MonitorType;
+  typedef itk::StreamingImageFilter< ImageType, ImageType > StreamerType;
+  typedef itk::DCMTKImageIO                          ImageIOType;
+  typedef itk::DCMTKSeriesFileNames                  SeriesFileNamesType;
+
+  ImageIOType::Pointer dcmtkIO = ImageIOType::New();
+  if ( !dcmtkIO->CanReadFile(av[1]) )
+    {
+    std::cerr << "Cannot read " << av[1] << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(av[1]);
+  reader->SetImageIO(dcmtkIO);
+
+  ReaderType::Pointer streamedReader = ReaderType::New();
+  streamedReader->SetFileName(av[1]);
+  streamedReader->SetImageIO( ImageIOType::New() );
+  streamedReader->UseStreamingOn();
+
+  MonitorType::Pointer monitor = MonitorType::New();
+  monitor->SetInput( streamedReader->GetOutput() );
+
+  StreamerType::Pointer streamer = StreamerType::New();
+  streamer->SetInput( monitor->GetOutput() );
+
+  unsigned int numberOfFrames = 0;
+  try
+    {
+    reader->Update();
+    numberOfFrames = reader->GetOutput()->GetLargestPossibleRegion().GetSize()[2];
+    streamer->SetNumberOfStreamDivisions(numberOfFrames);
+    streamer->Update();
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+  dcmtkIO->Print(std::cout);
+
+  if ( numberOfFrames > 1 && !monitor->VerifyAllInputCanStream(numberOfFrames) )
+    {
+    std::cerr << monitor << std::endl;
+    std::cerr << "The frames were not streamed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  itk::ImageRegionConstIterator< ImageType > it( reader->GetOutput(),
+                                                 reader->GetOutput()->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< ImageType > sit( streamer->GetOutput(),
+                                                  reader->GetOutput()->GetLargestPossibleRegion() );
+  for ( it.GoToBegin(), sit.GoToBegin(); !it.IsAtEnd(); ++it, ++sit )
+    {
+    if ( it.Get() != sit.Get() )
+      {
+      std::cerr << "Streamed value " << sit.Get() << " at " << it.GetIndex()
+                << " differs from " << it.Get() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  if ( reader->GetOutput()->GetMetaDataDictionary().GetKeys().empty() )
+    {
+    std::cerr << "The MetaDataDictionary is empty" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  SeriesFileNamesType::Pointer seriesFileNames = SeriesFileNamesType::New();
+  seriesFileNames->SetInputDirectory(av[2]);
+  const SeriesFileNamesType::FileNamesContainerType & fileNames =
+    seriesFileNames->GetInputFileNames();
+  seriesFileNames->Print(std::cout);
+  if ( fileNames.empty() )
+    {
+    std::cerr << "No series found in " << av[2] << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  SeriesReaderType::Pointer seriesReader = SeriesReaderType::New();
+  seriesReader->SetFileNames(fileNames);
+  seriesReader->SetImageIO( ImageIOType::New() );
+  try
+    {
+    seriesReader->Update();
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Series size: " << seriesReader->GetOutput()->GetLargestPossibleRegion().GetSize()
+            << " spacing: " << seriesReader->GetOutput()->GetSpacing() << std::endl;
+  if ( seriesReader->GetOutput()->GetLargestPossibleRegion().GetSize()[2] != fileNames.size() )
+    {
+    std::cerr << "The series has " << fileNames.size() << " files" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
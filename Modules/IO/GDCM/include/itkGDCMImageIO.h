@@ -33,6 +33,7 @@
 #include "itkImageIOBase.h"
 #include <fstream>
 #include <string>
+#include <vector>
 
 namespace itk
 {
@@ -106,9 +107,43 @@ public:
   /** Set the spacing and dimesion information for the current filename. */
   virtual void ReadImageInformation();
 
-  /** Reads the data from disk into the memory buffer provided. */
+  /** Reads the data from disk into the memory buffer provided.
+   *
+   * The file is parsed only once: the dataset parsed by CanReadFile() or
+   * ReadImageInformation() is kept, and reused by Read() as long as the
+   * file name, modification time and length of the file are unchanged. It
+   * is released once the pixel data have been copied into buffer. */
   virtual void Read(void *buffer);
 
+  /** List of DICOM tags, formatted as the MetaDataDictionary keys
+   * (eg "0010|0010"). */
+  typedef std::vector< std::string > TagListType;
+
+  /** Set/Get the tags loaded into the MetaDataDictionary. When the list is
+   * not empty, only these tags are loaded; by default every public tag is.
+   * The geometry and the pixel data are read regardless. */
+  void SetTagsToLoad(const TagListType & tags);
+  itkGetConstReferenceMacro(TagsToLoad, TagListType);
+
+  /** Set/Get tags that are never loaded into the MetaDataDictionary, for
+   * instance large binary elements nobody reads. */
+  void SetTagsToSkip(const TagListType & tags);
+  itkGetConstReferenceMacro(TagsToSkip, TagListType);
+
+  /** When LazyMetaData is on, the MetaDataDictionary entries are only
+   * converted to strings (or base64 encoded, for binary elements) the first
+   * time their value is accessed, instead of when the file is read. The
+   * entries then keep a reference on the header of the file, without its
+   * pixel data. Off by default. */
+  itkSetMacro(LazyMetaData, bool);
+  itkGetConstMacro(LazyMetaData, bool);
+  itkBooleanMacro(LazyMetaData);
+
+  /** Get the number of times gdcm parsed a file for this ImageIO.
+   * CanReadFile(), ReadImageInformation() and Read() share the parse of a
+   * file: reading an image with ImageFileReader parses it once. */
+  itkGetConstMacro(NumberOfFileParses, SizeValueType);
+
   /** Get the original component type of the image. This differs from
    * ComponentType which may change as a function of rescale slope and
    * intercept. */
@@ -281,6 +316,15 @@ protected:
 
   void InternalReadImageInformation(std::ifstream & file);
 
+  /** Parse filename, unless the dataset kept from a previous parse of the
+   * same file is still up to date. Returns false if gdcm cannot read the
+   * file. The dataset is kept until Read() copies the pixels, or another
+   * file is parsed. */
+  bool ParseFile(const char *filename);
+
+  /** Release the dataset kept by ParseFile(). */
+  void ReleaseParsedFile();
+
   double m_RescaleSlope;
   double m_RescaleIntercept;
 
@@ -320,6 +364,12 @@ private:
 
   ImageIOBase::IOComponentType m_InternalComponentType;
   InternalHeader *             m_DICOMHeader;
+
+  TagListType m_TagsToLoad;
+  TagListType m_TagsToSkip;
+  bool        m_LazyMetaData;
+
+  SizeValueType m_NumberOfFileParses;
 };
 } // end namespace itk
 
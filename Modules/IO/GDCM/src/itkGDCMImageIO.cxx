@@ -37,6 +37,7 @@
 #include "vnl/vnl_cross.h"
 
 #include "itkMetaDataObject.h"
+#include "itkSimpleFastMutexLock.h"
 
 #include "itksys/SystemTools.hxx"
 #include "itksys/Base64.h"
@@ -60,17 +61,306 @@
 #include "gdcmDictEntry.h"
 
 #include <fstream>
+#include <set>
+#include <vector>
+#include <sys/types.h>
+#include <sys/stat.h>
 #include "itksys/ios/sstream"
 
 namespace itk
 {
+/** The dataset and image of the last file parsed, with what is needed to
+ * tell whether the file was modified since. */
 class InternalHeader
 {
 public:
-  InternalHeader():m_Header(0) {}
-  gdcm::File *m_Header;
+  InternalHeader():m_ModifiedTime(0), m_ChangeTime(0), m_FileLength(0), m_FileSerial(0) {}
+  gdcm::SmartPointer< gdcm::File >  m_File;
+  gdcm::SmartPointer< gdcm::Image > m_Image;
+  std::string                       m_FileName;
+  long int                          m_ModifiedTime;
+  long int                          m_ChangeTime;
+  unsigned long                     m_FileLength;
+  unsigned long                     m_FileSerial;
 };
 
+namespace
+{
+// GDCMImageIO always lets gdcm compute the rescaled pixel type. This gdcm
+// global is set once, when the library is loaded, instead of from each
+// read: reads of different files may run concurrently.
+class ForceRescaleInterceptSlopeInitializer
+{
+public:
+  ForceRescaleInterceptSlopeInitializer()
+  {
+    gdcm::ImageHelper::SetForceRescaleInterceptSlope(true);
+  }
+};
+const ForceRescaleInterceptSlopeInitializer forceRescaleInterceptSlopeInitializer;
+
+// Serial number of the file, zero when the platform does not provide one.
+// Rewriting a file by replacing it changes its serial number even within
+// the resolution of the modification time.
+unsigned long FileSerialNumber(const char *filename)
+{
+#if !defined( _WIN32 ) || defined( __CYGWIN__ )
+  struct stat fs;
+  if ( stat(filename, &fs) == 0 )
+    {
+    return static_cast< unsigned long >( fs.st_ino );
+    }
+#else
+  (void)filename;
+#endif
+  return 0;
+}
+
+// TODO: this function was not part of gdcm::Tag API as of gdcm 2.0.10:
+std::string PrintAsPipeSeparatedString(const gdcm::Tag & tag)
+{
+  std::string ret = tag.PrintAsPipeSeparatedString();
+  return ret;
+}
+
+// Only public tags are copied to the MetaDataDictionary. Binary elements
+// are encoded as mime64, only when we do not know of any better
+// representation: VR::US is binary, but user want ASCII representation.
+// Old behavior was to skip SQ, Pixel Data element. I decided that it is
+// not safe to mime64 VR::UN element. There used to be a bug in gdcm 1.2.0
+// and VR:UN element.
+bool IsBinaryVR(const gdcm::VR & vr)
+{
+  return ( vr & ( gdcm::VR::OB | gdcm::VR::OF | gdcm::VR::OW | gdcm::VR::SQ | gdcm::VR::UN ) ) != 0;
+}
+
+bool IsCopiedToDictionary(const gdcm::DataElement & ref, const gdcm::VR & vr)
+{
+  const gdcm::Tag & tag = ref.GetTag();
+
+  if ( !tag.IsPublic() )
+    {
+    return false;
+    }
+  if ( IsBinaryVR(vr) )
+    {
+    return vr != gdcm::VR::SQ && tag != gdcm::Tag(0x7fe0, 0x0010) /* && vr != gdcm::VR::UN*/
+           && ref.GetByteValue() != 0;
+    }
+  return true;
+}
+
+std::string DataElementToString(const gdcm::StringFilter & sf, const gdcm::DataElement & ref, bool binary)
+{
+  if ( !binary )
+    {
+    return sf.ToString( ref.GetTag() );
+    }
+
+  const gdcm::ByteValue *bv = ref.GetByteValue();
+  // base64 streams have to be a multiple of 4 bytes in length
+  int encodedLengthEstimate = 2 * bv->GetLength();
+  encodedLengthEstimate = ( ( encodedLengthEstimate / 4 ) + 1 ) * 4;
+
+  char *       bin = new char[encodedLengthEstimate];
+  unsigned int encodedLengthActual = static_cast< unsigned int >(
+    itksysBase64_Encode(
+      (const unsigned char *)bv->GetPointer(),
+      static_cast< SizeValueType >( bv->GetLength() ),
+      (unsigned char *)bin,
+      static_cast< int >( 0 ) ) );
+  std::string encodedValue(bin, encodedLengthActual);
+  delete[] bin;
+  return encodedValue;
+}
+
+/** \class GDCMLazyHeader
+ * The header shared by the lazy entries of a dictionary. gdcm reference
+ * counts are not thread safe: the entries decode their values, and release
+ * the header, under the lock of the header they share. Its elements are
+ * copies that share no value with the parsed file. */
+class GDCMLazyHeader:public LightObject
+{
+public:
+  typedef GDCMLazyHeader       Self;
+  typedef LightObject          Superclass;
+  typedef SmartPointer< Self > Pointer;
+
+  itkFactorylessNewMacro(Self);
+  itkTypeMacro(GDCMLazyHeader, LightObject);
+
+  void SetTransferSyntax(const gdcm::TransferSyntax & ts)
+  {
+    m_File->GetHeader().SetDataSetTransferSyntax(ts);
+  }
+
+  void AddDataElement(const gdcm::DataElement & ref)
+  {
+    gdcm::DataElement de( ref.GetTag() );
+    de.SetVR( ref.GetVR() );
+    const gdcm::ByteValue *bv = ref.GetByteValue();
+    if ( bv )
+      {
+      de.SetByteValue( bv->GetPointer(), bv->GetLength() );
+      }
+    m_File->GetDataSet().Insert(de);
+    ++m_NumberOfPendingEntries;
+  }
+
+  SimpleFastMutexLock & GetLock() const
+  {
+    return m_Lock;
+  }
+
+  // Both must be called with the lock held.
+  std::string Decode(const gdcm::Tag & tag, bool binary)
+  {
+    std::string value;
+      {
+      gdcm::StringFilter sf;
+      sf.SetFile(*m_File);
+      value = DataElementToString( sf, m_File->GetDataSet().GetDataElement(tag), binary );
+      }
+    this->ReleaseEntry();
+    return value;
+  }
+
+  void ReleaseEntry()
+  {
+    if ( --m_NumberOfPendingEntries == 0 )
+      {
+      m_File = 0;
+      }
+  }
+
+protected:
+  GDCMLazyHeader():m_File(new gdcm::File), m_NumberOfPendingEntries(0) {}
+
+private:
+  GDCMLazyHeader(const Self &); //purposely not implemented
+  void operator=(const Self &); //purposely not implemented
+
+  gdcm::SmartPointer< gdcm::File > m_File;
+  SizeValueType                    m_NumberOfPendingEntries;
+  mutable SimpleFastMutexLock      m_Lock;
+};
+
+/** \class GDCMLazyMetaDataObject
+ * A string MetaDataObject whose value is converted from the DICOM
+ * element the first time it is accessed. */
+class GDCMLazyMetaDataObject:public MetaDataObject< std::string >
+{
+public:
+  typedef GDCMLazyMetaDataObject        Self;
+  typedef MetaDataObject< std::string > Superclass;
+  typedef SmartPointer< Self >          Pointer;
+
+  itkFactorylessNewMacro(Self);
+  itkTypeMacro(GDCMLazyMetaDataObject, MetaDataObject);
+
+  // The header is set once, before the entry is shared.
+  void SetDataElement(GDCMLazyHeader *header, const gdcm::DataElement & ref, bool binary)
+  {
+    header->AddDataElement(ref);
+    m_Header = header;
+    m_Tag = ref.GetTag();
+    m_Binary = binary;
+    m_Decoded = false;
+  }
+
+  virtual const std::string & GetMetaDataObjectValue(void) const
+  {
+    if ( m_Header )
+      {
+      m_Header->GetLock().Lock();
+      if ( !m_Decoded )
+        {
+        Self *self = const_cast< Self * >( this );
+        self->Superclass::SetMetaDataObjectValue( m_Header->Decode(m_Tag, m_Binary) );
+        self->m_Decoded = true;
+        }
+      m_Header->GetLock().Unlock();
+      }
+    return Superclass::GetMetaDataObjectValue();
+  }
+
+  virtual void SetMetaDataObjectValue(const std::string & value)
+  {
+    if ( !m_Header )
+      {
+      Superclass::SetMetaDataObjectValue(value);
+      return;
+      }
+    m_Header->GetLock().Lock();
+    Superclass::SetMetaDataObjectValue(value);
+    if ( !m_Decoded )
+      {
+      m_Header->ReleaseEntry();
+      m_Decoded = true;
+      }
+    m_Header->GetLock().Unlock();
+  }
+
+  virtual void Print(std::ostream & os) const
+  {
+    os << this->GetMetaDataObjectValue() << std::endl;
+  }
+
+protected:
+  GDCMLazyMetaDataObject():m_Binary(false), m_Decoded(true) {}
+
+private:
+  GDCMLazyMetaDataObject(const Self &); //purposely not implemented
+  void operator=(const Self &);         //purposely not implemented
+
+  GDCMLazyHeader::Pointer m_Header;
+  gdcm::Tag               m_Tag;
+  bool                    m_Binary;
+  bool                    m_Decoded;
+};
+
+// Add the element to the dictionary, converted now or, when header is not
+// null, on first access.
+void CopyToDictionary(MetaDataDictionary & dico, const gdcm::StringFilter & sf,
+                      const gdcm::DataElement & ref, GDCMLazyHeader *header)
+{
+  const gdcm::File & f = sf.GetFile();
+  const gdcm::Tag &  tag = ref.GetTag();
+  // Compute VR from the toplevel file, and the currently processed dataset:
+  const gdcm::VR vr = gdcm::DataSetHelper::ComputeVR(f, f.GetDataSet(), tag);
+
+  if ( !IsCopiedToDictionary(ref, vr) )
+    {
+    return;
+    }
+
+  const std::string key = PrintAsPipeSeparatedString(tag);
+  if ( header )
+    {
+    GDCMLazyMetaDataObject::Pointer entry = GDCMLazyMetaDataObject::New();
+    entry->SetDataElement( header, ref, IsBinaryVR(vr) );
+    dico[key] = entry.GetPointer();
+    }
+  else
+    {
+    EncapsulateMetaData< std::string >( dico, key, DataElementToString( sf, ref, IsBinaryVR(vr) ) );
+    }
+}
+
+void ParseTagList(const GDCMImageIO::TagListType & tags, std::set< gdcm::Tag > & parsed)
+{
+  for ( GDCMImageIO::TagListType::const_iterator it = tags.begin(); it != tags.end(); ++it )
+    {
+    gdcm::Tag t;
+    if ( !t.ReadFromPipeSeparatedString( it->c_str() ) )
+      {
+      itkGenericExceptionMacro(<< "Invalid DICOM tag: " << *it);
+      }
+    parsed.insert(t);
+    }
+}
+}
+
 GDCMImageIO::GDCMImageIO()
 {
   this->m_DICOMHeader = new InternalHeader;
@@ -100,17 +390,82 @@ GDCMImageIO::GDCMImageIO()
   // By default use JPEG2000. For legacy system, one should prefer JPEG since
   // JPEG2000 was only recently added to the DICOM standard
   m_CompressionType = JPEG2000;
+
+  m_LazyMetaData = false;
+  m_NumberOfFileParses = 0;
 }
 
-GDCMImageIO::~GDCMImageIO()
+void GDCMImageIO::SetTagsToLoad(const TagListType & tags)
 {
-  if ( this->m_DICOMHeader->m_Header )
+  if ( m_TagsToLoad != tags )
     {
-    delete this->m_DICOMHeader->m_Header;
+    m_TagsToLoad = tags;
+    this->Modified();
     }
+}
+
+void GDCMImageIO::SetTagsToSkip(const TagListType & tags)
+{
+  if ( m_TagsToSkip != tags )
+    {
+    m_TagsToSkip = tags;
+    this->Modified();
+    }
+}
+
+GDCMImageIO::~GDCMImageIO()
+{
   delete this->m_DICOMHeader;
 }
 
+bool GDCMImageIO::ParseFile(const char *filename)
+{
+  // The modification time only has a resolution of one second, the
+  // change time, length and serial number of the file catch most of the
+  // rewrites within that second.
+  const long int      modifiedTime = itksys::SystemTools::ModifiedTime(filename);
+  const long int      changeTime = itksys::SystemTools::CreationTime(filename);
+  const unsigned long fileLength = itksys::SystemTools::FileLength(filename);
+  const unsigned long fileSerial = FileSerialNumber(filename);
+
+  if ( this->m_DICOMHeader->m_Image
+       && this->m_DICOMHeader->m_FileName == filename
+       && this->m_DICOMHeader->m_ModifiedTime == modifiedTime
+       && this->m_DICOMHeader->m_ChangeTime == changeTime
+       && this->m_DICOMHeader->m_FileLength == fileLength
+       && this->m_DICOMHeader->m_FileSerial == fileSerial )
+    {
+    return true;
+    }
+  this->ReleaseParsedFile();
+
+  gdcm::ImageReader reader;
+  reader.SetFileName(filename);
+  ++m_NumberOfFileParses;
+  if ( !reader.Read() )
+    {
+    return false;
+    }
+
+  // The File and the Image are reference counted, keeping a reference
+  // keeps them alive once the reader is gone.
+  this->m_DICOMHeader->m_File = &reader.GetFile();
+  this->m_DICOMHeader->m_Image = &reader.GetImage();
+  this->m_DICOMHeader->m_FileName = filename;
+  this->m_DICOMHeader->m_ModifiedTime = modifiedTime;
+  this->m_DICOMHeader->m_ChangeTime = changeTime;
+  this->m_DICOMHeader->m_FileLength = fileLength;
+  this->m_DICOMHeader->m_FileSerial = fileSerial;
+  return true;
+}
+
+void GDCMImageIO::ReleaseParsedFile()
+{
+  this->m_DICOMHeader->m_File = 0;
+  this->m_DICOMHeader->m_Image = 0;
+  this->m_DICOMHeader->m_FileName = "";
+}
+
 bool GDCMImageIO::OpenGDCMFileForReading(std::ifstream & os,
                                          const char *filename)
 {
@@ -193,30 +548,23 @@ bool GDCMImageIO::CanReadFile(const char *filename)
     }
 
   // Check to see if its a valid dicom file gdcm is able to parse:
-  // We are parsing the header one time here:
-  gdcm::ImageReader reader;
-  reader.SetFileName(filename);
-  if ( reader.Read() )
-    {
-    return true;
-    }
-  return false;
+  // We are parsing the header one time here, the result is reused by
+  // ReadImageInformation() and Read().
+  return this->ParseFile(filename);
 }
 
 void GDCMImageIO::Read(void *pointer)
 {
   const char *filename = m_FileName.c_str();
 
-  itkAssertInDebugAndIgnoreInReleaseMacro( gdcm::ImageHelper::GetForceRescaleInterceptSlope() );
-  gdcm::ImageReader reader;
-  reader.SetFileName(filename);
-  if ( !reader.Read() )
+  if ( !this->ParseFile(filename) )
     {
     itkExceptionMacro(<< "Cannot read requested file");
     return;
     }
+  itkAssertInDebugAndIgnoreInReleaseMacro( gdcm::ImageHelper::GetForceRescaleInterceptSlope() );
 
-  gdcm::Image & image = reader.GetImage();
+  gdcm::Image & image = *this->m_DICOMHeader->m_Image;
   gdcm::PixelFormat pixeltype_debug = image.GetPixelFormat();
   itkAssertInDebugAndIgnoreInReleaseMacro(image.GetNumberOfDimensions() == 2 || image.GetNumberOfDimensions() == 3);
   SizeValueType len = image.GetBufferLength();
@@ -240,12 +588,6 @@ void GDCMImageIO::Read(void *pointer)
     len *= 3;
     }
 
-  if ( !image.GetBuffer( (char*)pointer ) )
-    {
-    itkExceptionMacro(<< "Failed to get the buffer!");
-    return;
-    }
-
   const gdcm::PixelFormat & pixeltype = image.GetPixelFormat();
   itkAssertInDebugAndIgnoreInReleaseMacro( pixeltype_debug == pixeltype ); (void)pixeltype_debug;
 
@@ -256,14 +598,51 @@ void GDCMImageIO::Read(void *pointer)
     r.SetSlope(m_RescaleSlope);
     r.SetPixelFormat(pixeltype);
     gdcm::PixelFormat outputpt = r.ComputeInterceptSlopePixelType();
-    char *            copy = new char[len];
-    memcpy(copy, (char *)pointer, len);
-    r.Rescale( (char *)pointer, copy, len );
-    delete[] copy;
     // WARNING: sizeof(Real World Value) != sizeof(Stored Pixel)
-    len = len * outputpt.GetPixelSize() / pixeltype.GetPixelSize();
+    const SizeValueType outputLen = len * outputpt.GetPixelSize() / pixeltype.GetPixelSize();
+
+    if ( outputLen >= len )
+      {
+      // The stored pixels are loaded at the end of the buffer and rescaled
+      // toward its beginning: the output pixels are at least as large as
+      // the stored ones, so that each stored pixel is read before it is
+      // overwritten, and no temporary copy is needed.
+      char *stored = static_cast< char * >( pointer ) + ( outputLen - len );
+      if ( !image.GetBuffer(stored) )
+        {
+        this->ReleaseParsedFile();
+        itkExceptionMacro(<< "Failed to get the buffer!");
+        return;
+        }
+      r.Rescale(static_cast< char * >( pointer ), stored, len);
+      }
+    else
+      {
+      // gdcm picks the output type from the bits stored, it can be smaller
+      // than the allocated one: the stored pixels do not fit in the output
+      // buffer.
+      std::vector< char > stored(len);
+      if ( !image.GetBuffer(&stored[0]) )
+        {
+        this->ReleaseParsedFile();
+        itkExceptionMacro(<< "Failed to get the buffer!");
+        return;
+        }
+      r.Rescale(static_cast< char * >( pointer ), &stored[0], len);
+      }
+    len = outputLen;
+    }
+  else if ( !image.GetBuffer( (char*)pointer ) )
+    {
+    this->ReleaseParsedFile();
+    itkExceptionMacro(<< "Failed to get the buffer!");
+    return;
     }
 
+  // The pixel data are now in the output buffer, there is no need to keep
+  // a second copy around.
+  this->ReleaseParsedFile();
+
 #ifndef NDEBUG
   // \postcondition
   // Now that len was updated (after unpacker 12bits -> 16bits, rescale...) ,
@@ -274,13 +653,6 @@ void GDCMImageIO::Read(void *pointer)
 #endif
 }
 
-// TODO: this function was not part of gdcm::Tag API as of gdcm 2.0.10:
-static std::string PrintAsPipeSeparatedString(const gdcm::Tag & tag)
-{
-  std::string ret = tag.PrintAsPipeSeparatedString();
-  return ret;
-}
-
 void GDCMImageIO::InternalReadImageInformation(std::ifstream & file)
 {
   //read header
@@ -289,18 +661,12 @@ void GDCMImageIO::InternalReadImageInformation(std::ifstream & file)
     itkExceptionMacro(<< "Cannot read requested file");
     }
 
-  // In general this should be relatively safe to assume
-  gdcm::ImageHelper::SetForceRescaleInterceptSlope(true);
-
-  const char *      filename = m_FileName.c_str();
-  gdcm::ImageReader reader;
-  reader.SetFileName(filename);
-  if ( !reader.Read() )
+  if ( !this->ParseFile( m_FileName.c_str() ) )
     {
     itkExceptionMacro(<< "Cannot read requested file");
     }
-  const gdcm::Image &   image = reader.GetImage();
-  const gdcm::File &    f = reader.GetFile();
+  const gdcm::Image &   image = *this->m_DICOMHeader->m_Image;
+  const gdcm::File &    f = *this->m_DICOMHeader->m_File;
   const gdcm::DataSet & ds = f.GetDataSet();
   const unsigned int *  dims = image.GetDimensions();
 
@@ -420,55 +786,39 @@ void GDCMImageIO::InternalReadImageInformation(std::ifstream & file)
 
   gdcm::StringFilter sf;
   sf.SetFile(f);
-  gdcm::DataSet::ConstIterator it = ds.Begin();
 
-  // Copy of the header->content
-  for (; it != ds.End(); ++it )
+  std::set< gdcm::Tag > tagsToLoad;
+  std::set< gdcm::Tag > tagsToSkip;
+  ParseTagList(m_TagsToLoad, tagsToLoad);
+  ParseTagList(m_TagsToSkip, tagsToSkip);
+
+  // The lazy entries share a header holding a copy of their elements only.
+  GDCMLazyHeader::Pointer header;
+  if ( m_LazyMetaData )
     {
-    const gdcm::DataElement & ref = *it;
-    const gdcm::Tag &         tag = ref.GetTag();
-    // Compute VR from the toplevel file, and the currently processed dataset:
-    gdcm::VR vr = gdcm::DataSetHelper::ComputeVR(f, ds, tag);
+    header = GDCMLazyHeader::New();
+    header->SetTransferSyntax( f.GetHeader().GetDataSetTransferSyntax() );
+    }
 
-    // Process binary field and encode them as mime64: only when we do not know
-    // of any better
-    // representation. VR::US is binary, but user want ASCII representation.
-    if ( vr & ( gdcm::VR::OB | gdcm::VR::OF | gdcm::VR::OW | gdcm::VR::SQ | gdcm::VR::UN ) )
+  // Copy of the header->content. With a list of tags to load, only those are
+  // looked up instead of walking the whole dataset.
+  if ( tagsToLoad.empty() )
+    {
+    for ( gdcm::DataSet::ConstIterator it = ds.Begin(); it != ds.End(); ++it )
       {
-      // itkAssertInDebugAndIgnoreInReleaseMacro( vr & gdcm::VR::VRBINARY );
-      /*
-       * Old behavior was to skip SQ, Pixel Data element. I decided that it is not safe to mime64
-       * VR::UN element. There used to be a bug in gdcm 1.2.0 and VR:UN element.
-       */
-      if ( tag.IsPublic() && vr != gdcm::VR::SQ
-           && tag != gdcm::Tag(0x7fe0, 0x0010) /* && vr != gdcm::VR::UN*/ )
+      if ( tagsToSkip.find( it->GetTag() ) == tagsToSkip.end() )
         {
-        const gdcm::ByteValue *bv = ref.GetByteValue();
-        if ( bv )
-          {
-          // base64 streams have to be a multiple of 4 bytes in length
-          int encodedLengthEstimate = 2 * bv->GetLength();
-          encodedLengthEstimate = ( ( encodedLengthEstimate / 4 ) + 1 ) * 4;
-
-          char *       bin = new char[encodedLengthEstimate];
-          unsigned int encodedLengthActual = static_cast< unsigned int >(
-            itksysBase64_Encode(
-              (const unsigned char *)bv->GetPointer(),
-              static_cast< SizeValueType >( bv->GetLength() ),
-              (unsigned char *)bin,
-              static_cast< int >( 0 ) ) );
-          std::string encodedValue(bin, encodedLengthActual);
-          EncapsulateMetaData< std::string >(dico, PrintAsPipeSeparatedString(tag), encodedValue);
-          delete[] bin;
-          }
+        CopyToDictionary(dico, sf, *it, header.GetPointer());
         }
       }
-    else /* if ( vr & gdcm::VR::VRASCII ) */
+    }
+  else
+    {
+    for ( std::set< gdcm::Tag >::const_iterator it = tagsToLoad.begin(); it != tagsToLoad.end(); ++it )
       {
-      // Only copying field from the public DICOM dictionary
-      if ( tag.IsPublic() )
+      if ( tagsToSkip.find(*it) == tagsToSkip.end() && ds.FindDataElement(*it) )
         {
-        EncapsulateMetaData< std::string >( dico, PrintAsPipeSeparatedString(tag), sf.ToString(tag) );
+        CopyToDictionary(dico, sf, ds.GetDataElement(*it), header.GetPointer());
         }
       }
     }
@@ -499,6 +849,8 @@ void GDCMImageIO::ReadImageInformation()
 {
   std::ifstream file;
 
+  // The parsed file is kept for Read(), which releases it once the pixels
+  // are copied.
   this->InternalReadImageInformation(file);
 }
 
@@ -1148,6 +1500,20 @@ void GDCMImageIO::PrintSelf(std::ostream & os, Indent indent) const
   os << indent << "SeriesInstanceUID: " << m_SeriesInstanceUID << std::endl;
   os << indent << "FrameOfReferenceInstanceUID: " << m_FrameOfReferenceInstanceUID << std::endl;
   os << indent << "CompressionType:" << m_CompressionType << std::endl;
+  os << indent << "TagsToLoad:";
+  for ( TagListType::const_iterator it = m_TagsToLoad.begin(); it != m_TagsToLoad.end(); ++it )
+    {
+    os << " " << *it;
+    }
+  os << std::endl;
+  os << indent << "TagsToSkip:";
+  for ( TagListType::const_iterator it = m_TagsToSkip.begin(); it != m_TagsToSkip.end(); ++it )
+    {
+    os << " " << *it;
+    }
+  os << std::endl;
+  os << indent << "LazyMetaData: " << ( m_LazyMetaData ? "On" : "Off" ) << std::endl;
+  os << indent << "NumberOfFileParses: " << m_NumberOfFileParses << std::endl;
 
 #if defined( ITKIO_DEPRECATED_GDCM1_API )
   os << indent << "Patient Name:" << m_PatientName << std::endl;
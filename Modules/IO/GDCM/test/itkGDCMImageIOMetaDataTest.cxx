@@ -0,0 +1,191 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageFileReader.h"
+#include "itkMetaDataObject.h"
+#include "itkGDCMImageIO.h"
+#include "itkMultiThreader.h"
+
+typedef itk::Image< short, 2 >            ImageType;
+typedef itk::ImageFileReader< ImageType > ReaderType;
+typedef itk::GDCMImageIO                  ImageIOType;
+
+static bool ReadDictionary(const char *filename, ImageIOType *io,
+                           itk::MetaDataDictionary & dict)
+{
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(filename);
+  reader->SetImageIO(io);
+  try
+    {
+    reader->Update();
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return false;
+    }
+  dict = reader->GetOutput()->GetMetaDataDictionary();
+  return true;
+}
+
+struct LazyDecodingThreadData
+{
+  const itk::MetaDataDictionary *m_Full;
+  const itk::MetaDataDictionary *m_Lazy;
+  bool                           m_Failed[ITK_MAX_THREADS];
+};
+
+// Each thread decodes all the entries, from a different first key, through
+// its own copy of the dictionary.
+static ITK_THREAD_RETURN_TYPE LazyDecodingThreadCallback(void *arg)
+{
+  itk::MultiThreader::ThreadInfoStruct *info =
+    static_cast< itk::MultiThreader::ThreadInfoStruct * >( arg );
+  LazyDecodingThreadData *data = static_cast< LazyDecodingThreadData * >( info->UserData );
+
+  const itk::MetaDataDictionary  lazy = *data->m_Lazy;
+  const std::vector< std::string > keys = data->m_Full->GetKeys();
+  for ( size_t i = 0; i < keys.size(); ++i )
+    {
+    const std::string & key = keys[( i + info->ThreadID ) % keys.size()];
+    std::string expected;
+    std::string value;
+    itk::ExposeMetaData< std::string >(*data->m_Full, key, expected);
+    if ( !itk::ExposeMetaData< std::string >(lazy, key, value) || value != expected )
+      {
+      data->m_Failed[info->ThreadID] = true;
+      }
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+//
+// Check that the tag lists and the lazy mode of GDCMImageIO give the same
+// values as a full read of the dictionary.
+//
+int itkGDCMImageIOMetaDataTest(int ac, char* av[])
+{
+  if ( ac < 2 )
+    {
+    std::cerr << "Usage: " << av[0] << " DicomImage\n";
+    return EXIT_FAILURE;
+    }
+
+  itk::MetaDataDictionary full;
+  if ( !ReadDictionary(av[1], ImageIOType::New(), full) )
+    {
+    return EXIT_FAILURE;
+    }
+  std::cout << full.GetKeys().size() << " entries in the full dictionary" << std::endl;
+
+  // Lazy entries must decode to the same values.
+  ImageIOType::Pointer lazyIO = ImageIOType::New();
+  lazyIO->LazyMetaDataOn();
+  itk::MetaDataDictionary lazy;
+  if ( !ReadDictionary(av[1], lazyIO, lazy) )
+    {
+    return EXIT_FAILURE;
+    }
+  if ( lazy.GetKeys().size() != full.GetKeys().size() )
+    {
+    std::cerr << "The lazy dictionary has " << lazy.GetKeys().size() << " entries" << std::endl;
+    return EXIT_FAILURE;
+    }
+  for ( itk::MetaDataDictionary::ConstIterator it = full.Begin(); it != full.End(); ++it )
+    {
+    std::string expected;
+    std::string value;
+    itk::ExposeMetaData< std::string >(full, it->first, expected);
+    if ( !itk::ExposeMetaData< std::string >(lazy, it->first, value) || value != expected )
+      {
+      std::cerr << "Lazy value of " << it->first << " is \"" << value
+                << "\" instead of \"" << expected << "\"" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // The entries of a dictionary share their header: decoding them from
+  // several threads must give the same values.
+  itk::MetaDataDictionary shared;
+  if ( !ReadDictionary(av[1], lazyIO, shared) )
+    {
+    return EXIT_FAILURE;
+    }
+  LazyDecodingThreadData data;
+  data.m_Full = &full;
+  data.m_Lazy = &shared;
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads(4);
+  for ( itk::ThreadIdType i = 0; i < ITK_MAX_THREADS; ++i )
+    {
+    data.m_Failed[i] = false;
+    }
+  threader->SetSingleMethod(LazyDecodingThreadCallback, &data);
+  threader->SingleMethodExecute();
+  for ( itk::ThreadIdType i = 0; i < ITK_MAX_THREADS; ++i )
+    {
+    if ( data.m_Failed[i] )
+      {
+      std::cerr << "Thread " << i << " decoded wrong lazy values" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Only the listed tags are loaded, and the skipped ones never are.
+  const std::string modality = "0008|0060";
+  const std::string rows = "0028|0010";
+  const std::string columns = "0028|0011";
+
+  ImageIOType::TagListType tagsToLoad;
+  tagsToLoad.push_back(modality);
+  tagsToLoad.push_back(rows);
+  tagsToLoad.push_back(columns);
+  ImageIOType::TagListType tagsToSkip;
+  tagsToSkip.push_back(columns);
+
+  ImageIOType::Pointer filteredIO = ImageIOType::New();
+  filteredIO->SetTagsToLoad(tagsToLoad);
+  filteredIO->SetTagsToSkip(tagsToSkip);
+  filteredIO->Print(std::cout);
+  itk::MetaDataDictionary filtered;
+  if ( !ReadDictionary(av[1], filteredIO, filtered) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  const std::vector< std::string > keys = filtered.GetKeys();
+  for ( std::vector< std::string >::const_iterator it = keys.begin(); it != keys.end(); ++it )
+    {
+    std::string value;
+    if ( itk::ExposeMetaData< std::string >(filtered, *it, value)
+         && *it != modality && *it != rows )
+      {
+      std::cerr << "Unexpected tag " << *it << " in the filtered dictionary" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if ( !filtered.HasKey(rows) || filtered.HasKey(columns) )
+    {
+    std::cerr << "The tag lists were not honored" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
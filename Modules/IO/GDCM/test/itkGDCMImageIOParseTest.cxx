@@ -0,0 +1,152 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIterator.h"
+#include "itkGDCMImageIO.h"
+
+typedef itk::Image< short, 2 >            ImageType;
+typedef itk::ImageFileReader< ImageType > ReaderType;
+typedef itk::ImageFileWriter< ImageType > WriterType;
+typedef itk::GDCMImageIO                  ImageIOType;
+
+static ImageType::Pointer CreateImage(unsigned int width, unsigned int height)
+{
+  ImageType::SizeType size;
+  size[0] = width;
+  size[1] = height;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(size);
+  image->Allocate();
+
+  itk::ImageRegionIterator< ImageType > it( image, image->GetLargestPossibleRegion() );
+  short value = 0;
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it, ++value )
+    {
+    it.Set( static_cast< short >( value * 7 % 1000 ) );
+    }
+  return image;
+}
+
+static void WriteImage(const ImageType *image, const std::string & filename)
+{
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(image);
+  writer->SetFileName(filename);
+  writer->SetImageIO( ImageIOType::New() );
+  writer->Update();
+}
+
+static bool CheckParses(const char *description, const ImageIOType *io, itk::SizeValueType expected)
+{
+  if ( io->GetNumberOfFileParses() != expected )
+    {
+    std::cerr << description << ": " << io->GetNumberOfFileParses()
+              << " parses instead of " << expected << std::endl;
+    return false;
+    }
+  std::cout << description << ": " << expected << " parses" << std::endl;
+  return true;
+}
+
+//
+// Check that GDCMImageIO parses a file once for CanReadFile,
+// ReadImageInformation and Read, and again when the file changes.
+//
+int itkGDCMImageIOParseTest(int ac, char* av[])
+{
+  if ( ac < 2 )
+    {
+    std::cerr << "Usage: " << av[0] << " outputDirectory\n";
+    return EXIT_FAILURE;
+    }
+  const std::string filename = std::string(av[1]) + "/itkGDCMImageIOParseTest.dcm";
+
+  try
+    {
+    ImageType::Pointer image = CreateImage(16, 12);
+    WriteImage(image, filename);
+
+    // A read through ImageFileReader parses the file once.
+    ImageIOType::Pointer io = ImageIOType::New();
+    ReaderType::Pointer  reader = ReaderType::New();
+    reader->SetFileName(filename);
+    reader->SetImageIO(io);
+    reader->Update();
+    if ( !CheckParses("ImageFileReader", io, 1) )
+      {
+      return EXIT_FAILURE;
+      }
+    itk::ImageRegionConstIterator< ImageType > it( image, image->GetLargestPossibleRegion() );
+    itk::ImageRegionConstIterator< ImageType > rit( reader->GetOutput(), image->GetLargestPossibleRegion() );
+    for ( it.GoToBegin(), rit.GoToBegin(); !it.IsAtEnd(); ++it, ++rit )
+      {
+      if ( it.Get() != rit.Get() )
+        {
+        std::cerr << "Read " << rit.Get() << " at " << it.GetIndex()
+                  << " instead of " << it.Get() << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+
+    // Read() reuses the parse of CanReadFile() and ReadImageInformation(),
+    // and releases it: the next read parses the file again.
+    ImageIOType::Pointer directIO = ImageIOType::New();
+    if ( !directIO->CanReadFile( filename.c_str() ) )
+      {
+      std::cerr << "Cannot read " << filename << std::endl;
+      return EXIT_FAILURE;
+      }
+    directIO->SetFileName(filename);
+    directIO->ReadImageInformation();
+    std::vector< short > buffer( image->GetLargestPossibleRegion().GetNumberOfPixels() );
+    directIO->Read( &buffer[0] );
+    if ( !CheckParses("CanReadFile, ReadImageInformation and Read", directIO, 1) )
+      {
+      return EXIT_FAILURE;
+      }
+    directIO->ReadImageInformation();
+    if ( !CheckParses("ReadImageInformation after Read", directIO, 2) )
+      {
+      return EXIT_FAILURE;
+      }
+
+    // A file rewritten since it was parsed is parsed again.
+    WriteImage(CreateImage(20, 9), filename);
+    directIO->ReadImageInformation();
+    if ( !CheckParses("ReadImageInformation of the rewritten file", directIO, 3) )
+      {
+      return EXIT_FAILURE;
+      }
+    if ( directIO->GetDimensions(0) != 20 || directIO->GetDimensions(1) != 9 )
+      {
+      std::cerr << "The rewritten file has the size " << directIO->GetDimensions(0)
+                << "x" << directIO->GetDimensions(1) << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
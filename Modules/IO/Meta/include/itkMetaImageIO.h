@@ -21,6 +21,7 @@
 
 #include <fstream>
 #include "itkImageIOBase.h"
+#include "itkParallelDeflate.h"
 #include "metaObject.h"
 #include "metaImage.h"
 
@@ -69,6 +70,11 @@ public:
   /** Reads the data from disk into the memory buffer provided. */
   virtual void Read(void *buffer);
 
+  /** The pixel data can be mapped when they are stored uncompressed, in a
+   * single file and in the byte order of this machine, and are not
+   * subsampled. */
+  virtual bool GetMappablePixelDataLocation(std::string & dataFileName, SizeValueType & offset);
+
   MetaImage * GetMetaImagePointer(void);
 
   /*-------- This part of the interfaces deals with writing data. ----- */
@@ -115,11 +121,12 @@ public:
                            const ImageIORegion & largestPossibleRegion);
 
   /** Determine if the ImageIO can stream reading from this
-   *  file. Only time cannot stream read/write is if compression is used.
+   *  file. Only time cannot stream read/write is if compression is used,
+   *  unless the file has the index of its compressed blocks.
    *  CanRead must be called prior to this function. */
   virtual bool CanStreamRead()
   {
-    if ( m_MetaImage.CompressedData() )
+    if ( m_MetaImage.CompressedData() && m_CompressedDataBlockIndex.BlockOffsets.empty() )
       {
       return false;
       }
@@ -152,8 +159,24 @@ protected:
 
 private:
 
+  /** Parse the index of the compressed blocks from the header, if any. */
+  void ReadCompressedDataBlockIndex();
+
+  /** Read the IORegion from the blocks that hold it. */
+  void ReadCompressedDataBlocks(void *buffer);
+
+  /** Compress the image in blocks, in parallel, and write it with the
+   * index of the blocks. */
+  void WriteCompressedDataBlocks(const void *buffer);
+
+  /** Where the data of dataSize bytes are. */
+  bool GetPixelDataLocation(std::string & dataFileName, SizeValueType dataSize, SizeValueType & offset);
+
   MetaImage m_MetaImage;
 
+  /** Empty unless the file has the index of its compressed blocks. */
+  ParallelDeflate::BlockIndexType m_CompressedDataBlockIndex;
+
   MetaImageIO(const Self &);    //purposely not implemented
   void operator=(const Self &); //purposely not implemented
 
@@ -16,6 +16,7 @@
  *
  *=========================================================================*/
 
+#include <fstream>
 #include <string>
 #include <sstream>
 #include <stdlib.h>
@@ -24,9 +25,24 @@
 #include "itkMetaDataObject.h"
 #include "itkIOCommon.h"
 #include "itksys/SystemTools.hxx"
+#include "itk_zlib.h"
+#include <algorithm>
 
 namespace itk
 {
+namespace
+{
+// The header fields of the index of the blocks written when
+// UseParallelCompression is on. The offsets are counted from the start of
+// the compressed data.
+const char *const CompressedDataBlockSizeField = "CompressedDataBlockSize";
+const char *const CompressedDataBlockOffsetsField = "CompressedDataBlockOffsets";
+
+// MetaIO reads at most 500 characters of a field it does not know: the
+// blocks are made larger when needed to keep the offsets within that.
+const SizeValueType MaximumNumberOfCompressedDataBlocks = 32;
+}
+
 MetaImageIO::MetaImageIO()
 {
   m_FileType = Binary;
@@ -55,6 +71,8 @@ void MetaImageIO::PrintSelf(std::ostream & os, Indent indent) const
   Superclass::PrintSelf(os, indent);
   m_MetaImage.PrintInfo();
   os << indent << "SubSamplingFactor: " << m_SubSamplingFactor << "\n";
+  os << indent << "NumberOfCompressedDataBlocks: "
+     << m_CompressedDataBlockIndex.BlockOffsets.size() << "\n";
 }
 
 void MetaImageIO::SetDataFileName(const char *filename)
@@ -399,6 +417,11 @@ void MetaImageIO::ReadImageInformation()
     {
     std::string key( m_MetaImage.GetAdditionalReadFieldName(f) );
     std::string value ( m_MetaImage.GetAdditionalReadFieldValue(f) );
+    // The block index describes this file only.
+    if ( key == CompressedDataBlockSizeField || key == CompressedDataBlockOffsetsField )
+      {
+      continue;
+      }
     EncapsulateMetaData< std::string >( thisMetaDict,key,value );
     }
 
@@ -419,12 +442,75 @@ void MetaImageIO::ReadImageInformation()
     EncapsulateMetaData< std::string >(
       metaDict, ITK_ExperimentDate, std::string( m_MetaImage.AcquisitionDate() ) );
     }
+
+  this->ReadCompressedDataBlockIndex();
+}
+
+void MetaImageIO::ReadCompressedDataBlockIndex()
+{
+  m_CompressedDataBlockIndex.BlockOffsets.clear();
+  if ( !m_MetaImage.BinaryData() || !m_MetaImage.CompressedData()
+       || m_MetaImage.CompressedDataSize() <= 0 )
+    {
+    return;
+    }
+
+  std::string blockSizeValue;
+  std::string blockOffsetsValue;
+  for ( int f = 0; f < m_MetaImage.GetNumberOfAdditionalReadFields(); f++ )
+    {
+    const std::string key( m_MetaImage.GetAdditionalReadFieldName(f) );
+    if ( key == CompressedDataBlockSizeField )
+      {
+      blockSizeValue = m_MetaImage.GetAdditionalReadFieldValue(f);
+      }
+    else if ( key == CompressedDataBlockOffsetsField )
+      {
+      blockOffsetsValue = m_MetaImage.GetAdditionalReadFieldValue(f);
+      }
+    }
+
+  ParallelDeflate::BlockIndexType index;
+  std::istringstream              blockSizeStream(blockSizeValue);
+  if ( !( blockSizeStream >> index.BlockSize ) || index.BlockSize == 0 )
+    {
+    return;
+    }
+  index.UncompressedSize = static_cast< SizeValueType >( this->GetImageSizeInBytes() );
+  index.CompressedSize = static_cast< SizeValueType >( m_MetaImage.CompressedDataSize() );
+
+  // An index that does not match the data is ignored.
+  const SizeValueType numberOfBlocks =
+    std::max( ( index.UncompressedSize + index.BlockSize - 1 ) / index.BlockSize,
+              static_cast< SizeValueType >( 1 ) );
+  std::istringstream blockOffsetsStream(blockOffsetsValue);
+  SizeValueType      offset;
+  while ( blockOffsetsStream >> offset )
+    {
+    if ( offset >= index.CompressedSize
+         || ( !index.BlockOffsets.empty() && offset <= index.BlockOffsets.back() ) )
+      {
+      return;
+      }
+    index.BlockOffsets.push_back(offset);
+    }
+  if ( index.BlockOffsets.size() != numberOfBlocks )
+    {
+    return;
+    }
+  m_CompressedDataBlockIndex = index;
 }
 
 void MetaImageIO::Read(void *buffer)
 {
   const unsigned int nDims = this->GetNumberOfDimensions();
 
+  if ( !m_CompressedDataBlockIndex.BlockOffsets.empty() && m_SubSamplingFactor == 1 )
+    {
+    this->ReadCompressedDataBlocks(buffer);
+    return;
+    }
+
   // this will check to see if we are actually streaming
   // we initialize with the dimensions of the file, since if
   // largestRegion and ioRegion don't match, we'll use the streaming
@@ -490,6 +576,182 @@ void MetaImageIO::Read(void *buffer)
     }
 }
 
+void MetaImageIO::ReadCompressedDataBlocks(void *buffer)
+{
+  const unsigned int nDims = this->GetNumberOfDimensions();
+  const SizeValueType pixelSize = static_cast< SizeValueType >( this->GetPixelSize() );
+
+  // The region spans the bytes [begin, end) of the uncompressed data.
+  std::vector< SizeValueType > strides(nDims);
+  std::vector< SizeValueType > regionIndex(nDims, 0);
+  std::vector< SizeValueType > regionSize(nDims, 1);
+  SizeValueType                begin = 0;
+  SizeValueType                end = pixelSize;
+  for ( unsigned int i = 0; i < nDims; i++ )
+    {
+    strides[i] = ( i == 0 ? pixelSize : strides[i - 1] * this->GetDimensions(i - 1) );
+    if ( i < m_IORegion.GetImageDimension() )
+      {
+      regionIndex[i] = m_IORegion.GetIndex()[i];
+      regionSize[i] = m_IORegion.GetSize()[i];
+      }
+    begin += regionIndex[i] * strides[i];
+    end += ( regionIndex[i] + regionSize[i] - 1 ) * strides[i];
+    }
+
+  std::string   dataFileName;
+  SizeValueType dataOffset;
+  if ( !this->GetPixelDataLocation(dataFileName, m_CompressedDataBlockIndex.CompressedSize, dataOffset) )
+    {
+    itkExceptionMacro( "File cannot be read: " << this->GetFileName() << " for reading."
+                       << std::endl << "Reason: the compressed data were not found" );
+    }
+
+  SizeValueType compressedBegin;
+  SizeValueType compressedEnd;
+  ParallelDeflate::GetCompressedRange(m_CompressedDataBlockIndex, begin, end,
+                                      compressedBegin, compressedEnd);
+  ParallelDeflate::BufferType compressed(compressedEnd - compressedBegin);
+  std::ifstream               stream(dataFileName.c_str(), std::ios::in | std::ios::binary);
+  stream.seekg(dataOffset + compressedBegin, std::ios::beg);
+  stream.read( reinterpret_cast< char * >( &compressed[0] ), compressed.size() );
+  if ( !stream )
+    {
+    itkExceptionMacro( "File cannot be read: " << dataFileName << " for reading."
+                       << std::endl << "Reason: "
+                       << itksys::SystemTools::GetLastSystemError() );
+    }
+
+  const ThreadIdType        numberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+  const SizeValueType       numberOfPixels = static_cast< SizeValueType >( m_IORegion.GetNumberOfPixels() );
+  if ( end - begin == numberOfPixels * pixelSize )
+    {
+    ParallelDeflate::InflateBlocks(m_CompressedDataBlockIndex, &compressed[0], compressedBegin,
+                                   begin, end, buffer, numberOfThreads);
+    }
+  else
+    {
+    // Inflate the span of the region, and copy its lines.
+    ParallelDeflate::BufferType span(end - begin);
+    ParallelDeflate::InflateBlocks(m_CompressedDataBlockIndex, &compressed[0], compressedBegin,
+                                   begin, end, &span[0], numberOfThreads);
+
+    const SizeValueType          lineSize = regionSize[0] * pixelSize;
+    char *                       out = static_cast< char * >( buffer );
+    std::vector< SizeValueType > lineIndex(nDims, 0);
+    for ( SizeValueType line = 0; line < numberOfPixels / regionSize[0]; line++ )
+      {
+      SizeValueType lineOffset = 0;
+      for ( unsigned int i = 1; i < nDims; i++ )
+        {
+        lineOffset += lineIndex[i] * strides[i];
+        }
+      memcpy(out, &span[lineOffset], lineSize);
+      out += lineSize;
+      for ( unsigned int i = 1; i < nDims && ++lineIndex[i] == regionSize[i]; i++ )
+        {
+        lineIndex[i] = 0;
+        }
+      }
+    }
+
+  m_MetaImage.ElementData(buffer, false);
+  m_MetaImage.ElementByteOrderFix(numberOfPixels);
+}
+
+bool MetaImageIO::GetMappablePixelDataLocation(std::string & dataFileName, SizeValueType & offset)
+{
+  if ( !m_MetaImage.BinaryData() || m_MetaImage.CompressedData() || m_SubSamplingFactor != 1 )
+    {
+    return false;
+    }
+
+  int elementSize;
+  MET_SizeOfType(m_MetaImage.ElementType(), &elementSize);
+  if ( static_cast< unsigned int >( elementSize ) != this->GetComponentSize() )
+    {
+    return false;
+    }
+  if ( elementSize > 1 && m_MetaImage.BinaryDataByteOrderMSB() != MET_SystemByteOrderMSB() )
+    {
+    return false;
+    }
+
+  return this->GetPixelDataLocation(dataFileName,
+                                    static_cast< SizeValueType >( this->GetImageSizeInBytes() ),
+                                    offset);
+}
+
+bool MetaImageIO::GetPixelDataLocation(std::string & dataFileName, SizeValueType dataSize,
+                                       SizeValueType & offset)
+{
+  // Lists of files and numbered files hold the image in several files.
+  const std::string elementDataFileName = m_MetaImage.ElementDataFileName();
+  if ( elementDataFileName.compare(0, 4, "LIST") == 0
+       || elementDataFileName.find('%') != std::string::npos )
+    {
+    return false;
+    }
+
+  const bool local = itksys::SystemTools::LowerCase(elementDataFileName) == "local";
+  if ( local )
+    {
+    dataFileName = m_FileName;
+    }
+  else if ( itksys::SystemTools::FileIsFullPath( elementDataFileName.c_str() ) )
+    {
+    dataFileName = elementDataFileName;
+    }
+  else
+    {
+    dataFileName = itksys::SystemTools::GetFilenamePath(m_FileName);
+    if ( !dataFileName.empty() )
+      {
+      dataFileName += "/";
+      }
+    dataFileName += elementDataFileName;
+    }
+  if ( !itksys::SystemTools::FileExists( dataFileName.c_str(), true ) )
+    {
+    return false;
+    }
+  const SizeValueType fileSize =
+    static_cast< SizeValueType >( itksys::SystemTools::FileLength( dataFileName.c_str() ) );
+
+  // The same rules as MetaImage::M_ReadElements(): a positive HeaderSize is
+  // the offset of the data, -1 puts the data at the end of the file,
+  // otherwise they follow the header.
+  const int headerSize = m_MetaImage.HeaderSize();
+  if ( headerSize > 0 )
+    {
+    offset = headerSize;
+    }
+  else if ( headerSize == -1 )
+    {
+    if ( fileSize < dataSize )
+      {
+      return false;
+      }
+    offset = fileSize - dataSize;
+    }
+  else if ( local )
+    {
+    std::ifstream stream(m_FileName.c_str(), std::ios::in | std::ios::binary);
+    MetaImage     header;
+    if ( !stream.is_open() || !header.ReadStream(0, &stream, false) )
+      {
+      return false;
+      }
+    offset = static_cast< SizeValueType >( stream.tellg() );
+    }
+  else
+    {
+    offset = 0;
+    }
+
+  return offset + dataSize <= fileSize;
+}
+
 MetaImage * MetaImageIO::GetMetaImagePointer(void)
 {
   return &m_MetaImage;
@@ -1043,10 +1305,17 @@ MetaImageIO
     largestRegion.SetSize( i, this->GetDimensions(i) );
     }
 
+  const std::string elementDataFileName = m_MetaImage.ElementDataFileName();
   if ( m_UseCompression && ( largestRegion != m_IORegion ) )
     {
     std::cout << "Compression in use: cannot stream the file writing" << std::endl;
     }
+  else if ( m_UseCompression && m_UseParallelCompression && binaryData
+            && elementDataFileName.compare(0, 4, "LIST") != 0
+            && elementDataFileName.find('%') == std::string::npos )
+    {
+    this->WriteCompressedDataBlocks(buffer);
+    }
   else if (  largestRegion != m_IORegion )
     {
     int *indexMin = new int[nDims];
@@ -1092,6 +1361,96 @@ MetaImageIO
   delete[] eOrigin;
 }
 
+void MetaImageIO::WriteCompressedDataBlocks(const void *buffer)
+{
+  const SizeValueType dataSize = static_cast< SizeValueType >( this->GetImageSizeInBytes() );
+  const SizeValueType blockSize =
+    std::max( std::max( m_CompressionBlockSize, static_cast< SizeValueType >( 1 ) ),
+              ( dataSize + MaximumNumberOfCompressedDataBlocks - 1 ) / MaximumNumberOfCompressedDataBlocks );
+
+  ParallelDeflate::BufferType     compressed;
+  ParallelDeflate::BlockIndexType index;
+  ParallelDeflate::Deflate(buffer, dataSize, blockSize, ParallelDeflate::ZlibFormat,
+                           Z_DEFAULT_COMPRESSION, MultiThreader::GetGlobalDefaultNumberOfThreads(),
+                           compressed, index);
+
+  std::ostringstream blockSizeStream;
+  blockSizeStream << index.BlockSize;
+  std::ostringstream blockOffsetsStream;
+  for ( unsigned int i = 0; i < index.BlockOffsets.size(); i++ )
+    {
+    blockOffsetsStream << ( i > 0 ? " " : "" ) << index.BlockOffsets[i];
+    }
+  const std::string blockSizeValue = blockSizeStream.str();
+  const std::string blockOffsetsValue = blockOffsetsStream.str();
+
+  // Name the data file as MetaImage::Write() does, to know where to put
+  // the data.
+  const char *dataName = 0;
+  std::string generatedDataName;
+  if ( strlen( m_MetaImage.ElementDataFileName() ) == 0 )
+    {
+    if ( itksys::SystemTools::LowerCase( itksys::SystemTools::GetFilenameLastExtension(m_FileName) ) == ".mha" )
+      {
+      generatedDataName = "LOCAL";
+      }
+    else
+      {
+      generatedDataName = itksys::SystemTools::GetFilenameWithoutLastExtension(m_FileName) + ".zraw";
+      }
+    dataName = generatedDataName.c_str();
+    }
+  const std::string elementDataFileName = dataName ? dataName : m_MetaImage.ElementDataFileName();
+
+  // Write the header alone, then the data.
+  m_MetaImage.AddUserField(CompressedDataBlockSizeField, MET_STRING, blockSizeValue.size(),
+                           blockSizeValue.c_str(), false, -1);
+  m_MetaImage.AddUserField(CompressedDataBlockOffsetsField, MET_STRING, blockOffsetsValue.size(),
+                           blockOffsetsValue.c_str(), false, -1);
+  m_MetaImage.CompressedDataSize(index.CompressedSize);
+  const bool headerWritten = m_MetaImage.Write(m_FileName.c_str(), dataName, false);
+  m_MetaImage.RemoveUserField(CompressedDataBlockSizeField);
+  m_MetaImage.RemoveUserField(CompressedDataBlockOffsetsField);
+  m_MetaImage.CompressedDataSize(0);
+
+  const std::string headerFileName = m_MetaImage.FileName();
+  const bool        local = itksys::SystemTools::LowerCase(elementDataFileName) == "local";
+  std::string       dataFileName;
+  if ( local )
+    {
+    dataFileName = headerFileName;
+    }
+  else if ( itksys::SystemTools::FileIsFullPath( elementDataFileName.c_str() ) )
+    {
+    dataFileName = elementDataFileName;
+    }
+  else
+    {
+    dataFileName = itksys::SystemTools::GetFilenamePath(headerFileName);
+    if ( !dataFileName.empty() )
+      {
+      dataFileName += "/";
+      }
+    dataFileName += elementDataFileName;
+    }
+
+  std::ofstream stream;
+  if ( headerWritten )
+    {
+    stream.open(dataFileName.c_str(),
+                std::ios::out | std::ios::binary | ( local ? std::ios::app : std::ios::trunc ) );
+    stream.write( reinterpret_cast< const char * >( &compressed[0] ), compressed.size() );
+    }
+  if ( !headerWritten || !stream )
+    {
+    itkExceptionMacro( "File cannot be written: "
+                       << this->GetFileName()
+                       << std::endl
+                       << "Reason: "
+                       << itksys::SystemTools::GetLastSystemError() );
+    }
+}
+
 /** Given a requested region, determine what could be the region that we can
  * read from the file. This is called the streamable region, which will be
  * smaller than the LargestPossibleRegion and greater or equal to the
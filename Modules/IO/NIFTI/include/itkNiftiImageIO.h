@@ -71,6 +71,12 @@ public:
   /** Reads the data from disk into the memory buffer provided. */
   virtual void Read(void *buffer);
 
+  /** The pixel data can be mapped when the file is not compressed, is in
+   * the byte order of this machine, and holds integer scalars, RGB or RGBA
+   * pixels that are not rescaled. Floating point data are excluded because
+   * niftilib replaces their non-finite values when reading. */
+  virtual bool GetMappablePixelDataLocation(std::string & dataFileName, SizeValueType & offset);
+
   /*-------- This part of the interfaces deals with writing data. ----- */
 
   /** Determine if the file can be written with this ImageIO implementation.
@@ -117,6 +123,11 @@ private:
 
   void  SetImageIOMetadataFromNIfTI();
 
+  /** Write the header and the data m_NiftiImage points to. With
+   * UseParallelCompression, the data of a gzipped file are deflated in
+   * parallel and appended as a gzip member of their own. */
+  void  WriteNiftiImage();
+
   nifti_image *m_NiftiImage;
 
   double m_RescaleSlope;
@@ -21,11 +21,13 @@
 #include "itkMetaDataObject.h"
 #include "itkSpatialOrientationAdapter.h"
 #include "itkNumericTraits.h"
+#include "itkParallelDeflate.h"
 #include "itksys/SystemTools.hxx"
 #include "vnl/vnl_math.h"
 #include "itk_zlib.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <fstream>
 #include <vector>
 
 namespace itk
@@ -921,6 +923,45 @@ void NiftiImageIO::SetImageIOMetadataFromNIfTI()
     }
 }
 
+bool
+NiftiImageIO
+::GetMappablePixelDataLocation(std::string & dataFileName, SizeValueType & offset)
+{
+  // The layouts that Read() copies as they are stored.
+  if ( this->GetNumberOfComponents() != 1
+       && this->GetPixelType() != RGB
+       && this->GetPixelType() != RGBA )
+    {
+    return false;
+    }
+  if ( this->MustRescale()
+       || this->m_ComponentType != this->m_OnDiskComponentType
+       || this->m_ComponentType == FLOAT
+       || this->m_ComponentType == DOUBLE )
+    {
+    return false;
+    }
+
+  nifti_image *header = nifti_image_read(this->GetFileName(), false);
+  if ( header == 0 )
+    {
+    return false;
+    }
+  const bool mappable =
+    header->iname != 0
+    && header->iname_offset >= 0
+    && !nifti_is_gzfile(header->iname)
+    && ( header->swapsize <= 1 || header->byteorder == nifti_short_order() )
+    && static_cast< SizeType >( header->nvox ) * header->nbyper == this->GetImageSizeInBytes();
+  if ( mappable )
+    {
+    dataFileName = header->iname;
+    offset = static_cast< SizeValueType >( header->iname_offset );
+    }
+  nifti_image_free(header);
+  return mappable;
+}
+
 void
 NiftiImageIO
 ::ReadImageInformation()
@@ -1853,6 +1894,42 @@ NiftiImageIO::SetNIfTIOrientationFromImageIO(unsigned short int origdims, unsign
   //  this->m_NiftiImage->sform_code = 0;
 }
 
+void
+NiftiImageIO
+::WriteNiftiImage()
+{
+  if ( !m_UseParallelCompression || !nifti_is_gzfile(this->m_NiftiImage->fname) )
+    {
+    nifti_image_write(this->m_NiftiImage);
+    return;
+    }
+
+  // The header, the extensions and the padding up to the data go in a
+  // gzip member written by niftilib. gzip readers, niftilib's included,
+  // read the members that follow as the continuation of the file.
+  znzFile file = nifti_image_write_hdr_img(this->m_NiftiImage, 2, "wb");
+  if ( znz_isnull(file) )
+    {
+    itkExceptionMacro( << "Could not write " << this->GetFileName() );
+    }
+  znzclose(file);
+
+  ParallelDeflate::BufferType     compressed;
+  ParallelDeflate::BlockIndexType index;
+  ParallelDeflate::Deflate(this->m_NiftiImage->data, nifti_get_volsize(this->m_NiftiImage),
+                           m_CompressionBlockSize, ParallelDeflate::GzipFormat,
+                           Z_DEFAULT_COMPRESSION, MultiThreader::GetGlobalDefaultNumberOfThreads(),
+                           compressed, index);
+
+  std::ofstream stream(this->m_NiftiImage->iname, std::ios::out | std::ios::binary | std::ios::app);
+  stream.write( reinterpret_cast< const char * >( &compressed[0] ), compressed.size() );
+  if ( !stream )
+    {
+    itkExceptionMacro( << "Could not write the data of " << this->GetFileName()
+                       << " to " << this->m_NiftiImage->iname );
+    }
+}
+
 /**
  * Write the image Information before writing data
  */
@@ -1870,7 +1947,7 @@ NiftiImageIO
     // Need a const cast here so that we don't have to copy the memory
     // for writing.
     this->m_NiftiImage->data = const_cast< void * >( buffer );
-    nifti_image_write(this->m_NiftiImage);
+    this->WriteNiftiImage();
     this->m_NiftiImage->data = 0; // if left pointing to data buffer
     // nifti_image_free will try and free this memory
     }
@@ -1952,7 +2029,7 @@ NiftiImageIO
     //Need a const cast here so that we don't have to copy the memory for
     //writing.
     this->m_NiftiImage->data = (void *)nifti_buf;
-    nifti_image_write(this->m_NiftiImage);
+    this->WriteNiftiImage();
     this->m_NiftiImage->data = 0; // if left pointing to data buffer
     delete[] nifti_buf;
     }
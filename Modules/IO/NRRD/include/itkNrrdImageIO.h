@@ -65,6 +65,11 @@ public:
   /** Reads the data from disk into the memory buffer provided. */
   virtual void Read(void *buffer);
 
+  /** The pixel data can be mapped when they are stored with the raw
+   * encoding, in a single data file, in the byte order of this machine and
+   * with the components on the fastest axis. */
+  virtual bool GetMappablePixelDataLocation(std::string & dataFileName, SizeValueType & offset);
+
   /** Determine the file type. Returns true if this ImageIO can write the
    * file specified. */
   virtual bool CanWriteFile(const char *);
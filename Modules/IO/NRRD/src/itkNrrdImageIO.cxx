@@ -818,6 +818,78 @@ void NrrdImageIO::Read(void *buffer)
     }
 }
 
+bool NrrdImageIO::GetMappablePixelDataLocation(std::string & dataFileName, SizeValueType & offset)
+{
+  // The masked tensors are cropped by Read().
+  if ( ImageIOBase::SYMMETRICSECONDRANKTENSOR == this->GetPixelType() )
+    {
+    return false;
+    }
+
+  Nrrd *       nrrd = nrrdNew();
+  NrrdIoState *nio = nrrdIoStateNew();
+
+  bool saveFPEState(FloatingPointExceptions::GetExceptionAction());
+  FloatingPointExceptions::Disable();
+
+  // Read the header again, keeping the data file open and positioned, after
+  // the line and byte skips, on the first byte of the data.
+  nrrdIoStateSet(nio, nrrdIoStateSkipData, 1);
+  nrrdIoStateSet(nio, nrrdIoStateKeepNrrdDataFileOpen, 1);
+  bool mappable = ( nrrdLoad(nrrd, this->GetFileName(), nio) == 0 );
+  if ( !mappable )
+    {
+    free( biffGetDone(NRRD) );
+    }
+
+  FloatingPointExceptions::SetEnabled(saveFPEState);
+
+  unsigned int rangeAxisIdx[NRRD_DIM_MAX];
+  mappable = mappable
+             && nio->dataFile
+             && nio->encoding == nrrdEncodingRaw
+             && !nio->dataFNFormat
+             && nio->dataFNArr->len <= 1
+             && ( nrrdElementSize(nrrd) == 1 || nio->endian == airMyEndian )
+             && nrrdElementSize(nrrd) == this->GetComponentSize()
+             && ( nrrdRangeAxesGet(nrrd, rangeAxisIdx) == 0 || rangeAxisIdx[0] == 0 );
+
+  if ( mappable )
+    {
+    const long position = ftell(nio->dataFile);
+    mappable = ( position >= 0 );
+    offset = static_cast< SizeValueType >( position );
+    if ( nio->dataFNArr->len == 0 )
+      {
+      // The data are attached to the header.
+      dataFileName = this->GetFileName();
+      }
+    else
+      {
+      // Same rule as nrrdIoStateDataFileIterNext() for header-relative
+      // data files.
+      const std::string name = nio->dataFN[0];
+      if ( name != "-" && ( name.size() < 2 || name[1] != ':' ) && name[0] != '/' )
+        {
+        dataFileName = std::string( airStrlen(nio->path) ? nio->path : "." ) + "/" + name;
+        }
+      else
+        {
+        dataFileName = name;
+        }
+      mappable = mappable && name != "-";
+      }
+    }
+
+  if ( nio->dataFile )
+    {
+    airFclose(nio->dataFile);
+    }
+  nrrdNix(nrrd);
+  nrrdIoStateNix(nio);
+  return mappable;
+}
+
 bool NrrdImageIO::CanWriteFile(const char *name)
 {
   std::string filename = name;
@@ -25,6 +25,7 @@
 #include "itkSize.h"
 #include "itkObject.h"
 #include "itkArray.h"
+#include "itkMultiThreader.h"
 
 #include "itkSubsample.h"
 
@@ -466,6 +467,13 @@ private:
  * GetSearchResult method returns a pointer to a NearestNeighbors object
  * with k-nearest neighbors.
  *
+ * When the root is set, the tree is also copied to arrays in breadth-first
+ * order: the nodes, and the instance identifiers and measurement values of
+ * the points of each node stored contiguously. The searches walk these
+ * arrays and never access the sample, so they can be run concurrently.
+ * The Search method taking a vector of query points spreads them over
+ * the threads. The tree must be generated again when the sample changes.
+ *
  * <b>Recent API changes:</b>
  * The static const macro to get the length of a measurement vector,
  * 'MeasurementVectorSize'  has been removed to allow the length of a measurement
@@ -642,6 +650,7 @@ public:
       this->DeleteNode( this->m_Root );
       }
     this->m_Root = root;
+    this->FlattenTree();
   }
 
   /** Returns the pointer to the root node. */
@@ -665,6 +674,11 @@ public:
     return m_Sample->GetFrequency( id );
   }
 
+  /** Set/Get the number of threads used by the searches of several query
+   * points. */
+  itkSetClampMacro( NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS );
+  itkGetConstMacro( NumberOfThreads, ThreadIdType );
+
   /** Get the pointer to the distance metric. */
   DistanceMetricType * GetDistanceMetric()
   {
@@ -675,6 +689,11 @@ public:
   void Search( const MeasurementVectorType &, unsigned int,
     InstanceIdentifierVectorType & ) const;
 
+  /** Searches the k-nearest neighbors of each query point, with the
+   * threads */
+  void Search( const std::vector< MeasurementVectorType > &, unsigned int,
+    std::vector< InstanceIdentifierVectorType > & ) const;
+
   /** Searches the neighbors fallen into a hypersphere */
   void Search( const MeasurementVectorType &, double,
     InstanceIdentifierVectorType & ) const;
@@ -722,20 +741,53 @@ protected:
 
   void PrintSelf( std::ostream & os, Indent indent ) const;
 
-  /** search loop */
-  int NearestNeighborSearchLoop( const KdTreeNodeType *,
+  /** search loop, over the nodes of the flattened tree */
+  int NearestNeighborSearchLoop( SizeValueType,
     const MeasurementVectorType &, MeasurementVectorType &,
     MeasurementVectorType &, NearestNeighbors & ) const;
 
-  /** search loop */
-  int SearchLoop( const KdTreeNodeType *, const MeasurementVectorType &,
+  /** search loop, over the nodes of the flattened tree */
+  int SearchLoop( SizeValueType, const MeasurementVectorType &,
     double, MeasurementVectorType &, MeasurementVectorType &,
     InstanceIdentifierVectorType & ) const;
 
+  /** Copies the tree under the root to the flat arrays */
+  void FlattenTree();
+
 private:
   KdTree( const Self & );         //purposely not implemented
   void operator=( const Self & ); //purposely not implemented
 
+  /** Node of the flattened tree. The points of the node are
+   * [Begin, End) in the flat point arrays: the bucket of a terminal
+   * node, or the point of a nonterminal node. An empty terminal node has
+   * no point. */
+  struct FlatNodeType
+    {
+    bool            Terminal;
+    unsigned int    PartitionDimension;
+    MeasurementType PartitionValue;
+    SizeValueType   Left;
+    SizeValueType   Right;
+    SizeValueType   Begin;
+    SizeValueType   End;
+    };
+
+  /** Euclidean distance between the query and a point of the flat arrays,
+   * computed as EuclideanDistanceMetric does */
+  double EvaluateFlatDistance( const MeasurementVectorType &,
+    SizeValueType ) const;
+
+  struct SearchThreadStruct
+    {
+    const Self *                                  Tree;
+    const std::vector< MeasurementVectorType > *  Queries;
+    unsigned int                                  NumberOfNeighbors;
+    std::vector< InstanceIdentifierVectorType > * Results;
+    };
+
+  static ITK_THREAD_RETURN_TYPE SearchThreaderCallback( void *arg );
+
   /** Pointer to the input sample */
   const TSample *m_Sample;
 
@@ -753,6 +805,18 @@ private:
 
   /** Measurement vector size */
   MeasurementVectorSizeType m_MeasurementVectorSize;
+
+  /** Nodes of the flattened tree in breadth-first order, the root first */
+  std::vector< FlatNodeType > m_FlatNodes;
+
+  /** Instance identifiers of the points of the flat nodes, in node order */
+  std::vector< InstanceIdentifier > m_FlatInstanceIdentifiers;
+
+  /** Measurement values of the points of the flat nodes, in node order */
+  std::vector< MeasurementType > m_FlatMeasurements;
+
+  /** Number of threads of the searches of several query points */
+  ThreadIdType m_NumberOfThreads;
 };  // end of class
 } // end of namespace Statistics
 } // end of namespace itk
@@ -85,6 +85,7 @@ KdTree<TSample>
   this->m_Root = 0;
   this->m_BucketSize = 16;
   this->m_MeasurementVectorSize = 0;
+  this->m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
 }
 
 template<class TSample>
@@ -126,6 +127,9 @@ KdTree<TSample>
     }
   os << indent << "MeasurementVectorSize: "
      << this->m_MeasurementVectorSize << std::endl;
+  os << indent << "Number of flat nodes: " << this->m_FlatNodes.size()
+     << std::endl;
+  os << indent << "NumberOfThreads: " << this->m_NumberOfThreads << std::endl;
 }
 
 template<class TSample>
@@ -168,9 +172,113 @@ KdTree<TSample>
   this->m_MeasurementVectorSize = this->m_Sample->GetMeasurementVectorSize();
   this->m_DistanceMetric->SetMeasurementVectorSize(
     this->m_MeasurementVectorSize );
+  this->FlattenTree();
   this->Modified();
 }
 
+template<class TSample>
+void
+KdTree<TSample>
+::FlattenTree()
+{
+  this->m_FlatNodes.clear();
+  this->m_FlatInstanceIdentifiers.clear();
+  this->m_FlatMeasurements.clear();
+  if( this->m_Root == 0 || this->m_Sample == 0 )
+    {
+    return;
+    }
+
+  // List the nodes in breadth-first order. The children of a node are
+  // listed after all the nodes of its level, and next to each other.
+  std::vector< const KdTreeNodeType * > nodes;
+  nodes.push_back( this->m_Root );
+  SizeValueType numberOfPoints = 0;
+  for( SizeValueType n = 0; n < nodes.size(); n++ )
+    {
+    const KdTreeNodeType *node = nodes[n];
+    if( node->IsTerminal() )
+      {
+      if( node != this->m_EmptyTerminalNode )
+        {
+        numberOfPoints += node->Size();
+        }
+      }
+    else
+      {
+      nodes.push_back( node->Left() );
+      nodes.push_back( node->Right() );
+      numberOfPoints++;
+      }
+    }
+
+  this->m_FlatNodes.resize( nodes.size() );
+  this->m_FlatInstanceIdentifiers.reserve( numberOfPoints );
+  this->m_FlatMeasurements.reserve( numberOfPoints *
+    this->m_MeasurementVectorSize );
+
+  SizeValueType nextChild = 1;
+  for( SizeValueType n = 0; n < nodes.size(); n++ )
+    {
+    const KdTreeNodeType *node = nodes[n];
+    FlatNodeType & flatNode = this->m_FlatNodes[n];
+    flatNode.Terminal = node->IsTerminal();
+    flatNode.PartitionDimension = 0;
+    flatNode.PartitionValue = NumericTraits< MeasurementType >::Zero;
+    flatNode.Left = 0;
+    flatNode.Right = 0;
+    flatNode.Begin = this->m_FlatInstanceIdentifiers.size();
+
+    unsigned int numberOfNodePoints = 0;
+    if( flatNode.Terminal )
+      {
+      if( node != this->m_EmptyTerminalNode )
+        {
+        numberOfNodePoints = node->Size();
+        }
+      }
+    else
+      {
+      node->GetParameters( flatNode.PartitionDimension,
+        flatNode.PartitionValue );
+      flatNode.Left = nextChild++;
+      flatNode.Right = nextChild++;
+      numberOfNodePoints = 1;
+      }
+
+    for( unsigned int i = 0; i < numberOfNodePoints; i++ )
+      {
+      const InstanceIdentifier id = node->GetInstanceIdentifier( i );
+      const MeasurementVectorType & measurement =
+        this->m_Sample->GetMeasurementVector( id );
+      this->m_FlatInstanceIdentifiers.push_back( id );
+      for( unsigned int d = 0; d < this->m_MeasurementVectorSize; d++ )
+        {
+        this->m_FlatMeasurements.push_back( measurement[d] );
+        }
+      }
+    flatNode.End = this->m_FlatInstanceIdentifiers.size();
+    }
+}
+
+template<class TSample>
+inline double
+KdTree<TSample>
+::EvaluateFlatDistance( const MeasurementVectorType & query,
+  SizeValueType point ) const
+{
+  const MeasurementType *measurement =
+    &( this->m_FlatMeasurements[point * this->m_MeasurementVectorSize] );
+
+  double sumOfSquares = NumericTraits< double >::Zero;
+  for( unsigned int d = 0; d < this->m_MeasurementVectorSize; d++ )
+    {
+    const double temp = query[d] - measurement[d];
+    sumOfSquares += temp * temp;
+    }
+  return vcl_sqrt( sumOfSquares );
+}
+
 template<class TSample>
 void
 KdTree<TSample>
@@ -210,40 +318,123 @@ KdTree<TSample>
     upperBound[d] = static_cast< MeasurementType >( vcl_sqrt(
       static_cast<double >( NumericTraits< MeasurementType >::max() ) / 2.0 ) );
     }
-  this->NearestNeighborSearchLoop( this->m_Root, query, lowerBound, upperBound,
-    nearestNeighbors );
+  if( !this->m_FlatNodes.empty() )
+    {
+    if( NumericTraits<MeasurementVectorType>::GetLength( query ) !=
+      this->m_MeasurementVectorSize )
+      {
+      itkExceptionMacro( "The query point and the measurement vectors of "
+        << "the tree have unequal size" );
+      }
+    this->NearestNeighborSearchLoop( 0, query, lowerBound, upperBound,
+      nearestNeighbors );
+    }
 
   result = nearestNeighbors.GetNeighbors();
 }
 
+template<class TSample>
+void
+KdTree<TSample>
+::Search( const std::vector< MeasurementVectorType > & queries,
+  unsigned int numberOfNeighborsRequested,
+  std::vector< InstanceIdentifierVectorType > & results ) const
+{
+  if( numberOfNeighborsRequested > this->Size() )
+    {
+    itkExceptionMacro( "The numberOfNeighborsRequested for the nearest "
+      << "neighbor search should be less than or equal to the number of "
+      << "the measurement vectors." );
+    }
+  for( SizeValueType q = 0; q < queries.size(); q++ )
+    {
+    if( NumericTraits<MeasurementVectorType>::GetLength( queries[q] ) !=
+      this->m_MeasurementVectorSize )
+      {
+      itkExceptionMacro( "The query point " << q << " and the measurement "
+        << "vectors of the tree have unequal size" );
+      }
+    }
+
+  results.resize( queries.size() );
+
+  SearchThreadStruct str;
+  str.Tree = this;
+  str.Queries = &queries;
+  str.NumberOfNeighbors = numberOfNeighborsRequested;
+  str.Results = &results;
+
+  ThreadIdType numberOfThreads = this->m_NumberOfThreads;
+  if( queries.size() < numberOfThreads )
+    {
+    numberOfThreads = static_cast< ThreadIdType >( queries.size() );
+    }
+  if( numberOfThreads <= 1 )
+    {
+    for( SizeValueType q = 0; q < queries.size(); q++ )
+      {
+      this->Search( queries[q], numberOfNeighborsRequested, results[q] );
+      }
+    return;
+    }
+
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( numberOfThreads );
+  threader->SetSingleMethod( this->SearchThreaderCallback, &str );
+  threader->SingleMethodExecute();
+}
+
+template<class TSample>
+ITK_THREAD_RETURN_TYPE
+KdTree<TSample>
+::SearchThreaderCallback( void *arg )
+{
+  ThreadIdType threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  ThreadIdType threadCount = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->NumberOfThreads;
+
+  SearchThreadStruct *str = (SearchThreadStruct *)
+    ( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  // Each thread searches a contiguous range of the query points
+  const SizeValueType numberOfQueries = str->Queries->size();
+  const SizeValueType begin = numberOfQueries * threadId / threadCount;
+  const SizeValueType end = numberOfQueries * ( threadId + 1 ) / threadCount;
+  for( SizeValueType q = begin; q < end; q++ )
+    {
+    str->Tree->Search( ( *str->Queries )[q], str->NumberOfNeighbors,
+      ( *str->Results )[q] );
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 template<class TSample>
 inline int
 KdTree<TSample>
-::NearestNeighborSearchLoop( const KdTreeNodeType *node,
+::NearestNeighborSearchLoop( SizeValueType nodeIndex,
   const MeasurementVectorType &query, MeasurementVectorType &lowerBound,
   MeasurementVectorType &upperBound, NearestNeighbors &nearestNeighbors ) const
 {
-  unsigned int       i;
-  InstanceIdentifier tempId;
-  double             tempDistance;
+  const FlatNodeType & node = this->m_FlatNodes[nodeIndex];
+  InstanceIdentifier   tempId;
+  double               tempDistance;
 
-  if( node->IsTerminal() )
+  if( node.Terminal )
     {
     // terminal node
-    if( node == this->m_EmptyTerminalNode )
+    if( node.Begin == node.End )
       {
       // empty node
       return 0;
       }
 
-    for(  i = 0; i < node->Size(); ++i )
+    for( SizeValueType i = node.Begin; i < node.End; ++i )
       {
-      tempId = node->GetInstanceIdentifier(i);
-      tempDistance = this->m_DistanceMetric->Evaluate( query,
-        this->m_Sample->GetMeasurementVector( tempId ) );
+      tempDistance = this->EvaluateFlatDistance( query, i );
       if( tempDistance < nearestNeighbors.GetLargestDistance() )
         {
-        nearestNeighbors.ReplaceFarthestNeighbor( tempId, tempDistance );
+        nearestNeighbors.ReplaceFarthestNeighbor(
+          this->m_FlatInstanceIdentifiers[i], tempDistance );
         }
       }
 
@@ -256,18 +447,16 @@ KdTree<TSample>
     return 0;
     }
 
-  unsigned int    partitionDimension;
-  MeasurementType partitionValue;
-  MeasurementType tempValue;
-  node->GetParameters( partitionDimension, partitionValue );
+  const unsigned int    partitionDimension = node.PartitionDimension;
+  const MeasurementType partitionValue = node.PartitionValue;
+  MeasurementType       tempValue;
 
   //
   // Check the point associated with the nonterminal node
   // and potentially add it to the list of nearest neighbors
   //
-  tempId = node->GetInstanceIdentifier(0);
-  tempDistance = this->m_DistanceMetric->Evaluate( query,
-    this->m_Sample->GetMeasurementVector( tempId ) );
+  tempId = this->m_FlatInstanceIdentifiers[node.Begin];
+  tempDistance = this->EvaluateFlatDistance( query, node.Begin );
   if( tempDistance < nearestNeighbors.GetLargestDistance() )
     {
     nearestNeighbors.ReplaceFarthestNeighbor( tempId, tempDistance );
@@ -281,7 +470,7 @@ KdTree<TSample>
     // search the closer child node
     tempValue = upperBound[partitionDimension];
     upperBound[partitionDimension] = partitionValue;
-    if( this->NearestNeighborSearchLoop( node->Left(), query, lowerBound,
+    if( this->NearestNeighborSearchLoop( node.Left, query, lowerBound,
       upperBound, nearestNeighbors ) )
       {
       return 1;
@@ -294,7 +483,7 @@ KdTree<TSample>
     if( this->BoundsOverlapBall( query, lowerBound, upperBound,
       nearestNeighbors.GetLargestDistance() ) )
       {
-      this->NearestNeighborSearchLoop( node->Right(), query, lowerBound,
+      this->NearestNeighborSearchLoop( node.Right, query, lowerBound,
         upperBound, nearestNeighbors );
       }
     lowerBound[partitionDimension] = tempValue;
@@ -304,7 +493,7 @@ KdTree<TSample>
     // search the closer child node
     tempValue = lowerBound[partitionDimension];
     lowerBound[partitionDimension] = partitionValue;
-    if( this->NearestNeighborSearchLoop( node->Right(), query, lowerBound,
+    if( this->NearestNeighborSearchLoop( node.Right, query, lowerBound,
       upperBound, nearestNeighbors ) )
       {
       return 1;
@@ -317,7 +506,7 @@ KdTree<TSample>
     if( this->BoundsOverlapBall( query, lowerBound, upperBound,
       nearestNeighbors.GetLargestDistance() ) )
       {
-      this->NearestNeighborSearchLoop( node->Left(), query, lowerBound,
+      this->NearestNeighborSearchLoop( node.Left, query, lowerBound,
         upperBound, nearestNeighbors );
       }
     upperBound[partitionDimension] = tempValue;
@@ -357,36 +546,43 @@ KdTree<TSample>
     }
 
   result.clear();
-  this->SearchLoop( this->m_Root, query, radius, lowerBound, upperBound, result );
+  if( !this->m_FlatNodes.empty() )
+    {
+    if( NumericTraits<MeasurementVectorType>::GetLength( query ) !=
+      this->m_MeasurementVectorSize )
+      {
+      itkExceptionMacro( "The query point and the measurement vectors of "
+        << "the tree have unequal size" );
+      }
+    this->SearchLoop( 0, query, radius, lowerBound, upperBound, result );
+    }
 }
 
 template<class TSample>
 inline int
 KdTree<TSample>
-::SearchLoop( const KdTreeNodeType *node, const MeasurementVectorType &query,
+::SearchLoop( SizeValueType nodeIndex, const MeasurementVectorType &query,
   double radius, MeasurementVectorType &lowerBound, MeasurementVectorType
   &upperBound, InstanceIdentifierVectorType &neighbors ) const
 {
-  InstanceIdentifier tempId;
-  double             tempDistance;
+  const FlatNodeType & node = this->m_FlatNodes[nodeIndex];
+  double               tempDistance;
 
-  if( node->IsTerminal() )
+  if( node.Terminal )
     {
     // terminal node
-    if( node == this->m_EmptyTerminalNode )
+    if( node.Begin == node.End )
       {
       // empty node
       return 0;
       }
 
-    for( unsigned int i = 0; i < node->Size(); ++i )
+    for( SizeValueType i = node.Begin; i < node.End; ++i )
       {
-      tempId = node->GetInstanceIdentifier( i );
-      tempDistance = this->m_DistanceMetric->Evaluate( query,
-        this->m_Sample->GetMeasurementVector( tempId ) );
+      tempDistance = this->EvaluateFlatDistance( query, i );
       if( tempDistance <= radius )
         {
-        neighbors.push_back( tempId );
+        neighbors.push_back( this->m_FlatInstanceIdentifiers[i] );
         }
       }
 
@@ -397,28 +593,23 @@ KdTree<TSample>
 
     return 0;
     }
-  if( node->IsTerminal() == false )
+
+  tempDistance = this->EvaluateFlatDistance( query, node.Begin );
+  if( tempDistance <= radius )
     {
-    tempId = node->GetInstanceIdentifier( 0 );
-    tempDistance = this->m_DistanceMetric->Evaluate( query,
-      this->m_Sample->GetMeasurementVector( tempId ) );
-    if( tempDistance <= radius )
-      {
-      neighbors.push_back( tempId );
-      }
+    neighbors.push_back( this->m_FlatInstanceIdentifiers[node.Begin] );
     }
 
-  unsigned int    partitionDimension;
-  MeasurementType partitionValue;
-  MeasurementType tempValue;
-  node->GetParameters( partitionDimension, partitionValue );
+  const unsigned int    partitionDimension = node.PartitionDimension;
+  const MeasurementType partitionValue = node.PartitionValue;
+  MeasurementType       tempValue;
 
   if( query[partitionDimension] <= partitionValue )
     {
     // search the closer child node
     tempValue = upperBound[partitionDimension];
     upperBound[partitionDimension] = partitionValue;
-    if( this->SearchLoop( node->Left(), query, radius, lowerBound, upperBound,
+    if( this->SearchLoop( node.Left, query, radius, lowerBound, upperBound,
       neighbors ) )
       {
       return 1;
@@ -430,7 +621,7 @@ KdTree<TSample>
     lowerBound[partitionDimension] = partitionValue;
     if( this->BoundsOverlapBall( query, lowerBound, upperBound, radius ) )
       {
-      this->SearchLoop( node->Right(), query, radius, lowerBound, upperBound,
+      this->SearchLoop( node.Right, query, radius, lowerBound, upperBound,
         neighbors );
       }
     lowerBound[partitionDimension] = tempValue;
@@ -440,7 +631,7 @@ KdTree<TSample>
     // search the closer child node
     tempValue = lowerBound[partitionDimension];
     lowerBound[partitionDimension] = partitionValue;
-    if( this->SearchLoop( node->Right(), query, radius, lowerBound, upperBound,
+    if( this->SearchLoop( node.Right, query, radius, lowerBound, upperBound,
       neighbors ) )
       {
       return 1;
@@ -452,7 +643,7 @@ KdTree<TSample>
     upperBound[partitionDimension] = partitionValue;
     if( this->BoundsOverlapBall( query, lowerBound, upperBound, radius ) )
       {
-      this->SearchLoop( node->Left(), query, radius, lowerBound, upperBound,
+      this->SearchLoop( node.Left, query, radius, lowerBound, upperBound,
         neighbors );
       }
     upperBound[partitionDimension] = tempValue;
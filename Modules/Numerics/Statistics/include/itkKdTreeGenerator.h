@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "itkKdTree.h"
+#include "itkMultiThreader.h"
 #include "itkStatisticsAlgorithm.h"
 
 namespace itk
@@ -50,6 +51,14 @@ namespace Statistics
  * (SetBucketSize method) and the input sample (SetSample method). The
  * Update method will run this generator. To get the resulting KdTree
  * object, call the GetOutput method.
+ *
+ * The two children of a large node cover separate ranges of the
+ * measurement vectors, so they are generated in two threads, until about
+ * SetNumberOfThreads threads are running. The generated tree does not
+ * depend on the number of threads. The threads read the sample at the
+ * same time, so the tree is generated in a single thread when the sample
+ * returns its measurement vectors through a shared buffer, as the image
+ * and point set adaptors do.
 
  * <b>Recent API changes:</b>
  * The static const macro to get the length of a measurement vector,
@@ -110,6 +119,10 @@ public:
    * terminal node. */
   void SetBucketSize(unsigned int size);
 
+  /** Set/Get the maximum number of threads generating the tree. */
+  itkSetClampMacro(NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS);
+  itkGetConstMacro(NumberOfThreads, ThreadIdType);
+
   /** Returns the pointer to the generated k-d tree. */
   OutputPointer GetOutput()
   {
@@ -158,10 +171,37 @@ protected:
                                     MeasurementVectorType & upperBound,
                                     unsigned int level);
 
+  /** Generates the children of a nonterminal node partitioned at
+   * medianIndex, in two threads when the node is large enough. */
+  void GenerateChildNodes(unsigned int beginIndex,
+                          unsigned int medianIndex,
+                          unsigned int endIndex,
+                          unsigned int partitionDimension,
+                          MeasurementType partitionValue,
+                          MeasurementVectorType & lowerBound,
+                          MeasurementVectorType & upperBound,
+                          unsigned int level,
+                          KdTreeNodeType * & left,
+                          KdTreeNodeType * & right);
+
 private:
   KdTreeGenerator(const Self &); //purposely not implemented
   void operator=(const Self &);  //purposely not implemented
 
+  /** The two children generated by the two threads */
+  struct GenerateChildNodesThreadStruct
+    {
+    Self *                Generator;
+    unsigned int          BeginIndex[2];
+    unsigned int          EndIndex[2];
+    MeasurementVectorType LowerBound[2];
+    MeasurementVectorType UpperBound[2];
+    unsigned int          Level;
+    KdTreeNodeType *      Node[2];
+    };
+
+  static ITK_THREAD_RETURN_TYPE GenerateChildNodesThreaderCallback(void *arg);
+
   /** Pointer to the input (source) sample */
   TSample *m_SourceSample;
 
@@ -177,17 +217,15 @@ private:
   /** Pointer to the resulting k-d tree. */
   OutputPointer m_Tree;
 
-  /** Temporary lower bound for the TreeGenerationLoop */
-  MeasurementVectorType m_TempLowerBound;
-
-  /** Temporary upper bound for the TreeGenerationLoop */
-  MeasurementVectorType m_TempUpperBound;
-
-  /** Temporary mean for the TreeGenerationLoop */
-  MeasurementVectorType m_TempMean;
-
   /** Length of a measurement vector */
   MeasurementVectorSizeType m_MeasurementVectorSize;
+
+  /** Maximum number of threads generating the tree */
+  ThreadIdType m_NumberOfThreads;
+
+  /** The children of the nodes with more measurement vectors than this
+   * are generated in two threads */
+  unsigned int m_ThreadedNodeSize;
 };  // end of class
 } // end of namespace Statistics
 } // end of namespace itk
@@ -32,6 +32,8 @@ KdTreeGenerator< TSample >
   m_BucketSize = 16;
   m_Subsample = SubsampleType::New();
   m_MeasurementVectorSize = 0;
+  m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+  m_ThreadedNodeSize = NumericTraits< unsigned int >::max();
 }
 
 template< class TSample >
@@ -54,6 +56,7 @@ KdTreeGenerator< TSample >
   os << indent << "Bucket Size: " << m_BucketSize << std::endl;
   os << indent << "MeasurementVectorSize: "
      << m_MeasurementVectorSize << std::endl;
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
 }
 
 template< class TSample >
@@ -65,9 +68,6 @@ KdTreeGenerator< TSample >
   m_Subsample->SetSample(sample);
   m_Subsample->InitializeWithAllInstances();
   m_MeasurementVectorSize = sample->GetMeasurementVectorSize();
-  NumericTraits<MeasurementVectorType>::SetLength(m_TempLowerBound, m_MeasurementVectorSize);
-  NumericTraits<MeasurementVectorType>::SetLength(m_TempUpperBound, m_MeasurementVectorSize);
-  NumericTraits<MeasurementVectorType>::SetLength(m_TempMean, m_MeasurementVectorSize);
 }
 
 template< class TSample >
@@ -115,6 +115,24 @@ KdTreeGenerator< TSample >
     upperBound[d] = NumericTraits< MeasurementType >::max();
     }
 
+  // The threads read the sample at the same time, which is not possible
+  // when it returns all the measurement vectors in the same buffer.
+  ThreadIdType numberOfThreads = m_NumberOfThreads;
+  if ( subsample->Size() > 1
+       && &subsample->GetMeasurementVectorByIndex(0) ==
+       &subsample->GetMeasurementVectorByIndex(1) )
+    {
+    numberOfThreads = 1;
+    }
+
+  // Split the nodes until there is about one thread per range of
+  // subsample->Size() / numberOfThreads measurement vectors, but do not
+  // bother with threads for small nodes.
+  const unsigned int minimumThreadedNodeSize = 1024;
+  m_ThreadedNodeSize = vnl_math_max(
+    static_cast< unsigned int >( subsample->Size() / numberOfThreads ),
+    minimumThreadedNodeSize);
+
   KdTreeNodeType *root =
     this->GenerateTreeLoop(0, m_Subsample->Size(), lowerBound, upperBound, 0);
   m_Tree->SetRoot(root);
@@ -130,8 +148,6 @@ KdTreeGenerator< TSample >
                           unsigned int level)
 {
   typedef typename KdTreeType::KdTreeNodeType NodeType;
-  MeasurementType dimensionLowerBound;
-  MeasurementType dimensionUpperBound;
   MeasurementType partitionValue;
   unsigned int    partitionDimension = 0;
   unsigned int    i;
@@ -142,15 +158,21 @@ KdTreeGenerator< TSample >
   SubsamplePointer subsample = this->GetSubsample();
 
   // find most widely spread dimension
+  MeasurementVectorType tempLowerBound;
+  NumericTraits<MeasurementVectorType>::SetLength(tempLowerBound, m_MeasurementVectorSize);
+  MeasurementVectorType tempUpperBound;
+  NumericTraits<MeasurementVectorType>::SetLength(tempUpperBound, m_MeasurementVectorSize);
+  MeasurementVectorType tempMean;
+  NumericTraits<MeasurementVectorType>::SetLength(tempMean, m_MeasurementVectorSize);
   Algorithm::FindSampleBoundAndMean< SubsampleType >(subsample,
                                                      beginIndex, endIndex,
-                                                     m_TempLowerBound, m_TempUpperBound,
-                                                     m_TempMean);
+                                                     tempLowerBound, tempUpperBound,
+                                                     tempMean);
 
   maxSpread = NumericTraits< MeasurementType >::NonpositiveMin();
   for ( i = 0; i < m_MeasurementVectorSize; i++ )
     {
-    spread = m_TempUpperBound[i] - m_TempLowerBound[i];
+    spread = tempUpperBound[i] - tempLowerBound[i];
     if ( spread >= maxSpread )
       {
       maxSpread = spread;
@@ -172,21 +194,12 @@ KdTreeGenerator< TSample >
 
   medianIndex += beginIndex;
 
-  // save bounds for cutting dimension
-  dimensionLowerBound = lowerBound[partitionDimension];
-  dimensionUpperBound = upperBound[partitionDimension];
-
-  upperBound[partitionDimension] = partitionValue;
-  const unsigned int beginLeftIndex = beginIndex;
-  const unsigned int endLeftIndex   = medianIndex;
-  NodeType *         left = GenerateTreeLoop(beginLeftIndex, endLeftIndex, lowerBound, upperBound, level + 1);
-  upperBound[partitionDimension] = dimensionUpperBound;
-
-  lowerBound[partitionDimension] = partitionValue;
-  const unsigned int beginRightIndex = medianIndex + 1;
-  const unsigned int endRightIndex   = endIndex;
-  NodeType *         right = GenerateTreeLoop(beginRightIndex, endRightIndex, lowerBound, upperBound, level + 1);
-  lowerBound[partitionDimension] = dimensionLowerBound;
+  NodeType *left;
+  NodeType *right;
+  this->GenerateChildNodes(beginIndex, medianIndex, endIndex,
+                           partitionDimension, partitionValue,
+                           lowerBound, upperBound, level + 1,
+                           left, right);
 
   typedef KdTreeNonterminalNode< TSample > KdTreeNonterminalNodeType;
 
@@ -240,6 +253,83 @@ KdTreeGenerator< TSample >
                                          lowerBound, upperBound, level + 1);
     }
 }
+
+template< class TSample >
+void
+KdTreeGenerator< TSample >
+::GenerateChildNodes(unsigned int beginIndex,
+                     unsigned int medianIndex,
+                     unsigned int endIndex,
+                     unsigned int partitionDimension,
+                     MeasurementType partitionValue,
+                     MeasurementVectorType & lowerBound,
+                     MeasurementVectorType & upperBound,
+                     unsigned int level,
+                     KdTreeNodeType * & left,
+                     KdTreeNodeType * & right)
+{
+  if ( endIndex - beginIndex > m_ThreadedNodeSize )
+    {
+    // Each thread works on its own range of the subsample and its own
+    // bounds
+    GenerateChildNodesThreadStruct str;
+    str.Generator = this;
+    str.BeginIndex[0] = beginIndex;
+    str.EndIndex[0] = medianIndex;
+    str.BeginIndex[1] = medianIndex + 1;
+    str.EndIndex[1] = endIndex;
+    str.LowerBound[0] = lowerBound;
+    str.UpperBound[0] = upperBound;
+    str.UpperBound[0][partitionDimension] = partitionValue;
+    str.LowerBound[1] = lowerBound;
+    str.UpperBound[1] = upperBound;
+    str.LowerBound[1][partitionDimension] = partitionValue;
+    str.Level = level;
+
+    MultiThreader::Pointer threader = MultiThreader::New();
+    threader->SetNumberOfThreads(2);
+    if ( threader->GetNumberOfThreads() == 2 )
+      {
+      threader->SetSingleMethod(this->GenerateChildNodesThreaderCallback, &str);
+      threader->SingleMethodExecute();
+      left = str.Node[0];
+      right = str.Node[1];
+      return;
+      }
+    }
+
+  // save bounds for cutting dimension
+  const MeasurementType dimensionLowerBound = lowerBound[partitionDimension];
+  const MeasurementType dimensionUpperBound = upperBound[partitionDimension];
+
+  upperBound[partitionDimension] = partitionValue;
+  left = this->GenerateTreeLoop(beginIndex, medianIndex, lowerBound, upperBound, level);
+  upperBound[partitionDimension] = dimensionUpperBound;
+
+  lowerBound[partitionDimension] = partitionValue;
+  right = this->GenerateTreeLoop(medianIndex + 1, endIndex, lowerBound, upperBound, level);
+  lowerBound[partitionDimension] = dimensionLowerBound;
+}
+
+template< class TSample >
+ITK_THREAD_RETURN_TYPE
+KdTreeGenerator< TSample >
+::GenerateChildNodesThreaderCallback(void *arg)
+{
+  ThreadIdType threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+
+  GenerateChildNodesThreadStruct *str = (GenerateChildNodesThreadStruct *)
+    ( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  str->Node[threadId] =
+    str->Generator->GenerateTreeLoop(str->BeginIndex[threadId],
+                                     str->EndIndex[threadId],
+                                     str->LowerBound[threadId],
+                                     str->UpperBound[threadId],
+                                     str->Level);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
 } // end of namespace Statistics
 } // end of namespace itk
 
@@ -22,6 +22,7 @@
 #include "itkHistogram.h"
 #include "itkVectorContainer.h"
 #include "itkNumericTraits.h"
+#include <vector>
 
 namespace itk
 {
@@ -73,6 +74,13 @@ namespace Statistics
  * texture or in cases where the user wants more histogram bins, a sparse container
  * can be used for the histogram instead.
  *
+ * The image is split between the threads, and each thread counts the
+ * co-occurrences of its part of the image, for all the offsets, in private
+ * dense matrices, which are added to the histogram at the end. When a mask
+ * is given, only the bounding box of the pixels inside the mask is visited.
+ * A separate matrix can also be computed for each offset in the same pass
+ * over the image, see SetComputeOffsetHistograms().
+ *
  * WARNING: This probably won't work for pixels of double or long-double type
  * unless you set the histogram min and max manually. This is because the largest
  * histogram bin by default has max value of the largest possible pixel value
@@ -111,6 +119,7 @@ public:
   typedef typename ImageType::ConstPointer             ImageConstPointer;
   typedef typename ImageType::PixelType                PixelType;
   typedef typename ImageType::RegionType               RegionType;
+  typedef typename ImageType::IndexType                IndexType;
   typedef typename ImageType::SizeType                 RadiusType;
   typedef typename ImageType::OffsetType               OffsetType;
   typedef VectorContainer< unsigned char, OffsetType > OffsetVector;
@@ -123,6 +132,7 @@ public:
   typedef typename HistogramType::Pointer                            HistogramPointer;
   typedef typename HistogramType::ConstPointer                       HistogramConstPointer;
   typedef typename HistogramType::MeasurementVectorType              MeasurementVectorType;
+  typedef typename HistogramType::AbsoluteFrequencyType              AbsoluteFrequencyType;
 
   itkStaticConstMacro(DefaultBinsPerAxis, unsigned int, 256);
 
@@ -163,6 +173,18 @@ public:
   /** method to get the Histogram */
   const HistogramType * GetOutput() const;
 
+  /** Set/Get whether a co-occurrence matrix is also computed for each
+   * offset, in the same pass over the image as the matrix of all the
+   * offsets. This is cheaper than running the filter once per offset. Off
+   * by default. */
+  itkSetMacro(ComputeOffsetHistograms, bool);
+  itkGetConstMacro(ComputeOffsetHistograms, bool);
+  itkBooleanMacro(ComputeOffsetHistograms);
+
+  /** Get the co-occurrence matrix of the offset of the given position in
+   * the offsets. Only available when ComputeOffsetHistograms is on. */
+  const HistogramType * GetOffsetHistogram(unsigned int offsetIndex) const;
+
   /** Set the pixel value of the mask that should be considered "inside" the
     object. Defaults to one. */
   itkSetMacro(InsidePixelValue, PixelType);
@@ -194,6 +216,31 @@ private:
 
   void NormalizeHistogram(void);
 
+  void NormalizeHistogram(HistogramType *histogram);
+
+  /** Count the co-occurrences of the region with all the threads, and add
+   * them to the histograms. */
+  void FillHistograms(const RegionType & region, const ImageType *maskImage);
+
+  struct FillHistogramsThreadStruct {
+    ScalarImageToCooccurrenceMatrixFilter *Filter;
+    RegionType Region;
+    const ImageType *MaskImage;
+    unsigned int NumberOfMatrices;
+    std::vector< std::vector< AbsoluteFrequencyType > > *Matrices;
+  };
+
+  static ITK_THREAD_RETURN_TYPE FillHistogramsThreaderCallback(void *arg);
+
+  void ThreadedFillHistograms(const FillHistogramsThreadStruct & str,
+                              ThreadIdType threadId, ThreadIdType threadCount);
+
+  /** The bin of a pixel value, on both axes of the histograms. Return false
+   * if the value is outside of the bins, in which case its pairs are not
+   * counted. */
+  bool GetBin(const PixelType & value, MeasurementVectorType & measurement,
+              typename HistogramType::IndexType & index, SizeValueType & bin) const;
+
   OffsetVectorConstPointer m_Offsets;
   PixelType                m_Min;
   PixelType                m_Max;
@@ -204,6 +251,9 @@ private:
   bool                  m_Normalize;
 
   PixelType m_InsidePixelValue;
+
+  bool                                m_ComputeOffsetHistograms;
+  std::vector< HistogramPointer >     m_OffsetHistograms;
 };
 } // end of namespace Statistics
 } // end of namespace itk
@@ -20,8 +20,10 @@
 
 #include "itkScalarImageToCooccurrenceMatrixFilter.h"
 
-#include "itkConstNeighborhoodIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionSplitter.h"
 #include "vnl/vnl_math.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -58,6 +60,7 @@ ScalarImageToCooccurrenceMatrixFilter< TImageType,
 
   this->m_NumberOfBinsPerAxis = DefaultBinsPerAxis;
   this->m_Normalize = false;
+  this->m_ComputeOffsetHistograms = false;
 }
 
 template< class TImageType, class THistogramFrequencyContainer >
@@ -125,6 +128,21 @@ ScalarImageToCooccurrenceMatrixFilter< TImageType,
   return output;
 }
 
+template< class TImageType, class THistogramFrequencyContainer >
+const typename ScalarImageToCooccurrenceMatrixFilter< TImageType,
+                                                      THistogramFrequencyContainer >::HistogramType *
+ScalarImageToCooccurrenceMatrixFilter< TImageType,
+                                       THistogramFrequencyContainer >
+::GetOffsetHistogram(unsigned int offsetIndex) const
+{
+  if ( offsetIndex >= m_OffsetHistograms.size() )
+    {
+    itkExceptionMacro(<< "No co-occurrence matrix for the offset " << offsetIndex
+                      << ". ComputeOffsetHistograms must be on, and the filter updated.");
+    }
+  return m_OffsetHistograms[offsetIndex];
+}
+
 template< class TImageType, class THistogramFrequencyContainer >
 typename ScalarImageToCooccurrenceMatrixFilter< TImageType,
                                                 THistogramFrequencyContainer >::DataObjectPointer
@@ -156,6 +174,18 @@ ScalarImageToCooccurrenceMatrixFilter< TImageType,
   size.Fill(m_NumberOfBinsPerAxis);
   output->Initialize(size, m_LowerBound, m_UpperBound);
 
+  m_OffsetHistograms.clear();
+  if ( m_ComputeOffsetHistograms )
+    {
+    for ( unsigned int i = 0; i < m_Offsets->size(); i++ )
+      {
+      HistogramPointer histogram = HistogramType::New();
+      histogram->SetMeasurementVectorSize( output->GetMeasurementVectorSize() );
+      histogram->Initialize(size, m_LowerBound, m_UpperBound);
+      m_OffsetHistograms.push_back(histogram);
+      }
+    }
+
   // Next, find the minimum radius that encloses all the offsets.
   unsigned int minRadius = 0;
   typename OffsetVector::ConstIterator offsets;
@@ -203,141 +233,283 @@ ScalarImageToCooccurrenceMatrixFilter< TImageType,
 template< class TImageType, class THistogramFrequencyContainer >
 void
 ScalarImageToCooccurrenceMatrixFilter< TImageType,
-                                       THistogramFrequencyContainer >::FillHistogram(RadiusType radius,
+                                       THistogramFrequencyContainer >::FillHistogram(RadiusType itkNotUsed(radius),
                                                                                      RegionType region)
 {
-  // Iterate over all of those pixels and offsets, adding each
-  // co-occurrence pair to the histogram
+  this->FillHistograms(region, NULL);
+}
 
-  const ImageType *input = this->GetInput();
+template< class TImageType, class THistogramFrequencyContainer >
+void
+ScalarImageToCooccurrenceMatrixFilter< TImageType,
+                                       THistogramFrequencyContainer >::FillHistogramWithMask(RadiusType itkNotUsed(radius),
+                                                                                             RegionType region,
+                                                                                             const ImageType *maskImage)
+{
+  // Only the bounding box of the pixels inside the mask has to be visited
+  IndexType minIndex;
+  IndexType maxIndex;
+  minIndex.Fill( NumericTraits< IndexValueType >::max() );
+  maxIndex.Fill( NumericTraits< IndexValueType >::NonpositiveMin() );
+  bool empty = true;
+
+  ImageRegionConstIteratorWithIndex< ImageType > mit(maskImage, region);
+  for ( mit.GoToBegin(); !mit.IsAtEnd(); ++mit )
+    {
+    if ( mit.Get() == m_InsidePixelValue )
+      {
+      const IndexType & index = mit.GetIndex();
+      for ( unsigned int i = 0; i < ImageType::ImageDimension; i++ )
+        {
+        minIndex[i] = vnl_math_min(minIndex[i], index[i]);
+        maxIndex[i] = vnl_math_max(maxIndex[i], index[i]);
+        }
+      empty = false;
+      }
+    }
 
-  HistogramType *output =
-    static_cast< HistogramType * >( this->ProcessObject::GetOutput(0) );
+  if ( empty )
+    {
+    return; // no pixel in the mask, the histograms stay empty
+    }
 
-  typedef ConstNeighborhoodIterator< ImageType > NeighborhoodIteratorType;
-  NeighborhoodIteratorType neighborIt;
-  neighborIt = NeighborhoodIteratorType(radius, input, region);
+  RegionType boundingBox;
+  boundingBox.SetIndex(minIndex);
+  for ( unsigned int i = 0; i < ImageType::ImageDimension; i++ )
+    {
+    boundingBox.SetSize(i, maxIndex[i] - minIndex[i] + 1);
+    }
 
-  MeasurementVectorType cooccur( output->GetMeasurementVectorSize() );
+  this->FillHistograms(boundingBox, maskImage);
+}
 
-  for ( neighborIt.GoToBegin(); !neighborIt.IsAtEnd(); ++neighborIt )
-    {
-    const PixelType centerPixelIntensity = neighborIt.GetCenterPixel();
-    if ( centerPixelIntensity < m_Min
-         || centerPixelIntensity > m_Max )
-      {
-      continue; // don't put a pixel in the histogram if the value
-                // is out-of-bounds.
-      }
+template< class TImageType, class THistogramFrequencyContainer >
+void
+ScalarImageToCooccurrenceMatrixFilter< TImageType,
+                                       THistogramFrequencyContainer >::FillHistograms(const RegionType & region,
+                                                                                      const ImageType *maskImage)
+{
+  HistogramType *output =
+    static_cast< HistogramType * >( this->ProcessObject::GetOutput(0) );
 
-    typename OffsetVector::ConstIterator offsets;
-    for ( offsets = m_Offsets->Begin(); offsets != m_Offsets->End(); offsets++ )
+  const SizeValueType matrixSize = m_NumberOfBinsPerAxis * m_NumberOfBinsPerAxis;
+
+  FillHistogramsThreadStruct str;
+  str.Filter = this;
+  str.Region = region;
+  str.MaskImage = maskImage;
+  str.NumberOfMatrices = m_OffsetHistograms.empty() ? 1 : m_OffsetHistograms.size();
+
+  // Each thread has its own matrices, so the number of threads is limited
+  // to keep the memory used by the matrices reasonable when there are many
+  // bins.
+  const SizeValueType maximumNumberOfEntries = 1 << 25;
+  const SizeValueType entriesPerThread = matrixSize * str.NumberOfMatrices;
+  const ThreadIdType  numberOfThreads = static_cast< ThreadIdType >(
+    std::max( std::min( static_cast< SizeValueType >( this->GetNumberOfThreads() ),
+                        maximumNumberOfEntries / entriesPerThread ), SizeValueType(1) ) );
+
+  std::vector< std::vector< AbsoluteFrequencyType > > matrices(numberOfThreads);
+  str.Matrices = &matrices;
+
+  this->GetMultiThreader()->SetNumberOfThreads(numberOfThreads);
+  this->GetMultiThreader()->SetSingleMethod(this->FillHistogramsThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  // Add the matrices of the threads to the histograms. The instance
+  // identifier of the bins (i, j) of a histogram is i + j * NumberOfBinsPerAxis.
+  for ( unsigned int m = 0; m < str.NumberOfMatrices; m++ )
+    {
+    HistogramType *histogram = m_OffsetHistograms.empty() ? output : m_OffsetHistograms[m].GetPointer();
+    for ( SizeValueType id = 0; id < matrixSize; id++ )
       {
-      bool            pixelInBounds;
-      const PixelType pixelIntensity =
-        neighborIt.GetPixel(offsets.Value(), pixelInBounds);
-
-      if ( !pixelInBounds )
+      AbsoluteFrequencyType frequency = NumericTraits< AbsoluteFrequencyType >::Zero;
+      for ( ThreadIdType t = 0; t < numberOfThreads; t++ )
         {
-        continue; // don't put a pixel in the histogram if it's out-of-bounds.
+        if ( !matrices[t].empty() )
+          {
+          frequency += matrices[t][m * matrixSize + id];
+          }
         }
-
-      if ( pixelIntensity < m_Min
-           || pixelIntensity > m_Max )
+      if ( frequency != NumericTraits< AbsoluteFrequencyType >::Zero )
         {
-        continue; // don't put a pixel in the histogram if the value
-                  // is out-of-bounds.
+        histogram->IncreaseFrequency(id, frequency);
+        if ( histogram != output )
+          {
+          output->IncreaseFrequency(id, frequency);
+          }
         }
+      }
+    }
+}
 
-      // Now make both possible co-occurrence combinations and increment the
-      // histogram with them.
+template< class TImageType, class THistogramFrequencyContainer >
+ITK_THREAD_RETURN_TYPE
+ScalarImageToCooccurrenceMatrixFilter< TImageType,
+                                       THistogramFrequencyContainer >::FillHistogramsThreaderCallback(void *arg)
+{
+  ThreadIdType threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  ThreadIdType threadCount = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->NumberOfThreads;
 
-      cooccur[0] = centerPixelIntensity;
-      cooccur[1] = pixelIntensity;
-      output->IncreaseFrequencyOfMeasurement(cooccur, 1);
+  FillHistogramsThreadStruct *str = (FillHistogramsThreadStruct *)
+    ( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
 
-      cooccur[1] = centerPixelIntensity;
-      cooccur[0] = pixelIntensity;
-      output->IncreaseFrequencyOfMeasurement(cooccur, 1);
-      }
+  str->Filter->ThreadedFillHistograms(*str, threadId, threadCount);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TImageType, class THistogramFrequencyContainer >
+bool
+ScalarImageToCooccurrenceMatrixFilter< TImageType,
+                                       THistogramFrequencyContainer >::GetBin(const PixelType & value,
+                                                                              MeasurementVectorType & measurement,
+                                                                              typename HistogramType::IndexType & index,
+                                                                              SizeValueType & bin) const
+{
+  measurement.Fill(value);
+  // the histogram clips the values out of its bins, like the upper bound
+  // itself, and then sets an index out of the matrix
+  if ( !this->GetOutput()->GetIndex(measurement, index) )
+    {
+    return false;
     }
+  bin = index[0];
+  return true;
 }
 
 template< class TImageType, class THistogramFrequencyContainer >
 void
 ScalarImageToCooccurrenceMatrixFilter< TImageType,
-                                       THistogramFrequencyContainer >::FillHistogramWithMask(RadiusType radius,
-                                                                                             RegionType region,
-                                                                                             const ImageType *maskImage)
+                                       THistogramFrequencyContainer >::ThreadedFillHistograms(
+  const FillHistogramsThreadStruct & str, ThreadIdType threadId, ThreadIdType threadCount)
 {
-  // Iterate over all of those pixels and offsets, adding each
-  // co-occurrence pair to the histogram
+  typedef ImageRegionSplitter< ImageType::ImageDimension > SplitterType;
+  typename SplitterType::Pointer splitter = SplitterType::New();
+  const unsigned int numberOfPieces = splitter->GetNumberOfSplits(str.Region, threadCount);
+  if ( threadId >= numberOfPieces )
+    {
+    return;
+    }
+  const RegionType region = splitter->GetSplit(threadId, numberOfPieces, str.Region);
 
   const ImageType *input = this->GetInput();
+  const ImageType *maskImage = str.MaskImage;
+  const unsigned int ImageDimension = ImageType::ImageDimension;
 
-  HistogramType *output =
-    static_cast< HistogramType * >( this->ProcessObject::GetOutput(0) );
+  const unsigned int  bins = m_NumberOfBinsPerAxis;
+  const SizeValueType matrixSize = bins * bins;
+  std::vector< AbsoluteFrequencyType > & matrices = ( *str.Matrices )[threadId];
+  matrices.assign(str.NumberOfMatrices * matrixSize, NumericTraits< AbsoluteFrequencyType >::Zero);
 
-  // Iterate over all of those pixels and offsets, adding each
-  // co-occurrence pair to the histogram
-  typedef ConstNeighborhoodIterator< ImageType > NeighborhoodIteratorType;
-  NeighborhoodIteratorType neighborIt, maskNeighborIt;
-  neighborIt = NeighborhoodIteratorType(radius, input, region);
-  maskNeighborIt = NeighborhoodIteratorType(radius, maskImage, region);
-
-  MeasurementVectorType cooccur( output->GetMeasurementVectorSize() );
+  // The neighbors must be in the buffers of the images
+  RegionType bufferedRegion = input->GetBufferedRegion();
+  if ( maskImage )
+    {
+    bufferedRegion.Crop( maskImage->GetBufferedRegion() );
+    }
+  const IndexType bufferBegin = bufferedRegion.GetIndex();
+  IndexType       bufferEnd = bufferBegin;
+  for ( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+    bufferEnd[i] += bufferedRegion.GetSize()[i];
+    }
 
-  for ( neighborIt.GoToBegin(), maskNeighborIt.GoToBegin();
-        !neighborIt.IsAtEnd(); ++neighborIt, ++maskNeighborIt )
+  // The offsets in the buffers
+  const unsigned int             numberOfOffsets = m_Offsets->size();
+  std::vector< OffsetType >      offsets(numberOfOffsets);
+  std::vector< OffsetValueType > inputOffsets(numberOfOffsets, 0);
+  std::vector< OffsetValueType > maskOffsets(numberOfOffsets, 0);
+  for ( unsigned int k = 0; k < numberOfOffsets; k++ )
     {
-    if ( maskNeighborIt.GetCenterPixel() != m_InsidePixelValue )
+    offsets[k] = m_Offsets->ElementAt(k);
+    for ( unsigned int i = 0; i < ImageDimension; i++ )
       {
-      continue; // Go to the next loop if we're not in the mask
+      inputOffsets[k] += offsets[k][i] * input->GetOffsetTable()[i];
+      if ( maskImage )
+        {
+        maskOffsets[k] += offsets[k][i] * maskImage->GetOffsetTable()[i];
+        }
       }
+    }
+
+  const PixelType *inputBuffer = input->GetBufferPointer();
+  const PixelType *maskBuffer = maskImage ? maskImage->GetBufferPointer() : NULL;
+
+  MeasurementVectorType measurement( this->GetOutput()->GetMeasurementVectorSize() );
+  typename HistogramType::IndexType binIndex( this->GetOutput()->GetMeasurementVectorSize() );
 
-    const PixelType centerPixelIntensity = neighborIt.GetCenterPixel();
+  ImageRegionConstIteratorWithIndex< ImageType > it(input, region);
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const IndexType & index = it.GetIndex();
+    const PixelType *maskCenter = NULL;
+    if ( maskImage )
+      {
+      maskCenter = maskBuffer + maskImage->ComputeOffset(index);
+      if ( *maskCenter != m_InsidePixelValue )
+        {
+        continue; // Go to the next loop if we're not in the mask
+        }
+      }
 
-    if ( centerPixelIntensity < this->GetMin()
-         || centerPixelIntensity > this->GetMax() )
+    const PixelType centerPixelIntensity = it.Get();
+    if ( centerPixelIntensity < m_Min
+         || centerPixelIntensity > m_Max )
       {
       continue; // don't put a pixel in the histogram if the value
                 // is out-of-bounds.
       }
+    SizeValueType centerBin;
+    if ( !this->GetBin(centerPixelIntensity, measurement, binIndex, centerBin) )
+      {
+      continue; // don't count the pairs of a value out of the bins.
+      }
+    const PixelType *   center = inputBuffer + input->ComputeOffset(index);
 
-    typename OffsetVector::ConstIterator offsets;
-    for ( offsets = this->GetOffsets()->Begin(); offsets != this->GetOffsets()->End(); offsets++ )
+    for ( unsigned int k = 0; k < numberOfOffsets; k++ )
       {
-      if ( maskNeighborIt.GetPixel( offsets.Value() ) != m_InsidePixelValue )
+      bool pixelInBounds = true;
+      for ( unsigned int i = 0; i < ImageDimension; i++ )
         {
-        continue; // Go to the next loop if we're not in the mask
+        const IndexValueType neighbor = index[i] + offsets[k][i];
+        if ( neighbor < bufferBegin[i] || neighbor >= bufferEnd[i] )
+          {
+          pixelInBounds = false;
+          break;
+          }
         }
-
-      bool            pixelInBounds;
-      const PixelType pixelIntensity =
-        neighborIt.GetPixel(offsets.Value(), pixelInBounds);
-
       if ( !pixelInBounds )
         {
         continue; // don't put a pixel in the histogram if it's out-of-bounds.
         }
 
-      if ( pixelIntensity < this->GetMin()
-           || pixelIntensity > this->GetMax() )
+      if ( maskImage && maskCenter[maskOffsets[k]] != m_InsidePixelValue )
+        {
+        continue; // Go to the next loop if we're not in the mask
+        }
+
+      const PixelType pixelIntensity = center[inputOffsets[k]];
+      if ( pixelIntensity < m_Min
+           || pixelIntensity > m_Max )
         {
         continue; // don't put a pixel in the histogram if the value
                   // is out-of-bounds.
         }
 
-      // Now make both possible co-occurrence combinations and increment the
-      // histogram with them.
-
-      cooccur[0] = centerPixelIntensity;
-      cooccur[1] = pixelIntensity;
-      output->IncreaseFrequencyOfMeasurement(cooccur, 1);
-
-      cooccur[1] = centerPixelIntensity;
-      cooccur[0] = pixelIntensity;
-      output->IncreaseFrequencyOfMeasurement(cooccur, 1);
+      // Now count both possible co-occurrence combinations.
+      SizeValueType bin;
+      if ( !this->GetBin(pixelIntensity, measurement, binIndex, bin) )
+        {
+        continue; // don't count the pair if the value is out of the bins.
+        }
+      AbsoluteFrequencyType *matrix = &matrices[0];
+      if ( str.NumberOfMatrices > 1 )
+        {
+        matrix += k * matrixSize;
+        }
+      matrix[centerBin + bin * bins]++;
+      matrix[bin + centerBin * bins]++;
       }
     }
 }
@@ -350,11 +522,23 @@ ScalarImageToCooccurrenceMatrixFilter< TImageType,
   HistogramType *output =
     static_cast< HistogramType * >( this->ProcessObject::GetOutput(0) );
 
+  this->NormalizeHistogram(output);
+  for ( unsigned int i = 0; i < m_OffsetHistograms.size(); i++ )
+    {
+    this->NormalizeHistogram(m_OffsetHistograms[i]);
+    }
+}
+
+template< class TImageType, class THistogramFrequencyContainer >
+void
+ScalarImageToCooccurrenceMatrixFilter< TImageType,
+                                       THistogramFrequencyContainer >::NormalizeHistogram(HistogramType *histogram)
+{
   typename HistogramType::AbsoluteFrequencyType totalFrequency =
-    output->GetTotalFrequency();
+    histogram->GetTotalFrequency();
 
-  typename HistogramType::Iterator hit = output->Begin();
-  while ( hit != output->End() )
+  typename HistogramType::Iterator hit = histogram->Begin();
+  while ( hit != histogram->End() )
     {
     hit.SetFrequency(hit.GetFrequency() / totalFrequency);
     ++hit;
@@ -387,6 +571,7 @@ ScalarImageToCooccurrenceMatrixFilter< TImageType,
   os << indent << "NumberOfBinsPerAxis: " << this->GetNumberOfBinsPerAxis() << std::endl;
   os << indent << "Normalize: " << this->GetNormalize() << std::endl;
   os << indent << "InsidePixelValue: " << this->GetInsidePixelValue() << std::endl;
+  os << indent << "ComputeOffsetHistograms: " << this->GetComputeOffsetHistograms() << std::endl;
 }
 } // end of namespace Statistics
 } // end of namespace itk
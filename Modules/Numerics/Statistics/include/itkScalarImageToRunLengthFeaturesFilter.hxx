@@ -137,15 +137,18 @@ ScalarImageToRunLengthFeaturesFilter<TImage, THistogramFrequencyContainer>
   typedef typename RunLengthFeaturesFilterType::RunLengthFeatureName
     InternalRunLengthFeatureName;
 
+  // The run-length matrices of all the offsets are computed at once
+  this->m_RunLengthMatrixGenerator->SetOffsets( this->m_Offsets );
+  this->m_RunLengthMatrixGenerator->ComputeOffsetHistogramsOn();
+  this->m_RunLengthMatrixGenerator->Update();
+
   for( offsetIt = this->m_Offsets->Begin(), offsetNum = 0;
     offsetIt != this->m_Offsets->End(); offsetIt++, offsetNum++ )
     {
-    this->m_RunLengthMatrixGenerator->SetOffset( offsetIt.Value() );
-    this->m_RunLengthMatrixGenerator->Update();
     typename RunLengthFeaturesFilterType::Pointer runLengthMatrixCalculator =
       RunLengthFeaturesFilterType::New();
     runLengthMatrixCalculator->SetInput(
-      this->m_RunLengthMatrixGenerator->GetOutput() );
+      this->m_RunLengthMatrixGenerator->GetOffsetHistogram( offsetNum ) );
     runLengthMatrixCalculator->Update();
 
     typename FeatureNameVector::ConstIterator fnameIt;
@@ -232,6 +235,7 @@ ScalarImageToRunLengthFeaturesFilter<TImage, THistogramFrequencyContainer>
   // Compute the feature for the first offset
   typename OffsetVector::ConstIterator offsetIt = this->m_Offsets->Begin();
   this->m_RunLengthMatrixGenerator->SetOffset( offsetIt.Value() );
+  this->m_RunLengthMatrixGenerator->ComputeOffsetHistogramsOff();
 
   this->m_RunLengthMatrixGenerator->Update();
   typename RunLengthFeaturesFilterType::Pointer runLengthMatrixCalculator =
@@ -22,6 +22,7 @@
 #include "itkHistogram.h"
 #include "itkNumericTraits.h"
 #include "itkVectorContainer.h"
+#include <vector>
 
 namespace itk
 {
@@ -91,6 +92,11 @@ namespace Statistics
  * NumericTraits class is the same, and thus cannot hold any larger values,
  * this would cause a float overflow.
  *
+ * The offsets are shared between the threads, each of which fills the
+ * matrices of its offsets, which are added to the histogram at the end. When
+ * a mask is given, the runs only start in the bounding box of the pixels
+ * inside the mask.
+ *
  * IJ article: http://hdl.handle.net/1926/1374
  *
  * \sa ScalarImageToRunLengthFeaturesFilter
@@ -128,6 +134,7 @@ public:
   typedef typename ImageType::OffsetType                  OffsetType;
   typedef VectorContainer<unsigned char, OffsetType>      OffsetVector;
   typedef typename OffsetVector::Pointer                  OffsetVectorPointer;
+  typedef typename OffsetVector::ConstPointer             OffsetVectorConstPointer;
   typedef typename ImageType::PointType                   PointType;
 
   typedef typename NumericTraits<PixelType>::RealType     MeasurementType;
@@ -150,7 +157,7 @@ public:
    * Set the offsets over which the intensity/distance pairs will be computed.
    * Invoking this function clears the previous offsets.
    */
-  itkSetObjectMacro( Offsets, OffsetVector );
+  itkSetConstObjectMacro( Offsets, OffsetVector );
 
   /**
    * Set offset over which the intensity/distance pairs will be computed.
@@ -213,6 +220,21 @@ public:
   /** method to get the Histogram */
   const HistogramType * GetOutput() const;
 
+  /**
+   * Set/Get whether a run-length matrix is also kept for each offset. They
+   * are computed anyway, so this is cheaper than running the filter once per
+   * offset. Off by default.
+   */
+  itkSetMacro( ComputeOffsetHistograms, bool );
+  itkGetConstMacro( ComputeOffsetHistograms, bool );
+  itkBooleanMacro( ComputeOffsetHistograms );
+
+  /**
+   * Get the run-length matrix of the offset of the given position in the
+   * offsets. Only available when ComputeOffsetHistograms is on.
+   */
+  const HistogramType * GetOffsetHistogram( unsigned int offsetIndex ) const;
+
   /**
    * Set the pixel value of the mask that should be considered "inside" the
    * object. Defaults to 1.
@@ -235,6 +257,17 @@ protected:
   virtual void GenerateData();
 
 private:
+  struct FillHistogramsThreadStruct
+    {
+    ScalarImageToRunLengthMatrixFilter *Filter;
+    RegionType                          CenterRegion;
+    };
+
+  static ITK_THREAD_RETURN_TYPE FillHistogramsThreaderCallback( void *arg );
+
+  /** Fill the matrices of the offsets assigned to a thread. */
+  void ThreadedFillHistograms( const FillHistogramsThreadStruct & str,
+    ThreadIdType threadId, ThreadIdType threadCount );
 
   unsigned int             m_NumberOfBinsPerAxis;
   PixelType                m_Min;
@@ -245,8 +278,10 @@ private:
 
   MeasurementVectorType    m_LowerBound;
   MeasurementVectorType    m_UpperBound;
-  OffsetVectorPointer      m_Offsets;
+  OffsetVectorConstPointer m_Offsets;
 
+  bool                          m_ComputeOffsetHistograms;
+  std::vector<HistogramPointer> m_OffsetHistograms;
 };
 } // end of namespace Statistics
 } // end of namespace itk
@@ -20,9 +20,9 @@
 
 #include "itkScalarImageToRunLengthMatrixFilter.h"
 
-#include "itkConstNeighborhoodIterator.h"
-#include "itkNeighborhood.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "vnl/vnl_math.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -37,7 +37,8 @@ ScalarImageToRunLengthMatrixFilter<TImageType, THistogramFrequencyContainer>
   m_Max( NumericTraits<PixelType>::max() ),
   m_MinDistance( NumericTraits<RealType>::Zero ),
   m_MaxDistance( NumericTraits<RealType>::max() ),
-  m_InsidePixelValue( NumericTraits<PixelType>::One )
+  m_InsidePixelValue( NumericTraits<PixelType>::One ),
+  m_ComputeOffsetHistograms( false )
 {
   this->SetNumberOfRequiredInputs( 1 );
   this->SetNumberOfRequiredOutputs( 1 );
@@ -120,6 +121,21 @@ ScalarImageToRunLengthMatrixFilter<TImageType, THistogramFrequencyContainer>
   return output;
 }
 
+template<class TImageType, class THistogramFrequencyContainer>
+const typename ScalarImageToRunLengthMatrixFilter<TImageType,
+  THistogramFrequencyContainer >::HistogramType *
+ScalarImageToRunLengthMatrixFilter<TImageType, THistogramFrequencyContainer>
+::GetOffsetHistogram( unsigned int offsetIndex ) const
+{
+  if( !this->m_ComputeOffsetHistograms ||
+    offsetIndex >= this->m_OffsetHistograms.size() )
+    {
+    itkExceptionMacro( << "No run-length matrix for the offset " << offsetIndex
+      << ". ComputeOffsetHistograms must be on, and the filter updated." );
+    }
+  return this->m_OffsetHistograms[offsetIndex];
+}
+
 template<class TImageType, class THistogramFrequencyContainer>
 typename ScalarImageToRunLengthMatrixFilter<TImageType,
   THistogramFrequencyContainer>::DataObjectPointer
@@ -149,61 +165,167 @@ ScalarImageToRunLengthMatrixFilter<TImageType, THistogramFrequencyContainer>
   this->m_UpperBound[1] = this->m_MaxDistance;
   output->Initialize( size, this->m_LowerBound, this->m_UpperBound );
 
-  MeasurementVectorType run( output->GetMeasurementVectorSize() );
+  // One matrix per offset, filled by the threads
+  const unsigned int numberOfOffsets = this->GetOffsets()->size();
+  this->m_OffsetHistograms.clear();
+  for( unsigned int k = 0; k < numberOfOffsets; k++ )
+    {
+    HistogramPointer histogram = HistogramType::New();
+    histogram->SetMeasurementVectorSize( output->GetMeasurementVectorSize() );
+    histogram->Initialize( size, this->m_LowerBound, this->m_UpperBound );
+    this->m_OffsetHistograms.push_back( histogram );
+    }
+
+  // The runs start only in the mask, so only its bounding box has to be
+  // visited
+  const RegionType & region = this->GetInput()->GetRequestedRegion();
+  FillHistogramsThreadStruct str;
+  str.Filter = this;
+  str.CenterRegion = region;
 
-  // Iterate over all of those pixels and offsets, adding each
-  // distance/intensity pair to the histogram
+  const ImageType *maskImage = this->GetMaskImage();
+  bool empty = false;
+  if( maskImage )
+    {
+    IndexType minIndex;
+    IndexType maxIndex;
+    minIndex.Fill( NumericTraits<IndexValueType>::max() );
+    maxIndex.Fill( NumericTraits<IndexValueType>::NonpositiveMin() );
+    empty = true;
+
+    ImageRegionConstIteratorWithIndex<ImageType> mit( maskImage, region );
+    for( mit.GoToBegin(); !mit.IsAtEnd(); ++mit )
+      {
+      if( mit.Get() == this->m_InsidePixelValue )
+        {
+        const IndexType & index = mit.GetIndex();
+        for( unsigned int i = 0; i < ImageDimension; i++ )
+          {
+          minIndex[i] = vnl_math_min( minIndex[i], index[i] );
+          maxIndex[i] = vnl_math_max( maxIndex[i], index[i] );
+          }
+        empty = false;
+        }
+      }
+    str.CenterRegion.SetIndex( minIndex );
+    for( unsigned int i = 0; i < ImageDimension && !empty; i++ )
+      {
+      str.CenterRegion.SetSize( i, maxIndex[i] - minIndex[i] + 1 );
+      }
+    }
 
-  typedef ConstNeighborhoodIterator<ImageType> NeighborhoodIteratorType;
-  typename NeighborhoodIteratorType::RadiusType radius;
-  radius.Fill( 1 );
-  NeighborhoodIteratorType neighborIt( radius,
-    this->GetInput(), this->GetInput()->GetRequestedRegion() );
+  if( !empty && numberOfOffsets > 0 )
+    {
+    // Each thread marks the pixels already in a run in its own image of the
+    // requested region, so the number of threads is limited to keep the
+    // memory used by these images reasonable when the region is large.
+    const SizeValueType maximumNumberOfVisitedPixels = 1 << 28;
+    const SizeValueType visitedPixelsPerThread =
+      std::max( static_cast<SizeValueType>( region.GetNumberOfPixels() ), SizeValueType( 1 ) );
+    const ThreadIdType numberOfThreads = static_cast<ThreadIdType>(
+      std::max( std::min( std::min( static_cast<SizeValueType>( this->GetNumberOfThreads() ),
+      static_cast<SizeValueType>( numberOfOffsets ) ),
+      maximumNumberOfVisitedPixels / visitedPixelsPerThread ), SizeValueType( 1 ) ) );
+    this->GetMultiThreader()->SetNumberOfThreads( numberOfThreads );
+    this->GetMultiThreader()->SetSingleMethod(
+      this->FillHistogramsThreaderCallback, &str );
+    this->GetMultiThreader()->SingleMethodExecute();
+    }
 
-  typename OffsetVector::ConstIterator offsets;
-  for( offsets = this->GetOffsets()->Begin();
-    offsets != this->GetOffsets()->End(); offsets++ )
+  // Add the matrices of the offsets
+  for( unsigned int k = 0; k < numberOfOffsets; k++ )
     {
-    typedef Image<bool, ImageDimension> BoolImageType;
-    typename BoolImageType::Pointer alreadyVisitedImage = BoolImageType::New();
-    alreadyVisitedImage->CopyInformation( this->GetInput() );
-    alreadyVisitedImage->SetRegions( this->GetInput()->GetRequestedRegion() );
-    alreadyVisitedImage->Allocate();
-    alreadyVisitedImage->FillBuffer( false );
+    const HistogramType *histogram = this->m_OffsetHistograms[k];
+    for( typename HistogramType::InstanceIdentifier id = 0;
+      id < histogram->Size(); id++ )
+      {
+      const typename HistogramType::AbsoluteFrequencyType frequency =
+        histogram->GetFrequency( id );
+      if( frequency != NumericTraits<typename HistogramType::AbsoluteFrequencyType>::Zero )
+        {
+        output->IncreaseFrequency( id, frequency );
+        }
+      }
+    }
+
+  if( !this->m_ComputeOffsetHistograms )
+    {
+    this->m_OffsetHistograms.clear();
+    }
+}
+
+template<class TImageType, class THistogramFrequencyContainer>
+ITK_THREAD_RETURN_TYPE
+ScalarImageToRunLengthMatrixFilter<TImageType, THistogramFrequencyContainer>
+::FillHistogramsThreaderCallback( void *arg )
+{
+  ThreadIdType threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  ThreadIdType threadCount = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->NumberOfThreads;
+
+  FillHistogramsThreadStruct *str = (FillHistogramsThreadStruct *)
+    ( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
 
-    neighborIt.GoToBegin();
-    OffsetType offset = offsets.Value();
+  str->Filter->ThreadedFillHistograms( *str, threadId, threadCount );
 
-    for( neighborIt.GoToBegin(); !neighborIt.IsAtEnd(); ++neighborIt )
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template<class TImageType, class THistogramFrequencyContainer>
+void
+ScalarImageToRunLengthMatrixFilter<TImageType, THistogramFrequencyContainer>
+::ThreadedFillHistograms( const FillHistogramsThreadStruct & str,
+  ThreadIdType threadId, ThreadIdType threadCount )
+{
+  const ImageType *input = this->GetInput();
+  const ImageType *maskImage = this->GetMaskImage();
+  const RegionType & region = input->GetRequestedRegion();
+
+  // The pixels already in a run, reset for each offset
+  typedef Image<bool, ImageDimension> BoolImageType;
+  typename BoolImageType::Pointer alreadyVisitedImage = BoolImageType::New();
+  alreadyVisitedImage->CopyInformation( input );
+  alreadyVisitedImage->SetRegions( region );
+  alreadyVisitedImage->Allocate();
+
+  MeasurementVectorType run( this->GetOutput()->GetMeasurementVectorSize() );
+
+  for( unsigned int k = threadId; k < this->m_OffsetHistograms.size();
+    k += threadCount )
+    {
+    HistogramType *histogram = this->m_OffsetHistograms[k];
+    const OffsetType offset = this->GetOffsets()->ElementAt( k );
+    alreadyVisitedImage->FillBuffer( false );
+
+    ImageRegionConstIteratorWithIndex<ImageType> it( input, str.CenterRegion );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
       {
-      const PixelType centerPixelIntensity = neighborIt.GetCenterPixel();
-      IndexType centerIndex = neighborIt.GetIndex();
+      const PixelType centerPixelIntensity = it.Get();
+      const IndexType & centerIndex = it.GetIndex();
       if( centerPixelIntensity < this->m_Min ||
         centerPixelIntensity > this->m_Max ||
-        alreadyVisitedImage->GetPixel( centerIndex ) || ( this->GetMaskImage() &&
-        this->GetMaskImage()->GetPixel( centerIndex ) !=
-        this->m_InsidePixelValue ) )
+        alreadyVisitedImage->GetPixel( centerIndex ) || ( maskImage &&
+        maskImage->GetPixel( centerIndex ) != this->m_InsidePixelValue ) )
         {
         continue; // don't put a pixel in the histogram if the value
                   // is out-of-bounds or is outside the mask.
         }
 
-      MeasurementType centerBinMin = this->GetOutput()->
-        GetBinMinFromValue( 0, centerPixelIntensity );
-      MeasurementType centerBinMax = this->GetOutput()->
-        GetBinMaxFromValue( 0, centerPixelIntensity );
+      MeasurementType centerBinMin =
+        histogram->GetBinMinFromValue( 0, centerPixelIntensity );
+      MeasurementType centerBinMax =
+        histogram->GetBinMaxFromValue( 0, centerPixelIntensity );
 
       IndexType index = centerIndex;
-      PixelType pixelIntensity = this->GetInput()->GetPixel( index );
+      PixelType pixelIntensity = input->GetPixel( index );
       while( pixelIntensity >= centerBinMin &&
         pixelIntensity <= centerBinMax &&
         !alreadyVisitedImage->GetPixel( index ) )
         {
         alreadyVisitedImage->SetPixel( index, true );
         index += offset;
-        if( this->GetInput()->GetRequestedRegion().IsInside( index ) )
+        if( region.IsInside( index ) )
           {
-          pixelIntensity = this->GetInput()->GetPixel( index );
+          pixelIntensity = input->GetPixel( index );
           }
         else
           {
@@ -212,17 +334,16 @@ ScalarImageToRunLengthMatrixFilter<TImageType, THistogramFrequencyContainer>
         }
 
       PointType centerPoint;
-      this->GetInput()->TransformIndexToPhysicalPoint(
-        centerIndex, centerPoint );
+      input->TransformIndexToPhysicalPoint( centerIndex, centerPoint );
       PointType point;
-      this->GetInput()->TransformIndexToPhysicalPoint( index, point );
+      input->TransformIndexToPhysicalPoint( index, point );
 
       run[0] = centerPixelIntensity;
       run[1] = centerPoint.EuclideanDistanceTo( point );
 
       if( run[1] >= this->m_MinDistance && run[1] <= this->m_MaxDistance )
         {
-        output->IncreaseFrequencyOfMeasurement( run, 1 );
+        histogram->IncreaseFrequencyOfMeasurement( run, 1 );
         }
       }
     }
@@ -271,6 +392,8 @@ ScalarImageToRunLengthMatrixFilter<TImageType, THistogramFrequencyContainer>
   os << indent << "NumberOfBinsPerAxis: " << this->m_NumberOfBinsPerAxis
     << std::endl;
   os << indent << "InsidePixelValue: " << this->m_InsidePixelValue << std::endl;
+  os << indent << "ComputeOffsetHistograms: " << this->m_ComputeOffsetHistograms
+    << std::endl;
 }
 
 } // end of namespace Statistics
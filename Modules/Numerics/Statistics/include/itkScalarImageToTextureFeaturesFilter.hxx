@@ -118,13 +118,17 @@ ScalarImageToTextureFeaturesFilter< TImage, THistogramFrequencyContainer >::Full
   int offsetNum, featureNum;
   typedef typename TextureFeaturesFilterType::TextureFeatureName InternalTextureFeatureName;
 
+  // The co-occurrence matrices of all the offsets are computed in a single
+  // pass over the image
+  m_GLCMGenerator->SetOffsets(m_Offsets);
+  m_GLCMGenerator->ComputeOffsetHistogramsOn();
+  m_GLCMGenerator->Update();
+
   for ( offsetIt = m_Offsets->Begin(), offsetNum = 0;
         offsetIt != m_Offsets->End(); offsetIt++, offsetNum++ )
     {
-    m_GLCMGenerator->SetOffset( offsetIt.Value() );
-    m_GLCMGenerator->Update();
     typename TextureFeaturesFilterType::Pointer glcmCalc = TextureFeaturesFilterType::New();
-    glcmCalc->SetInput( m_GLCMGenerator->GetOutput() );
+    glcmCalc->SetInput( m_GLCMGenerator->GetOffsetHistogram(offsetNum) );
     glcmCalc->Update();
 
     typename FeatureNameVector::ConstIterator fnameIt;
@@ -206,6 +210,7 @@ ScalarImageToTextureFeaturesFilter< TImage, THistogramFrequencyContainer >::Fast
   // Compute the feature for the first offset
   typename OffsetVector::ConstIterator offsetIt = m_Offsets->Begin();
   m_GLCMGenerator->SetOffset( offsetIt.Value() );
+  m_GLCMGenerator->ComputeOffsetHistogramsOff();
 
   m_GLCMGenerator->Update();
   typename TextureFeaturesFilterType::Pointer glcmCalc = TextureFeaturesFilterType::New();
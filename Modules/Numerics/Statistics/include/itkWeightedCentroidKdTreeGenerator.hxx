@@ -46,8 +46,6 @@ WeightedCentroidKdTreeGenerator< TSample >
                           MeasurementVectorType & upperBound,
                           unsigned int level)
 {
-  MeasurementType dimensionLowerBound;
-  MeasurementType dimensionUpperBound;
   MeasurementType partitionValue;
   unsigned int    partitionDimension = 0;
   unsigned int    i;
@@ -83,15 +81,24 @@ WeightedCentroidKdTreeGenerator< TSample >
     }
 
   // find most widely spread dimension
+  MeasurementVectorType tempLowerBound;
+  NumericTraits<MeasurementVectorType>::SetLength( tempLowerBound,
+    this->GetMeasurementVectorSize() );
+  MeasurementVectorType tempUpperBound;
+  NumericTraits<MeasurementVectorType>::SetLength( tempUpperBound,
+    this->GetMeasurementVectorSize() );
+  MeasurementVectorType tempMean;
+  NumericTraits<MeasurementVectorType>::SetLength( tempMean,
+    this->GetMeasurementVectorSize() );
   Algorithm::FindSampleBoundAndMean< SubsampleType >(this->GetSubsample(),
                                                      beginIndex, endIndex,
-                                                     m_TempLowerBound, m_TempUpperBound,
-                                                     m_TempMean);
+                                                     tempLowerBound, tempUpperBound,
+                                                     tempMean);
 
   maxSpread = NumericTraits< MeasurementType >::NonpositiveMin();
   for ( i = 0; i < this->GetMeasurementVectorSize(); i++ )
     {
-    spread = m_TempUpperBound[i] - m_TempLowerBound[i];
+    spread = tempUpperBound[i] - tempLowerBound[i];
     if ( spread >= maxSpread )
       {
       maxSpread = spread;
@@ -113,21 +120,12 @@ WeightedCentroidKdTreeGenerator< TSample >
 
   medianIndex += beginIndex;
 
-  // save bounds for cutting dimension
-  dimensionLowerBound = lowerBound[partitionDimension];
-  dimensionUpperBound = upperBound[partitionDimension];
-
-  upperBound[partitionDimension] = partitionValue;
-  const unsigned int beginLeftIndex = beginIndex;
-  const unsigned int endLeftIndex   = medianIndex;
-  KdTreeNodeType *   left = this->GenerateTreeLoop(beginLeftIndex, endLeftIndex, lowerBound, upperBound, level + 1);
-  upperBound[partitionDimension] = dimensionUpperBound;
-
-  lowerBound[partitionDimension] = partitionValue;
-  const unsigned int beginRightIndex = medianIndex + 1;
-  const unsigned int endRighIndex    = endIndex;
-  KdTreeNodeType *   right = this->GenerateTreeLoop(beginRightIndex, endRighIndex, lowerBound, upperBound, level + 1);
-  lowerBound[partitionDimension] = dimensionLowerBound;
+  KdTreeNodeType *left;
+  KdTreeNodeType *right;
+  this->GenerateChildNodes(beginIndex, medianIndex, endIndex,
+                           partitionDimension, partitionValue,
+                           lowerBound, upperBound, level + 1,
+                           left, right);
 
   typedef KdTreeWeightedCentroidNonterminalNode< TSample > KdTreeNonterminalNodeType;
 
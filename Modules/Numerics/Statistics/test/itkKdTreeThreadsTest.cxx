@@ -0,0 +1,222 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkVector.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkListSample.h"
+#include "itkWeightedCentroidKdTreeGenerator.h"
+#include "itkTimeProbe.h"
+#include <algorithm>
+#include <sstream>
+
+namespace
+{
+typedef itk::Vector< float, 3 >                              MeasurementVectorType;
+typedef itk::Statistics::ListSample< MeasurementVectorType > SampleType;
+
+// The distance as computed by EuclideanDistanceMetric
+double Distance( const MeasurementVectorType & x1, const MeasurementVectorType & x2 )
+{
+  double sumOfSquares = 0.0;
+  for ( unsigned int d = 0; d < MeasurementVectorType::Dimension; ++d )
+    {
+    const double temp = x1[d] - x2[d];
+    sumOfSquares += temp * temp;
+    }
+  return vcl_sqrt( sumOfSquares );
+}
+
+// Search the tree of each generator with the single and the batched searches
+template< class TGenerator >
+bool TestGenerator( const SampleType *sample, const std::vector< MeasurementVectorType > & queries )
+{
+  typedef typename TGenerator::KdTreeType TreeType;
+
+  const unsigned int numberOfNeighbors = 5;
+  const double       radius = 0.1;
+
+  // The tree generated with one thread is the reference
+  typename TGenerator::Pointer reference = TGenerator::New();
+  reference->SetSample( const_cast< SampleType * >( sample ) );
+  reference->SetBucketSize( 8 );
+  reference->SetNumberOfThreads( 1 );
+  reference->Update();
+  typename TreeType::Pointer referenceTree = reference->GetOutput();
+
+  std::ostringstream referenceTreeString;
+  referenceTree->PrintTree( referenceTreeString );
+
+  const itk::ThreadIdType threads[] = { 2, 3, 8 };
+  for ( unsigned int t = 0; t < sizeof( threads ) / sizeof( threads[0] ); t++ )
+    {
+    typename TGenerator::Pointer generator = TGenerator::New();
+    generator->SetSample( const_cast< SampleType * >( sample ) );
+    generator->SetBucketSize( 8 );
+    generator->SetNumberOfThreads( threads[t] );
+
+    itk::TimeProbe probe;
+    probe.Start();
+    generator->Update();
+    probe.Stop();
+    std::cout << "Generated with " << threads[t] << " threads in "
+              << probe.GetTotal() << " s" << std::endl;
+
+    typename TreeType::Pointer tree = generator->GetOutput();
+    std::ostringstream treeString;
+    tree->PrintTree( treeString );
+    if ( treeString.str() != referenceTreeString.str() )
+      {
+      std::cerr << "The tree generated with " << threads[t]
+                << " threads differs from the one generated with one thread" << std::endl;
+      return false;
+      }
+
+    tree->SetNumberOfThreads( threads[t] );
+    std::vector< typename TreeType::InstanceIdentifierVectorType > batchNeighbors;
+    itk::TimeProbe searchProbe;
+    searchProbe.Start();
+    tree->Search( queries, numberOfNeighbors, batchNeighbors );
+    searchProbe.Stop();
+    std::cout << "Searched with " << threads[t] << " threads in "
+              << searchProbe.GetTotal() << " s" << std::endl;
+
+    if ( batchNeighbors.size() != queries.size() )
+      {
+      std::cerr << batchNeighbors.size() << " results for " << queries.size()
+                << " query points" << std::endl;
+      return false;
+      }
+
+    for ( unsigned int q = 0; q < queries.size(); q++ )
+      {
+      typename TreeType::InstanceIdentifierVectorType neighbors;
+      referenceTree->Search( queries[q], numberOfNeighbors, neighbors );
+      if ( neighbors != batchNeighbors[q] )
+        {
+        std::cerr << "The batched search differs from the single search for the query point "
+                  << q << std::endl;
+        return false;
+        }
+
+      // The neighbors are the closest points of the sample
+      std::vector< double > distances;
+      for ( unsigned int i = 0; i < sample->Size(); i++ )
+        {
+        distances.push_back( Distance( queries[q], sample->GetMeasurementVector( i ) ) );
+        }
+      std::nth_element( distances.begin(), distances.begin() + numberOfNeighbors - 1, distances.end() );
+      const double kthDistance = distances[numberOfNeighbors - 1];
+      for ( unsigned int n = 0; n < neighbors.size(); n++ )
+        {
+        const double distance =
+          Distance( queries[q], sample->GetMeasurementVector( neighbors[n] ) );
+        if ( distance > kthDistance + 1e-6 )
+          {
+          std::cerr << "The neighbor " << neighbors[n] << " of the query point " << q
+                    << " is at " << distance << " instead of at most " << kthDistance << std::endl;
+          return false;
+          }
+        }
+
+      // The radius search finds the same points in both trees
+      typename TreeType::InstanceIdentifierVectorType inRadius;
+      typename TreeType::InstanceIdentifierVectorType referenceInRadius;
+      tree->Search( queries[q], radius, inRadius );
+      referenceTree->Search( queries[q], radius, referenceInRadius );
+      if ( inRadius != referenceInRadius )
+        {
+        std::cerr << "The radius search differs for the query point " << q << std::endl;
+        return false;
+        }
+      unsigned int numberInRadius = 0;
+      for ( unsigned int i = 0; i < sample->Size(); i++ )
+        {
+        if ( Distance( queries[q], sample->GetMeasurementVector( i ) ) <= radius )
+          {
+          numberInRadius++;
+          }
+        }
+      if ( numberInRadius != inRadius.size() )
+        {
+        std::cerr << "The radius search finds " << inRadius.size() << " points instead of "
+                  << numberInRadius << " for the query point " << q << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+}
+
+//
+// Generate k-d trees with several numbers of threads, check that they are
+// identical, and compare the searches of several query points with the
+// threads to the searches of each query point and to an exhaustive search.
+//
+int itkKdTreeThreadsTest( int, char * [] )
+{
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator NumberGeneratorType;
+  NumberGeneratorType::Pointer randomNumberGenerator = NumberGeneratorType::GetInstance();
+  randomNumberGenerator->Initialize( 20111 );
+
+  SampleType::Pointer sample = SampleType::New();
+  sample->SetMeasurementVectorSize( 3 );
+
+  // Enough points for the nodes to be generated in threads, some of them
+  // identical
+  MeasurementVectorType mv;
+  for ( unsigned int i = 0; i < 20000; ++i )
+    {
+    for ( unsigned int d = 0; d < 3; ++d )
+      {
+      mv[d] = randomNumberGenerator->GetUniformVariate( 0.0, 1.0 );
+      }
+    if ( i % 100 == 0 )
+      {
+      mv.Fill( 0.5 );
+      }
+    sample->PushBack( mv );
+    }
+
+  std::vector< MeasurementVectorType > queries;
+  for ( unsigned int i = 0; i < 200; ++i )
+    {
+    for ( unsigned int d = 0; d < 3; ++d )
+      {
+      mv[d] = randomNumberGenerator->GetUniformVariate( -0.1, 1.1 );
+      }
+    queries.push_back( mv );
+    }
+
+  typedef itk::Statistics::KdTreeGenerator< SampleType >                 GeneratorType;
+  typedef itk::Statistics::WeightedCentroidKdTreeGenerator< SampleType > WeightedCentroidGeneratorType;
+
+  if ( !TestGenerator< GeneratorType >( sample, queries ) )
+    {
+    std::cerr << "Test failed for KdTreeGenerator" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if ( !TestGenerator< WeightedCentroidGeneratorType >( sample, queries ) )
+    {
+    std::cerr << "Test failed for WeightedCentroidKdTreeGenerator" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
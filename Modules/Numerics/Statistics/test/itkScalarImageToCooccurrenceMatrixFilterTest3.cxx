@@ -0,0 +1,257 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkNeighborhood.h"
+#include "itkScalarImageToCooccurrenceMatrixFilter.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+const unsigned int Dimension = 3;
+const unsigned int NumberOfBins = 16;
+
+typedef itk::Image< unsigned char, Dimension >                           ImageType;
+typedef itk::Statistics::ScalarImageToCooccurrenceMatrixFilter< ImageType > FilterType;
+typedef FilterType::HistogramType                                        HistogramType;
+typedef FilterType::OffsetVector                                         OffsetVector;
+typedef std::vector< double >                                            MatrixType;
+
+// Count the co-occurrences of an offset pixel by pixel.
+MatrixType ComputeMatrix(const ImageType *image, const ImageType *mask, const ImageType::OffsetType & offset)
+{
+  MatrixType matrix(NumberOfBins * NumberOfBins, 0.0);
+  const ImageType::RegionType region = image->GetLargestPossibleRegion();
+
+  itk::ImageRegionConstIteratorWithIndex< ImageType > it( image, region );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType index = it.GetIndex();
+    const ImageType::IndexType neighbor = index + offset;
+    if ( !region.IsInside(neighbor)
+         || ( mask && ( mask->GetPixel(index) != 1 || mask->GetPixel(neighbor) != 1 ) ) )
+      {
+      continue;
+      }
+    const unsigned int center = it.Get();
+    const unsigned int other = image->GetPixel(neighbor);
+    matrix[center + other * NumberOfBins] += 1;
+    matrix[other + center * NumberOfBins] += 1;
+    }
+  return matrix;
+}
+
+bool CheckHistogram(const std::string & description, const HistogramType *histogram,
+                    const MatrixType & expected)
+{
+  for ( unsigned int id = 0; id < expected.size(); id++ )
+    {
+    if ( histogram->GetFrequency(id) != expected[id] )
+      {
+      std::cerr << description << ": frequency " << histogram->GetFrequency(id)
+                << " instead of " << expected[id] << " for the bin " << id << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+// With float pixels and the default bounds, the largest float is the upper
+// bound of the histogram and thus out of its bins: its pairs are not counted.
+bool TestFloatDefaultBounds()
+{
+  typedef itk::Image< float, Dimension >                                          FloatImageType;
+  typedef itk::Statistics::ScalarImageToCooccurrenceMatrixFilter< FloatImageType > FloatFilterType;
+  typedef FloatFilterType::HistogramType                                          FloatHistogramType;
+
+  FloatImageType::SizeType size;
+  size[0] = 13;
+  size[1] = 11;
+  size[2] = 7;
+  FloatImageType::RegionType region;
+  region.SetSize(size);
+
+  FloatImageType::Pointer image = FloatImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< FloatImageType > it( image, region );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const FloatImageType::IndexType & index = it.GetIndex();
+    const long value = ( index[0] + 2 * index[1] + 3 * index[2] ) % 5;
+    it.Set( value == 4 ? itk::NumericTraits< float >::max() : static_cast< float >( value ) - 1.5f );
+    }
+
+  FloatImageType::OffsetType offset;
+  offset[0] = 1;
+  offset[1] = 1;
+  offset[2] = 0;
+
+  const itk::ThreadIdType threads[] = { 1, 3 };
+  for ( unsigned int t = 0; t < sizeof( threads ) / sizeof( threads[0] ); t++ )
+    {
+    FloatFilterType::Pointer filter = FloatFilterType::New();
+    filter->SetInput(image);
+    filter->SetOffset(offset);
+    filter->SetNumberOfThreads(threads[t]);
+    filter->Update();
+    const FloatHistogramType *histogram = filter->GetOutput();
+
+    // count the pairs in the bins of the histogram, as
+    // IncreaseFrequencyOfMeasurement does
+    MatrixType                                expected(histogram->Size(), 0.0);
+    FloatHistogramType::MeasurementVectorType measurement(2);
+    FloatHistogramType::IndexType             index(2);
+    for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      const FloatImageType::IndexType neighbor = it.GetIndex() + offset;
+      if ( !region.IsInside(neighbor) )
+        {
+        continue;
+        }
+      for ( unsigned int order = 0; order < 2; order++ )
+        {
+        measurement[order] = it.Get();
+        measurement[1 - order] = image->GetPixel(neighbor);
+        if ( histogram->GetIndex(measurement, index) )
+          {
+          expected[histogram->GetInstanceIdentifier(index)] += 1;
+          }
+        }
+      }
+
+    std::ostringstream description;
+    description << "Float pixels with the default bounds, " << threads[t] << " threads";
+    if ( !CheckHistogram(description.str(), histogram, expected) )
+      {
+      return false;
+      }
+    }
+  return true;
+}
+}
+
+//
+// Compute the co-occurrence matrices of an image, with and without a mask,
+// with several numbers of threads, and compare them with the matrices
+// computed pixel by pixel, for all the offsets together and for each offset.
+// Also count the co-occurrences of float pixels with the default bounds.
+//
+int itkScalarImageToCooccurrenceMatrixFilterTest3(int, char* [])
+{
+  ImageType::RegionType region;
+  ImageType::SizeType   size;
+  size[0] = 61;
+  size[1] = 47;
+  size[2] = 33;
+  region.SetSize(size);
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+
+  // the mask is a ball, which does not touch the border of the image
+  ImageType::Pointer mask = ImageType::New();
+  mask->SetRegions(region);
+  mask->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, region );
+  itk::ImageRegionIteratorWithIndex< ImageType > mit( mask, region );
+  for ( ; !it.IsAtEnd(); ++it, ++mit )
+    {
+    const ImageType::IndexType & index = it.GetIndex();
+    it.Set( ( index[0] * 7 + index[1] * index[1] + index[2] * 3 ) % NumberOfBins );
+    const long x = index[0] - 35;
+    const long y = index[1] - 20;
+    const long z = index[2] - 15;
+    mit.Set( x * x + y * y + z * z < 144 ? 1 : 0 );
+    }
+
+  // half of the 26 neighbors, as in ScalarImageToTextureFeaturesFilter
+  itk::Neighborhood< unsigned char, Dimension > hood;
+  hood.SetRadius(1);
+  OffsetVector::Pointer offsets = OffsetVector::New();
+  for ( unsigned int d = 0; d < hood.GetCenterNeighborhoodIndex(); d++ )
+    {
+    offsets->push_back( hood.GetOffset(d) );
+    }
+
+  for ( unsigned int m = 0; m < 2; m++ )
+    {
+    const ImageType *maskImage = m == 0 ? NULL : mask.GetPointer();
+
+    std::vector< MatrixType > expected;
+    MatrixType                total(NumberOfBins * NumberOfBins, 0.0);
+    for ( unsigned int k = 0; k < offsets->size(); k++ )
+      {
+      expected.push_back( ComputeMatrix( image, maskImage, offsets->ElementAt(k) ) );
+      for ( unsigned int id = 0; id < total.size(); id++ )
+        {
+        total[id] += expected[k][id];
+        }
+      }
+
+    const itk::ThreadIdType threads[] = { 1, 2, 4, 7 };
+    for ( unsigned int t = 0; t < sizeof( threads ) / sizeof( threads[0] ); t++ )
+      {
+      FilterType::Pointer filter = FilterType::New();
+      filter->SetInput(image);
+      if ( maskImage )
+        {
+        filter->SetMaskImage(maskImage);
+        }
+      filter->SetOffsets(offsets);
+      filter->SetNumberOfBinsPerAxis(NumberOfBins);
+      filter->SetPixelValueMinMax(0, NumberOfBins - 1);
+      filter->ComputeOffsetHistogramsOn();
+      filter->SetNumberOfThreads(threads[t]);
+
+      itk::TimeProbe probe;
+      probe.Start();
+      filter->Update();
+      probe.Stop();
+      std::cout << ( maskImage ? "With" : "Without" ) << " mask, " << threads[t] << " threads: "
+                << probe.GetTotal() << " s" << std::endl;
+
+      std::ostringstream description;
+      description << ( maskImage ? "With" : "Without" ) << " mask, " << threads[t] << " threads";
+      if ( !CheckHistogram(description.str(), filter->GetOutput(), total) )
+        {
+        return EXIT_FAILURE;
+        }
+      for ( unsigned int k = 0; k < offsets->size(); k++ )
+        {
+        std::ostringstream offsetDescription;
+        offsetDescription << description.str() << ", offset " << offsets->ElementAt(k);
+        if ( !CheckHistogram(offsetDescription.str(), filter->GetOffsetHistogram(k), expected[k]) )
+          {
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+  if ( !TestFloatDefaultBounds() )
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test succeeded" << std::endl;
+  return EXIT_SUCCESS;
+}
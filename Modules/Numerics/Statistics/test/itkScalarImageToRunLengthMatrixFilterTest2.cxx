@@ -0,0 +1,176 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkNeighborhood.h"
+#include "itkScalarImageToRunLengthMatrixFilter.h"
+
+namespace
+{
+const unsigned int Dimension = 3;
+const unsigned int NumberOfBins = 8;
+
+typedef itk::Image< unsigned char, Dimension >                          ImageType;
+typedef itk::Statistics::ScalarImageToRunLengthMatrixFilter< ImageType > FilterType;
+typedef FilterType::HistogramType                                       HistogramType;
+typedef FilterType::OffsetVector                                        OffsetVector;
+
+FilterType::Pointer CreateFilter(const ImageType *image, const ImageType *mask)
+{
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(image);
+  if ( mask )
+    {
+    filter->SetMaskImage(mask);
+    }
+  filter->SetNumberOfBinsPerAxis(NumberOfBins);
+  filter->SetPixelValueMinMax(0, 15);
+  filter->SetDistanceValueMinMax(0, 16);
+  return filter;
+}
+
+bool CheckHistogram(const std::string & description, const HistogramType *histogram,
+                    const HistogramType *expected)
+{
+  if ( histogram->Size() != expected->Size() )
+    {
+    std::cerr << description << ": " << histogram->Size() << " bins instead of "
+              << expected->Size() << std::endl;
+    return false;
+    }
+  for ( HistogramType::InstanceIdentifier id = 0; id < expected->Size(); id++ )
+    {
+    if ( histogram->GetFrequency(id) != expected->GetFrequency(id) )
+      {
+      std::cerr << description << ": frequency " << histogram->GetFrequency(id)
+                << " instead of " << expected->GetFrequency(id) << " for the bin "
+                << id << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+}
+
+//
+// Compute the run-length matrices of several offsets together, with and
+// without a mask, with several numbers of threads, and compare them with the
+// matrices computed for each offset alone.
+//
+int itkScalarImageToRunLengthMatrixFilterTest2(int, char* [])
+{
+  ImageType::RegionType region;
+  ImageType::SizeType   size;
+  size[0] = 37;
+  size[1] = 29;
+  size[2] = 17;
+  region.SetSize(size);
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+
+  ImageType::Pointer mask = ImageType::New();
+  mask->SetRegions(region);
+  mask->Allocate();
+
+  // long runs along the first axis, and a ball as mask
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, region );
+  itk::ImageRegionIteratorWithIndex< ImageType > mit( mask, region );
+  for ( ; !it.IsAtEnd(); ++it, ++mit )
+    {
+    const ImageType::IndexType & index = it.GetIndex();
+    it.Set( ( index[0] / 5 + index[1] * 3 + ( index[2] / 2 ) * 5 ) % 16 );
+    const long x = index[0] - 20;
+    const long y = index[1] - 12;
+    const long z = index[2] - 9;
+    mit.Set( x * x + y * y + z * z < 64 ? 1 : 0 );
+    }
+
+  itk::Neighborhood< unsigned char, Dimension > hood;
+  hood.SetRadius(1);
+  OffsetVector::Pointer offsets = OffsetVector::New();
+  for ( unsigned int d = 0; d < hood.GetCenterNeighborhoodIndex(); d++ )
+    {
+    offsets->push_back( hood.GetOffset(d) );
+    }
+
+  for ( unsigned int m = 0; m < 2; m++ )
+    {
+    const ImageType *maskImage = m == 0 ? NULL : mask.GetPointer();
+
+    // the matrix of each offset alone, and their sum
+    std::vector< FilterType::Pointer > expected;
+    for ( unsigned int k = 0; k < offsets->size(); k++ )
+      {
+      FilterType::Pointer filter = CreateFilter(image, maskImage);
+      filter->SetOffset( offsets->ElementAt(k) );
+      filter->SetNumberOfThreads(1);
+      filter->Update();
+      expected.push_back(filter);
+      }
+    FilterType::Pointer sum = CreateFilter(image, maskImage);
+    sum->SetOffsets(offsets);
+    sum->SetNumberOfThreads(1);
+    sum->Update();
+    for ( HistogramType::InstanceIdentifier id = 0; id < sum->GetOutput()->Size(); id++ )
+      {
+      HistogramType::AbsoluteFrequencyType frequency = 0;
+      for ( unsigned int k = 0; k < offsets->size(); k++ )
+        {
+        frequency += expected[k]->GetOutput()->GetFrequency(id);
+        }
+      if ( frequency != sum->GetOutput()->GetFrequency(id) )
+        {
+        std::cerr << "The matrix of all the offsets is not the sum of the matrices of each offset"
+                  << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+
+    const itk::ThreadIdType threads[] = { 1, 2, 4, 7 };
+    for ( unsigned int t = 0; t < sizeof( threads ) / sizeof( threads[0] ); t++ )
+      {
+      FilterType::Pointer filter = CreateFilter(image, maskImage);
+      filter->SetOffsets(offsets);
+      filter->ComputeOffsetHistogramsOn();
+      filter->SetNumberOfThreads(threads[t]);
+      filter->Update();
+
+      std::ostringstream description;
+      description << ( maskImage ? "With" : "Without" ) << " mask, " << threads[t] << " threads";
+      if ( !CheckHistogram(description.str(), filter->GetOutput(), sum->GetOutput()) )
+        {
+        return EXIT_FAILURE;
+        }
+      for ( unsigned int k = 0; k < offsets->size(); k++ )
+        {
+        std::ostringstream offsetDescription;
+        offsetDescription << description.str() << ", offset " << offsets->ElementAt(k);
+        if ( !CheckHistogram(offsetDescription.str(), filter->GetOffsetHistogram(k),
+                             expected[k]->GetOutput()) )
+          {
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+  std::cout << "Test succeeded" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -214,6 +214,20 @@ public:
   itkGetConstReferenceMacro(UseExplicitPDFDerivatives, bool);
   itkBooleanMacro(UseExplicitPDFDerivatives);
 
+  /** With UseExplicitPDFDerivatives on and a BSplineTransform, keep in each
+   * thread only the PDF derivatives of the parameters that its samples
+   * touch. The samples are ordered along the last axis, so that the samples
+   * of a thread lie in one slab of the image and touch the parameters of the
+   * control points of that slab only. The derivatives are stored in blocks
+   * of parameters that are allocated on first use, and the metric
+   * derivative is accumulated from the blocks of every thread. The memory
+   * then grows with the number of parameters, not with the number of
+   * parameters times the number of threads. It has no effect with other
+   * transforms, which keep the dense PDF derivatives. */
+  itkSetMacro(UseSparsePDFDerivatives, bool);
+  itkGetConstReferenceMacro(UseSparsePDFDerivatives, bool);
+  itkBooleanMacro(UseSparsePDFDerivatives);
+
   /** The marginal PDFs are stored as std::vector. */
   typedef float PDFValueType;
 
@@ -302,6 +316,51 @@ private:
                                      double cubicBSplineDerivativeValue
                                      ) const;
 
+  /** The PDF derivatives of the parameters touched by one thread, in
+   * blocks of m_SparsePDFDerivativesBlockSize parameters. A block is empty
+   * until a sample of the thread touches one of its parameters, and is
+   * laid out as the dense PDF derivatives: [fixed bin][moving bin][parameter
+   * in the block]. */
+  typedef std::vector< JointPDFDerivativesValueType > PDFDerivativesBlockType;
+  struct SparsePDFDerivativesType {
+    std::vector< PDFDerivativesBlockType > Blocks;
+    std::vector< SizeValueType >           TouchedBlocks;
+  };
+
+  /** Orders the samples along the last axis first. */
+  struct FixedImageSampleSlabCompare {
+    bool operator()(const typename FixedImageSampleContainer::value_type & a,
+                    const typename FixedImageSampleContainer::value_type & b) const
+    {
+      for ( int d = static_cast< int >( a.point.Size() ) - 1; d >= 0; d-- )
+        {
+        if ( a.point[d] != b.point[d] )
+          {
+          return a.point[d] < b.point[d];
+          }
+        }
+      return false;
+    }
+  };
+
+  /** Parameters passed to the threads that accumulate the sparse PDF
+   * derivatives into the metric derivative. */
+  struct SparsePDFDerivativesReduceParameterType {
+    const Self *    metric;
+    DerivativeType *derivative;
+  };
+
+  /** Accumulate into the derivative the blocks whose number modulo the
+   * number of threads is threadID, from the PDF derivatives of every
+   * thread. */
+  void ReduceSparsePDFDerivatives(ThreadIdType threadID, DerivativeType & derivative) const;
+
+  static ITK_THREAD_RETURN_TYPE SparsePDFDerivativesReduceThreaderCallback(void *arg);
+
+  mutable std::vector< SparsePDFDerivativesType > m_ThreaderSparsePDFDerivatives;
+
+  SizeValueType m_SparsePDFDerivativesBlockSize;
+
   PDFValueType *m_ThreaderFixedImageMarginalPDF;
 
   typename JointPDFType::Pointer              * m_ThreaderJointPDF;
@@ -315,6 +374,9 @@ private:
   mutable double m_JointPDFSum;
 
   bool         m_UseExplicitPDFDerivatives;
+  bool         m_UseSparsePDFDerivatives;
+  /** UseSparsePDFDerivatives applies to the current transform. */
+  bool         m_AccumulateSparsePDFDerivatives;
   mutable bool m_ImplicitDerivativesSecondPass;
 
   virtual inline void GetValueThreadPreProcess(unsigned int threadID,
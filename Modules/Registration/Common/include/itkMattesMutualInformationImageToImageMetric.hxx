@@ -28,6 +28,8 @@
 #include "vnl/vnl_vector.h"
 #include "vnl/vnl_c_vector.h"
 
+#include <algorithm>
+
 namespace itk
 {
 /**
@@ -63,6 +65,8 @@ MattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage>
   m_CubicBSplineDerivativeKernel(NULL),
 
   // For multi-threading the metric
+  m_ThreaderSparsePDFDerivatives(),
+  m_SparsePDFDerivativesBlockSize(8),
   m_ThreaderFixedImageMarginalPDF(NULL),
   m_ThreaderJointPDF(NULL),
   m_ThreaderJointPDFDerivatives(NULL),
@@ -72,6 +76,8 @@ MattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage>
   m_JointPDFSum(0.0),
 
   m_UseExplicitPDFDerivatives(true),
+  m_UseSparsePDFDerivatives(false),
+  m_AccumulateSparsePDFDerivatives(false),
   m_ImplicitDerivativesSecondPass(false)
 {
   this->SetComputeGradient(false); // don't use the default gradient for now
@@ -165,6 +171,8 @@ MattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage>
   os << this->m_MovingImageBinSize << std::endl;
   os << indent << "UseExplicitPDFDerivatives: ";
   os << this->m_UseExplicitPDFDerivatives << std::endl;
+  os << indent << "UseSparsePDFDerivatives: ";
+  os << this->m_UseSparsePDFDerivatives << std::endl;
   os << indent << "ImplicitDerivativesSecondPass: ";
   os << this->m_ImplicitDerivativesSecondPass << std::endl;
   if( this->m_JointPDF.IsNotNull() )
@@ -190,6 +198,21 @@ throw ( ExceptionObject )
 {
   this->Superclass::Initialize();
   this->Superclass::MultiThreadingInitialize();
+
+  this->m_AccumulateSparsePDFDerivatives = this->m_UseExplicitPDFDerivatives
+                                           && this->m_UseSparsePDFDerivatives
+                                           && this->m_TransformIsBSpline;
+  if( this->m_AccumulateSparsePDFDerivatives )
+    {
+    // Give each thread the samples of one slab of the image, and recompute
+    // the cached B-spline weights in the new order.
+    std::sort(this->m_FixedImageSamples.begin(), this->m_FixedImageSamples.end(),
+              FixedImageSampleSlabCompare() );
+    if( this->m_UseCachingOfBSplineWeights )
+      {
+      this->PreComputeTransformValues();
+      }
+    }
     {
     /**
      * Compute the minimum and maximum within the specified mask
@@ -311,7 +334,7 @@ throw ( ExceptionObject )
   //
   // Now allocate memory according to the user-selected method.
   //
-  if( this->m_UseExplicitPDFDerivatives )
+  if( this->m_UseExplicitPDFDerivatives && !this->m_AccumulateSparsePDFDerivatives )
     {
     // Deallocate the memory that may have been allocated for
     // previous runs of the metric.
@@ -346,6 +369,14 @@ throw ( ExceptionObject )
       * jointPDFDerivativesSize[2]
       * sizeof( JointPDFDerivativesValueType );
     }
+  else if( this->m_AccumulateSparsePDFDerivatives )
+    {
+    // The PDF derivatives are kept by the threads; the pRatios weigh them
+    // when they are accumulated into the metric derivative.
+    this->m_JointPDFDerivatives = NULL;
+    this->m_PRatioArray.SetSize(this->m_NumberOfHistogramBins, this->m_NumberOfHistogramBins);
+    this->m_MetricDerivative = DerivativeType(1);
+    }
   else
     {
     // Deallocate the memory that may have been allocated for
@@ -464,7 +495,19 @@ throw ( ExceptionObject )
     }
   m_ThreaderMetricDerivative = NULL;
 
-  if( this->m_UseExplicitPDFDerivatives )
+  this->m_ThreaderSparsePDFDerivatives.clear();
+
+  if( this->m_AccumulateSparsePDFDerivatives )
+    {
+    const SizeValueType numberOfBlocks =
+      ( this->m_NumberOfParameters + m_SparsePDFDerivativesBlockSize - 1 ) / m_SparsePDFDerivativesBlockSize;
+    this->m_ThreaderSparsePDFDerivatives.resize(this->m_NumberOfThreads);
+    for( ThreadIdType threadID = 0; threadID < this->m_NumberOfThreads; threadID++ )
+      {
+      this->m_ThreaderSparsePDFDerivatives[threadID].Blocks.resize(numberOfBlocks);
+      }
+    }
+  else if( this->m_UseExplicitPDFDerivatives )
     {
     m_ThreaderJointPDFDerivatives = new typename
       JointPDFDerivativesType::Pointer[this->m_NumberOfThreads - 1];
@@ -810,7 +853,7 @@ MattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage>
             0,
             m_NumberOfHistogramBins * sizeof( PDFValueType ) );
 
-    if( this->m_UseExplicitPDFDerivatives )
+    if( this->m_UseExplicitPDFDerivatives && !this->m_AccumulateSparsePDFDerivatives )
       {
       memset(m_ThreaderJointPDFDerivatives[threadID - 1]->GetBufferPointer(),
              0,
@@ -826,13 +869,26 @@ MattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage>
             0,
             m_NumberOfHistogramBins * sizeof( PDFValueType ) );
 
-    if( this->m_UseExplicitPDFDerivatives )
+    if( this->m_UseExplicitPDFDerivatives && !this->m_AccumulateSparsePDFDerivatives )
       {
       memset(m_JointPDFDerivatives->GetBufferPointer(),
              0,
              m_JointPDFDerivativesBufferSize);
       }
     }
+
+  if( this->m_AccumulateSparsePDFDerivatives )
+    {
+    // The blocks touched in the previous iterations are kept, since the
+    // samples of the thread touch mostly the same parameters again.
+    SparsePDFDerivativesType & sparse = this->m_ThreaderSparsePDFDerivatives[threadID];
+    for( typename std::vector<SizeValueType>::const_iterator it = sparse.TouchedBlocks.begin();
+         it != sparse.TouchedBlocks.end(); ++it )
+      {
+      PDFDerivativesBlockType & block = sparse.Blocks[*it];
+      std::fill(block.begin(), block.end(), NumericTraits<JointPDFDerivativesValueType>::Zero);
+      }
+    }
 }
 
 template <class TFixedImage, class TMovingImage>
@@ -969,7 +1025,7 @@ MattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage>
 {
   this->GetValueThreadPostProcess(threadID, withinSampleThread);
 
-  if( this->m_UseExplicitPDFDerivatives )
+  if( this->m_UseExplicitPDFDerivatives && !this->m_AccumulateSparsePDFDerivatives )
     {
     const unsigned int rowSize = this->m_NumberOfParameters * m_NumberOfHistogramBins;
 
@@ -1029,6 +1085,10 @@ MattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage>
     memset( derivative.data_block(),
             0,
             this->m_NumberOfParameters * sizeof( double ) );
+    if( this->m_AccumulateSparsePDFDerivatives )
+      {
+      this->m_PRatioArray.Fill(0.0);
+      }
     }
   else
     {
@@ -1131,7 +1191,7 @@ MattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage>
           sum += jointPDFValue * ( pRatio - vcl_log(fixedImagePDFValue) );
           }
 
-        if( this->m_UseExplicitPDFDerivatives )
+        if( this->m_UseExplicitPDFDerivatives && !this->m_AccumulateSparsePDFDerivatives )
           {
           // move joint pdf derivative pointer to the right position
           JointPDFValueType const * derivPtr = m_JointPDFDerivatives->GetBufferPointer()
@@ -1151,7 +1211,17 @@ MattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage>
       }   // end for-loop over moving index
     }     // end for-loop over fixed index
 
-  if( !( this->m_UseExplicitPDFDerivatives ) )
+  if( this->m_AccumulateSparsePDFDerivatives )
+    {
+    // Weigh the PDF derivatives of every thread by the pRatios; each thread
+    // accumulates its own share of the parameter blocks.
+    SparsePDFDerivativesReduceParameterType reduceParameter;
+    reduceParameter.metric = this;
+    reduceParameter.derivative = &derivative;
+    this->m_Threader->SetSingleMethod(SparsePDFDerivativesReduceThreaderCallback, &reduceParameter);
+    this->m_Threader->SingleMethodExecute();
+    }
+  else if( !( this->m_UseExplicitPDFDerivatives ) )
     {
     // Second pass: This one is done for accumulating the contributions
     //              to the derivative array.
@@ -1217,7 +1287,12 @@ MattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage>
 
   DerivativeType *derivativeHelperArray = NULL;
 
-  if( this->m_UseExplicitPDFDerivatives )
+  if( this->m_AccumulateSparsePDFDerivatives )
+    {
+    // Only the BSplineTransform accumulates sparse PDF derivatives.
+    derivPtr = 0;
+    }
+  else if( this->m_UseExplicitPDFDerivatives )
     {
     if( threadID > 0 )
       {
@@ -1335,6 +1410,15 @@ MattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage>
         this->m_FixedImageSamples[sampleNumber].point,
         *weightsHelper, *indicesHelper);
       }
+    SparsePDFDerivativesType *sparse = NULL;
+    SizeValueType             sparseBinOffset = 0;
+    if( this->m_AccumulateSparsePDFDerivatives )
+      {
+      sparse = &( this->m_ThreaderSparsePDFDerivatives[threadID] );
+      sparseBinOffset = ( pdfFixedIndex * m_NumberOfHistogramBins + pdfMovingIndex )
+        * m_SparsePDFDerivativesBlockSize;
+      }
+
     for( unsigned int dim = 0; dim < Superclass::FixedImageDimension; dim++ )
       {
       for( unsigned int mu = 0; mu < this->m_NumBSplineWeights; mu++ )
@@ -1358,7 +1442,19 @@ MattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage>
 
         const double derivativeContribution = innerProduct * cubicBSplineDerivativeValue;
 
-        if( this->m_UseExplicitPDFDerivatives )
+        if( sparse )
+          {
+          const SizeValueType       blockNumber = parameterIndex / m_SparsePDFDerivativesBlockSize;
+          PDFDerivativesBlockType & block = sparse->Blocks[blockNumber];
+          if( block.empty() )
+            {
+            block.resize(m_NumberOfHistogramBins * m_NumberOfHistogramBins * m_SparsePDFDerivativesBlockSize,
+                         NumericTraits<JointPDFDerivativesValueType>::Zero);
+            sparse->TouchedBlocks.push_back(blockNumber);
+            }
+          block[sparseBinOffset + parameterIndex % m_SparsePDFDerivativesBlockSize] -= derivativeContribution;
+          }
+        else if( this->m_UseExplicitPDFDerivatives )
           {
           JointPDFValueType * const ptr = derivPtr + parameterIndex;
           *( ptr ) -= derivativeContribution;
@@ -1372,6 +1468,63 @@ MattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage>
     }     // end if-block transform is BSpline
 }
 
+template <class TFixedImage, class TMovingImage>
+void
+MattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage>
+::ReduceSparsePDFDerivatives(ThreadIdType threadID, DerivativeType & derivative) const
+{
+  const SizeValueType numberOfBins = m_NumberOfHistogramBins * m_NumberOfHistogramBins;
+  const PRatioType *  pRatios = this->m_PRatioArray.data_block();
+
+  for( ThreadIdType t = 0; t < this->m_NumberOfThreads; t++ )
+    {
+    const SparsePDFDerivativesType & sparse = this->m_ThreaderSparsePDFDerivatives[t];
+    for( typename std::vector<SizeValueType>::const_iterator it = sparse.TouchedBlocks.begin();
+         it != sparse.TouchedBlocks.end(); ++it )
+      {
+      if( *it % this->m_NumberOfThreads != threadID )
+        {
+        continue;
+        }
+      const SizeValueType firstParameter = *it * m_SparsePDFDerivativesBlockSize;
+      const SizeValueType numberOfBlockParameters =
+        vnl_math_min(m_SparsePDFDerivativesBlockSize,
+                     static_cast<SizeValueType>( this->m_NumberOfParameters ) - firstParameter);
+      double * const derivativeBlock = derivative.data_block() + firstParameter;
+
+      JointPDFDerivativesValueType const * derivPtr = &( sparse.Blocks[*it][0] );
+      for( SizeValueType bin = 0; bin < numberOfBins; ++bin, derivPtr += m_SparsePDFDerivativesBlockSize )
+        {
+        // The pRatio already includes the normalization of the derivatives.
+        const double pRatio = pRatios[bin];
+        if( pRatio != 0.0 )
+          {
+          for( SizeValueType parameter = 0; parameter < numberOfBlockParameters; ++parameter )
+            {
+            // Ref: eqn 23 of Thevenaz & Unser paper [3]
+            derivativeBlock[parameter] -= derivPtr[parameter] * pRatio;
+            }
+          }
+        }
+      }
+    }
+}
+
+template <class TFixedImage, class TMovingImage>
+ITK_THREAD_RETURN_TYPE
+MattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage>
+::SparsePDFDerivativesReduceThreaderCallback(void *arg)
+{
+  const ThreadIdType threadID = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+
+  SparsePDFDerivativesReduceParameterType *parameter = (SparsePDFDerivativesReduceParameterType *)
+    ( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  parameter->metric->ReduceSparsePDFDerivatives(threadID, *( parameter->derivative ) );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 } // end namespace itk
 
 #endif
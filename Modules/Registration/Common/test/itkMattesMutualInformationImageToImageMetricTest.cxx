@@ -45,7 +45,8 @@
 template< class TImage, class TInterpolator>
 int TestMattesMetricWithAffineTransform(
   TInterpolator * interpolator, bool useSampling,
-  bool useExplicitJointPDFDerivatives, bool useCachingBSplineWeights )
+  bool useExplicitJointPDFDerivatives, bool useCachingBSplineWeights,
+  bool useSparsePDFDerivatives )
 {
 
 //------------------------------------------------------------
@@ -210,6 +211,7 @@ int TestMattesMetricWithAffineTransform(
 
   metric->SetUseExplicitPDFDerivatives( useExplicitJointPDFDerivatives );
   metric->SetUseCachingOfBSplineWeights( useCachingBSplineWeights );
+  metric->SetUseSparsePDFDerivatives( useSparsePDFDerivatives );
 
   if( useSampling )
     {
@@ -403,7 +405,8 @@ int TestMattesMetricWithAffineTransform(
 template< class TImage, class TInterpolator>
 int TestMattesMetricWithBSplineTransform(
   TInterpolator * interpolator, bool useSampling,
-  bool useExplicitJointPDFDerivatives, bool useCachingBSplineWeights )
+  bool useExplicitJointPDFDerivatives, bool useCachingBSplineWeights,
+  bool useSparsePDFDerivatives )
 {
 
 //------------------------------------------------------------
@@ -540,6 +543,7 @@ int TestMattesMetricWithBSplineTransform(
 
   metric->SetUseExplicitPDFDerivatives( useExplicitJointPDFDerivatives );
   metric->SetUseCachingOfBSplineWeights( useCachingBSplineWeights );
+  metric->SetUseSparsePDFDerivatives( useSparsePDFDerivatives );
 
   if( useSampling )
     {
@@ -682,6 +686,12 @@ int itkMattesMutualInformationImageToImageMetricTest(int argc, char * argv [] )
     useCachingBSplineWeights = atoi( argv[2] );
     }
 
+  bool useSparsePDFDerivatives = false;
+  if( argc > 3 )
+    {
+    useSparsePDFDerivatives = atoi( argv[3] );
+    }
+
   int failed;
   typedef itk::Image<unsigned char,2> ImageType;
 
@@ -698,7 +708,8 @@ int itkMattesMutualInformationImageToImageMetricTest(int argc, char * argv [] )
     = LinearInterpolatorType::New();
 
   failed = TestMattesMetricWithAffineTransform<ImageType,LinearInterpolatorType>(
-    linearInterpolator, useSampling, useExplicitJointPDFDerivatives, useCachingBSplineWeights );
+    linearInterpolator, useSampling, useExplicitJointPDFDerivatives, useCachingBSplineWeights,
+    useSparsePDFDerivatives );
 
   if ( failed )
     {
@@ -708,7 +719,8 @@ int itkMattesMutualInformationImageToImageMetricTest(int argc, char * argv [] )
 
   useSampling = false;
   failed = TestMattesMetricWithAffineTransform<ImageType,LinearInterpolatorType>(
-    linearInterpolator, useSampling, useExplicitJointPDFDerivatives, useCachingBSplineWeights );
+    linearInterpolator, useSampling, useExplicitJointPDFDerivatives, useCachingBSplineWeights,
+    useSparsePDFDerivatives );
 
   if ( failed )
     {
@@ -728,7 +740,8 @@ int itkMattesMutualInformationImageToImageMetricTest(int argc, char * argv [] )
 
   useSampling = true;
   failed = TestMattesMetricWithAffineTransform<ImageType,BSplineInterpolatorType>(
-    bSplineInterpolator, useSampling, useExplicitJointPDFDerivatives, useCachingBSplineWeights );
+    bSplineInterpolator, useSampling, useExplicitJointPDFDerivatives, useCachingBSplineWeights,
+    useSparsePDFDerivatives );
 
   if ( failed )
     {
@@ -738,7 +751,8 @@ int itkMattesMutualInformationImageToImageMetricTest(int argc, char * argv [] )
 
   useSampling = false;
   failed = TestMattesMetricWithAffineTransform<ImageType,BSplineInterpolatorType>(
-    bSplineInterpolator, useSampling, useExplicitJointPDFDerivatives, useCachingBSplineWeights );
+    bSplineInterpolator, useSampling, useExplicitJointPDFDerivatives, useCachingBSplineWeights,
+    useSparsePDFDerivatives );
 
   if ( failed )
     {
@@ -751,7 +765,8 @@ int itkMattesMutualInformationImageToImageMetricTest(int argc, char * argv [] )
   useSampling = true;
   failed = TestMattesMetricWithBSplineTransform<
     ImageType,BSplineInterpolatorType>( bSplineInterpolator, useSampling,
-        useExplicitJointPDFDerivatives, useCachingBSplineWeights );
+        useExplicitJointPDFDerivatives, useCachingBSplineWeights,
+    useSparsePDFDerivatives );
 
   if ( failed )
     {
@@ -26,6 +26,7 @@
 #include "itkResampleImageFilter.h"
 #include "itkImageToImageFilter.h"
 #include "itkGradientRecursiveGaussianImageFilter.h"
+#include "itkBSplineTransform.h"
 
 namespace itk
 {
@@ -101,6 +102,20 @@ class ImageToData;
  *
  * Image masks are supported using SetMovingImageMask or SetFixedImageMask.
  *
+ * B-spline weights caching:
+ * When the moving transform is a cubic BSplineTransform, the interpolation
+ * weights and the indices of the coefficients in the support of each point
+ * of the virtual domain only depend on the virtual domain and on the grid
+ * of the transform, which do not change while it is optimized. With
+ * \c UseCachingOfBSplineWeights set (the default), they are computed once
+ * and reused at every iteration to map the points into the moving space and
+ * to fill the Jacobian of the moving transform at each point, clearing only
+ * the columns of the support of the previous point. The cache is rebuilt
+ * when the grid or the virtual domain change. It takes
+ * \c GetNumberOfAffectedWeights() weights and indices per virtual point, and
+ * is not built when that is more than \c MaximumBSplineWeightsCacheSize
+ * bytes; the weights are then recomputed for every point as usual.
+ *
  * Random sampling or user-supplied point lists are not yet supported, except
  * via an image mask. If the mask is sparse, the
  * SetPreWarp[Fixed|Moving]Image and Use[Fixed|Moving]ImageGradientFilter
@@ -449,6 +464,21 @@ public:
   itkGetConstReferenceMacro(DoMovingImagePreWarp, bool);
   itkBooleanMacro(DoMovingImagePreWarp);
 
+  /** Set/Get caching of the B-spline weights and support indices of each
+   * virtual point, when the moving transform is a cubic BSplineTransform. */
+  itkSetMacro(UseCachingOfBSplineWeights, bool);
+  itkGetConstReferenceMacro(UseCachingOfBSplineWeights, bool);
+  itkBooleanMacro(UseCachingOfBSplineWeights);
+
+  /** Set/Get the largest size in bytes of the B-spline weights cache.
+   * Above it, the weights are recomputed for every point. */
+  itkSetMacro(MaximumBSplineWeightsCacheSize, SizeValueType);
+  itkGetConstMacro(MaximumBSplineWeightsCacheSize, SizeValueType);
+
+  /** Get whether the B-spline weights were taken from the cache during the
+   * most recent evaluation. */
+  itkGetConstMacro(BSplineWeightsAreCached, bool);
+
   /** Get pre-warped images */
   itkGetConstObjectMacro( MovingWarpedImage, MovingImageType );
   itkGetConstObjectMacro( FixedWarpedImage, FixedImageType );
@@ -553,7 +583,10 @@ protected:
    *   \param metricValueReturn, and
    *   \param localDerivativeReturn
    * \param threadID may be used as needed, for example to access any per-thread
-   * data cached during pre-processing by the derived class.
+   * data cached during pre-processing by the derived class. When the moving
+   * transform does not have local support,
+   * \c m_MovingTransformJacobianPerThread[threadID] holds its Jacobian at
+   * \c virtualPoint, see \c ComputeMovingTransformJacobian.
    * \warning The derived class should use \c GetNumberOfThreads from this base
    * class only after ImageToImageObjectMetric:: Initialize has been called, to
    * assure that the same number of threads are used.
@@ -609,6 +642,19 @@ protected:
                            MovingImageGradientType & mappedMovingImageGradient,
                            bool & pointIsValid ) const;
 
+  /** Compute the Jacobian of the moving transform with respect to its
+   * parameters at a point of the virtual domain, into
+   * \c m_MovingTransformJacobianPerThread[threadID]. The cached B-spline
+   * weights are used when they are available. For a transform without
+   * local support, this is called before \c GetValueAndDerivativeProcessPoint
+   * for each valid point, which thus finds the Jacobian at the point there.
+   * \warning This is called from the threader, and thus must be thread-safe.
+   */
+  virtual void ComputeMovingTransformJacobian(
+                                    const VirtualIndexType & virtualIndex,
+                                    const VirtualPointType & virtualPoint,
+                                    const ThreadIdType threadID ) const;
+
   /** Compute image derivatives at a point. */
   virtual void ComputeFixedImageGradientAtPoint(
                                     const FixedImagePointType & mappedPoint,
@@ -787,6 +833,24 @@ protected:
    * classes for efficiency. */
   mutable std::vector<JacobianType>                  m_MovingTransformJacobianPerThread;
 
+  /** What the Jacobian of each thread holds besides zeros, when it was
+   * written from the B-spline weights cache: the columns of the support of
+   * the point at this offset of the cache, or one of these values. */
+  enum { BSplineJacobianIsZero = -1, BSplineJacobianIsUnknown = -2 };
+  mutable std::vector<OffsetValueType>               m_BSplineJacobianSupportPerThread;
+
+  /** Type of the moving transforms whose weights can be cached. */
+  typedef BSplineTransform< CoordinateRepresentationType,
+                            itkGetStaticConstMacro( VirtualImageDimension ),
+                            3 >                      MovingBSplineTransformType;
+  typedef typename MovingBSplineTransformType::WeightsType
+                                                     BSplineWeightsType;
+  typedef typename BSplineWeightsType::ValueType     BSplineWeightsValueType;
+  typedef typename MovingBSplineTransformType::ParameterIndexArrayType
+                                                     BSplineParametersIndexArrayType;
+  typedef typename BSplineParametersIndexArrayType::ValueType
+                                                     BSplineParametersIndexType;
+
   ImageToImageObjectMetric();
   virtual ~ImageToImageObjectMetric();
 
@@ -814,6 +878,35 @@ private:
   void DoFixedImagePreWarp( void ) const;
   void DoMovingImagePreWarp( void ) const;
 
+  /** Build the B-spline weights cache if it is enabled, fits in the memory
+   * budget and is out of date, and set \c m_BSplineWeightsAreCached. */
+  void UpdateBSplineWeightsCache( void ) const;
+
+  /** Offset of a virtual index in the B-spline weights cache. Returns false
+   * if the cache is not in use or the index is outside of the virtual
+   * domain. */
+  bool GetBSplineWeightsCacheOffset( const VirtualIndexType & index,
+                                     OffsetValueType & offset ) const;
+
+  /** B-spline weights caching. The weights and the parameter indices of
+   * the support of the point at offset \c o of the virtual domain start at
+   * \c o * m_BSplineNumberOfWeights. */
+  bool                                            m_UseCachingOfBSplineWeights;
+  SizeValueType                                   m_MaximumBSplineWeightsCacheSize;
+  mutable bool                                    m_BSplineWeightsAreCached;
+  mutable SizeValueType                           m_BSplineNumberOfWeights;
+  mutable NumberOfParametersType                  m_BSplineNumberOfParametersPerDimension;
+  mutable std::vector<BSplineWeightsValueType>    m_BSplineWeightsCache;
+  mutable std::vector<BSplineParametersIndexType> m_BSplineIndicesCache;
+  mutable std::vector<bool>                       m_BSplineInsideCache;
+
+  /** What the cache was computed for, to detect when it is out of date. */
+  mutable const MovingBSplineTransformType *      m_BSplineCacheTransform;
+  mutable ParametersType                          m_BSplineCacheFixedParameters;
+  mutable const VirtualImageType *                m_BSplineCacheVirtualImage;
+  mutable unsigned long                           m_BSplineCacheVirtualImageMTime;
+  mutable VirtualRegionType                       m_BSplineCacheVirtualRegion;
+
   /** Flag to track if threading memory has been initialized since last
    * call to Initialize. */
   mutable bool            m_ThreadingMemoryHasBeenInitialized;
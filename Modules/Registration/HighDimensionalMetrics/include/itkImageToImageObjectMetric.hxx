@@ -93,6 +93,16 @@ ImageToImageObjectMetric<TFixedImage, TMovingImage, TVirtualImage >
   this->m_UseFixedImageGradientFilter = true;
   this->m_UseMovingImageGradientFilter = true;
 
+  /* Cache the B-spline weights, up to 512 MB */
+  this->m_UseCachingOfBSplineWeights = true;
+  this->m_MaximumBSplineWeightsCacheSize = 512 * 1024 * 1024;
+  this->m_BSplineWeightsAreCached = false;
+  this->m_BSplineNumberOfWeights = 0;
+  this->m_BSplineNumberOfParametersPerDimension = 0;
+  this->m_BSplineCacheTransform = NULL;
+  this->m_BSplineCacheVirtualImage = NULL;
+  this->m_BSplineCacheVirtualImageMTime = 0;
+
   this->m_NumberOfThreadsHasBeenInitialized = false;
 }
 
@@ -355,6 +365,7 @@ ImageToImageObjectMetric<TFixedImage, TMovingImage, TVirtualImage >
   this->m_LocalDerivativesPerThread.resize( this->GetNumberOfThreads() );
   /* Per-thread pre-allocated Jacobian objects for efficiency */
   this->m_MovingTransformJacobianPerThread.resize( this->GetNumberOfThreads() );
+  this->m_BSplineJacobianSupportPerThread.resize( this->GetNumberOfThreads() );
 
   /* This size always comes from the moving image */
   NumberOfParametersType globalDerivativeSize =
@@ -413,6 +424,9 @@ ImageToImageObjectMetric<TFixedImage, TMovingImage, TVirtualImage >
     {
     this->m_NumberOfValidPointsPerThread[i] = 0;
     this->m_MeasurePerThread[i] = 0;
+    /* The B-spline weights cache may have been rebuilt since the Jacobian
+     * was last written. */
+    this->m_BSplineJacobianSupportPerThread[i] = BSplineJacobianIsUnknown;
     if ( ! this->m_MovingTransform->HasLocalSupport() )
       {
       /* Be sure to init to 0 here, because the threader may not use
@@ -440,6 +454,10 @@ ImageToImageObjectMetric<TFixedImage, TMovingImage, TVirtualImage >
       this->ComputeMovingImageGradientFilterImage();
       }
     }
+
+  /* The B-spline weights only need be computed again if the grid of
+   * the transform or the virtual domain have changed. */
+  this->UpdateBSplineWeightsCache();
 }
 
 /*
@@ -594,6 +612,13 @@ ImageToImageObjectMetric<TFixedImage, TMovingImage, TVirtualImage >
      * calculations for value and derivative. */
     try
       {
+      /* The derivative with respect to the parameters of a global
+       * transform needs its Jacobian at the point. */
+      if( ! self->m_MovingTransform->HasLocalSupport() )
+        {
+        self->ComputeMovingTransformJacobian( ItV.GetIndex(), virtualPoint,
+                                              threadID );
+        }
       pointIsValid = self->GetValueAndDerivativeProcessPoint(
                                      virtualPoint,
                                      mappedFixedPoint, mappedFixedPixelValue,
@@ -761,8 +786,39 @@ ImageToImageObjectMetric<TFixedImage, TMovingImage, TVirtualImage >
   pointIsValid = true;
   mappedMovingPixelValue = NumericTraits<MovingImagePixelType>::Zero;
 
-  // map the point into moving space
-  mappedMovingPoint = this->m_MovingTransform->TransformPoint( virtualPoint );
+  // map the point into moving space, with the cached B-spline weights
+  // if there are some for this point
+  OffsetValueType cacheOffset;
+  if( this->GetBSplineWeightsCacheOffset( index, cacheOffset ) )
+    {
+    mappedMovingPoint.Fill( NumericTraits<CoordinateRepresentationType>::Zero );
+    if( this->m_BSplineInsideCache[cacheOffset] )
+      {
+      const ParametersValueType * parameters =
+        this->m_MovingTransform->GetParameters().data_block();
+      const SizeValueType start = cacheOffset * this->m_BSplineNumberOfWeights;
+      for( SizeValueType k = start;
+           k < start + this->m_BSplineNumberOfWeights; k++ )
+        {
+        const BSplineWeightsValueType weight = this->m_BSplineWeightsCache[k];
+        const ParametersValueType * coefficients =
+                                  parameters + this->m_BSplineIndicesCache[k];
+        for( unsigned int d = 0; d < MovingImageDimension; d++ )
+          {
+          mappedMovingPoint[d] += static_cast<CoordinateRepresentationType>(
+            weight * coefficients[d * this->m_BSplineNumberOfParametersPerDimension] );
+          }
+        }
+      }
+    for( unsigned int d = 0; d < MovingImageDimension; d++ )
+      {
+      mappedMovingPoint[d] += virtualPoint[d];
+      }
+    }
+  else
+    {
+    mappedMovingPoint = this->m_MovingTransform->TransformPoint( virtualPoint );
+    }
 
   // check against the mask if one is assigned
   if ( this->m_MovingImageMask )
@@ -809,6 +865,186 @@ ImageToImageObjectMetric<TFixedImage, TMovingImage, TVirtualImage >
     }
 }
 
+/*
+ * Compute the moving transform Jacobian at a virtual point.
+ */
+template<class TFixedImage,class TMovingImage,class TVirtualImage>
+void
+ImageToImageObjectMetric<TFixedImage, TMovingImage, TVirtualImage >
+::ComputeMovingTransformJacobian( const VirtualIndexType & virtualIndex,
+                                  const VirtualPointType & virtualPoint,
+                                  const ThreadIdType threadID ) const
+{
+  JacobianType & jacobian = this->m_MovingTransformJacobianPerThread[threadID];
+  OffsetValueType & support = this->m_BSplineJacobianSupportPerThread[threadID];
+
+  OffsetValueType cacheOffset;
+  if( ! this->GetBSplineWeightsCacheOffset( virtualIndex, cacheOffset ) )
+    {
+    this->m_MovingTransform->ComputeJacobianWithRespectToParameters(
+                                                      virtualPoint, jacobian );
+    support = BSplineJacobianIsUnknown;
+    return;
+    }
+
+  /* The Jacobian keeps its size and its zeros from one point to the next:
+   * only the columns of the support of the previous point are cleared. */
+  const NumberOfParametersType numberOfParameters =
+                                   this->m_MovingTransform->GetNumberOfParameters();
+  if( support == BSplineJacobianIsUnknown
+      || jacobian.rows() != VirtualImageDimension
+      || jacobian.cols() != numberOfParameters )
+    {
+    jacobian.SetSize( VirtualImageDimension, numberOfParameters );
+    jacobian.Fill( 0.0 );
+    }
+  else if( support >= 0 )
+    {
+    const SizeValueType start = support * this->m_BSplineNumberOfWeights;
+    for( SizeValueType k = start;
+         k < start + this->m_BSplineNumberOfWeights; k++ )
+      {
+      for( unsigned int d = 0; d < VirtualImageDimension; d++ )
+        {
+        jacobian( d, this->m_BSplineIndicesCache[k]
+                     + d * this->m_BSplineNumberOfParametersPerDimension ) = 0.0;
+        }
+      }
+    }
+
+  support = BSplineJacobianIsZero;
+  if( this->m_BSplineInsideCache[cacheOffset] )
+    {
+    const SizeValueType start = cacheOffset * this->m_BSplineNumberOfWeights;
+    for( SizeValueType k = start;
+         k < start + this->m_BSplineNumberOfWeights; k++ )
+      {
+      for( unsigned int d = 0; d < VirtualImageDimension; d++ )
+        {
+        jacobian( d, this->m_BSplineIndicesCache[k]
+                     + d * this->m_BSplineNumberOfParametersPerDimension ) =
+          this->m_BSplineWeightsCache[k];
+        }
+      }
+    support = cacheOffset;
+    }
+}
+
+/*
+ * Offset of a virtual index in the B-spline weights cache.
+ */
+template<class TFixedImage,class TMovingImage,class TVirtualImage>
+bool
+ImageToImageObjectMetric<TFixedImage, TMovingImage, TVirtualImage >
+::GetBSplineWeightsCacheOffset( const VirtualIndexType & index,
+                                OffsetValueType & offset ) const
+{
+  if( ! this->m_BSplineWeightsAreCached
+      || ! this->m_BSplineCacheVirtualRegion.IsInside( index ) )
+    {
+    return false;
+    }
+  /* The cache covers the buffered region of the virtual image. */
+  offset = this->m_VirtualDomainImage->ComputeOffset( index );
+  return true;
+}
+
+/*
+ * Build the B-spline weights cache, if needed.
+ */
+template<class TFixedImage,class TMovingImage,class TVirtualImage>
+void
+ImageToImageObjectMetric<TFixedImage, TMovingImage, TVirtualImage >
+::UpdateBSplineWeightsCache() const
+{
+  this->m_BSplineWeightsAreCached = false;
+
+  const MovingBSplineTransformType * bspline =
+    dynamic_cast<const MovingBSplineTransformType *>(
+                                      this->m_MovingTransform.GetPointer() );
+  const VirtualRegionType region = this->GetVirtualDomainRegion();
+  SizeValueType numberOfWeights = 0;
+  if( this->m_UseCachingOfBSplineWeights && bspline != NULL
+      && bspline->GetCoefficientImages()[0]->GetBufferPointer() != NULL )
+    {
+    numberOfWeights = bspline->GetNumberOfAffectedWeights();
+    }
+
+  /* Size in bytes of the cache. Computed in floating point so that it
+   * cannot overflow. */
+  const double cacheSize =
+    static_cast<double>( region.GetNumberOfPixels() ) * numberOfWeights
+    * ( sizeof( BSplineWeightsValueType ) + sizeof( BSplineParametersIndexType ) );
+  if( numberOfWeights == 0
+      || cacheSize > static_cast<double>( this->m_MaximumBSplineWeightsCacheSize ) )
+    {
+    if( numberOfWeights != 0 )
+      {
+      itkDebugMacro("B-spline weights cache of " << cacheSize
+                    << " bytes is over MaximumBSplineWeightsCacheSize. "
+                    "Weights are recomputed for every point.");
+      }
+    /* Free memory if allocated from a previous run */
+    std::vector<BSplineWeightsValueType>().swap( this->m_BSplineWeightsCache );
+    std::vector<BSplineParametersIndexType>().swap( this->m_BSplineIndicesCache );
+    std::vector<bool>().swap( this->m_BSplineInsideCache );
+    this->m_BSplineCacheTransform = NULL;
+    return;
+    }
+
+  this->m_BSplineWeightsAreCached = true;
+  if( bspline == this->m_BSplineCacheTransform
+      && this->m_VirtualDomainImage.GetPointer() == this->m_BSplineCacheVirtualImage
+      && this->m_VirtualDomainImage->GetMTime() == this->m_BSplineCacheVirtualImageMTime
+      && region == this->m_BSplineCacheVirtualRegion
+      && bspline->GetFixedParameters() == this->m_BSplineCacheFixedParameters )
+    {
+    return;
+    }
+
+  itkDebugMacro("Building B-spline weights cache of " << cacheSize << " bytes");
+  const SizeValueType numberOfPoints = region.GetNumberOfPixels();
+  this->m_BSplineNumberOfWeights = numberOfWeights;
+  this->m_BSplineNumberOfParametersPerDimension =
+                                  bspline->GetNumberOfParametersPerDimension();
+  this->m_BSplineWeightsCache.resize( numberOfPoints * numberOfWeights );
+  this->m_BSplineIndicesCache.resize( numberOfPoints * numberOfWeights );
+  this->m_BSplineInsideCache.resize( numberOfPoints );
+
+  BSplineWeightsType              weights( numberOfWeights );
+  BSplineParametersIndexArrayType indices( numberOfWeights );
+  typename MovingBSplineTransformType::OutputPointType mappedPoint;
+  VirtualPointType                virtualPoint;
+  bool                            inside;
+
+  ImageRegionConstIteratorWithIndex<VirtualImageType>
+                                      ItV( this->m_VirtualDomainImage, region );
+  for( ItV.GoToBegin(); !ItV.IsAtEnd(); ++ItV )
+    {
+    this->m_VirtualDomainImage->TransformIndexToPhysicalPoint(
+                                              ItV.GetIndex(), virtualPoint );
+    bspline->TransformPoint( virtualPoint, mappedPoint, weights, indices,
+                             inside );
+
+    const OffsetValueType offset =
+                    this->m_VirtualDomainImage->ComputeOffset( ItV.GetIndex() );
+    this->m_BSplineInsideCache[offset] = inside;
+    if( inside )
+      {
+      std::copy( weights.begin(), weights.end(),
+                 this->m_BSplineWeightsCache.begin() + offset * numberOfWeights );
+      std::copy( indices.begin(), indices.end(),
+                 this->m_BSplineIndicesCache.begin() + offset * numberOfWeights );
+      }
+    }
+
+  this->m_BSplineCacheTransform = bspline;
+  this->m_BSplineCacheFixedParameters = bspline->GetFixedParameters();
+  this->m_BSplineCacheVirtualImage = this->m_VirtualDomainImage.GetPointer();
+  this->m_BSplineCacheVirtualImageMTime = this->m_VirtualDomainImage->GetMTime();
+  this->m_BSplineCacheVirtualRegion = region;
+}
+
 /*
  * Compute image derivatives for a Fixed point.
  * NOTE: This doesn't transform result into virtual space. For that,
@@ -1400,6 +1636,15 @@ ImageToImageObjectMetric<TFixedImage, TMovingImage, TVirtualImage >
                << "DoFixedImagePreWarp: " << this->GetDoFixedImagePreWarp()
                << std::endl
                << "DoMovingImagePreWarp: " << this->GetDoMovingImagePreWarp()
+               << std::endl
+               << "UseCachingOfBSplineWeights: "
+               << this->GetUseCachingOfBSplineWeights()
+               << std::endl
+               << "MaximumBSplineWeightsCacheSize: "
+               << this->GetMaximumBSplineWeightsCacheSize()
+               << std::endl
+               << "BSplineWeightsAreCached: "
+               << this->GetBSplineWeightsAreCached()
                << std::endl;
 
   if( this->m_NumberOfThreadsHasBeenInitialized )
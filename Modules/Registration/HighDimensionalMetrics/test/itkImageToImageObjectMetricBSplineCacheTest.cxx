@@ -0,0 +1,367 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkImage.h"
+#include "itkImageToImageObjectMetric.h"
+#include "itkBSplineTransform.h"
+#include "itkIdentityTransform.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTimeProbe.h"
+
+//We need this as long as we have to define ImageToData as a fwd-declare
+// in itkImageToImageObjectMetric.h
+#include "itkImageToData.h"
+
+/*
+ * This test checks that the B-spline weights cache of the metric gives the
+ * same transformed points and transform Jacobians as the transform itself,
+ * that it is rebuilt when the B-spline grid changes, and that the metric
+ * falls back to recomputing the weights when the cache is disabled or over
+ * its memory budget.
+ */
+
+namespace
+{
+
+/* A mean squares metric that uses the moving transform Jacobian, as
+ * computed by the base class. */
+template<class TImage>
+class ImageToImageObjectMetricBSplineCacheTestMetric
+  : public itk::ImageToImageObjectMetric<TImage, TImage, TImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef ImageToImageObjectMetricBSplineCacheTestMetric      Self;
+  typedef itk::ImageToImageObjectMetric<TImage, TImage, TImage>
+                                                              Superclass;
+  typedef itk::SmartPointer<Self>                             Pointer;
+  typedef itk::SmartPointer<const Self>                       ConstPointer;
+
+  itkNewMacro(Self);
+  itkTypeMacro(ImageToImageObjectMetricBSplineCacheTestMetric,
+               ImageToImageObjectMetric);
+
+  typedef typename Superclass::MeasureType              MeasureType;
+  typedef typename Superclass::DerivativeType           DerivativeType;
+  typedef typename Superclass::JacobianType             JacobianType;
+  typedef typename Superclass::VirtualPointType         VirtualPointType;
+  typedef typename Superclass::VirtualIndexType         VirtualIndexType;
+  typedef typename Superclass::FixedImagePointType      FixedImagePointType;
+  typedef typename Superclass::FixedImagePixelType      FixedImagePixelType;
+  typedef typename Superclass::FixedImageGradientType   FixedImageGradientType;
+  typedef typename Superclass::MovingImagePointType     MovingImagePointType;
+  typedef typename Superclass::MovingImagePixelType     MovingImagePixelType;
+  typedef typename Superclass::MovingImageGradientType  MovingImageGradientType;
+
+  bool GetValueAndDerivativeProcessPoint(
+                    const VirtualPointType &           virtualPoint,
+                    const FixedImagePointType &,
+                    const FixedImagePixelType &        fixedImageValue,
+                    const FixedImageGradientType &     fixedImageGradient,
+                    const MovingImagePointType &,
+                    const MovingImagePixelType &       movingImageValue,
+                    const MovingImageGradientType &,
+                    MeasureType &                      metricValueResult,
+                    DerivativeType &                   localDerivativeReturn,
+                    const itk::ThreadIdType            threadID ) const
+  {
+    const double diff = movingImageValue - fixedImageValue;
+    metricValueResult = diff * diff;
+
+    /* Computed at virtualPoint before this is called */
+    const JacobianType & jacobian =
+                            this->m_MovingTransformJacobianPerThread[threadID];
+    for ( unsigned int par = 0;
+          par < this->GetNumberOfLocalParameters(); par++ )
+      {
+      double sum = 0.0;
+      for ( unsigned int dim = 0; dim < Superclass::MovingImageDimension; dim++ )
+        {
+        sum += 2.0 * diff * fixedImageGradient[dim] * jacobian( dim, par );
+        }
+      localDerivativeReturn[par] = sum;
+      }
+    return true;
+  }
+
+  MeasureType GetValue() const
+  {
+    itkExceptionMacro("GetValue not yet implemented.");
+  }
+
+  void GetValueAndDerivative( MeasureType & valueReturn,
+                              DerivativeType & derivativeReturn) const
+  {
+    this->GetValueAndDerivativeThreadedExecute( derivativeReturn );
+    this->GetValueAndDerivativeThreadedPostProcess( true /*doAverage*/ );
+    valueReturn = this->GetValueResult();
+  }
+
+  /** Expose the mapping and the Jacobian of the base class */
+  MovingImagePointType MapPoint( const VirtualIndexType & index ) const
+  {
+    VirtualPointType      virtualPoint;
+    MovingImagePointType  mappedPoint;
+    MovingImagePixelType  value;
+    MovingImageGradientType gradient;
+    bool                  valid;
+    this->GetVirtualDomainImage()->TransformIndexToPhysicalPoint( index,
+                                                                  virtualPoint );
+    this->TransformAndEvaluateMovingPoint( index, virtualPoint, false,
+                                           mappedPoint, value, gradient, valid );
+    return mappedPoint;
+  }
+
+  JacobianType ComputeJacobian( const VirtualIndexType & index,
+                                const VirtualPointType & virtualPoint ) const
+  {
+    this->ComputeMovingTransformJacobian( index, virtualPoint, 0 );
+    return this->m_MovingTransformJacobianPerThread[0];
+  }
+
+protected:
+  ImageToImageObjectMetricBSplineCacheTestMetric() {}
+  virtual ~ImageToImageObjectMetricBSplineCacheTestMetric() {}
+
+private:
+  //purposely not implemented
+  ImageToImageObjectMetricBSplineCacheTestMetric(const Self &);
+  //purposely not implemented
+  void operator=(const Self &);
+};
+
+const unsigned int Dimension = 2;
+typedef itk::Image< double, Dimension >                         ImageType;
+typedef ImageToImageObjectMetricBSplineCacheTestMetric<ImageType> MetricType;
+typedef itk::BSplineTransform< double, Dimension, 3 >           BSplineTransformType;
+typedef itk::IdentityTransform< double, Dimension >             IdentityTransformType;
+
+ImageType::Pointer CreateImage( double shift )
+{
+  ImageType::Pointer image = ImageType::New();
+  ImageType::RegionType region;
+  ImageType::SizeType size;
+  size.Fill( 64 );
+  region.SetSize( size );
+  image->SetRegions( region );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, region );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const double x = it.GetIndex()[0] - 32.0 - shift;
+    const double y = it.GetIndex()[1] - 30.0;
+    it.Set( 100.0 * vcl_exp( -( x * x + 2.0 * y * y ) / 200.0 ) );
+    }
+  return image;
+}
+
+/* Set up the B-spline grid over the center of the images, so that some
+ * points of the virtual domain are outside of its support. */
+void SetGrid( BSplineTransformType * bspline, unsigned int meshSize,
+              BSplineTransformType::ParametersType & parameters )
+{
+  BSplineTransformType::OriginType             origin;
+  BSplineTransformType::PhysicalDimensionsType dimensions;
+  BSplineTransformType::MeshSizeType           mesh;
+  origin.Fill( 6.0 );
+  dimensions.Fill( 50.0 );
+  mesh.Fill( meshSize );
+  bspline->SetTransformDomainOrigin( origin );
+  bspline->SetTransformDomainPhysicalDimensions( dimensions );
+  bspline->SetTransformDomainMeshSize( mesh );
+
+  parameters.SetSize( bspline->GetNumberOfParameters() );
+  for ( unsigned int p = 0; p < parameters.Size(); ++p )
+    {
+    parameters[p] = ( p * 37 ) % 11 * 0.3 - 1.5;
+    }
+  bspline->SetParameters( parameters );
+}
+
+MetricType::Pointer CreateMetric( const ImageType * fixedImage,
+                                  const ImageType * movingImage,
+                                  BSplineTransformType * bspline )
+{
+  MetricType::Pointer metric = MetricType::New();
+  metric->SetFixedImage( fixedImage );
+  metric->SetMovingImage( movingImage );
+  metric->SetFixedTransform( IdentityTransformType::New() );
+  metric->SetMovingTransform( bspline );
+  metric->SetGradientSource( MetricType::GRADIENT_SOURCE_FIXED );
+  /* Interpolate the moving image at the mapped points */
+  metric->SetDoMovingImagePreWarp( false );
+  metric->SetUseMovingImageGradientFilter( false );
+  return metric;
+}
+
+bool Evaluate( const std::string & description, MetricType * metric,
+               bool expectCached, MetricType::MeasureType & value,
+               MetricType::DerivativeType & derivative )
+{
+  itk::TimeProbe probe;
+  probe.Start();
+  metric->GetValueAndDerivative( value, derivative );
+  probe.Stop();
+  std::cout << description << ": " << probe.GetTotal() << " s, "
+            << ( metric->GetBSplineWeightsAreCached() ? "cached" : "not cached" )
+            << ", value " << value << std::endl;
+  if( metric->GetBSplineWeightsAreCached() != expectCached )
+    {
+    std::cerr << description << ": the weights are "
+              << ( expectCached ? "not cached" : "cached" ) << std::endl;
+    return false;
+    }
+  return true;
+}
+
+bool Compare( const std::string & description,
+              MetricType::MeasureType value,
+              const MetricType::DerivativeType & derivative,
+              MetricType::MeasureType expectedValue,
+              const MetricType::DerivativeType & expectedDerivative )
+{
+  if( vcl_fabs( value - expectedValue ) > 1e-10
+      || derivative.Size() != expectedDerivative.Size() )
+    {
+    std::cerr << description << ": value " << value << " instead of "
+              << expectedValue << std::endl;
+    return false;
+    }
+  for( unsigned int p = 0; p < derivative.Size(); p++ )
+    {
+    if( vcl_fabs( derivative[p] - expectedDerivative[p] ) > 1e-10 )
+      {
+      std::cerr << description << ": derivative[" << p << "] = "
+                << derivative[p] << " instead of " << expectedDerivative[p]
+                << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+/* Check the mapped points and Jacobians of the cache against the
+ * transform at every point of the virtual domain. */
+bool CheckCacheAgainstTransform( const MetricType * metric,
+                                 const BSplineTransformType * bspline )
+{
+  const ImageType * virtualImage = metric->GetVirtualDomainImage();
+  itk::ImageRegionConstIteratorWithIndex< ImageType >
+              it( virtualImage, virtualImage->GetBufferedRegion() );
+  MetricType::JacobianType cachedJacobian;
+  MetricType::JacobianType jacobian;
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    ImageType::PointType point;
+    virtualImage->TransformIndexToPhysicalPoint( it.GetIndex(), point );
+    const ImageType::PointType expected = bspline->TransformPoint( point );
+    const ImageType::PointType mapped = metric->MapPoint( it.GetIndex() );
+    if( mapped.EuclideanDistanceTo( expected ) > 1e-12 )
+      {
+      std::cerr << it.GetIndex() << " is mapped to " << mapped
+                << " instead of " << expected << std::endl;
+      return false;
+      }
+
+    cachedJacobian = metric->ComputeJacobian( it.GetIndex(), point );
+    bspline->ComputeJacobianWithRespectToParameters( point, jacobian );
+    if( cachedJacobian.rows() != jacobian.rows()
+        || cachedJacobian.cols() != jacobian.cols()
+        || ( cachedJacobian - jacobian ).absolute_value_max() > 1e-12 )
+      {
+      std::cerr << "Wrong Jacobian at " << it.GetIndex() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+}
+
+int itkImageToImageObjectMetricBSplineCacheTest(int, char* [])
+{
+  ImageType::Pointer fixedImage = CreateImage( 0.0 );
+  ImageType::Pointer movingImage = CreateImage( 3.0 );
+
+  BSplineTransformType::Pointer bspline = BSplineTransformType::New();
+  BSplineTransformType::ParametersType parameters;
+  SetGrid( bspline, 5, parameters );
+
+  MetricType::Pointer cached = CreateMetric( fixedImage, movingImage, bspline );
+  MetricType::Pointer uncached = CreateMetric( fixedImage, movingImage, bspline );
+  uncached->UseCachingOfBSplineWeightsOff();
+  MetricType::Pointer overBudget = CreateMetric( fixedImage, movingImage, bspline );
+  /* Half of the 16 weights and 16 indices of 8 bytes per point */
+  overBudget->SetMaximumBSplineWeightsCacheSize( 64 * 64 * 16 * 8 );
+
+  MetricType::MeasureType    value;
+  MetricType::MeasureType    expectedValue;
+  MetricType::DerivativeType derivative;
+  MetricType::DerivativeType expectedDerivative;
+
+  for( unsigned int iteration = 0; iteration < 2; iteration++ )
+    {
+    if( iteration == 1 )
+      {
+      /* The weights do not depend on the parameters, which the optimizer
+       * updates, so the cache must not be rebuilt and stay right. */
+      for( unsigned int p = 0; p < parameters.Size(); p++ )
+        {
+        parameters[p] *= -0.5;
+        }
+      }
+    else
+      {
+      cached->Initialize();
+      uncached->Initialize();
+      overBudget->Initialize();
+      }
+
+    if( !Evaluate( "Not cached", uncached, false, expectedValue,
+                   expectedDerivative )
+        || !Evaluate( "Cached", cached, true, value, derivative )
+        || !Compare( "Cached", value, derivative, expectedValue,
+                     expectedDerivative )
+        || !CheckCacheAgainstTransform( cached, bspline )
+        || !Evaluate( "Over budget", overBudget, false, value, derivative )
+        || !Compare( "Over budget", value, derivative, expectedValue,
+                     expectedDerivative ) )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  /* A finer grid invalidates the cache. */
+  SetGrid( bspline, 7, parameters );
+  cached->Initialize();
+  uncached->Initialize();
+  if( !Evaluate( "Finer grid, not cached", uncached, false, expectedValue,
+                 expectedDerivative )
+      || !Evaluate( "Finer grid, cached", cached, true, value, derivative )
+      || !Compare( "Finer grid", value, derivative, expectedValue,
+                   expectedDerivative )
+      || !CheckCacheAgainstTransform( cached, bspline ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  cached->Print( std::cout );
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -54,10 +54,11 @@ namespace itk
  * of smoothing is governed by a set of user defined standard deviations
  * (one for each dimension).
  *
- * In terms of memory, this filter keeps two internal buffers: one for storing
- * the intermediate updates to the field and one for double-buffering when
- * smoothing the displacement field. Both buffers are the same type and size as the
- * output displacement field.
+ * In terms of memory, this filter keeps an internal buffer for storing
+ * the intermediate updates to the field, which is the same type and size as
+ * the output displacement field. The displacement field and the updates are
+ * smoothed in place, one line at a time, so that smoothing only needs a
+ * buffer of a line per thread.
  *
  * This class make use of the finite difference solver hierarchy. Update
  * for each iteration is computed using a PDEDeformableRegistrationFunction.
@@ -272,6 +273,15 @@ protected:
    * UpdateFieldStandardDeviations. */
   virtual void SmoothUpdateField();
 
+  /** Smooth a field in place, with a separable Gaussian operator of the
+   * given standard deviations. Each line of the buffered region of the
+   * field is copied in a buffer, padded by replicating its end pixels,
+   * and convolved back into the field, which gives the same result as a
+   * VectorNeighborhoodOperatorImageFilter with its default boundary
+   * condition. Used by SmoothDisplacementField and SmoothUpdateField. */
+  virtual void SmoothGivenField(DisplacementFieldType *field,
+                                const StandardDeviationsType & standardDeviations);
+
   /** This method is called after the solution has been generated. In this case,
    * the filter release the memory of the internal buffers. */
   virtual void PostProcessOutput();
@@ -305,9 +315,28 @@ private:
   bool m_SmoothDisplacementField;
   bool m_SmoothUpdateField;
 
-  /** Temporary displacement field use for smoothing the
-   * the displacement field. */
-  DisplacementFieldPointer m_TempField;
+  /** Type of the line buffers used for smoothing. */
+  typedef typename DisplacementFieldType::PixelType  DisplacementVectorType;
+  typedef typename DisplacementVectorType::ValueType DisplacementScalarType;
+  typedef std::vector< DisplacementVectorType >      SmoothingLineBufferType;
+
+  /** Structure for passing information into static callback methods. */
+  struct SmoothFieldThreadStruct {
+    PDEDeformableRegistrationFilter *Filter;
+    DisplacementFieldType *Field;
+    unsigned int Direction;
+    std::vector< DisplacementScalarType > Coefficients;
+  };
+
+  /** Callback and method smoothing the lines of a direction. The lines are
+   * split between the threads along another direction. */
+  static ITK_THREAD_RETURN_TYPE SmoothGivenFieldThreaderCallback(void *arg);
+  void ThreadedSmoothGivenField(const SmoothFieldThreadStruct & str,
+                                ThreadIdType threadId, ThreadIdType threadCount);
+
+  /** Line buffers used for smoothing, one per thread. They are kept
+   * from one iteration to the next. */
+  std::vector< SmoothingLineBufferType > m_SmoothingLineBuffers;
 private:
   /** Maximum error for Gaussian operator approximation. */
   double m_MaximumError;
@@ -21,11 +21,11 @@
 #include "itkPDEDeformableRegistrationFilter.h"
 
 #include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkImageLinearIteratorWithIndex.h"
 #include "itkDataObject.h"
 
 #include "itkGaussianOperator.h"
-#include "itkVectorNeighborhoodOperatorImageFilter.h"
 
 #include "vnl/vnl_math.h"
 
@@ -49,7 +49,6 @@ PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDisplacementField >
     m_UpdateFieldStandardDeviations[j] = 1.0;
     }
 
-  m_TempField = DisplacementFieldType::New();
   m_MaximumError = 0.1;
   m_MaximumKernelWidth = 30;
   m_StopRegistrationFlag = false;
@@ -363,7 +362,7 @@ PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDisplacementField >
 ::PostProcessOutput()
 {
   this->Superclass::PostProcessOutput();
-  m_TempField->Initialize();
+  m_SmoothingLineBuffers.clear();
 }
 
 /*
@@ -386,66 +385,12 @@ void
 PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDisplacementField >
 ::SmoothDisplacementField()
 {
-  DisplacementFieldPointer field = this->GetOutput();
-
-  // copy field to TempField
-  m_TempField->SetOrigin( field->GetOrigin() );
-  m_TempField->SetSpacing( field->GetSpacing() );
-  m_TempField->SetDirection( field->GetDirection() );
-  m_TempField->SetLargestPossibleRegion(
-    field->GetLargestPossibleRegion() );
-  m_TempField->SetRequestedRegion(
-    field->GetRequestedRegion() );
-  m_TempField->SetBufferedRegion( field->GetBufferedRegion() );
-  m_TempField->Allocate();
-
-  typedef typename DisplacementFieldType::PixelType      VectorType;
-  typedef typename VectorType::ValueType                 ScalarType;
-  typedef GaussianOperator< ScalarType, ImageDimension > OperatorType;
-  typedef VectorNeighborhoodOperatorImageFilter<
-    DisplacementFieldType,
-    DisplacementFieldType >                              SmootherType;
-
-  OperatorType *oper = new OperatorType;
-  typename SmootherType::Pointer smoother = SmootherType::New();
-
-  typedef typename DisplacementFieldType::PixelContainerPointer
-  PixelContainerPointer;
-  PixelContainerPointer swapPtr;
-
-  // graft the output field onto the mini-pipeline
-  smoother->GraftOutput(m_TempField);
+  DisplacementFieldType *field = this->GetOutput();
 
-  for ( unsigned int j = 0; j < ImageDimension; j++ )
-    {
-    // smooth along this dimension
-    oper->SetDirection(j);
-    double variance = vnl_math_sqr(m_StandardDeviations[j]);
-    oper->SetVariance(variance);
-    oper->SetMaximumError(m_MaximumError);
-    oper->SetMaximumKernelWidth(m_MaximumKernelWidth);
-    oper->CreateDirectional();
-
-    // todo: make sure we only smooth within the buffered region
-    smoother->SetOperator(*oper);
-    smoother->SetInput(field);
-    smoother->Update();
-
-    if ( j < ImageDimension - 1 )
-      {
-      // swap the containers
-      swapPtr = smoother->GetOutput()->GetPixelContainer();
-      smoother->GraftOutput(field);
-      field->SetPixelContainer(swapPtr);
-      smoother->Modified();
-      }
-    }
-
-  // graft the output back to this filter
-  m_TempField->SetPixelContainer( field->GetPixelContainer() );
-  this->GraftOutput( smoother->GetOutput() );
+  this->SmoothGivenField(field, m_StandardDeviations);
 
-  delete oper;
+  // the buffer was changed in place
+  field->Modified();
 }
 
 /*
@@ -457,54 +402,146 @@ PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDisplacementField >
 ::SmoothUpdateField()
 {
   // The update buffer will be overwritten with new data.
-  DisplacementFieldPointer field = this->GetUpdateBuffer();
+  DisplacementFieldType *field = this->GetUpdateBuffer();
+
+  this->SmoothGivenField( field, this->GetUpdateFieldStandardDeviations() );
+}
+
+/*
+ * Smooth a field in place, one direction at a time
+ */
+template< class TFixedImage, class TMovingImage, class TDisplacementField >
+void
+PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDisplacementField >
+::SmoothGivenField(DisplacementFieldType *field,
+                   const StandardDeviationsType & standardDeviations)
+{
+  typedef GaussianOperator< DisplacementScalarType, ImageDimension > OperatorType;
 
-  typedef typename DisplacementFieldType::PixelType       VectorType;
-  typedef typename VectorType::ValueType                  ScalarType;
-  typedef GaussianOperator< ScalarType, ImageDimension >  OperatorType;
-  typedef VectorNeighborhoodOperatorImageFilter<
-    DisplacementFieldType,
-    DisplacementFieldType >                               SmootherType;
+  SmoothFieldThreadStruct str;
+  str.Filter = this;
+  str.Field = field;
 
-  OperatorType opers[ImageDimension];
-  typename SmootherType::Pointer smoothers[ImageDimension];
+  this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
+  m_SmoothingLineBuffers.resize( this->GetMultiThreader()->GetNumberOfThreads() );
 
   for ( unsigned int j = 0; j < ImageDimension; j++ )
     {
     // smooth along this dimension
-    opers[j].SetDirection(j);
-    double variance = vnl_math_sqr(this->GetUpdateFieldStandardDeviations()[j]);
-    //double variance = vnl_math_sqr( 1.0 );
-    opers[j].SetVariance(variance);
-    opers[j].SetMaximumError( this->GetMaximumError() );
-    opers[j].SetMaximumKernelWidth( this->GetMaximumKernelWidth() );
-    opers[j].CreateDirectional();
-
-    smoothers[j] = SmootherType::New();
-    smoothers[j]->SetOperator(opers[j]);
-    smoothers[j]->ReleaseDataFlagOn();
-
-    if ( j > 0 )
+    OperatorType oper;
+    oper.SetDirection(j);
+    double variance = vnl_math_sqr(standardDeviations[j]);
+    oper.SetVariance(variance);
+    oper.SetMaximumError(m_MaximumError);
+    oper.SetMaximumKernelWidth(m_MaximumKernelWidth);
+    oper.CreateDirectional();
+
+    str.Direction = j;
+    str.Coefficients.assign( oper.Begin(), oper.End() );
+
+    this->GetMultiThreader()->SetSingleMethod(this->SmoothGivenFieldThreaderCallback,
+                                              &str);
+    this->GetMultiThreader()->SingleMethodExecute();
+    }
+}
+
+template< class TFixedImage, class TMovingImage, class TDisplacementField >
+ITK_THREAD_RETURN_TYPE
+PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDisplacementField >
+::SmoothGivenFieldThreaderCallback(void *arg)
+{
+  ThreadIdType threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  ThreadIdType threadCount = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->NumberOfThreads;
+
+  SmoothFieldThreadStruct *str = (SmoothFieldThreadStruct *)
+    ( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  str->Filter->ThreadedSmoothGivenField(*str, threadId, threadCount);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TFixedImage, class TMovingImage, class TDisplacementField >
+void
+PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDisplacementField >
+::ThreadedSmoothGivenField(const SmoothFieldThreadStruct & str,
+                           ThreadIdType threadId, ThreadIdType threadCount)
+{
+  typedef typename DisplacementFieldType::RegionType RegionType;
+
+  DisplacementFieldType *field = str.Field;
+  const unsigned int     direction = str.Direction;
+
+  // Split the lines along the outermost other direction.
+  RegionType         region = field->GetBufferedRegion();
+  const unsigned int length = region.GetSize(direction);
+  if ( length == 0 )
+    {
+    return;
+    }
+  if ( ImageDimension > 1 )
+    {
+    const unsigned int splitAxis = ( direction == ImageDimension - 1 ) ?
+                                   ImageDimension - 2 : ImageDimension - 1;
+    const SizeValueType range = region.GetSize(splitAxis);
+    const SizeValueType valuesPerThread =
+      ( range + threadCount - 1 ) / threadCount;
+    const SizeValueType begin = threadId * valuesPerThread;
+    if ( begin >= range )
       {
-      smoothers[j]->SetInput( smoothers[j - 1]->GetOutput() );
+      return;
+      }
+    const SizeValueType end = vnl_math_min(begin + valuesPerThread, range);
+    region.SetIndex(splitAxis, region.GetIndex(splitAxis) + begin);
+    region.SetSize(splitAxis, end - begin);
+    }
+  else if ( threadId != 0 )
+    {
+    return;
+    }
+
+  // Line buffer with the pixels of a line, padded by radius copies of
+  // its first and last pixels.
+  const std::vector< DisplacementScalarType > & coefficients = str.Coefficients;
+  const unsigned int radius = static_cast< unsigned int >( coefficients.size() / 2 );
+  SmoothingLineBufferType & line = m_SmoothingLineBuffers[threadId];
+  line.resize(length + 2 * radius);
+
+  const unsigned int      vectorDimension = DisplacementVectorType::Dimension;
+  const OffsetValueType   stride = field->GetOffsetTable()[direction];
+  DisplacementVectorType *buffer = field->GetBufferPointer();
+
+  // Iterate over the first pixel of each line.
+  region.SetSize(direction, 1);
+  ImageRegionConstIteratorWithIndex< DisplacementFieldType > it(field, region);
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    DisplacementVectorType *first = buffer + field->ComputeOffset( it.GetIndex() );
+
+    for ( unsigned int i = 0; i < radius; i++ )
+      {
+      line[i] = first[0];
+      line[radius + length + i] = first[( length - 1 ) * stride];
+      }
+    for ( unsigned int i = 0; i < length; i++ )
+      {
+      line[radius + i] = first[i * stride];
+      }
+
+    for ( unsigned int i = 0; i < length; i++ )
+      {
+      DisplacementVectorType & pixel = first[i * stride];
+      for ( unsigned int c = 0; c < vectorDimension; c++ )
+        {
+        DisplacementScalarType sum = NumericTraits< DisplacementScalarType >::Zero;
+        for ( unsigned int k = 0; k < coefficients.size(); k++ )
+          {
+          sum += coefficients[k] * line[i + k][c];
+          }
+        pixel[c] = sum;
+        }
       }
     }
-  smoothers[0]->SetInput(field);
-  smoothers[ImageDimension - 1]->GetOutput()
-  ->SetRequestedRegion( field->GetBufferedRegion() );
-
-  smoothers[ImageDimension - 1]->Update();
-
-  // field to contain the final smoothed data, do the equivalent of a graft
-  field->SetPixelContainer( smoothers[ImageDimension - 1]->GetOutput()
-                            ->GetPixelContainer() );
-  field->SetRequestedRegion( smoothers[ImageDimension - 1]->GetOutput()
-                             ->GetRequestedRegion() );
-  field->SetBufferedRegion( smoothers[ImageDimension - 1]->GetOutput()
-                            ->GetBufferedRegion() );
-  field->SetLargestPossibleRegion( smoothers[ImageDimension - 1]->GetOutput()
-                                   ->GetLargestPossibleRegion() );
-  field->CopyInformation( smoothers[ImageDimension - 1]->GetOutput() );
 }
 } // end namespace itk
 
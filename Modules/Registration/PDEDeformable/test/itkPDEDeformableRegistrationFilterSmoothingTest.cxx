@@ -0,0 +1,180 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkDemonsRegistrationFilter.h"
+#include "itkGaussianOperator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkVectorNeighborhoodOperatorImageFilter.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+const unsigned int Dimension = 3;
+
+typedef itk::Image< float, Dimension >                            ImageType;
+typedef itk::Vector< float, Dimension >                           VectorType;
+typedef itk::Image< VectorType, Dimension >                       FieldType;
+
+// Gives access to the in-place smoothing of the registration filters.
+class SmoothingRegistrationFilter:
+  public itk::DemonsRegistrationFilter< ImageType, ImageType, FieldType >
+{
+public:
+  typedef SmoothingRegistrationFilter                                     Self;
+  typedef itk::DemonsRegistrationFilter< ImageType, ImageType, FieldType > Superclass;
+  typedef itk::SmartPointer< Self >                                       Pointer;
+  itkNewMacro(Self);
+
+  void Smooth(FieldType *field, const StandardDeviationsType & standardDeviations)
+  {
+    this->SmoothGivenField(field, standardDeviations);
+  }
+};
+
+typedef SmoothingRegistrationFilter::StandardDeviationsType StandardDeviationsType;
+
+// Smooth with a chain of VectorNeighborhoodOperatorImageFilter, as the
+// registration filters used to.
+FieldType::Pointer SmoothWithOperatorFilters(const FieldType *field,
+                                             const StandardDeviationsType & standardDeviations,
+                                             double maximumError, unsigned int maximumKernelWidth)
+{
+  typedef itk::GaussianOperator< float, Dimension >                            OperatorType;
+  typedef itk::VectorNeighborhoodOperatorImageFilter< FieldType, FieldType >   SmootherType;
+
+  OperatorType           opers[Dimension];
+  SmootherType::Pointer  smoothers[Dimension];
+  for ( unsigned int j = 0; j < Dimension; j++ )
+    {
+    opers[j].SetDirection(j);
+    opers[j].SetVariance( vnl_math_sqr(standardDeviations[j]) );
+    opers[j].SetMaximumError(maximumError);
+    opers[j].SetMaximumKernelWidth(maximumKernelWidth);
+    opers[j].CreateDirectional();
+
+    smoothers[j] = SmootherType::New();
+    smoothers[j]->SetOperator(opers[j]);
+    if ( j > 0 )
+      {
+      smoothers[j]->SetInput( smoothers[j - 1]->GetOutput() );
+      }
+    }
+  smoothers[0]->SetInput(field);
+  smoothers[Dimension - 1]->Update();
+  return smoothers[Dimension - 1]->GetOutput();
+}
+
+bool TestSmoothing(const FieldType::SizeType & size,
+                   const StandardDeviationsType & standardDeviations,
+                   itk::ThreadIdType numberOfThreads)
+{
+  FieldType::Pointer    field = FieldType::New();
+  FieldType::RegionType region;
+  FieldType::IndexType  start;
+  start[0] = 3;
+  start[1] = -2;
+  start[2] = 0;
+  region.SetIndex(start);
+  region.SetSize(size);
+  field->SetRegions(region);
+  field->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< FieldType > it(field, region);
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const FieldType::IndexType & index = it.GetIndex();
+    VectorType                   vector;
+    for ( unsigned int c = 0; c < Dimension; c++ )
+      {
+      vector[c] = static_cast< float >( ( index[0] * 7 + index[1] * 13 + index[2] * ( c + 5 ) ) % 17 ) - 8.0f;
+      }
+    it.Set(vector);
+    }
+
+  SmoothingRegistrationFilter::Pointer filter = SmoothingRegistrationFilter::New();
+  filter->SetNumberOfThreads(numberOfThreads);
+
+  itk::TimeProbe referenceProbe;
+  referenceProbe.Start();
+  FieldType::Pointer expected = SmoothWithOperatorFilters( field, standardDeviations,
+                                                           filter->GetMaximumError(),
+                                                           filter->GetMaximumKernelWidth() );
+  referenceProbe.Stop();
+
+  itk::TimeProbe inPlaceProbe;
+  inPlaceProbe.Start();
+  filter->Smooth(field, standardDeviations);
+  inPlaceProbe.Stop();
+
+  std::cout << size << ", sigma " << standardDeviations << ", " << numberOfThreads << " threads: "
+            << referenceProbe.GetTotal() << " s with the operator filters, "
+            << inPlaceProbe.GetTotal() << " s in place" << std::endl;
+
+  itk::ImageRegionConstIteratorWithIndex< FieldType > eit(expected, region);
+  for ( it.GoToBegin(), eit.GoToBegin(); !it.IsAtEnd(); ++it, ++eit )
+    {
+    if ( it.Get() != eit.Get() )
+      {
+      std::cerr << "At " << it.GetIndex() << ", the field is smoothed to " << it.Get()
+                << " instead of " << eit.Get() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+}
+
+//
+// Check that the in-place smoothing of the PDE registration filters gives
+// the same fields as smoothing with VectorNeighborhoodOperatorImageFilter,
+// including when the kernel is longer than the lines, and time both.
+//
+int itkPDEDeformableRegistrationFilterSmoothingTest(int, char* [])
+{
+  FieldType::SizeType size;
+  size[0] = 40;
+  size[1] = 33;
+  size[2] = 9;
+
+  StandardDeviationsType standardDeviations;
+  standardDeviations[0] = 1.0;
+  standardDeviations[1] = 2.5;
+  standardDeviations[2] = 4.0;
+
+  StandardDeviationsType small;
+  small.Fill(0.5);
+
+  for ( itk::ThreadIdType numberOfThreads = 1; numberOfThreads <= 8; numberOfThreads *= 2 )
+    {
+    if ( !TestSmoothing(size, standardDeviations, numberOfThreads)
+         || !TestSmoothing(size, small, numberOfThreads) )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  FieldType::SizeType large;
+  large.Fill(100);
+  if ( !TestSmoothing(large, standardDeviations, 4) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
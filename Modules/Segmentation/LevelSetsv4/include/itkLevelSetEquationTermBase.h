@@ -37,6 +37,13 @@ namespace itk
  *  the input image; and \f$\alpha_i\f$ is a weight to balance the contribution of
  *  each term in the PDE.
  *
+ *  \warning The Whitaker and Malcolm sparse level set evolutions evaluate the
+ *  zero layer with several threads when their NumberOfThreads is larger than
+ *  1, the default. Evaluate and Value are then called concurrently, and must
+ *  only read the data shared by all the points. The members of a term must
+ *  only be modified in Initialize, InitializeParameters, UpdatePixel and
+ *  Update, which are not called from several threads.
+ *
  *  \tparam TInput Input Image Type
  *  \tparam TLevelSetContainer Level set function container type
  *  \ingroup ITKLevelSetsv4
@@ -26,6 +26,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 namespace itk
 {
@@ -78,6 +79,10 @@ public:
                                                                        TermType;
   typedef typename TermType::Pointer                                   TermPointer;
 
+  /** Largest absolute value of each term, in the order of the terms, used
+   *  to accumulate the CFL contribution without writing to the container */
+  typedef std::vector< LevelSetOutputRealType >                        TermContributionArrayType;
+
   /** Set/Get the input image to be segmented. */
   itkSetObjectMacro( Input, InputImageType );
   itkGetObjectMacro( Input, InputImageType );
@@ -111,6 +116,24 @@ public:
   LevelSetOutputRealType Evaluate( const LevelSetInputIndexType& iP,
                                    const LevelSetDataType& iData );
 
+  /** Evaluate the term at a given pixel location, accumulating the CFL
+   *  contribution of each term into ioContribution instead of the container.
+   *  Several threads can call this method concurrently, each with its own
+   *  array, provided the terms only read shared data in Evaluate. */
+  LevelSetOutputRealType Evaluate( const LevelSetInputIndexType& iP,
+                                   TermContributionArrayType& ioContribution );
+
+  /** Evaluate the term at a given pixel location, accumulating the CFL
+   *  contribution of each term into ioContribution instead of the container.
+   *  Several threads can call this method concurrently, each with its own
+   *  array, provided the terms only read shared data in Evaluate. */
+  LevelSetOutputRealType Evaluate( const LevelSetInputIndexType& iP,
+                                   const LevelSetDataType& iData,
+                                   TermContributionArrayType& ioContribution );
+
+  /** Merge CFL contributions accumulated by Evaluate into the container */
+  void MergeTermContribution( const TermContributionArrayType& iContribution );
+
   /** Update the term parameters at end of iteration */
   void Update();
 
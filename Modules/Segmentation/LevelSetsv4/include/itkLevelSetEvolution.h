@@ -22,6 +22,7 @@
 
 #include "itkLevelSetEvolutionBase.h"
 #include "itkLevelSetDenseImageBase.h"
+#include "itkMultiThreader.h"
 
 #include "itkWhitakerSparseLevelSetImage.h"
 #include "itkUpdateWhitakerSparseLevelSet.h"
@@ -233,20 +234,46 @@ public:
 
   typedef UpdateWhitakerSparseLevelSet< ImageDimension, LevelSetOutputType, EquationContainerType > UpdateLevelSetFilterType;
   typedef typename UpdateLevelSetFilterType::Pointer                                                UpdateLevelSetFilterPointer;
+  typedef typename UpdateLevelSetFilterType::UpdateBufferType                                       UpdateBufferType;
 
   /** Update the filter by computing the output level function
    * by calling GenerateData() once the instantiation of necessary variables
    * is verified */
   void Update();
 
+  /** Set/Get the number of threads used to compute the updates of the
+   *  zero layer. Defaults to 1. With more threads, the terms of the
+   *  equations are evaluated concurrently, hence they must not modify shared
+   *  data in Evaluate, see LevelSetEquationTermBase. */
+  itkSetClampMacro( NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS );
+  itkGetConstMacro( NumberOfThreads, ThreadIdType );
+
 protected:
   LevelSetEvolution();
   ~LevelSetEvolution();
 
   typedef std::pair< LevelSetInputType, LevelSetOutputType > NodePairType;
 
-  // For sparse case, the update buffer needs to be the size of the active layer
-  std::map< IdentifierType, LevelSetLayerType* >  m_UpdateBuffer;
+  // For sparse case, the update buffer needs to be the size of the active
+  // layer. Updates are stored in the order of the zero layer nodes.
+  std::map< IdentifierType, UpdateBufferType >  m_UpdateBuffer;
+
+  ThreadIdType m_NumberOfThreads;
+
+  typedef typename TermContainerType::TermContributionArrayType TermContributionArrayType;
+
+  /** Structure passed to the threads computing the updates of a zero layer */
+  struct ComputeIterationThreadStruct
+    {
+    TermContainerType *                       TermContainer;
+    std::vector< LevelSetLayerIterator >      RangeBegin;
+    std::vector< SizeValueType >              RangeOffset;
+    UpdateBufferType *                        UpdateBuffer;
+    std::vector< TermContributionArrayType >  TermContribution;
+    };
+
+  /** Compute the updates of one range of the zero layer */
+  static ITK_THREAD_RETURN_TYPE ComputeIterationThreaderCallback( void *arg );
 
   /** Initialize the update buffers for all level sets to hold the updates of
    *  equations in each iteration */
@@ -367,7 +394,9 @@ protected:
   /** Initialize the iteration by computing parameters in the terms of the level set equation */
   void InitializeIteration();
 
-  /** Computer the update at each pixel and store in the update buffer */
+  /** Does nothing: the Shi update filter evaluates the equation at each
+   *  node while it moves the nodes between the layers, and the next nodes
+   *  depend on these moves, so the evaluation is not threaded. */
   void ComputeIteration();
 
   /** Compute the time-step for the next iteration */
@@ -457,15 +486,25 @@ public:
   typedef typename UpdateLevelSetFilterType::Pointer UpdateLevelSetFilterPointer;
   void Update();
 
+  /** Set/Get the number of threads used by the update filter to evaluate
+   *  the equation on the zero layer. Defaults to 1. With more threads, the
+   *  terms of the equations are evaluated concurrently, hence they must not
+   *  modify shared data in Evaluate, see LevelSetEquationTermBase. */
+  itkSetClampMacro( NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS );
+  itkGetConstMacro( NumberOfThreads, ThreadIdType );
+
 protected:
   LevelSetEvolution();
   ~LevelSetEvolution();
 
+  ThreadIdType m_NumberOfThreads;
+
   /** Initialize the update buffers for all level sets to hold the updates of
    *  equations in each iteration */
   void AllocateUpdateBuffer();
 
-  /** Computer the update at each pixel and store in the update buffer */
+  /** Does nothing: the Malcolm update filter evaluates the equation on the
+   *  zero layer, with NumberOfThreads threads, before it moves the nodes. */
   void ComputeIteration();
 
   /** Compute the time-step for the next iteration */
@@ -312,19 +312,13 @@ template< class TEquationContainer, typename TOutput, unsigned int VDimension >
 LevelSetEvolution< TEquationContainer, WhitakerSparseLevelSetImage< TOutput, VDimension > >
 ::LevelSetEvolution()
 {
+  this->m_NumberOfThreads = 1;
 }
 
 template< class TEquationContainer, typename TOutput, unsigned int VDimension >
 LevelSetEvolution< TEquationContainer, WhitakerSparseLevelSetImage< TOutput, VDimension > >
 ::~LevelSetEvolution()
-{
-  typename LevelSetContainerType::ConstIterator it = this->m_LevelSetContainer->Begin();
-  while( it != this->m_LevelSetContainer->End() )
-    {
-    delete this->m_UpdateBuffer[ it->GetIdentifier() ];
-    ++it;
-    }
-}
+{}
 
 template< class TEquationContainer, typename TOutput, unsigned int VDimension >
 void
@@ -384,23 +378,7 @@ LevelSetEvolution< TEquationContainer, WhitakerSparseLevelSetImage< TOutput, VDi
   typename LevelSetContainerType::Iterator it = this->m_LevelSetContainer->Begin();
   while( it != this->m_LevelSetContainer->End() )
     {
-    IdentifierType id = it->GetIdentifier();
-
-    if( this->m_UpdateBuffer.find( id ) == this->m_UpdateBuffer.end() )
-      {
-      this->m_UpdateBuffer[ id ] = new LevelSetLayerType;
-      }
-    else
-      {
-      if( this->m_UpdateBuffer[ id ] )
-        {
-        this->m_UpdateBuffer[ id ]->clear();
-        }
-      else
-        {
-        this->m_UpdateBuffer[ id ] = new LevelSetLayerType;
-        }
-      }
+    this->m_UpdateBuffer[ it->GetIdentifier() ].clear();
     ++it;
     }
 }
@@ -494,29 +472,99 @@ LevelSetEvolution< TEquationContainer, WhitakerSparseLevelSetImage< TOutput, VDi
     LevelSetIdentifierType levelSetId = it->GetIdentifier();
     TermContainerPointer termContainer = this->m_EquationContainer->GetEquation( levelSetId );
 
-    LevelSetLayerIterator list_it = levelSet->GetLayer( 0 ).begin();
-    LevelSetLayerIterator list_end = levelSet->GetLayer( 0 ).end();
+    LevelSetLayerType & layer0 = levelSet->GetLayer( 0 );
+    const SizeValueType numberOfNodes = static_cast< SizeValueType >( layer0.size() );
+
+    UpdateBufferType & update = this->m_UpdateBuffer[ levelSetId ];
+    update.resize( numberOfNodes );
 
-    while( list_it != list_end )
+    ThreadIdType numberOfThreads = this->m_NumberOfThreads;
+    if( numberOfNodes < numberOfThreads )
       {
-      const LevelSetInputType idx = list_it->first;
+      numberOfThreads = static_cast< ThreadIdType >( numberOfNodes );
+      }
+    if( numberOfThreads < 1 )
+      {
+      numberOfThreads = 1;
+      }
 
-      LevelSetDataType characteristics;
+    ComputeIterationThreadStruct str;
+    str.TermContainer = termContainer;
+    str.UpdateBuffer = &update;
+    str.TermContribution.resize( numberOfThreads );
 
-      termContainer->ComputeRequiredData( idx, characteristics );
+    // Each thread evaluates a contiguous range of the zero layer, and writes
+    // its updates at the position of the nodes in the layer. Record where
+    // each range starts since the layer can only be walked sequentially.
+    str.RangeBegin.reserve( numberOfThreads + 1 );
+    str.RangeOffset.reserve( numberOfThreads + 1 );
 
-      const LevelSetOutputType temp_update =
-          static_cast< LevelSetOutputType >( termContainer->Evaluate( idx, characteristics ) );
+    LevelSetLayerIterator list_it = layer0.begin();
+    SizeValueType position = 0;
+    for( ThreadIdType t = 0; t <= numberOfThreads; t++ )
+      {
+      const SizeValueType offset = numberOfNodes * t / numberOfThreads;
+      while( position < offset )
+        {
+        ++list_it;
+        ++position;
+        }
+      str.RangeBegin.push_back( list_it );
+      str.RangeOffset.push_back( offset );
+      }
 
-      this->m_UpdateBuffer[ levelSetId ]->insert(
-            NodePairType( idx, temp_update ) );
+    MultiThreader::Pointer threader = MultiThreader::New();
+    threader->SetNumberOfThreads( numberOfThreads );
+    threader->SetSingleMethod( this->ComputeIterationThreaderCallback, &str );
+    threader->SingleMethodExecute();
 
-      ++list_it;
+    // The largest contribution of each term does not depend on the order in
+    // which the threads are merged
+    for( ThreadIdType t = 0; t < numberOfThreads; t++ )
+      {
+      termContainer->MergeTermContribution( str.TermContribution[t] );
       }
     ++it;
     }
 }
 
+template< class TEquationContainer, typename TOutput, unsigned int VDimension >
+ITK_THREAD_RETURN_TYPE
+LevelSetEvolution< TEquationContainer, WhitakerSparseLevelSetImage< TOutput, VDimension > >
+::ComputeIterationThreaderCallback( void *arg )
+{
+  ThreadIdType threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+
+  ComputeIterationThreadStruct *str = (ComputeIterationThreadStruct *)
+    ( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  TermContainerType * termContainer = str->TermContainer;
+  TermContributionArrayType & termContribution = str->TermContribution[threadId];
+
+  LevelSetLayerIterator list_it = str->RangeBegin[threadId];
+  LevelSetLayerIterator list_end = str->RangeBegin[threadId + 1];
+
+  typename UpdateBufferType::iterator up_it =
+    str->UpdateBuffer->begin() + str->RangeOffset[threadId];
+
+  while( list_it != list_end )
+    {
+    const LevelSetInputType idx = list_it->first;
+
+    LevelSetDataType characteristics;
+
+    termContainer->ComputeRequiredData( idx, characteristics );
+
+    *up_it = static_cast< LevelSetOutputType >(
+      termContainer->Evaluate( idx, characteristics, termContribution ) );
+
+    ++list_it;
+    ++up_it;
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 template< class TEquationContainer, typename TOutput, unsigned int VDimension >
 void
 LevelSetEvolution< TEquationContainer, WhitakerSparseLevelSetImage< TOutput, VDimension > >
@@ -564,7 +612,7 @@ LevelSetEvolution< TEquationContainer, WhitakerSparseLevelSetImage< TOutput, VDi
 
     UpdateLevelSetFilterPointer update_levelset = UpdateLevelSetFilterType::New();
     update_levelset->SetInputLevelSet( levelSet );
-    update_levelset->SetUpdate( * this->m_UpdateBuffer[it->GetIdentifier()] );
+    update_levelset->SetUpdate( this->m_UpdateBuffer[it->GetIdentifier()] );
     update_levelset->SetEquationContainer( this->m_EquationContainer );
     update_levelset->SetTimeStep( this->m_Dt );
     update_levelset->SetCurrentLevelSetId( it->GetIdentifier() );
@@ -574,7 +622,7 @@ LevelSetEvolution< TEquationContainer, WhitakerSparseLevelSetImage< TOutput, VDi
 
     this->m_RMSChangeAccumulator = update_levelset->GetRMSChangeAccumulator();
 
-    this->m_UpdateBuffer[it->GetIdentifier()]->clear();
+    this->m_UpdateBuffer[it->GetIdentifier()].clear();
     ++it;
     }
 }
@@ -782,6 +830,7 @@ template< class TEquationContainer, unsigned int VDimension >
 LevelSetEvolution< TEquationContainer, MalcolmSparseLevelSetImage< VDimension > >
 ::LevelSetEvolution()
 {
+  this->m_NumberOfThreads = 1;
 }
 
 template< class TEquationContainer, unsigned int VDimension >
@@ -952,6 +1001,7 @@ void LevelSetEvolution< TEquationContainer, MalcolmSparseLevelSetImage< VDimensi
     update_levelset->SetInputLevelSet( levelSet );
     update_levelset->SetCurrentLevelSetId( levelSetId );
     update_levelset->SetEquationContainer( this->m_EquationContainer );
+    update_levelset->SetNumberOfThreads( this->m_NumberOfThreads );
     update_levelset->Update();
 
     levelSet->Graft( update_levelset->GetOutputLevelSet() );
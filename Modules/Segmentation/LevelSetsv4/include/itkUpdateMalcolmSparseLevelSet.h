@@ -27,6 +27,7 @@
 #include "itkNeighborhoodAlgorithm.h"
 #include "itkLabelMapToLabelImageFilter.h"
 #include "itkLabelImageToLabelMapFilter.h"
+#include "itkMultiThreader.h"
 
 namespace itk
 {
@@ -80,6 +81,7 @@ public:
 
   typedef TEquationContainer                                    EquationContainerType;
   typedef typename EquationContainerType::Pointer               EquationContainerPointer;
+  typedef typename EquationContainerType::TermContainerType     TermContainerType;
   typedef typename EquationContainerType::TermContainerPointer  TermContainerPointer;
 
   itkGetObjectMacro( OutputLevelSet, LevelSetType );
@@ -102,6 +104,12 @@ public:
   itkSetMacro( CurrentLevelSetId, IdentifierType );
   itkGetMacro( CurrentLevelSetId, IdentifierType );
 
+  /** Set/Get the number of threads used to evaluate the equation on the
+   *  zero layer. Defaults to 1. With more threads, the terms of the equation
+   *  are evaluated concurrently, see LevelSetEquationTermBase. */
+  itkSetClampMacro( NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS );
+  itkGetConstMacro( NumberOfThreads, ThreadIdType );
+
 protected:
   UpdateMalcolmSparseLevelSet();
   virtual ~UpdateMalcolmSparseLevelSet();
@@ -124,6 +132,23 @@ protected:
 
   bool m_IsUsingUnPhasedPropagation;
 
+  ThreadIdType m_NumberOfThreads;
+
+  typedef typename TermContainerType::TermContributionArrayType TermContributionArrayType;
+
+  /** Structure passed to the threads evaluating the equation on the 0 layer */
+  struct FillUpdateContainerThreadStruct
+    {
+    TermContainerType *                         TermContainer;
+    std::vector< LevelSetLayerConstIterator >   RangeBegin;
+    std::vector< SizeValueType >                RangeOffset;
+    std::vector< LevelSetOutputType > *         Update;
+    std::vector< TermContributionArrayType >    TermContribution;
+    };
+
+  /** Evaluate the equation on one range of the 0 layer */
+  static ITK_THREAD_RETURN_TYPE FillUpdateContainerThreaderCallback( void *arg );
+
   /** Compute the updates for all points in the 0 layer and store in UpdateContainer */
   void FillUpdateContainer();
 
@@ -29,7 +29,8 @@ UpdateMalcolmSparseLevelSet< VDimension, TEquationContainer >
 ::UpdateMalcolmSparseLevelSet() :
   m_CurrentLevelSetId( NumericTraits< IdentifierType >::Zero ),
   m_RMSChangeAccumulator( NumericTraits< LevelSetOutputRealType >::Zero ),
-  m_IsUsingUnPhasedPropagation( true )
+  m_IsUsingUnPhasedPropagation( true ),
+  m_NumberOfThreads( 1 )
 {
   this->m_OutputLevelSet = LevelSetType::New();
 }
@@ -128,18 +129,91 @@ void
 UpdateMalcolmSparseLevelSet< VDimension, TEquationContainer >
 ::FillUpdateContainer()
 {
-  LevelSetLayerType level0 = this->m_OutputLevelSet->GetLayer( LevelSetType::ZeroLayer() );
-
-  LevelSetLayerIterator nodeIt = level0.begin();
-  LevelSetLayerIterator nodeEnd = level0.end();
+  const LevelSetLayerType & level0 = this->m_OutputLevelSet->GetLayer( LevelSetType::ZeroLayer() );
+  const SizeValueType numberOfNodes = static_cast< SizeValueType >( level0.size() );
 
   TermContainerPointer termContainer = this->m_EquationContainer->GetEquation( this->m_CurrentLevelSetId );
 
+  ThreadIdType numberOfThreads = this->m_NumberOfThreads;
+  if( numberOfNodes < numberOfThreads )
+    {
+    numberOfThreads = static_cast< ThreadIdType >( numberOfNodes );
+    }
+  if( numberOfThreads < 1 )
+    {
+    numberOfThreads = 1;
+    }
+
+  std::vector< LevelSetOutputType > update( numberOfNodes );
+
+  FillUpdateContainerThreadStruct str;
+  str.TermContainer = termContainer;
+  str.Update = &update;
+  str.TermContribution.resize( numberOfThreads );
+
+  // Each thread evaluates a contiguous range of the zero layer, and writes
+  // the sign of the update at the position of the nodes in the layer.
+  str.RangeBegin.reserve( numberOfThreads + 1 );
+  str.RangeOffset.reserve( numberOfThreads + 1 );
+
+  LevelSetLayerConstIterator nodeIt = level0.begin();
+  SizeValueType position = 0;
+  for( ThreadIdType t = 0; t <= numberOfThreads; t++ )
+    {
+    const SizeValueType offset = numberOfNodes * t / numberOfThreads;
+    while( position < offset )
+      {
+      ++nodeIt;
+      ++position;
+      }
+    str.RangeBegin.push_back( nodeIt );
+    str.RangeOffset.push_back( offset );
+    }
+
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( numberOfThreads );
+  threader->SetSingleMethod( this->FillUpdateContainerThreaderCallback, &str );
+  threader->SingleMethodExecute();
+
+  for( ThreadIdType t = 0; t < numberOfThreads; t++ )
+    {
+    termContainer->MergeTermContribution( str.TermContribution[t] );
+    }
+
+  // The nodes are in the order of the layer, so each one is inserted at the
+  // end of the update container
+  typename std::vector< LevelSetOutputType >::const_iterator upIt = update.begin();
+  for( nodeIt = level0.begin(); nodeIt != level0.end(); ++nodeIt, ++upIt )
+    {
+    this->m_Update.insert( this->m_Update.end(), NodePairType( nodeIt->first, *upIt ) );
+    }
+}
+
+template< unsigned int VDimension,
+          class TEquationContainer >
+ITK_THREAD_RETURN_TYPE
+UpdateMalcolmSparseLevelSet< VDimension, TEquationContainer >
+::FillUpdateContainerThreaderCallback( void *arg )
+{
+  ThreadIdType threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+
+  FillUpdateContainerThreadStruct *str = (FillUpdateContainerThreadStruct *)
+    ( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  TermContainerType * termContainer = str->TermContainer;
+  TermContributionArrayType & termContribution = str->TermContribution[threadId];
+
+  LevelSetLayerConstIterator nodeIt = str->RangeBegin[threadId];
+  LevelSetLayerConstIterator nodeEnd = str->RangeBegin[threadId + 1];
+
+  typename std::vector< LevelSetOutputType >::iterator upIt =
+    str->Update->begin() + str->RangeOffset[threadId];
+
   while( nodeIt != nodeEnd )
     {
     const LevelSetInputType currentIndex = nodeIt->first;
 
-    const LevelSetOutputRealType update = termContainer->Evaluate( currentIndex );
+    const LevelSetOutputRealType update = termContainer->Evaluate( currentIndex, termContribution );
 
     LevelSetOutputType value = NumericTraits< LevelSetOutputType >::Zero;
 
@@ -152,10 +226,13 @@ UpdateMalcolmSparseLevelSet< VDimension, TEquationContainer >
       value = - NumericTraits< LevelSetOutputType >::One;
       }
 
-    this->m_Update.insert( NodePairType( currentIndex, value ) );
+    *upIt = value;
 
     ++nodeIt;
+    ++upIt;
     }
+
+  return ITK_THREAD_RETURN_VALUE;
 }
 
 template< unsigned int VDimension,
@@ -79,6 +79,10 @@ public:
   typedef typename LevelSetType::LayerConstIterator    LevelSetLayerConstIterator;
   typedef typename LevelSetType::OutputRealType        LevelSetOutputRealType;
 
+  /** Updates of the zero layer, stored in the order of the layer nodes */
+  typedef std::vector< LevelSetOutputType >            UpdateBufferType;
+  typedef typename UpdateBufferType::const_iterator    UpdateBufferConstIterator;
+
   typedef typename LevelSetType::LayerMapType           LevelSetLayerMapType;
   typedef typename LevelSetType::LayerMapIterator       LevelSetLayerMapIterator;
   typedef typename LevelSetType::LayerMapConstIterator  LevelSetLayerMapConstIterator;
@@ -122,6 +126,10 @@ public:
   /** Set the update map for all points in the zero layer */
   void SetUpdate( const LevelSetLayerType& iUpdate );
 
+  /** Set the update for all points in the zero layer, given in the order in
+   *  which the nodes are stored in the zero layer */
+  void SetUpdate( const UpdateBufferType& iUpdate );
+
 
 protected:
   UpdateWhitakerSparseLevelSet();
@@ -167,7 +175,7 @@ private:
 
   EquationContainerPointer m_EquationContainer;
 
-  LevelSetLayerType  m_Update;
+  UpdateBufferType   m_Update;
   LevelSetPointer    m_InputLevelSet;
   LevelSetPointer    m_OutputLevelSet;
 
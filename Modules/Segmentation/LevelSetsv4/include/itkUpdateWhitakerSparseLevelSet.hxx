@@ -49,6 +49,21 @@ template< unsigned int VDimension,
           class TEquationContainer >
 void UpdateWhitakerSparseLevelSet< VDimension, TLevelSetValueType, TEquationContainer >
 ::SetUpdate( const LevelSetLayerType& iUpdate )
+{
+  // the update map has the nodes of the zero layer, in the same order
+  this->m_Update.clear();
+  this->m_Update.reserve( iUpdate.size() );
+  for( LevelSetLayerConstIterator it = iUpdate.begin(); it != iUpdate.end(); ++it )
+    {
+    this->m_Update.push_back( it->second );
+    }
+}
+
+template< unsigned int VDimension,
+          typename TLevelSetValueType,
+          class TEquationContainer >
+void UpdateWhitakerSparseLevelSet< VDimension, TLevelSetValueType, TEquationContainer >
+::SetUpdate( const UpdateBufferType& iUpdate )
 {
   this->m_Update = iUpdate;
 }
@@ -223,7 +238,7 @@ void UpdateWhitakerSparseLevelSet< VDimension, TLevelSetValueType, TEquationCont
   LevelSetLayerIterator nodeIt   = outputLayer0.begin();
   LevelSetLayerIterator nodeEnd  = outputLayer0.end();
 
-  LevelSetLayerIterator upIt     = this->m_Update.begin();
+  UpdateBufferConstIterator upIt = this->m_Update.begin();
 
   ZeroFluxNeumannBoundaryCondition< LabelImageType > sp_nbc;
 
@@ -250,11 +265,9 @@ void UpdateWhitakerSparseLevelSet< VDimension, TLevelSetValueType, TEquationCont
 
   while( nodeIt != nodeEnd )
     {
-    itkAssertInDebugAndIgnoreInReleaseMacro( nodeIt->first == upIt->first );
-
     LevelSetInputType   currentIndex = nodeIt->first;
     LevelSetOutputType  currentValue = nodeIt->second;
-    LevelSetOutputType  tempUpdate = this->m_TimeStep * static_cast< LevelSetOutputType >( upIt->second );
+    LevelSetOutputType  tempUpdate = this->m_TimeStep * static_cast< LevelSetOutputType >( *upIt );
 
     if( tempUpdate > 0.5 )
       {
@@ -0,0 +1,32 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkTwoLevelSetSparseImage2DThreadsTestHelper.h"
+
+int itkTwoLevelSetMalcolmImage2DThreadsTest( int , char* [] )
+{
+  typedef itk::MalcolmSparseLevelSetImage< 2 >                              SparseLevelSetType;
+  typedef itk::TwoLevelSetSparseImage2DThreadsTestHelper< SparseLevelSetType > HelperType;
+
+  // The Malcolm level set only has a zero layer, and its evolution does not
+  // support the curvature term.
+  HelperType::LayerIdListType layers;
+  layers.push_back( SparseLevelSetType::ZeroLayer() );
+
+  return HelperType::Run( layers, false );
+}
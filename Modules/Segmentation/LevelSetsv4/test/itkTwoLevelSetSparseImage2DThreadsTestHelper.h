@@ -0,0 +1,343 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkTwoLevelSetSparseImage2DThreadsTestHelper_h
+#define __itkTwoLevelSetSparseImage2DThreadsTestHelper_h
+
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkLevelSetDomainMapImageFilter.h"
+#include "itkLevelSetContainerBase.h"
+#include "itkLevelSetEquationChanAndVeseInternalTerm.h"
+#include "itkLevelSetEquationChanAndVeseExternalTerm.h"
+#include "itkLevelSetEquationCurvatureTerm.h"
+#include "itkLevelSetEquationTermContainerBase.h"
+#include "itkLevelSetEquationContainerBase.h"
+#include "itkSinRegularizedHeavisideStepFunction.h"
+#include "itkLevelSetEvolution.h"
+#include "itkBinaryImageToSparseLevelSetImageAdaptor.h"
+#include "itkLevelSetEvolutionNumberOfIterationsStoppingCriterion.h"
+#include "itkNumericTraits.h"
+
+namespace itk
+{
+
+/**
+ * \class TwoLevelSetSparseImage2DThreadsTestHelper
+ *
+ * \brief Evolve two overlapping sparse level sets with Chan and Vese terms,
+ * and check that 2, 3 and 8 threads give the same layers and status as a
+ * single thread.
+ */
+template< typename TSparseLevelSet >
+class TwoLevelSetSparseImage2DThreadsTestHelper
+{
+public:
+  typedef TSparseLevelSet                                   SparseLevelSetType;
+  typedef typename SparseLevelSetType::Pointer              SparseLevelSetPointer;
+  typedef typename SparseLevelSetType::LayerIdType          LayerIdType;
+  typedef std::vector< LayerIdType >                        LayerIdListType;
+
+  itkStaticConstMacro(Dimension, unsigned int, SparseLevelSetType::Dimension);
+
+  typedef unsigned short                                    InputPixelType;
+  typedef Image< InputPixelType, Dimension >                InputImageType;
+  typedef ImageRegionIteratorWithIndex< InputImageType >    InputIteratorType;
+
+  typedef BinaryImageToSparseLevelSetImageAdaptor< InputImageType, SparseLevelSetType >
+                                                            BinaryToSparseAdaptorType;
+
+  typedef LevelSetContainerBase< IdentifierType, SparseLevelSetType >
+                                                            LevelSetContainerType;
+
+  typedef std::list< IdentifierType >                       IdListType;
+  typedef Image< IdListType, Dimension >                    IdListImageType;
+  typedef Image< short, Dimension >                         CacheImageType;
+  typedef LevelSetDomainMapImageFilter< IdListImageType, CacheImageType >
+                                                            DomainMapImageFilterType;
+
+  typedef LevelSetEquationChanAndVeseInternalTerm< InputImageType, LevelSetContainerType >
+                                                            ChanAndVeseInternalTermType;
+  typedef LevelSetEquationChanAndVeseExternalTerm< InputImageType, LevelSetContainerType >
+                                                            ChanAndVeseExternalTermType;
+  typedef LevelSetEquationCurvatureTerm< InputImageType, LevelSetContainerType >
+                                                            CurvatureTermType;
+  typedef LevelSetEquationTermContainerBase< InputImageType, LevelSetContainerType >
+                                                            TermContainerType;
+
+  typedef LevelSetEquationContainerBase< TermContainerType >
+                                                            EquationContainerType;
+
+  typedef LevelSetEvolution< EquationContainerType, SparseLevelSetType >
+                                                            LevelSetEvolutionType;
+
+  typedef typename SparseLevelSetType::OutputRealType       LevelSetOutputRealType;
+  typedef SinRegularizedHeavisideStepFunction< LevelSetOutputRealType, LevelSetOutputRealType >
+                                                            HeavisideFunctionBaseType;
+
+  typedef LevelSetEvolutionNumberOfIterationsStoppingCriterion< LevelSetContainerType >
+                                                            StoppingCriterionType;
+
+  /** Compare the given layers, and the status of every pixel. The curvature
+   *  term is added to the equations when useCurvatureTerm is set. */
+  static int Run( const LayerIdListType & layers, bool useCurvatureTerm )
+  {
+    // Bright disk on a dark background
+    typename InputImageType::Pointer input = InputImageType::New();
+    typename InputImageType::SizeType size;
+    size.Fill( 64 );
+    input->SetRegions( size );
+    input->Allocate();
+
+    InputIteratorType iIt( input, input->GetLargestPossibleRegion() );
+    iIt.GoToBegin();
+    while( !iIt.IsAtEnd() )
+      {
+      typename InputImageType::IndexType idx = iIt.GetIndex();
+      const double dx = idx[0] - 30.;
+      const double dy = idx[1] - 34.;
+      iIt.Set( ( dx * dx + dy * dy < 300. ) ? 200 : 20 + ( ( idx[0] * 7 + idx[1] * 3 ) % 11 ) );
+      ++iIt;
+      }
+
+    const unsigned int numberOfIterations = 10;
+
+    SparseLevelSetPointer reference0;
+    SparseLevelSetPointer reference1;
+
+    try
+      {
+      EvolveTwoLevelSets( input, 1, numberOfIterations, useCurvatureTerm, reference0, reference1 );
+      }
+    catch ( ExceptionObject& err )
+      {
+      std::cerr << err << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    const ThreadIdType threads[] = { 2, 3, 8 };
+    for( unsigned int t = 0; t < 3; t++ )
+      {
+      SparseLevelSetPointer levelSet0;
+      SparseLevelSetPointer levelSet1;
+
+      try
+        {
+        EvolveTwoLevelSets( input, threads[t], numberOfIterations, useCurvatureTerm, levelSet0, levelSet1 );
+        }
+      catch ( ExceptionObject& err )
+        {
+        std::cerr << err << std::endl;
+        return EXIT_FAILURE;
+        }
+
+      std::cout << threads[t] << " threads" << std::endl;
+      if( !CompareLevelSets( levelSet0, reference0, layers, input->GetLargestPossibleRegion() ) ||
+          !CompareLevelSets( levelSet1, reference1, layers, input->GetLargestPossibleRegion() ) )
+        {
+        std::cerr << "Evolution with " << threads[t]
+                  << " threads differs from the single threaded one" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+
+    typename LevelSetEvolutionType::Pointer evolution = LevelSetEvolutionType::New();
+    if( evolution->GetNumberOfThreads() != 1 )
+      {
+      std::cerr << "NumberOfThreads should default to 1" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    evolution->SetNumberOfThreads( 0 );
+    if( evolution->GetNumberOfThreads() != 1 )
+      {
+      std::cerr << "NumberOfThreads should be clamped to 1" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    return EXIT_SUCCESS;
+  }
+
+private:
+  static SparseLevelSetPointer
+  CreateLevelSet( InputImageType * input, const typename InputImageType::IndexType & index,
+                  const typename InputImageType::SizeType & size )
+  {
+    typename InputImageType::Pointer binary = InputImageType::New();
+    binary->SetRegions( input->GetLargestPossibleRegion() );
+    binary->CopyInformation( input );
+    binary->Allocate();
+    binary->FillBuffer( NumericTraits<InputPixelType>::Zero );
+
+    typename InputImageType::RegionType region;
+    region.SetIndex( index );
+    region.SetSize( size );
+
+    InputIteratorType iIt( binary, region );
+    iIt.GoToBegin();
+    while( !iIt.IsAtEnd() )
+      {
+      iIt.Set( NumericTraits<InputPixelType>::One );
+      ++iIt;
+      }
+
+    typename BinaryToSparseAdaptorType::Pointer adaptor = BinaryToSparseAdaptorType::New();
+    adaptor->SetInputImage( binary );
+    adaptor->Initialize();
+
+    return adaptor->GetLevelSet();
+  }
+
+  // Evolve two overlapping level sets with the given number of threads
+  static void
+  EvolveTwoLevelSets( InputImageType * input, ThreadIdType numberOfThreads,
+                      unsigned int numberOfIterations, bool useCurvatureTerm,
+                      SparseLevelSetPointer & levelSet0,
+                      SparseLevelSetPointer & levelSet1 )
+  {
+    typename InputImageType::IndexType index;
+    typename InputImageType::SizeType size;
+
+    index.Fill( 10 );
+    size.Fill( 30 );
+    levelSet0 = CreateLevelSet( input, index, size );
+
+    index.Fill( 25 );
+    size.Fill( 20 );
+    levelSet1 = CreateLevelSet( input, index, size );
+
+    IdListType list_ids;
+    list_ids.push_back( 1 );
+    list_ids.push_back( 2 );
+
+    typename IdListImageType::Pointer id_image = IdListImageType::New();
+    id_image->SetRegions( input->GetLargestPossibleRegion() );
+    id_image->Allocate();
+    id_image->FillBuffer( list_ids );
+
+    typename DomainMapImageFilterType::Pointer domainMapFilter = DomainMapImageFilterType::New();
+    domainMapFilter->SetInput( id_image );
+    domainMapFilter->Update();
+
+    typename HeavisideFunctionBaseType::Pointer heaviside = HeavisideFunctionBaseType::New();
+    heaviside->SetEpsilon( 1.0 );
+
+    typename LevelSetContainerType::Pointer lscontainer = LevelSetContainerType::New();
+    lscontainer->SetHeaviside( heaviside );
+    lscontainer->SetDomainMapFilter( domainMapFilter );
+    lscontainer->AddLevelSet( 0, levelSet0, false );
+    lscontainer->AddLevelSet( 1, levelSet1, false );
+
+    typename EquationContainerType::Pointer equationContainer = EquationContainerType::New();
+
+    for( IdentifierType id = 0; id < 2; id++ )
+      {
+      typename ChanAndVeseInternalTermType::Pointer cvInternalTerm = ChanAndVeseInternalTermType::New();
+      cvInternalTerm->SetInput( input );
+      cvInternalTerm->SetCoefficient( 1.0 );
+      cvInternalTerm->SetCurrentLevelSetId( id );
+      cvInternalTerm->SetLevelSetContainer( lscontainer );
+
+      typename ChanAndVeseExternalTermType::Pointer cvExternalTerm = ChanAndVeseExternalTermType::New();
+      cvExternalTerm->SetInput( input );
+      cvExternalTerm->SetCoefficient( 1.0 );
+      cvExternalTerm->SetCurrentLevelSetId( id );
+      cvExternalTerm->SetLevelSetContainer( lscontainer );
+
+      typename TermContainerType::Pointer termContainer = TermContainerType::New();
+      termContainer->SetInput( input );
+      termContainer->AddTerm( 0, cvInternalTerm.GetPointer() );
+      termContainer->AddTerm( 1, cvExternalTerm.GetPointer() );
+
+      if( useCurvatureTerm )
+        {
+        typename CurvatureTermType::Pointer curvatureTerm = CurvatureTermType::New();
+        curvatureTerm->SetInput( input );
+        curvatureTerm->SetCoefficient( 1.0 );
+        curvatureTerm->SetCurrentLevelSetId( id );
+        curvatureTerm->SetLevelSetContainer( lscontainer );
+        termContainer->AddTerm( 2, curvatureTerm.GetPointer() );
+        }
+
+      equationContainer->AddEquation( id, termContainer );
+      }
+
+    typename StoppingCriterionType::Pointer criterion = StoppingCriterionType::New();
+    criterion->SetNumberOfIterations( numberOfIterations );
+
+    typename LevelSetEvolutionType::Pointer evolution = LevelSetEvolutionType::New();
+    evolution->SetEquationContainer( equationContainer );
+    evolution->SetStoppingCriterion( criterion );
+    evolution->SetLevelSetContainer( lscontainer );
+    evolution->SetNumberOfThreads( numberOfThreads );
+    evolution->Update();
+  }
+
+  static bool
+  CompareLevelSets( const SparseLevelSetType * levelSetA,
+                    const SparseLevelSetType * levelSetB,
+                    const LayerIdListType & layers,
+                    const typename InputImageType::RegionType & region )
+  {
+    for( typename LayerIdListType::const_iterator lIt = layers.begin(); lIt != layers.end(); ++lIt )
+      {
+      const typename SparseLevelSetType::LayerType & layerA = levelSetA->GetLayer( *lIt );
+      const typename SparseLevelSetType::LayerType & layerB = levelSetB->GetLayer( *lIt );
+
+      if( layerA.size() != layerB.size() )
+        {
+        std::cerr << "Layer " << static_cast< int >( *lIt ) << " has "
+                  << layerA.size() << " nodes instead of " << layerB.size() << std::endl;
+        return false;
+        }
+
+      typename SparseLevelSetType::LayerConstIterator itA = layerA.begin();
+      typename SparseLevelSetType::LayerConstIterator itB = layerB.begin();
+      while( itA != layerA.end() )
+        {
+        if( ( itA->first != itB->first ) || ( itA->second != itB->second ) )
+          {
+          std::cerr << "Layer " << static_cast< int >( *lIt ) << " differs at "
+                    << itA->first << ": " << itA->second << " != " << itB->second << std::endl;
+          return false;
+          }
+        ++itA;
+        ++itB;
+        }
+      }
+
+    typename InputImageType::IndexType idx;
+    for( idx[1] = region.GetIndex()[1];
+         idx[1] < region.GetIndex()[1] + static_cast< IndexValueType >( region.GetSize()[1] ); idx[1]++ )
+      {
+      for( idx[0] = region.GetIndex()[0];
+           idx[0] < region.GetIndex()[0] + static_cast< IndexValueType >( region.GetSize()[0] ); idx[0]++ )
+        {
+        if( levelSetA->Status( idx ) != levelSetB->Status( idx ) )
+          {
+          std::cerr << "Status differs at " << idx << std::endl;
+          return false;
+          }
+        }
+      }
+    return true;
+  }
+};
+
+} // end namespace itk
+
+#endif
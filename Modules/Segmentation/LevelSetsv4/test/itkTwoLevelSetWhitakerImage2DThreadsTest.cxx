@@ -0,0 +1,34 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkTwoLevelSetSparseImage2DThreadsTestHelper.h"
+
+int itkTwoLevelSetWhitakerImage2DThreadsTest( int , char* [] )
+{
+  typedef itk::WhitakerSparseLevelSetImage< float, 2 >                      SparseLevelSetType;
+  typedef itk::TwoLevelSetSparseImage2DThreadsTestHelper< SparseLevelSetType > HelperType;
+
+  HelperType::LayerIdListType layers;
+  for( SparseLevelSetType::LayerIdType status = SparseLevelSetType::MinusTwoLayer();
+       status <= SparseLevelSetType::PlusTwoLayer(); status++ )
+    {
+    layers.push_back( status );
+    }
+
+  return HelperType::Run( layers, true );
+}
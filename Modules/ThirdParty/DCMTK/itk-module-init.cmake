@@ -3,4 +3,6 @@ mark_as_advanced(ITK_USE_SYSTEM_DCMTK)
 
 if(ITK_USE_SYSTEM_DCMTK)
   find_package(DCMTK REQUIRED)
+else()
+  message(FATAL_ERROR "DCMTK is not bundled with ITK: Module_ITKDCMTK requires ITK_USE_SYSTEM_DCMTK.")
 endif()
@@ -1,13 +1,9 @@
 set(DOCUMENTATION "This module contains the third party <a
-href=\"http://dicom.offis.de/dcmtk/\">DCMTK</a> DCMTK is a collection of libraries and applications implementing large parts the DICOM standard.")
+href=\"http://dicom.offis.de/dcmtk/\">DCMTK</a> DCMTK is a collection of libraries and applications implementing large parts the DICOM standard.
+DCMTK is not bundled with ITK, this module requires ITK_USE_SYSTEM_DCMTK.")
 
 itk_module(ITKDCMTK
-  DEPENDS
-     ITKDCMTK
-     ITKIOBase
-  TEST_DEPENDS
-     ITKTestKernel
-     ITKImageIntensity
+  EXCLUDE_FROM_ALL
   DESCRIPTION
     "${DOCUMENTATION}"
 )
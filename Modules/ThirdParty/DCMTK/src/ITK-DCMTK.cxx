@@ -0,0 +1 @@
+int ITK_DCMTK(void) {return 0; }
@@ -1620,8 +1620,11 @@ WriteStream(METAIO_STREAM::ofstream * _stream,
 
   m_WriteStream = _stream;
 
+  // When only the header is written, the caller gives the size of the
+  // data it compresses itself through CompressedDataSize().
   unsigned char * compressedElementData = NULL;
-  if(m_BinaryData && m_CompressedData && !strstr(m_ElementDataFileName, "%"))
+  if(_writeElements && m_BinaryData && m_CompressedData
+     && !strstr(m_ElementDataFileName, "%"))
     // compressed & !slice/file
     {
     int elementSize;
@@ -194,6 +194,51 @@ void MetaObject
   m_UserDefinedReadFields.clear();
   }
 
+// Remove one user's field
+bool MetaObject
+::RemoveUserField(const char* _fieldName)
+  {
+  // m_Fields may hold the records: release it while they are still
+  // known as user's fields. The same record may also be in both lists.
+  this->ClearFields();
+
+  FieldsContainerType removed;
+  FieldsContainerType * lists[2] = { &m_UserDefinedWriteFields,
+                                     &m_UserDefinedReadFields };
+  for(int l=0; l<2; l++)
+    {
+    FieldsContainerType::iterator it = lists[l]->begin();
+    while(it != lists[l]->end())
+      {
+      if(!strcmp((*it)->name, _fieldName))
+        {
+        if(METAIO_STL::find(removed.begin(), removed.end(), *it)
+           == removed.end())
+          {
+          removed.push_back(*it);
+          }
+        it = lists[l]->erase(it);
+        }
+      else
+        {
+        it++;
+        }
+      }
+    }
+  if(removed.empty())
+    {
+    return false;
+    }
+
+  FieldsContainerType::iterator it = removed.begin();
+  while(it != removed.end())
+    {
+    delete *it;
+    it++;
+    }
+  return true;
+  }
+
 // Clear AdditionalReadFields
 void MetaObject
 ::ClearAdditionalFields()
@@ -1024,6 +1069,16 @@ bool MetaObject::CompressedData(void) const
   return m_CompressedData;
   }
 
+void MetaObject::CompressedDataSize(METAIO_STL::streamoff _compressedDataSize)
+  {
+  m_CompressedDataSize = _compressedDataSize;
+  }
+
+METAIO_STL::streamoff MetaObject::CompressedDataSize(void) const
+  {
+  return m_CompressedDataSize;
+  }
+
 void  MetaObject::BinaryData(bool _binaryData)
   {
   m_BinaryData = _binaryData;
@@ -266,6 +266,13 @@ class METAIO_EXPORT MetaObject
       void  CompressedData(bool _compressedData);
       bool  CompressedData(void) const;
 
+      //    CompressedDataSize(...)
+      //       Optional Field
+      //       Size of the compressed data, written with a header when
+      //       the data are compressed by the caller
+      void  CompressedDataSize(METAIO_STL::streamoff _compressedDataSize);
+      METAIO_STL::streamoff CompressedDataSize(void) const;
+
 
       virtual void Clear(void);
 
@@ -345,6 +352,9 @@ class METAIO_EXPORT MetaObject
       // Clear UserFields
       void ClearUserFields();
 
+      // Remove one user's field
+      bool RemoveUserField(const char* _fieldName);
+
       // Get the user field
       void* GetUserField(const char* _name);
 